@@ -97,6 +97,119 @@ static void SHA1Transform(ULONG State[5], UCHAR Buffer[64])
 }
 
 
+#if defined(__GNUC__) && defined(__x86_64__)
+
+/* SHA1 using the SHA extensions, x86_64 only */
+
+static void sha_cpuid(unsigned int ax, unsigned int cx, unsigned int *p)
+{
+   __asm__("cpuid"
+           : "=a" (p[0]), "=b" (p[1]), "=c" (p[2]), "=d" (p[3])
+           : "0" (ax), "2" (cx));
+}
+
+/* -1 until the CPU has been checked */
+static int sha_ni_present = -1;
+
+static BOOL sha_ni_available(void)
+{
+   unsigned int regs[4];
+
+   if (sha_ni_present < 0)
+   {
+      sha_ni_present = 0;
+      sha_cpuid(0, 0, regs);
+      if (regs[0] >= 7)
+      {
+         sha_cpuid(1, 0, regs);
+         /* SSSE3 and SSE4.1 are used too */
+         if ((regs[2] & (1 << 9)) && (regs[2] & (1 << 19)))
+         {
+            sha_cpuid(7, 0, regs);
+            sha_ni_present = (regs[1] >> 29) & 1;
+         }
+      }
+   }
+   return sha_ni_present;
+}
+
+/* pshufb mask turning the big endian block around */
+static const UCHAR sha1_ni_shuffle[16] =
+{
+   15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0
+};
+
+/*
+ * Register use: xmm0 ABCD, xmm1/xmm2 E, alternating between groups of four
+ * rounds, xmm3-xmm6 message schedule, xmm7 byte shuffle mask, xmm8/xmm9
+ * state at the start of the block.
+ */
+#define SHA1NI_LOAD(i, m) \
+   "movdqu " #i "*16(%[data]), %%xmm" #m "\n\t" \
+   "pshufb %%xmm7, %%xmm" #m "\n\t"
+/* four rounds, e taken from ecur and saved to enext for the following ones */
+#define SHA1NI_RNDS(f, m, ecur, enext) \
+   "sha1nexte %%xmm" #m ", %%xmm" #ecur "\n\t" \
+   "movdqa %%xmm0, %%xmm" #enext "\n\t" \
+   "sha1rnds4 $" #f ", %%xmm" #ecur ", %%xmm0\n\t"
+#define SHA1NI_MSG1(cur, prev) \
+   "sha1msg1 %%xmm" #cur ", %%xmm" #prev "\n\t"
+#define SHA1NI_MSG2(cur, next) \
+   "sha1msg2 %%xmm" #cur ", %%xmm" #next "\n\t"
+#define SHA1NI_XOR(cur, prev2) \
+   "pxor %%xmm" #cur ", %%xmm" #prev2 "\n\t"
+
+static void SHA1Transform_ni(ULONG State[5], const UCHAR *data, UINT blocks)
+{
+   __asm__ __volatile__(
+      "movdqu (%[state]), %%xmm0\n\t"
+      "movd 16(%[state]), %%xmm1\n\t"
+      "pslldq $12, %%xmm1\n\t"
+      "pshufd $0x1b, %%xmm0, %%xmm0\n\t"
+      "movdqu (%[shuf]), %%xmm7\n"
+      "1:\tmovdqa %%xmm1, %%xmm8\n\t"
+      "movdqa %%xmm0, %%xmm9\n\t"
+      /* rounds 0-15 */
+      SHA1NI_LOAD(0, 3)
+      "paddd %%xmm3, %%xmm1\n\t"
+      "movdqa %%xmm0, %%xmm2\n\t"
+      "sha1rnds4 $0, %%xmm1, %%xmm0\n\t"
+      SHA1NI_LOAD(1, 4) SHA1NI_RNDS(0, 4, 2, 1) SHA1NI_MSG1(4, 3)
+      SHA1NI_LOAD(2, 5) SHA1NI_RNDS(0, 5, 1, 2) SHA1NI_MSG1(5, 4) SHA1NI_XOR(5, 3)
+      SHA1NI_LOAD(3, 6) SHA1NI_MSG2(6, 3) SHA1NI_RNDS(0, 6, 2, 1) SHA1NI_MSG1(6, 5) SHA1NI_XOR(6, 4)
+      /* rounds 16-79 */
+      SHA1NI_MSG2(3, 4) SHA1NI_RNDS(0, 3, 1, 2) SHA1NI_MSG1(3, 6) SHA1NI_XOR(3, 5)
+      SHA1NI_MSG2(4, 5) SHA1NI_RNDS(1, 4, 2, 1) SHA1NI_MSG1(4, 3) SHA1NI_XOR(4, 6)
+      SHA1NI_MSG2(5, 6) SHA1NI_RNDS(1, 5, 1, 2) SHA1NI_MSG1(5, 4) SHA1NI_XOR(5, 3)
+      SHA1NI_MSG2(6, 3) SHA1NI_RNDS(1, 6, 2, 1) SHA1NI_MSG1(6, 5) SHA1NI_XOR(6, 4)
+      SHA1NI_MSG2(3, 4) SHA1NI_RNDS(1, 3, 1, 2) SHA1NI_MSG1(3, 6) SHA1NI_XOR(3, 5)
+      SHA1NI_MSG2(4, 5) SHA1NI_RNDS(1, 4, 2, 1) SHA1NI_MSG1(4, 3) SHA1NI_XOR(4, 6)
+      SHA1NI_MSG2(5, 6) SHA1NI_RNDS(2, 5, 1, 2) SHA1NI_MSG1(5, 4) SHA1NI_XOR(5, 3)
+      SHA1NI_MSG2(6, 3) SHA1NI_RNDS(2, 6, 2, 1) SHA1NI_MSG1(6, 5) SHA1NI_XOR(6, 4)
+      SHA1NI_MSG2(3, 4) SHA1NI_RNDS(2, 3, 1, 2) SHA1NI_MSG1(3, 6) SHA1NI_XOR(3, 5)
+      SHA1NI_MSG2(4, 5) SHA1NI_RNDS(2, 4, 2, 1) SHA1NI_MSG1(4, 3) SHA1NI_XOR(4, 6)
+      SHA1NI_MSG2(5, 6) SHA1NI_RNDS(2, 5, 1, 2) SHA1NI_MSG1(5, 4) SHA1NI_XOR(5, 3)
+      SHA1NI_MSG2(6, 3) SHA1NI_RNDS(3, 6, 2, 1) SHA1NI_MSG1(6, 5) SHA1NI_XOR(6, 4)
+      SHA1NI_MSG2(3, 4) SHA1NI_RNDS(3, 3, 1, 2) SHA1NI_MSG1(3, 6) SHA1NI_XOR(3, 5)
+      SHA1NI_MSG2(4, 5) SHA1NI_RNDS(3, 4, 2, 1) SHA1NI_XOR(4, 6)
+      SHA1NI_MSG2(5, 6) SHA1NI_RNDS(3, 5, 1, 2)
+      SHA1NI_RNDS(3, 6, 2, 1)
+      "sha1nexte %%xmm8, %%xmm1\n\t"
+      "paddd %%xmm9, %%xmm0\n\t"
+      "add $64, %[data]\n\t"
+      "dec %[blocks]\n\t"
+      "jnz 1b\n\t"
+      "pshufd $0x1b, %%xmm0, %%xmm0\n\t"
+      "movdqu %%xmm0, (%[state])\n\t"
+      "pextrd $3, %%xmm1, 16(%[state])"
+      : [data] "+r" (data), [blocks] "+r" (blocks)
+      : [state] "r" (State), [shuf] "r" (sha1_ni_shuffle)
+      : "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6", "xmm7",
+        "xmm8", "xmm9", "memory", "cc");
+}
+
+#endif
+
 /******************************************************************************
  * A_SHAInit [ADVAPI32.@]
  *
@@ -150,6 +263,27 @@ A_SHAUpdate(PSHA_CTX Context, const unsigned char *Buffer, UINT BufferSize)
       RtlCopyMemory(&Context->Buffer[BufferContentSize], Buffer,
                     BufferSize);
    }
+#if defined(__GNUC__) && defined(__x86_64__)
+   else if (sha_ni_available())
+   {
+      /* the input is not modified, so whole blocks are hashed in place */
+      if (BufferContentSize)
+      {
+         RtlCopyMemory(Context->Buffer + BufferContentSize, Buffer,
+                       64 - BufferContentSize);
+         Buffer += 64 - BufferContentSize;
+         BufferSize -= 64 - BufferContentSize;
+         SHA1Transform_ni(Context->State, Context->Buffer, 1);
+      }
+      if (BufferSize >= 64)
+      {
+         SHA1Transform_ni(Context->State, Buffer, BufferSize / 64);
+         Buffer += BufferSize & ~63;
+         BufferSize &= 63;
+      }
+      RtlCopyMemory(Context->Buffer, Buffer, BufferSize);
+   }
+#endif
    else
    {
       while (BufferContentSize + BufferSize >= 64)
@@ -1,6 +1,6 @@
 @ stdcall CancelIo(long) kernel32.CancelIo
 @ stdcall CancelIoEx(long ptr) kernel32.CancelIoEx
-@ stub CancelSynchronousIo
+@ stdcall CancelSynchronousIo(long) kernel32.CancelSynchronousIo
 @ stdcall CreateIoCompletionPort(long long long long) kernel32.CreateIoCompletionPort
 @ stdcall DeviceIoControl(long long ptr long ptr long ptr ptr) kernel32.DeviceIoControl
 @ stdcall GetOverlappedResult(long ptr ptr long) kernel32.GetOverlappedResult
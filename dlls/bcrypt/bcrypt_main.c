@@ -27,10 +27,138 @@
 #include "winbase.h"
 #include "ntsecapi.h"
 #include "bcrypt.h"
+#include "tomcrypt.h"
+#include "sha2.h"
 #include "wine/debug.h"
+#include "wine/unicode.h"
 
 WINE_DEFAULT_DEBUG_CHANNEL(bcrypt);
 
+/* Next typedef copied from dlls/advapi32/crypt_md5.c */
+typedef struct tagMD5_CTX
+{
+    unsigned int i[2];
+    unsigned int buf[4];
+    unsigned char in[64];
+    unsigned char digest[16];
+} MD5_CTX;
+
+/* Next typedef copied from dlls/advapi32/crypt_sha.c */
+typedef struct tagSHA_CTX
+{
+    ULONG Unknown[6];
+    ULONG State[5];
+    ULONG Count[2];
+    UCHAR Buffer[64];
+} SHA_CTX, *PSHA_CTX;
+
+VOID WINAPI MD5Init( MD5_CTX *ctx );
+VOID WINAPI MD5Update( MD5_CTX *ctx, const unsigned char *buf, unsigned int len );
+VOID WINAPI MD5Final( MD5_CTX *ctx );
+
+VOID WINAPI A_SHAInit(PSHA_CTX Context);
+VOID WINAPI A_SHAUpdate(PSHA_CTX Context, const unsigned char *Buffer, UINT BufferSize);
+VOID WINAPI A_SHAFinal(PSHA_CTX Context, PULONG Result);
+
+#define MAGIC_ALG  (('A' << 24) | ('L' << 16) | ('G' << 8) | '0')
+#define MAGIC_HASH (('H' << 24) | ('A' << 16) | ('S' << 8) | 'H')
+#define MAGIC_KEY  (('K' << 24) | ('E' << 16) | ('Y' << 8) | '0')
+
+struct object
+{
+    ULONG magic;
+};
+
+enum alg_id
+{
+    ALG_ID_AES,
+    ALG_ID_MD5,
+    ALG_ID_SHA1,
+    ALG_ID_SHA256,
+    ALG_ID_SHA384,
+    ALG_ID_SHA512
+};
+
+enum mode_id
+{
+    MODE_ID_NA,
+    MODE_ID_CBC,
+    MODE_ID_ECB
+};
+
+#define AES_BLOCK_LEN 16
+
+static const struct
+{
+    const WCHAR *name;
+    ULONG        hash_length;
+    ULONG        block_length;
+    enum mode_id mode;
+} alg_props[] =
+{
+    /* ALG_ID_AES    */ { BCRYPT_AES_ALGORITHM,    0,                     AES_BLOCK_LEN, MODE_ID_CBC },
+    /* ALG_ID_MD5    */ { BCRYPT_MD5_ALGORITHM,    16,                    0,             MODE_ID_NA },
+    /* ALG_ID_SHA1   */ { BCRYPT_SHA1_ALGORITHM,   20,                    0,             MODE_ID_NA },
+    /* ALG_ID_SHA256 */ { BCRYPT_SHA256_ALGORITHM, SHA256_DIGEST_LENGTH,  0,             MODE_ID_NA },
+    /* ALG_ID_SHA384 */ { BCRYPT_SHA384_ALGORITHM, SHA384_DIGEST_LENGTH,  0,             MODE_ID_NA },
+    /* ALG_ID_SHA512 */ { BCRYPT_SHA512_ALGORITHM, SHA512_DIGEST_LENGTH,  0,             MODE_ID_NA }
+};
+
+struct algorithm
+{
+    struct object hdr;
+    enum alg_id   id;
+    enum mode_id  mode;
+    ULONG         flags;
+};
+
+/* Hash providers have no state that can be changed after they are opened,
+ * so every open of the same hash algorithm returns one of these shared
+ * handles instead of allocating a new one. Only AES handles, whose chaining
+ * mode can be set per handle, are allocated. */
+static struct algorithm shared_algs[] =
+{
+    { { MAGIC_ALG }, ALG_ID_MD5,    MODE_ID_NA, 0 },
+    { { MAGIC_ALG }, ALG_ID_MD5,    MODE_ID_NA, BCRYPT_HASH_REUSABLE_FLAG },
+    { { MAGIC_ALG }, ALG_ID_SHA1,   MODE_ID_NA, 0 },
+    { { MAGIC_ALG }, ALG_ID_SHA1,   MODE_ID_NA, BCRYPT_HASH_REUSABLE_FLAG },
+    { { MAGIC_ALG }, ALG_ID_SHA256, MODE_ID_NA, 0 },
+    { { MAGIC_ALG }, ALG_ID_SHA256, MODE_ID_NA, BCRYPT_HASH_REUSABLE_FLAG },
+    { { MAGIC_ALG }, ALG_ID_SHA384, MODE_ID_NA, 0 },
+    { { MAGIC_ALG }, ALG_ID_SHA384, MODE_ID_NA, BCRYPT_HASH_REUSABLE_FLAG },
+    { { MAGIC_ALG }, ALG_ID_SHA512, MODE_ID_NA, 0 },
+    { { MAGIC_ALG }, ALG_ID_SHA512, MODE_ID_NA, BCRYPT_HASH_REUSABLE_FLAG }
+};
+
+static BOOL is_shared_alg(const struct algorithm *alg)
+{
+    return alg >= shared_algs && alg < shared_algs + sizeof(shared_algs)/sizeof(shared_algs[0]);
+}
+
+struct hash
+{
+    struct object hdr;
+    enum alg_id   alg_id;
+    BOOL          reusable;
+    BOOL          allocated;
+    union
+    {
+        MD5_CTX    md5;
+        SHA_CTX    sha1;
+        SHA256_CTX sha256;
+        SHA512_CTX sha512;
+    } u;
+};
+
+struct key
+{
+    struct object hdr;
+    enum alg_id   alg_id;
+    enum mode_id  mode;
+    BOOL          allocated;
+    aes_key       aes;
+};
+
 NTSTATUS WINAPI BCryptEnumAlgorithms(ULONG dwAlgOperations, ULONG *pAlgCount,
                                      BCRYPT_ALGORITHM_IDENTIFIER **ppAlgList, ULONG dwFlags)
 {
@@ -78,24 +206,77 @@ NTSTATUS WINAPI BCryptGenRandom(BCRYPT_ALG_HANDLE algorithm, UCHAR *buffer, ULON
     return STATUS_NOT_IMPLEMENTED;
 }
 
-NTSTATUS WINAPI BCryptOpenAlgorithmProvider(BCRYPT_ALG_HANDLE *algorithm, LPCWSTR algorithmId,
-                                            LPCWSTR implementation, DWORD flags)
+NTSTATUS WINAPI BCryptOpenAlgorithmProvider(BCRYPT_ALG_HANDLE *handle, LPCWSTR id, LPCWSTR implementation, ULONG flags)
 {
-    FIXME("%p, %s, %s, %08x - stub\n", algorithm, wine_dbgstr_w(algorithmId), wine_dbgstr_w(implementation), flags);
+    const ULONG supported_flags = BCRYPT_HASH_REUSABLE_FLAG;
+    struct algorithm *alg;
+    enum alg_id alg_id;
+    unsigned int i;
 
-    if (!algorithm)
+    TRACE("%p, %s, %s, %08x\n", handle, wine_dbgstr_w(id), wine_dbgstr_w(implementation), flags);
+
+    if (!handle || !id)
         return STATUS_INVALID_PARAMETER;
 
-    *algorithm = NULL;
+    if (flags & ~supported_flags)
+    {
+        FIXME("unsupported flags %08x\n", flags & ~supported_flags);
+        return STATUS_NOT_IMPLEMENTED;
+    }
 
-    return STATUS_NOT_IMPLEMENTED;
+    for (i = 0; i < sizeof(alg_props)/sizeof(alg_props[0]); i++)
+        if (!strcmpW(id, alg_props[i].name)) break;
+    if (i == sizeof(alg_props)/sizeof(alg_props[0]))
+    {
+        FIXME("algorithm %s not supported\n", debugstr_w(id));
+        return STATUS_NOT_IMPLEMENTED;
+    }
+    alg_id = i;
+
+    if (implementation && strcmpW(implementation, MS_PRIMITIVE_PROVIDER))
+    {
+        FIXME("implementation %s not supported\n", debugstr_w(implementation));
+        return STATUS_NOT_IMPLEMENTED;
+    }
+
+    if (alg_id != ALG_ID_AES)
+    {
+        for (i = 0; i < sizeof(shared_algs)/sizeof(shared_algs[0]); i++)
+        {
+            if (shared_algs[i].id == alg_id && shared_algs[i].flags == flags)
+            {
+                *handle = &shared_algs[i];
+                return STATUS_SUCCESS;
+            }
+        }
+    }
+
+    if (!(alg = HeapAlloc( GetProcessHeap(), 0, sizeof(*alg) )))
+        return STATUS_NO_MEMORY;
+    alg->hdr.magic = MAGIC_ALG;
+    alg->id        = alg_id;
+    alg->mode      = alg_props[alg_id].mode;
+    alg->flags     = flags;
+
+    *handle = alg;
+    return STATUS_SUCCESS;
 }
 
-NTSTATUS WINAPI BCryptCloseAlgorithmProvider(BCRYPT_ALG_HANDLE algorithm, DWORD flags)
+NTSTATUS WINAPI BCryptCloseAlgorithmProvider(BCRYPT_ALG_HANDLE handle, ULONG flags)
 {
-    FIXME("%p, %08x - stub\n", algorithm, flags);
+    struct algorithm *alg = handle;
 
-    return STATUS_NOT_IMPLEMENTED;
+    TRACE("%p, %08x\n", handle, flags);
+
+    if (!alg || alg->hdr.magic != MAGIC_ALG)
+        return STATUS_INVALID_HANDLE;
+
+    if (is_shared_alg(alg))
+        return STATUS_SUCCESS;
+
+    alg->hdr.magic = 0;
+    HeapFree( GetProcessHeap(), 0, alg );
+    return STATUS_SUCCESS;
 }
 
 NTSTATUS WINAPI BCryptGetFipsAlgorithmMode(BOOLEAN *enabled)
@@ -109,9 +290,494 @@ NTSTATUS WINAPI BCryptGetFipsAlgorithmMode(BOOLEAN *enabled)
     return STATUS_SUCCESS;
 }
 
-NTSTATUS WINAPI BCryptGetProperty(BCRYPT_HANDLE obj, LPCWSTR prop, UCHAR *buffer, ULONG count, ULONG *res, ULONG flags)
+static NTSTATUS get_property_value(const void *value, ULONG size, UCHAR *buf, ULONG count, ULONG *ret_size)
 {
-    FIXME("%p, %s, %p, %u, %p, %08x - stub\n", obj, wine_dbgstr_w(prop), buffer, count, res, flags);
+    *ret_size = size;
+    if (!buf)
+        return STATUS_SUCCESS;
+    if (count < size)
+        return STATUS_BUFFER_TOO_SMALL;
+    memcpy(buf, value, size);
+    return STATUS_SUCCESS;
+}
+
+static NTSTATUS get_alg_property(enum alg_id id, enum mode_id mode, const WCHAR *prop,
+                                 UCHAR *buf, ULONG count, ULONG *ret_size)
+{
+    ULONG value;
+
+    if (!strcmpW(prop, BCRYPT_OBJECT_LENGTH))
+    {
+        value = (id == ALG_ID_AES) ? sizeof(struct key) : sizeof(struct hash);
+        return get_property_value(&value, sizeof(value), buf, count, ret_size);
+    }
+    if (!strcmpW(prop, BCRYPT_ALGORITHM_NAME))
+    {
+        const WCHAR *name = alg_props[id].name;
+        return get_property_value(name, (strlenW(name) + 1) * sizeof(WCHAR), buf, count, ret_size);
+    }
+    if (!strcmpW(prop, BCRYPT_HASH_LENGTH) && alg_props[id].hash_length)
+    {
+        value = alg_props[id].hash_length;
+        return get_property_value(&value, sizeof(value), buf, count, ret_size);
+    }
+    if (!strcmpW(prop, BCRYPT_BLOCK_LENGTH) && alg_props[id].block_length)
+    {
+        value = alg_props[id].block_length;
+        return get_property_value(&value, sizeof(value), buf, count, ret_size);
+    }
+    if (!strcmpW(prop, BCRYPT_CHAINING_MODE) && id == ALG_ID_AES)
+    {
+        const WCHAR *str = (mode == MODE_ID_ECB) ? BCRYPT_CHAIN_MODE_ECB : BCRYPT_CHAIN_MODE_CBC;
+        return get_property_value(str, (strlenW(str) + 1) * sizeof(WCHAR), buf, count, ret_size);
+    }
 
+    FIXME("unsupported property %s\n", debugstr_w(prop));
     return STATUS_NOT_IMPLEMENTED;
 }
+
+NTSTATUS WINAPI BCryptGetProperty(BCRYPT_HANDLE handle, LPCWSTR prop, UCHAR *buffer, ULONG count, ULONG *res, ULONG flags)
+{
+    struct object *object = handle;
+
+    TRACE("%p, %s, %p, %u, %p, %08x\n", handle, wine_dbgstr_w(prop), buffer, count, res, flags);
+
+    if (!object) return STATUS_INVALID_HANDLE;
+    if (!prop || !res) return STATUS_INVALID_PARAMETER;
+
+    switch (object->magic)
+    {
+    case MAGIC_ALG:
+    {
+        const struct algorithm *alg = (const struct algorithm *)object;
+        return get_alg_property(alg->id, alg->mode, prop, buffer, count, res);
+    }
+    case MAGIC_HASH:
+    {
+        const struct hash *hash = (const struct hash *)object;
+        return get_alg_property(hash->alg_id, MODE_ID_NA, prop, buffer, count, res);
+    }
+    case MAGIC_KEY:
+    {
+        const struct key *key = (const struct key *)object;
+        return get_alg_property(key->alg_id, key->mode, prop, buffer, count, res);
+    }
+    default:
+        WARN("unknown magic %08x\n", object->magic);
+        return STATUS_INVALID_HANDLE;
+    }
+}
+
+static NTSTATUS set_chaining_mode(enum alg_id id, enum mode_id *mode, const UCHAR *value, ULONG size)
+{
+    if (id != ALG_ID_AES)
+        return STATUS_NOT_SUPPORTED;
+
+    if (size >= sizeof(BCRYPT_CHAIN_MODE_CBC) && !strcmpW((const WCHAR *)value, BCRYPT_CHAIN_MODE_CBC))
+        *mode = MODE_ID_CBC;
+    else if (size >= sizeof(BCRYPT_CHAIN_MODE_ECB) && !strcmpW((const WCHAR *)value, BCRYPT_CHAIN_MODE_ECB))
+        *mode = MODE_ID_ECB;
+    else
+    {
+        FIXME("unsupported chaining mode %s\n", debugstr_wn((const WCHAR *)value, size / sizeof(WCHAR)));
+        return STATUS_NOT_SUPPORTED;
+    }
+    return STATUS_SUCCESS;
+}
+
+NTSTATUS WINAPI BCryptSetProperty(BCRYPT_HANDLE handle, LPCWSTR prop, UCHAR *value, ULONG size, ULONG flags)
+{
+    struct object *object = handle;
+
+    TRACE("%p, %s, %p, %u, %08x\n", handle, debugstr_w(prop), value, size, flags);
+
+    if (!object) return STATUS_INVALID_HANDLE;
+    if (!prop || !value) return STATUS_INVALID_PARAMETER;
+
+    if (strcmpW(prop, BCRYPT_CHAINING_MODE))
+    {
+        FIXME("unsupported property %s\n", debugstr_w(prop));
+        return STATUS_NOT_IMPLEMENTED;
+    }
+
+    switch (object->magic)
+    {
+    case MAGIC_ALG:
+    {
+        struct algorithm *alg = (struct algorithm *)object;
+        return set_chaining_mode(alg->id, &alg->mode, value, size);
+    }
+    case MAGIC_KEY:
+    {
+        struct key *key = (struct key *)object;
+        return set_chaining_mode(key->alg_id, &key->mode, value, size);
+    }
+    case MAGIC_HASH:
+        return STATUS_NOT_SUPPORTED;
+    default:
+        WARN("unknown magic %08x\n", object->magic);
+        return STATUS_INVALID_HANDLE;
+    }
+}
+
+static void hash_init(struct hash *hash)
+{
+    switch (hash->alg_id)
+    {
+    case ALG_ID_MD5:
+        MD5Init(&hash->u.md5);
+        break;
+    case ALG_ID_SHA1:
+        A_SHAInit(&hash->u.sha1);
+        break;
+    case ALG_ID_SHA256:
+        SHA256_Init(&hash->u.sha256);
+        break;
+    case ALG_ID_SHA384:
+        SHA384_Init(&hash->u.sha512);
+        break;
+    case ALG_ID_SHA512:
+        SHA512_Init(&hash->u.sha512);
+        break;
+    default:
+        ERR("unhandled id %u\n", hash->alg_id);
+        break;
+    }
+}
+
+static void hash_update(struct hash *hash, const UCHAR *input, ULONG size)
+{
+    switch (hash->alg_id)
+    {
+    case ALG_ID_MD5:
+        MD5Update(&hash->u.md5, input, size);
+        break;
+    case ALG_ID_SHA1:
+        A_SHAUpdate(&hash->u.sha1, input, size);
+        break;
+    case ALG_ID_SHA256:
+        SHA256_Update(&hash->u.sha256, input, size);
+        break;
+    case ALG_ID_SHA384:
+        SHA384_Update(&hash->u.sha512, input, size);
+        break;
+    case ALG_ID_SHA512:
+        SHA512_Update(&hash->u.sha512, input, size);
+        break;
+    default:
+        ERR("unhandled id %u\n", hash->alg_id);
+        break;
+    }
+}
+
+static void hash_finish(struct hash *hash, UCHAR *output)
+{
+    switch (hash->alg_id)
+    {
+    case ALG_ID_MD5:
+        MD5Final(&hash->u.md5);
+        memcpy(output, hash->u.md5.digest, 16);
+        break;
+    case ALG_ID_SHA1:
+        A_SHAFinal(&hash->u.sha1, (ULONG *)output);
+        break;
+    case ALG_ID_SHA256:
+        SHA256_Final(output, &hash->u.sha256);
+        break;
+    case ALG_ID_SHA384:
+        SHA384_Final(output, &hash->u.sha512);
+        break;
+    case ALG_ID_SHA512:
+        SHA512_Final(output, &hash->u.sha512);
+        break;
+    default:
+        ERR("unhandled id %u\n", hash->alg_id);
+        break;
+    }
+}
+
+/* Hash and key objects are built in the buffer passed by the caller when
+ * there is one, so that they can be created without touching the heap. */
+static void *alloc_object(UCHAR *buffer, ULONG buffer_size, ULONG size, BOOL *allocated)
+{
+    if (buffer)
+    {
+        if (buffer_size < size) return NULL;
+        *allocated = FALSE;
+        return buffer;
+    }
+    *allocated = TRUE;
+    return HeapAlloc( GetProcessHeap(), 0, size );
+}
+
+static void free_object(void *object, ULONG size, BOOL allocated)
+{
+    memset(object, 0, size);
+    if (allocated) HeapFree( GetProcessHeap(), 0, object );
+}
+
+NTSTATUS WINAPI BCryptCreateHash(BCRYPT_ALG_HANDLE algorithm, BCRYPT_HASH_HANDLE *handle, UCHAR *object, ULONG objectlen,
+                                 UCHAR *secret, ULONG secretlen, ULONG flags)
+{
+    const ULONG supported_flags = BCRYPT_HASH_REUSABLE_FLAG;
+    struct algorithm *alg = algorithm;
+    struct hash *hash;
+    BOOL allocated;
+
+    TRACE("%p, %p, %p, %u, %p, %u, %08x\n", algorithm, handle, object, objectlen, secret, secretlen, flags);
+
+    if (!alg || alg->hdr.magic != MAGIC_ALG) return STATUS_INVALID_HANDLE;
+    if (!handle) return STATUS_INVALID_PARAMETER;
+    if (alg->id == ALG_ID_AES) return STATUS_NOT_SUPPORTED;
+
+    if (flags & ~supported_flags)
+    {
+        FIXME("unsupported flags %08x\n", flags & ~supported_flags);
+        return STATUS_NOT_IMPLEMENTED;
+    }
+    if (secret) FIXME("ignoring secret\n");
+
+    if (!(hash = alloc_object(object, objectlen, sizeof(*hash), &allocated)))
+        return object ? STATUS_BUFFER_TOO_SMALL : STATUS_NO_MEMORY;
+
+    hash->hdr.magic = MAGIC_HASH;
+    hash->alg_id    = alg->id;
+    hash->reusable  = (flags | alg->flags) & BCRYPT_HASH_REUSABLE_FLAG;
+    hash->allocated = allocated;
+    hash_init(hash);
+
+    *handle = hash;
+    return STATUS_SUCCESS;
+}
+
+NTSTATUS WINAPI BCryptDuplicateHash(BCRYPT_HASH_HANDLE handle, BCRYPT_HASH_HANDLE *handle_copy,
+                                    UCHAR *object, ULONG objectlen, ULONG flags)
+{
+    struct hash *hash_orig = handle;
+    struct hash *hash_copy;
+    BOOL allocated;
+
+    TRACE("%p, %p, %p, %u, %u\n", handle, handle_copy, object, objectlen, flags);
+
+    if (!hash_orig || hash_orig->hdr.magic != MAGIC_HASH) return STATUS_INVALID_HANDLE;
+    if (!handle_copy) return STATUS_INVALID_PARAMETER;
+
+    if (!(hash_copy = alloc_object(object, objectlen, sizeof(*hash_copy), &allocated)))
+        return object ? STATUS_BUFFER_TOO_SMALL : STATUS_NO_MEMORY;
+
+    memcpy(hash_copy, hash_orig, sizeof(*hash_orig));
+    hash_copy->allocated = allocated;
+
+    *handle_copy = hash_copy;
+    return STATUS_SUCCESS;
+}
+
+NTSTATUS WINAPI BCryptDestroyHash(BCRYPT_HASH_HANDLE handle)
+{
+    struct hash *hash = handle;
+
+    TRACE("%p\n", handle);
+
+    if (!hash || hash->hdr.magic != MAGIC_HASH) return STATUS_INVALID_HANDLE;
+    free_object(hash, sizeof(*hash), hash->allocated);
+    return STATUS_SUCCESS;
+}
+
+NTSTATUS WINAPI BCryptHashData(BCRYPT_HASH_HANDLE handle, UCHAR *input, ULONG size, ULONG flags)
+{
+    struct hash *hash = handle;
+
+    TRACE("%p, %p, %u, %08x\n", handle, input, size, flags);
+
+    if (!hash || hash->hdr.magic != MAGIC_HASH) return STATUS_INVALID_HANDLE;
+    if (!input && size) return STATUS_INVALID_PARAMETER;
+
+    hash_update(hash, input, size);
+    return STATUS_SUCCESS;
+}
+
+NTSTATUS WINAPI BCryptFinishHash(BCRYPT_HASH_HANDLE handle, UCHAR *output, ULONG size, ULONG flags)
+{
+    struct hash *hash = handle;
+
+    TRACE("%p, %p, %u, %08x\n", handle, output, size, flags);
+
+    if (!hash || hash->hdr.magic != MAGIC_HASH) return STATUS_INVALID_HANDLE;
+    if (!output || size != alg_props[hash->alg_id].hash_length) return STATUS_INVALID_PARAMETER;
+
+    hash_finish(hash, output);
+    if (hash->reusable) hash_init(hash);
+    return STATUS_SUCCESS;
+}
+
+NTSTATUS WINAPI BCryptGenerateSymmetricKey(BCRYPT_ALG_HANDLE algorithm, BCRYPT_KEY_HANDLE *handle,
+                                           UCHAR *object, ULONG objectlen, UCHAR *secret, ULONG secretlen,
+                                           ULONG flags)
+{
+    struct algorithm *alg = algorithm;
+    struct key *key;
+    BOOL allocated;
+
+    TRACE("%p, %p, %p, %u, %p, %u, %08x\n", algorithm, handle, object, objectlen, secret, secretlen, flags);
+
+    if (!alg || alg->hdr.magic != MAGIC_ALG) return STATUS_INVALID_HANDLE;
+    if (!handle || !secret) return STATUS_INVALID_PARAMETER;
+    if (alg->id != ALG_ID_AES) return STATUS_NOT_SUPPORTED;
+    if (secretlen != 16 && secretlen != 24 && secretlen != 32) return STATUS_INVALID_PARAMETER;
+
+    if (!(key = alloc_object(object, objectlen, sizeof(*key), &allocated)))
+        return object ? STATUS_BUFFER_TOO_SMALL : STATUS_NO_MEMORY;
+
+    key->hdr.magic = MAGIC_KEY;
+    key->alg_id    = alg->id;
+    key->mode      = alg->mode;
+    key->allocated = allocated;
+    /* the schedule is expanded once here, not for every BCryptEncrypt call */
+    aes_setup(secret, secretlen, 0, &key->aes);
+
+    *handle = key;
+    return STATUS_SUCCESS;
+}
+
+NTSTATUS WINAPI BCryptDestroyKey(BCRYPT_KEY_HANDLE handle)
+{
+    struct key *key = handle;
+
+    TRACE("%p\n", handle);
+
+    if (!key || key->hdr.magic != MAGIC_KEY) return STATUS_INVALID_HANDLE;
+    free_object(key, sizeof(*key), key->allocated);
+    return STATUS_SUCCESS;
+}
+
+static NTSTATUS check_key_params(const struct key *key, const void *padding, const UCHAR *iv, ULONG iv_len,
+                                 ULONG *ret_len, ULONG flags)
+{
+    const ULONG supported_flags = BCRYPT_BLOCK_PADDING;
+
+    if (!key || key->hdr.magic != MAGIC_KEY) return STATUS_INVALID_HANDLE;
+    if (!ret_len) return STATUS_INVALID_PARAMETER;
+
+    if (padding)
+    {
+        FIXME("padding info not implemented\n");
+        return STATUS_NOT_IMPLEMENTED;
+    }
+    if (flags & ~supported_flags)
+    {
+        FIXME("unsupported flags %08x\n", flags & ~supported_flags);
+        return STATUS_NOT_IMPLEMENTED;
+    }
+    if (key->mode == MODE_ID_CBC && (!iv || iv_len != AES_BLOCK_LEN))
+        return STATUS_INVALID_PARAMETER;
+    return STATUS_SUCCESS;
+}
+
+NTSTATUS WINAPI BCryptEncrypt(BCRYPT_KEY_HANDLE handle, UCHAR *input, ULONG input_len, void *padding, UCHAR *iv,
+                              ULONG iv_len, UCHAR *output, ULONG output_len, ULONG *ret_len, ULONG flags)
+{
+    struct key *key = handle;
+    ULONG blocks, bytes_left, out_len;
+    UCHAR buf[AES_BLOCK_LEN];
+    NTSTATUS status;
+
+    TRACE("%p, %p, %u, %p, %p, %u, %p, %u, %p, %08x\n", handle, input, input_len, padding, iv, iv_len,
+          output, output_len, ret_len, flags);
+
+    if ((status = check_key_params(key, padding, iv, iv_len, ret_len, flags))) return status;
+
+    blocks     = input_len / AES_BLOCK_LEN;
+    bytes_left = input_len % AES_BLOCK_LEN;
+    if (flags & BCRYPT_BLOCK_PADDING)
+        out_len = (blocks + 1) * AES_BLOCK_LEN;
+    else if (bytes_left)
+        return STATUS_INVALID_BUFFER_SIZE;
+    else
+        out_len = input_len;
+
+    *ret_len = out_len;
+    if (!output) return STATUS_SUCCESS;
+    if (output_len < out_len) return STATUS_BUFFER_TOO_SMALL;
+
+    if (key->mode == MODE_ID_ECB)
+        aes_ecb_encrypt_blocks(input, output, blocks, &key->aes);
+    else
+        aes_cbc_encrypt(input, output, blocks, iv, &key->aes);
+
+    if (flags & BCRYPT_BLOCK_PADDING)
+    {
+        memcpy(buf, input + blocks * AES_BLOCK_LEN, bytes_left);
+        memset(buf + bytes_left, AES_BLOCK_LEN - bytes_left, AES_BLOCK_LEN - bytes_left);
+        if (key->mode == MODE_ID_ECB)
+            aes_ecb_encrypt_blocks(buf, output + blocks * AES_BLOCK_LEN, 1, &key->aes);
+        else
+            aes_cbc_encrypt(buf, output + blocks * AES_BLOCK_LEN, 1, iv, &key->aes);
+    }
+    return STATUS_SUCCESS;
+}
+
+NTSTATUS WINAPI BCryptDecrypt(BCRYPT_KEY_HANDLE handle, UCHAR *input, ULONG input_len, void *padding, UCHAR *iv,
+                              ULONG iv_len, UCHAR *output, ULONG output_len, ULONG *ret_len, ULONG flags)
+{
+    struct key *key = handle;
+    UCHAR last[AES_BLOCK_LEN], buf[AES_BLOCK_LEN];
+    ULONG blocks, out_len, pad, i;
+    NTSTATUS status;
+
+    TRACE("%p, %p, %u, %p, %p, %u, %p, %u, %p, %08x\n", handle, input, input_len, padding, iv, iv_len,
+          output, output_len, ret_len, flags);
+
+    if ((status = check_key_params(key, padding, iv, iv_len, ret_len, flags))) return status;
+
+    if (input_len % AES_BLOCK_LEN) return STATUS_INVALID_BUFFER_SIZE;
+    blocks = input_len / AES_BLOCK_LEN;
+
+    if (!(flags & BCRYPT_BLOCK_PADDING))
+    {
+        *ret_len = input_len;
+        if (!output) return STATUS_SUCCESS;
+        if (output_len < input_len) return STATUS_BUFFER_TOO_SMALL;
+
+        if (key->mode == MODE_ID_ECB)
+            aes_ecb_decrypt_blocks(input, output, blocks, &key->aes);
+        else
+            aes_cbc_decrypt(input, output, blocks, iv, &key->aes);
+        return STATUS_SUCCESS;
+    }
+
+    if (!blocks) return STATUS_INVALID_BUFFER_SIZE;
+    if (!output)
+    {
+        /* the padding length is only known once the last block is decrypted */
+        *ret_len = input_len;
+        return STATUS_SUCCESS;
+    }
+
+    /* decrypt the last block first, the output may overlap the input */
+    memcpy(last, input + (blocks - 1) * AES_BLOCK_LEN, AES_BLOCK_LEN);
+    aes_ecb_decrypt_blocks(last, buf, 1, &key->aes);
+    if (key->mode == MODE_ID_CBC)
+    {
+        const UCHAR *prev = (blocks > 1) ? input + (blocks - 2) * AES_BLOCK_LEN : iv;
+        for (i = 0; i < AES_BLOCK_LEN; i++) buf[i] ^= prev[i];
+    }
+
+    pad = buf[AES_BLOCK_LEN - 1];
+    if (!pad || pad > AES_BLOCK_LEN) return STATUS_INVALID_PARAMETER;
+    for (i = AES_BLOCK_LEN - pad; i < AES_BLOCK_LEN; i++)
+        if (buf[i] != pad) return STATUS_INVALID_PARAMETER;
+
+    out_len = input_len - pad;
+    *ret_len = out_len;
+    if (output_len < out_len) return STATUS_BUFFER_TOO_SMALL;
+
+    if (key->mode == MODE_ID_ECB)
+        aes_ecb_decrypt_blocks(input, output, blocks - 1, &key->aes);
+    else
+    {
+        aes_cbc_decrypt(input, output, blocks - 1, iv, &key->aes);
+        memcpy(iv, last, AES_BLOCK_LEN);
+    }
+    memcpy(output + (blocks - 1) * AES_BLOCK_LEN, buf, AES_BLOCK_LEN - pad);
+    return STATUS_SUCCESS;
+}
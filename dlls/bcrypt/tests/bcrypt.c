@@ -18,6 +18,7 @@
  * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
  */
 
+#include <stdio.h>
 #include <ntstatus.h>
 #define WIN32_NO_STATUS
 #include <windows.h>
@@ -28,6 +29,22 @@
 static NTSTATUS (WINAPI *pBCryptGenRandom)(BCRYPT_ALG_HANDLE hAlgorithm, PUCHAR pbBuffer,
                                            ULONG cbBuffer, ULONG dwFlags);
 static NTSTATUS (WINAPI *pBCryptGetFipsAlgorithmMode)(BOOLEAN *enabled);
+static NTSTATUS (WINAPI *pBCryptOpenAlgorithmProvider)(BCRYPT_ALG_HANDLE *, LPCWSTR, LPCWSTR, ULONG);
+static NTSTATUS (WINAPI *pBCryptCloseAlgorithmProvider)(BCRYPT_ALG_HANDLE, ULONG);
+static NTSTATUS (WINAPI *pBCryptGetProperty)(BCRYPT_HANDLE, LPCWSTR, PUCHAR, ULONG, ULONG *, ULONG);
+static NTSTATUS (WINAPI *pBCryptSetProperty)(BCRYPT_HANDLE, LPCWSTR, PUCHAR, ULONG, ULONG);
+static NTSTATUS (WINAPI *pBCryptCreateHash)(BCRYPT_ALG_HANDLE, BCRYPT_HASH_HANDLE *, PUCHAR, ULONG, PUCHAR,
+                                            ULONG, ULONG);
+static NTSTATUS (WINAPI *pBCryptHashData)(BCRYPT_HASH_HANDLE, PUCHAR, ULONG, ULONG);
+static NTSTATUS (WINAPI *pBCryptFinishHash)(BCRYPT_HASH_HANDLE, PUCHAR, ULONG, ULONG);
+static NTSTATUS (WINAPI *pBCryptDestroyHash)(BCRYPT_HASH_HANDLE);
+static NTSTATUS (WINAPI *pBCryptGenerateSymmetricKey)(BCRYPT_ALG_HANDLE, BCRYPT_KEY_HANDLE *, PUCHAR, ULONG,
+                                                      PUCHAR, ULONG, ULONG);
+static NTSTATUS (WINAPI *pBCryptEncrypt)(BCRYPT_KEY_HANDLE, PUCHAR, ULONG, VOID *, PUCHAR, ULONG, PUCHAR,
+                                         ULONG, ULONG *, ULONG);
+static NTSTATUS (WINAPI *pBCryptDecrypt)(BCRYPT_KEY_HANDLE, PUCHAR, ULONG, VOID *, PUCHAR, ULONG, PUCHAR,
+                                         ULONG, ULONG *, ULONG);
+static NTSTATUS (WINAPI *pBCryptDestroyKey)(BCRYPT_KEY_HANDLE);
 
 static BOOL Init(void)
 {
@@ -40,6 +57,18 @@ static BOOL Init(void)
 
     pBCryptGenRandom = (void *)GetProcAddress(hbcrypt, "BCryptGenRandom");
     pBCryptGetFipsAlgorithmMode = (void *)GetProcAddress(hbcrypt, "BCryptGetFipsAlgorithmMode");
+    pBCryptOpenAlgorithmProvider = (void *)GetProcAddress(hbcrypt, "BCryptOpenAlgorithmProvider");
+    pBCryptCloseAlgorithmProvider = (void *)GetProcAddress(hbcrypt, "BCryptCloseAlgorithmProvider");
+    pBCryptGetProperty = (void *)GetProcAddress(hbcrypt, "BCryptGetProperty");
+    pBCryptSetProperty = (void *)GetProcAddress(hbcrypt, "BCryptSetProperty");
+    pBCryptCreateHash = (void *)GetProcAddress(hbcrypt, "BCryptCreateHash");
+    pBCryptHashData = (void *)GetProcAddress(hbcrypt, "BCryptHashData");
+    pBCryptFinishHash = (void *)GetProcAddress(hbcrypt, "BCryptFinishHash");
+    pBCryptDestroyHash = (void *)GetProcAddress(hbcrypt, "BCryptDestroyHash");
+    pBCryptGenerateSymmetricKey = (void *)GetProcAddress(hbcrypt, "BCryptGenerateSymmetricKey");
+    pBCryptEncrypt = (void *)GetProcAddress(hbcrypt, "BCryptEncrypt");
+    pBCryptDecrypt = (void *)GetProcAddress(hbcrypt, "BCryptDecrypt");
+    pBCryptDestroyKey = (void *)GetProcAddress(hbcrypt, "BCryptDestroyKey");
 
     return TRUE;
 }
@@ -98,6 +127,212 @@ static void test_BCryptGetFipsAlgorithmMode(void)
     ok(ret == STATUS_INVALID_PARAMETER, "Expected STATUS_INVALID_PARAMETER, got 0x%x\n", ret);
 }
 
+static void format_hash(const UCHAR *bytes, ULONG size, char *buf)
+{
+    ULONG i;
+    buf[0] = '\0';
+    for (i = 0; i < size; i++)
+    {
+        sprintf(buf + i * 2, "%02x", bytes[i]);
+    }
+}
+
+static void test_hash(void)
+{
+    const struct
+    {
+        const WCHAR *alg;
+        ULONG len;
+        const char *expected;
+    }
+    tests[] =
+    {
+        { BCRYPT_MD5_ALGORITHM, 16, "900150983cd24fb0d6963f7d28e17f72" },
+        { BCRYPT_SHA1_ALGORITHM, 20, "a9993e364706816aba3e25717850c26c9cd0d89d" },
+        { BCRYPT_SHA256_ALGORITHM, 32, "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad" },
+        { BCRYPT_SHA384_ALGORITHM, 48, "cb00753f45a35e8bb5a03d699ac65007272c32ab0eded163"
+                                       "1a8b605a43ff5bed8086072ba1e7cc2358baeca134c825a7" },
+        { BCRYPT_SHA512_ALGORITHM, 64, "ddaf35a193617abacc417349ae20413112e6fa4e89a97ea20a9eeee64b55d39a"
+                                       "2192992a274fc1a836ba3c23a3feebbd454d4423643ce80e2a9ac94fa54ca49f" },
+    };
+    BCRYPT_ALG_HANDLE alg;
+    BCRYPT_HASH_HANDLE hash;
+    UCHAR buf[512], hash_buf[64];
+    char str[129];
+    ULONG len, size;
+    NTSTATUS ret;
+    int i;
+
+    if (!pBCryptOpenAlgorithmProvider || !pBCryptCreateHash)
+    {
+        win_skip("BCryptCreateHash is not available\n");
+        return;
+    }
+
+    for (i = 0; i < sizeof(tests)/sizeof(tests[0]); i++)
+    {
+        alg = NULL;
+        ret = pBCryptOpenAlgorithmProvider(&alg, tests[i].alg, MS_PRIMITIVE_PROVIDER, 0);
+        ok(ret == STATUS_SUCCESS, "%u: got %08x\n", i, ret);
+        ok(alg != NULL, "%u: alg not set\n", i);
+
+        len = size = 0xdeadbeef;
+        ret = pBCryptGetProperty(alg, BCRYPT_HASH_LENGTH, (UCHAR *)&len, sizeof(len), &size, 0);
+        ok(ret == STATUS_SUCCESS, "%u: got %08x\n", i, ret);
+        ok(len == tests[i].len, "%u: got %u\n", i, len);
+        ok(size == sizeof(len), "%u: got %u\n", i, size);
+
+        len = size = 0xdeadbeef;
+        ret = pBCryptGetProperty(alg, BCRYPT_OBJECT_LENGTH, (UCHAR *)&len, sizeof(len), &size, 0);
+        ok(ret == STATUS_SUCCESS, "%u: got %08x\n", i, ret);
+        ok(len != 0xdeadbeef && len <= sizeof(buf), "%u: got %u\n", i, len);
+
+        hash = NULL;
+        ret = pBCryptCreateHash(alg, &hash, buf, len, NULL, 0, 0);
+        ok(ret == STATUS_SUCCESS, "%u: got %08x\n", i, ret);
+        ok(hash != NULL, "%u: hash not set\n", i);
+
+        ret = pBCryptHashData(hash, (UCHAR *)"ab", 2, 0);
+        ok(ret == STATUS_SUCCESS, "%u: got %08x\n", i, ret);
+        ret = pBCryptHashData(hash, (UCHAR *)"c", 1, 0);
+        ok(ret == STATUS_SUCCESS, "%u: got %08x\n", i, ret);
+
+        ret = pBCryptFinishHash(hash, hash_buf, tests[i].len + 1, 0);
+        ok(ret == STATUS_INVALID_PARAMETER, "%u: got %08x\n", i, ret);
+
+        memset(hash_buf, 0, sizeof(hash_buf));
+        ret = pBCryptFinishHash(hash, hash_buf, tests[i].len, 0);
+        ok(ret == STATUS_SUCCESS, "%u: got %08x\n", i, ret);
+        format_hash(hash_buf, tests[i].len, str);
+        ok(!strcmp(str, tests[i].expected), "%u: got %s\n", i, str);
+
+        ret = pBCryptDestroyHash(hash);
+        ok(ret == STATUS_SUCCESS, "%u: got %08x\n", i, ret);
+
+        ret = pBCryptCloseAlgorithmProvider(alg, 0);
+        ok(ret == STATUS_SUCCESS, "%u: got %08x\n", i, ret);
+    }
+
+    /* reusable hash objects start over after BCryptFinishHash */
+    ret = pBCryptOpenAlgorithmProvider(&alg, BCRYPT_SHA256_ALGORITHM, MS_PRIMITIVE_PROVIDER, 0);
+    ok(ret == STATUS_SUCCESS, "got %08x\n", ret);
+
+    hash = NULL;
+    ret = pBCryptCreateHash(alg, &hash, NULL, 0, NULL, 0, BCRYPT_HASH_REUSABLE_FLAG);
+    if (ret == STATUS_INVALID_PARAMETER)
+    {
+        win_skip("BCRYPT_HASH_REUSABLE_FLAG not supported\n");
+        pBCryptCloseAlgorithmProvider(alg, 0);
+        return;
+    }
+    ok(ret == STATUS_SUCCESS, "got %08x\n", ret);
+
+    for (i = 0; i < 2; i++)
+    {
+        ret = pBCryptHashData(hash, (UCHAR *)"abc", 3, 0);
+        ok(ret == STATUS_SUCCESS, "%u: got %08x\n", i, ret);
+        ret = pBCryptFinishHash(hash, hash_buf, 32, 0);
+        ok(ret == STATUS_SUCCESS, "%u: got %08x\n", i, ret);
+        format_hash(hash_buf, 32, str);
+        ok(!strcmp(str, tests[2].expected), "%u: got %s\n", i, str);
+    }
+
+    pBCryptDestroyHash(hash);
+    pBCryptCloseAlgorithmProvider(alg, 0);
+}
+
+static void test_aes(void)
+{
+    static UCHAR secret[] =
+        {0x00,0x01,0x02,0x03,0x04,0x05,0x06,0x07,0x08,0x09,0x0a,0x0b,0x0c,0x0d,0x0e,0x0f};
+    static const UCHAR expected_ecb[] =
+        {0x0a,0x94,0x0b,0xb5,0x41,0x6e,0xf0,0x45,0xf1,0xc3,0x94,0x58,0xc6,0x53,0xea,0x5a};
+    static const UCHAR expected_cbc[] =
+        {0x0a,0x94,0x0b,0xb5,0x41,0x6e,0xf0,0x45,0xf1,0xc3,0x94,0x58,0xc6,0x53,0xea,0x5a,
+         0xf9,0xc4,0xf9,0x47,0x93,0x7a,0x24,0xc2,0x71,0x68,0x61,0xf9,0xa9,0x87,0xe0,0x54};
+    BCRYPT_ALG_HANDLE alg;
+    BCRYPT_KEY_HANDLE key;
+    UCHAR data[17], ciphertext[32], plaintext[32], iv[16];
+    WCHAR mode[64];
+    ULONG size, len;
+    NTSTATUS ret;
+    int i;
+
+    if (!pBCryptOpenAlgorithmProvider || !pBCryptGenerateSymmetricKey)
+    {
+        win_skip("BCryptGenerateSymmetricKey is not available\n");
+        return;
+    }
+
+    for (i = 0; i < sizeof(data); i++) data[i] = i;
+
+    alg = NULL;
+    ret = pBCryptOpenAlgorithmProvider(&alg, BCRYPT_AES_ALGORITHM, MS_PRIMITIVE_PROVIDER, 0);
+    ok(ret == STATUS_SUCCESS, "got %08x\n", ret);
+    ok(alg != NULL, "alg not set\n");
+
+    len = size = 0;
+    ret = pBCryptGetProperty(alg, BCRYPT_BLOCK_LENGTH, (UCHAR *)&len, sizeof(len), &size, 0);
+    ok(ret == STATUS_SUCCESS, "got %08x\n", ret);
+    ok(len == 16, "got %u\n", len);
+
+    size = 0;
+    memset(mode, 0, sizeof(mode));
+    ret = pBCryptGetProperty(alg, BCRYPT_CHAINING_MODE, (UCHAR *)mode, sizeof(mode), &size, 0);
+    ok(ret == STATUS_SUCCESS, "got %08x\n", ret);
+    ok(!lstrcmpW(mode, BCRYPT_CHAIN_MODE_CBC), "got %s\n", wine_dbgstr_w(mode));
+    ok(size == sizeof(BCRYPT_CHAIN_MODE_CBC), "got %u\n", size);
+
+    key = NULL;
+    ret = pBCryptGenerateSymmetricKey(alg, &key, NULL, 0, secret, sizeof(secret), 0);
+    ok(ret == STATUS_SUCCESS, "got %08x\n", ret);
+    ok(key != NULL, "key not set\n");
+
+    /* input that is not a multiple of the block size needs padding */
+    memset(iv, 0, sizeof(iv));
+    ret = pBCryptEncrypt(key, data, 17, NULL, iv, sizeof(iv), ciphertext, sizeof(ciphertext), &size, 0);
+    ok(ret == STATUS_INVALID_BUFFER_SIZE, "got %08x\n", ret);
+
+    size = 0;
+    ret = pBCryptEncrypt(key, data, 17, NULL, iv, sizeof(iv), NULL, 0, &size, BCRYPT_BLOCK_PADDING);
+    ok(ret == STATUS_SUCCESS, "got %08x\n", ret);
+    ok(size == 32, "got %u\n", size);
+
+    size = 0;
+    memset(ciphertext, 0, sizeof(ciphertext));
+    ret = pBCryptEncrypt(key, data, 17, NULL, iv, sizeof(iv), ciphertext, sizeof(ciphertext), &size,
+                         BCRYPT_BLOCK_PADDING);
+    ok(ret == STATUS_SUCCESS, "got %08x\n", ret);
+    ok(size == 32, "got %u\n", size);
+    ok(!memcmp(ciphertext, expected_cbc, sizeof(expected_cbc)), "wrong data\n");
+
+    size = 0;
+    memset(iv, 0, sizeof(iv));
+    memset(plaintext, 0, sizeof(plaintext));
+    ret = pBCryptDecrypt(key, ciphertext, 32, NULL, iv, sizeof(iv), plaintext, sizeof(plaintext), &size,
+                         BCRYPT_BLOCK_PADDING);
+    ok(ret == STATUS_SUCCESS, "got %08x\n", ret);
+    ok(size == 17, "got %u\n", size);
+    ok(!memcmp(plaintext, data, sizeof(data)), "wrong data\n");
+
+    ret = pBCryptSetProperty(key, BCRYPT_CHAINING_MODE, (UCHAR *)BCRYPT_CHAIN_MODE_ECB,
+                             sizeof(BCRYPT_CHAIN_MODE_ECB), 0);
+    ok(ret == STATUS_SUCCESS, "got %08x\n", ret);
+
+    size = 0;
+    memset(ciphertext, 0, sizeof(ciphertext));
+    ret = pBCryptEncrypt(key, data, 16, NULL, NULL, 0, ciphertext, sizeof(ciphertext), &size, 0);
+    ok(ret == STATUS_SUCCESS, "got %08x\n", ret);
+    ok(size == 16, "got %u\n", size);
+    ok(!memcmp(ciphertext, expected_ecb, sizeof(expected_ecb)), "wrong data\n");
+
+    ret = pBCryptDestroyKey(key);
+    ok(ret == STATUS_SUCCESS, "got %08x\n", ret);
+
+    ret = pBCryptCloseAlgorithmProvider(alg, 0);
+    ok(ret == STATUS_SUCCESS, "got %08x\n", ret);
+}
+
 START_TEST(bcrypt)
 {
     if (!Init())
@@ -105,4 +340,6 @@ START_TEST(bcrypt)
 
     test_BCryptGenRandom();
     test_BCryptGetFipsAlgorithmMode();
+    test_hash();
+    test_aes();
 }
@@ -1055,6 +1055,7 @@ HRESULT IDirectSoundBufferImpl_Duplicate(
     dsb->sec_mixpos = 0;
     dsb->notifies = NULL;
     dsb->nrofnotifies = 0;
+    dsb->notify_pending = FALSE;
     dsb->device = device;
     DSOUND_RecalcFormat(dsb);
 
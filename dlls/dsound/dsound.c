@@ -238,7 +238,7 @@ static ULONG DirectSoundDevice_Release(DirectSoundDevice * device)
         if(device->volume)
             IAudioStreamVolume_Release(device->volume);
 
-        HeapFree(GetProcessHeap(), 0, device->tmp_buffer);
+        DSOUND_DestroyMixWorkers(device);
         HeapFree(GetProcessHeap(), 0, device->mix_buffer);
         HeapFree(GetProcessHeap(), 0, device->buffer);
         RtlDeleteResource(&device->buffer_list_lock);
@@ -104,6 +104,83 @@ static float getieee32(const IDirectSoundBufferImpl *dsb, DWORD pos, DWORD chann
 
 const bitsgetfunc getbpp[5] = {get8, get16, get24, get32, getieee32};
 
+/* Same conversions as above, for count consecutive frames of one channel.
+ * The results are written ostride floats apart. */
+static void get8_run(const IDirectSoundBufferImpl *dsb, DWORD pos, DWORD channel,
+        float *out, UINT ostride, UINT count)
+{
+    const BYTE* buf = dsb->buffer->memory;
+    UINT istride = dsb->pwfx->nBlockAlign;
+    buf += pos + channel;
+    while (count--)
+    {
+        *out = (buf[0] - 0x80) / (float)0x80;
+        buf += istride;
+        out += ostride;
+    }
+}
+
+static void get16_run(const IDirectSoundBufferImpl *dsb, DWORD pos, DWORD channel,
+        float *out, UINT ostride, UINT count)
+{
+    const BYTE* buf = dsb->buffer->memory;
+    UINT istride = dsb->pwfx->nBlockAlign;
+    buf += pos + 2 * channel;
+    while (count--)
+    {
+        SHORT sample = (SHORT)le16(*(const SHORT*)buf);
+        *out = sample / (float)0x8000;
+        buf += istride;
+        out += ostride;
+    }
+}
+
+static void get24_run(const IDirectSoundBufferImpl *dsb, DWORD pos, DWORD channel,
+        float *out, UINT ostride, UINT count)
+{
+    const BYTE* buf = dsb->buffer->memory;
+    UINT istride = dsb->pwfx->nBlockAlign;
+    buf += pos + 3 * channel;
+    while (count--)
+    {
+        LONG sample = (buf[0] << 8) | (buf[1] << 16) | (buf[2] << 24);
+        *out = sample / (float)0x80000000U;
+        buf += istride;
+        out += ostride;
+    }
+}
+
+static void get32_run(const IDirectSoundBufferImpl *dsb, DWORD pos, DWORD channel,
+        float *out, UINT ostride, UINT count)
+{
+    const BYTE* buf = dsb->buffer->memory;
+    UINT istride = dsb->pwfx->nBlockAlign;
+    buf += pos + 4 * channel;
+    while (count--)
+    {
+        LONG sample = le32(*(const LONG*)buf);
+        *out = sample / (float)0x80000000U;
+        buf += istride;
+        out += ostride;
+    }
+}
+
+static void getieee32_run(const IDirectSoundBufferImpl *dsb, DWORD pos, DWORD channel,
+        float *out, UINT ostride, UINT count)
+{
+    const BYTE* buf = dsb->buffer->memory;
+    UINT istride = dsb->pwfx->nBlockAlign;
+    buf += pos + 4 * channel;
+    while (count--)
+    {
+        *out = *(const float*)buf;
+        buf += istride;
+        out += ostride;
+    }
+}
+
+const bitsgetrunfunc getbpp_run[5] = {get8_run, get16_run, get24_run, get32_run, getieee32_run};
+
 float get_mono(const IDirectSoundBufferImpl *dsb, DWORD pos, DWORD channel)
 {
     DWORD channels = dsb->pwfx->nChannels;
@@ -154,7 +231,7 @@ static inline LONG f_to_32(float value)
 
 void putieee32(const IDirectSoundBufferImpl *dsb, DWORD pos, DWORD channel, float value)
 {
-    BYTE *buf = (BYTE *)dsb->device->tmp_buffer;
+    BYTE *buf = (BYTE *)dsb->tmp_buffer;
     float *fbuf = (float*)(buf + pos + sizeof(float) * channel);
     *fbuf = value;
 }
@@ -215,6 +292,30 @@ void mixieee32(float *src, float *dst, unsigned samples)
         *(dst++) += *(src++);
 }
 
+void mixieee32_vol(const float *src, float *dst, unsigned frames, unsigned channels, const float *vols)
+{
+    unsigned chan;
+
+    TRACE("%p - %p %d\n", src, dst, frames);
+
+    if (channels == 2)
+    {
+        float left = vols[0], right = vols[1];
+        while (frames--)
+        {
+            dst[0] += src[0] * left;
+            dst[1] += src[1] * right;
+            dst += 2;
+            src += 2;
+        }
+        return;
+    }
+
+    while (frames--)
+        for (chan = 0; chan < channels; chan++)
+            *(dst++) += *(src++) * vols[chan];
+}
+
 static void norm8(float *src, unsigned char *dst, unsigned len)
 {
     TRACE("%p - %p %d\n", src, dst, len);
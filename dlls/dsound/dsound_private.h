@@ -44,9 +44,12 @@ typedef struct DirectSoundDevice             DirectSoundDevice;
 /* dsound_convert.h */
 typedef float (*bitsgetfunc)(const IDirectSoundBufferImpl *, DWORD, DWORD);
 typedef void (*bitsputfunc)(const IDirectSoundBufferImpl *, DWORD, DWORD, float);
+typedef void (*bitsgetrunfunc)(const IDirectSoundBufferImpl *, DWORD, DWORD, float *, UINT, UINT);
 extern const bitsgetfunc getbpp[5] DECLSPEC_HIDDEN;
+extern const bitsgetrunfunc getbpp_run[5] DECLSPEC_HIDDEN;
 void putieee32(const IDirectSoundBufferImpl *dsb, DWORD pos, DWORD channel, float value) DECLSPEC_HIDDEN;
 void mixieee32(float *src, float *dst, unsigned samples) DECLSPEC_HIDDEN;
+void mixieee32_vol(const float *src, float *dst, unsigned frames, unsigned channels, const float *vols) DECLSPEC_HIDDEN;
 typedef void (*normfunc)(const void *, void *, unsigned);
 extern const normfunc normfunctions[5] DECLSPEC_HIDDEN;
 
@@ -57,6 +60,23 @@ typedef struct _DSVOLUMEPAN
     LONG	lPan;
 } DSVOLUMEPAN,*PDSVOLUMEPAN;
 
+#define MAX_MIX_WORKERS 4
+
+/* a thread mixing a share of the secondary buffers, see DSOUND_MixToPrimary */
+struct mix_worker
+{
+    DirectSoundDevice          *device;
+    HANDLE                      thread, start_event, done_event;
+    BOOL                        quit;
+    /* converted output of one secondary buffer, and the sum of its group */
+    float                      *tmp_buffer, *mix_buffer;
+    DWORD                       tmp_buffer_len;
+    /* the range of buffer groups to mix, and the outcome */
+    int                         first, last;
+    DWORD                       writepos, mixlen;
+    BOOL                        all_stopped;
+};
+
 /*****************************************************************************
  * IDirectSoundDevice implementation structure
  */
@@ -82,8 +102,12 @@ struct DirectSoundDevice
     int                         speaker_num[DS_MAX_CHANNELS];
     int                         num_speakers;
     int                         lfe_channel;
-    float *mix_buffer, *tmp_buffer;
-    DWORD                       tmp_buffer_len, mix_buffer_len;
+    float                      *mix_buffer;
+    DWORD                       mix_buffer_len;
+    int                         nrofworkers;
+    struct mix_worker           workers[MAX_MIX_WORKERS];
+    float                      *group_buffers;
+    DWORD                       group_buffers_len;
 
     DSVOLUMEPAN                 volpan;
 
@@ -147,10 +171,15 @@ struct IDirectSoundBufferImpl
     LONG64                      freqAccNum;
     /* used for mixing */
     DWORD                       sec_mixpos;
+    float                      *tmp_buffer; /* of the thread mixing this buffer */
 
     /* IDirectSoundNotify fields */
     LPDSBPOSITIONNOTIFY         notifies;
     int                         nrofnotifies;
+    /* notifications found while mixing, signalled by the mixer thread */
+    BOOL                        notify_pending, notify_stopped;
+    DWORD                       notify_pos;
+    int                         notify_len;
     /* DirectSound3DBuffer fields */
     DS3DBUFFER                  ds3db_ds3db;
     LONG                        ds3db_lVolume;
@@ -159,6 +188,7 @@ struct IDirectSoundBufferImpl
     int                         mix_channels;
     bitsgetfunc get, get_aux;
     bitsputfunc put, put_aux;
+    bitsgetrunfunc get_run;
 
     struct list entry;
 };
@@ -223,6 +253,7 @@ void DSOUND_RecalcFormat(IDirectSoundBufferImpl *dsb) DECLSPEC_HIDDEN;
 DWORD DSOUND_secpos_to_bufpos(const IDirectSoundBufferImpl *dsb, DWORD secpos, DWORD secmixpos, float *overshot) DECLSPEC_HIDDEN;
 
 DWORD CALLBACK DSOUND_mixthread(void *ptr) DECLSPEC_HIDDEN;
+void DSOUND_DestroyMixWorkers(DirectSoundDevice *device) DECLSPEC_HIDDEN;
 
 /* sound3d.c */
 
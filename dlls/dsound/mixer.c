@@ -135,6 +135,7 @@ void DSOUND_RecalcFormat(IDirectSoundBufferImpl *dsb)
 	dsb->freqAccNum = 0;
 
 	dsb->get_aux = ieee ? getbpp[4] : getbpp[dsb->pwfx->wBitsPerSample/8 - 1];
+	dsb->get_run = ieee ? getbpp_run[4] : getbpp_run[dsb->pwfx->wBitsPerSample/8 - 1];
 	dsb->put_aux = putieee32;
 
 	dsb->get = dsb->get_aux;
@@ -182,33 +183,25 @@ void DSOUND_RecalcFormat(IDirectSoundBufferImpl *dsb)
 	}
 }
 
-/**
- * Check for application callback requests for when the play position
- * reaches certain points.
- *
- * The offsets that will be triggered will be those between the recorded
- * "last played" position for the buffer (i.e. dsb->playpos) and "len" bytes
- * beyond that position.
- */
-void DSOUND_CheckEvent(const IDirectSoundBufferImpl *dsb, DWORD playpos, int len)
+/* Signal the DSBPN_OFFSETSTOP notifications of a buffer that has stopped. */
+static void DSOUND_SignalStop(const IDirectSoundBufferImpl *dsb)
 {
-    int first, left, right, check;
+    int i;
 
-    if(dsb->nrofnotifies == 0)
-        return;
-
-    if(dsb->state == STATE_STOPPED){
-        TRACE("Stopped...\n");
-        /* DSBPN_OFFSETSTOP notifies are always at the start of the sorted array */
-        for(left = 0; left < dsb->nrofnotifies; ++left){
-            if(dsb->notifies[left].dwOffset != DSBPN_OFFSETSTOP)
-                break;
+    /* DSBPN_OFFSETSTOP notifies are always at the start of the sorted array */
+    for(i = 0; i < dsb->nrofnotifies; ++i){
+        if(dsb->notifies[i].dwOffset != DSBPN_OFFSETSTOP)
+            break;
 
-            TRACE("Signalling %p\n", dsb->notifies[left].hEventNotify);
-            SetEvent(dsb->notifies[left].hEventNotify);
-        }
-        return;
+        TRACE("Signalling %p\n", dsb->notifies[i].hEventNotify);
+        SetEvent(dsb->notifies[i].hEventNotify);
     }
+}
+
+/* Signal the notifications of a playing buffer between playpos and playpos + len. */
+static void DSOUND_SignalRange(const IDirectSoundBufferImpl *dsb, DWORD playpos, int len)
+{
+    int first, left, right, check;
 
     for(first = 0; first < dsb->nrofnotifies && dsb->notifies[first].dwOffset == DSBPN_OFFSETSTOP; ++first)
         ;
@@ -259,6 +252,28 @@ void DSOUND_CheckEvent(const IDirectSoundBufferImpl *dsb, DWORD playpos, int len
     }
 }
 
+/**
+ * Check for application callback requests for when the play position
+ * reaches certain points.
+ *
+ * The offsets that will be triggered will be those between the recorded
+ * "last played" position for the buffer (i.e. dsb->playpos) and "len" bytes
+ * beyond that position.
+ */
+void DSOUND_CheckEvent(const IDirectSoundBufferImpl *dsb, DWORD playpos, int len)
+{
+    if(dsb->nrofnotifies == 0)
+        return;
+
+    if(dsb->state == STATE_STOPPED){
+        TRACE("Stopped...\n");
+        DSOUND_SignalStop(dsb);
+        return;
+    }
+
+    DSOUND_SignalRange(dsb, playpos, len);
+}
+
 static inline float get_current_sample(const IDirectSoundBufferImpl *dsb,
         DWORD mixpos, DWORD channel)
 {
@@ -267,11 +282,62 @@ static inline float get_current_sample(const IDirectSoundBufferImpl *dsb,
     return dsb->get(dsb, mixpos % dsb->buflen, channel);
 }
 
+/* Same as calling get_current_sample() for count consecutive frames, but
+ * converts each contiguous stretch of the buffer in one go. */
+static void get_current_samples(const IDirectSoundBufferImpl *dsb,
+        DWORD mixpos, DWORD channel, float *out, UINT ostride, UINT count)
+{
+    UINT istride = dsb->pwfx->nBlockAlign;
+    UINT run;
+
+    if (dsb->get != dsb->get_aux)
+    {
+        /* downmixing, no run conversion */
+        for (run = 0; run < count; run++)
+            out[run * ostride] = get_current_sample(dsb, mixpos + run * istride, channel);
+        return;
+    }
+
+    while (count)
+    {
+        if (mixpos >= dsb->buflen)
+        {
+            if (!(dsb->playflags & DSBPLAY_LOOPING))
+            {
+                while (count--)
+                {
+                    *out = 0.0f;
+                    out += ostride;
+                }
+                return;
+            }
+            mixpos %= dsb->buflen;
+        }
+
+        run = min(count, (dsb->buflen - mixpos + istride - 1) / istride);
+        dsb->get_run(dsb, mixpos, channel, out, ostride, run);
+
+        out += run * ostride;
+        mixpos += run * istride;
+        count -= run;
+    }
+}
+
 static UINT cp_fields_noresample(IDirectSoundBufferImpl *dsb, UINT count)
 {
     UINT istride = dsb->pwfx->nBlockAlign;
     UINT ostride = dsb->device->pwfx->nChannels * sizeof(float);
     DWORD channel, i;
+
+    if (dsb->put == putieee32)
+    {
+        /* same channel layout, convert straight into the temporary buffer */
+        for (channel = 0; channel < dsb->mix_channels; channel++)
+            get_current_samples(dsb, dsb->sec_mixpos, channel,
+                    dsb->tmp_buffer + channel, dsb->device->pwfx->nChannels, count);
+        return count;
+    }
+
     for (i = 0; i < count; i++)
         for (channel = 0; channel < dsb->mix_channels; channel++)
             dsb->put(dsb, i * ostride, channel, get_current_sample(dsb,
@@ -282,7 +348,6 @@ static UINT cp_fields_noresample(IDirectSoundBufferImpl *dsb, UINT count)
 static UINT cp_fields_resample(IDirectSoundBufferImpl *dsb, UINT count, LONG64 *freqAccNum)
 {
     UINT i, channel;
-    UINT istride = dsb->pwfx->nBlockAlign;
     UINT ostride = dsb->device->pwfx->nChannels * sizeof(float);
 
     LONG64 freqAcc_start = *freqAccNum;
@@ -304,11 +369,9 @@ static UINT cp_fields_resample(IDirectSoundBufferImpl *dsb, UINT count, LONG64 *
      * if you want -msse3 to have any effect.
      * This is good for CPU cache effects, too.
      */
-    float* itmp = intermediate;
     for (channel = 0; channel < channels; channel++)
-        for (i = 0; i < required_input; i++)
-            *(itmp++) = get_current_sample(dsb,
-                    dsb->sec_mixpos + i * istride, channel);
+        get_current_samples(dsb, dsb->sec_mixpos, channel,
+                intermediate + channel * required_input, 1, required_input);
 
     for(i = 0; i < count; ++i) {
         UINT int_fir_steps = (freqAcc_start + i * dsb->freqAdjustNum) * dsbfirstep / dsb->freqAdjustDen;
@@ -333,7 +396,10 @@ static UINT cp_fields_resample(IDirectSoundBufferImpl *dsb, UINT count, LONG64 *
             float* cache = &intermediate[channel * required_input + ipos];
             for (j = 0; j < fir_used; j++)
                 sum += fir_copy[j] * cache[j];
-            dsb->put(dsb, i * ostride, channel, sum * dsb->firgain);
+            if (dsb->put == putieee32)
+                dsb->tmp_buffer[i * ostride / sizeof(float) + channel] = sum * dsb->firgain;
+            else
+                dsb->put(dsb, i * ostride, channel, sum * dsb->firgain);
         }
     }
 
@@ -383,39 +449,40 @@ static inline DWORD DSOUND_BufPtrDiff(DWORD buflen, DWORD ptr1, DWORD ptr2)
 	}
 }
 /**
- * Mix at most the given amount of data into the allocated temporary buffer
- * of the given secondary buffer, starting from the dsb's first currently
+ * Mix at most the given amount of data into the temporary buffer of the
+ * mixing thread, starting from the dsb's first currently
  * unsampled frame (writepos), translating frequency (pitch), stereo/mono
  * and bits-per-sample so that it is ideal for the primary buffer.
  * Doesn't perform any mixing - this is a straight copy/convert operation.
  *
+ * worker = the mixing thread
  * dsb = the secondary buffer
- * writepos = Starting position of changed buffer
- * len = number of bytes to resample from writepos
- *
- * NOTE: writepos + len <= buflen. When called by mixer, MixOne makes sure of this.
+ * frames = number of frames to produce
  */
-static void DSOUND_MixToTemporary(IDirectSoundBufferImpl *dsb, DWORD frames)
+static void DSOUND_MixToTemporary(struct mix_worker *worker, IDirectSoundBufferImpl *dsb, DWORD frames)
 {
 	UINT size_bytes = frames * sizeof(float) * dsb->device->pwfx->nChannels;
 
-	if (dsb->device->tmp_buffer_len < size_bytes || !dsb->device->tmp_buffer)
+	if (worker->tmp_buffer_len < size_bytes || !worker->tmp_buffer)
 	{
-		dsb->device->tmp_buffer_len = size_bytes;
-		if (dsb->device->tmp_buffer)
-			dsb->device->tmp_buffer = HeapReAlloc(GetProcessHeap(), 0, dsb->device->tmp_buffer, size_bytes);
+		worker->tmp_buffer_len = size_bytes;
+		if (worker->tmp_buffer)
+			worker->tmp_buffer = HeapReAlloc(GetProcessHeap(), 0, worker->tmp_buffer, size_bytes);
 		else
-			dsb->device->tmp_buffer = HeapAlloc(GetProcessHeap(), 0, size_bytes);
+			worker->tmp_buffer = HeapAlloc(GetProcessHeap(), 0, size_bytes);
 	}
 
+	dsb->tmp_buffer = worker->tmp_buffer;
 	cp_fields(dsb, frames, &dsb->freqAccNum);
 }
 
-static void DSOUND_MixerVol(const IDirectSoundBufferImpl *dsb, INT frames)
+/* Add the converted data in the temporary buffer to the given mixing buffer,
+ * applying volume and pan on the way if needed. */
+static void DSOUND_MixerVol(const IDirectSoundBufferImpl *dsb, float *mix_buffer, INT frames)
 {
 	INT	i;
 	float vols[DS_MAX_CHANNELS];
-	UINT channels = dsb->device->pwfx->nChannels, chan;
+	UINT channels = dsb->device->pwfx->nChannels;
 
 	TRACE("(%p,%d)\n",dsb,frames);
 	TRACE("left = %x, right = %x\n", dsb->volpan.dwTotalAmpFactor[0],
@@ -424,22 +491,23 @@ static void DSOUND_MixerVol(const IDirectSoundBufferImpl *dsb, INT frames)
 	if ((!(dsb->dsbd.dwFlags & DSBCAPS_CTRLPAN) || (dsb->volpan.lPan == 0)) &&
 	    (!(dsb->dsbd.dwFlags & DSBCAPS_CTRLVOLUME) || (dsb->volpan.lVolume == 0)) &&
 	     !(dsb->dsbd.dwFlags & DSBCAPS_CTRL3D))
-		return; /* Nothing to do */
+	{
+		/* No volume to apply */
+		mixieee32(dsb->tmp_buffer, mix_buffer, frames * channels);
+		return;
+	}
 
 	if (channels > DS_MAX_CHANNELS)
 	{
 		FIXME("There is no support for %u channels\n", channels);
+		mixieee32(dsb->tmp_buffer, mix_buffer, frames * channels);
 		return;
 	}
 
 	for (i = 0; i < channels; ++i)
 		vols[i] = dsb->volpan.dwTotalAmpFactor[i] / ((float)0xFFFF);
 
-	for(i = 0; i < frames; ++i){
-		for(chan = 0; chan < channels; ++chan){
-			dsb->device->tmp_buffer[i * channels + chan] *= vols[chan];
-		}
-	}
+	mixieee32_vol(dsb->tmp_buffer, mix_buffer, frames, channels, vols);
 }
 
 /**
@@ -451,14 +519,14 @@ static void DSOUND_MixerVol(const IDirectSoundBufferImpl *dsb, INT frames)
  * will match fraglen unless the end of the secondary buffer is reached
  * (and it is not looping).
  *
+ * worker = the mixing thread
  * dsb  = the secondary buffer to mix from
  * writepos = position (offset) in device buffer to write at
  * fraglen = number of bytes to mix
  */
-static DWORD DSOUND_MixInBuffer(IDirectSoundBufferImpl *dsb, DWORD writepos, DWORD fraglen)
+static DWORD DSOUND_MixInBuffer(struct mix_worker *worker, IDirectSoundBufferImpl *dsb, DWORD writepos, DWORD fraglen)
 {
 	INT len = fraglen;
-	float *ibuf;
 	DWORD oldpos;
 	UINT frames = fraglen / dsb->device->pwfx->nBlockAlign;
 
@@ -474,19 +542,18 @@ static DWORD DSOUND_MixInBuffer(IDirectSoundBufferImpl *dsb, DWORD writepos, DWO
 	/* Resample buffer to temporary buffer specifically allocated for this purpose, if needed */
 	oldpos = dsb->sec_mixpos;
 
-	DSOUND_MixToTemporary(dsb, frames);
-	ibuf = dsb->device->tmp_buffer;
+	DSOUND_MixToTemporary(worker, dsb, frames);
 
-	/* Apply volume if needed */
-	DSOUND_MixerVol(dsb, frames);
+	/* Mix into the thread's mix buffer, applying volume if needed */
+	DSOUND_MixerVol(dsb, worker->mix_buffer, frames);
 
-	mixieee32(ibuf, dsb->device->mix_buffer, frames * dsb->device->pwfx->nChannels);
-
-	/* check for notification positions */
+	/* check for notification positions, they are signalled once all threads are done */
 	if (dsb->dsbd.dwFlags & DSBCAPS_CTRLPOSITIONNOTIFY &&
-	    dsb->state != STATE_STARTING) {
-		INT ilen = DSOUND_BufPtrDiff(dsb->buflen, dsb->sec_mixpos, oldpos);
-		DSOUND_CheckEvent(dsb, oldpos, ilen);
+	    dsb->state != STATE_STARTING && dsb->nrofnotifies) {
+		dsb->notify_pending = TRUE;
+		dsb->notify_stopped = FALSE;
+		dsb->notify_pos = oldpos;
+		dsb->notify_len = DSOUND_BufPtrDiff(dsb->buflen, dsb->sec_mixpos, oldpos);
 	}
 
 	return len;
@@ -496,15 +563,15 @@ static DWORD DSOUND_MixInBuffer(IDirectSoundBufferImpl *dsb, DWORD writepos, DWO
  * Mix some frames from the given secondary buffer "dsb" into the device
  * primary buffer.
  *
+ * worker = the mixing thread
  * dsb = the secondary buffer
- * playpos = the current play position in the device buffer (primary buffer)
  * writepos = the current safe-to-write position in the device buffer
  * mixlen = the maximum number of bytes in the primary buffer to mix, from the
  *          current writepos.
  *
  * Returns: the number of bytes beyond the writepos that were mixed.
  */
-static DWORD DSOUND_MixOne(IDirectSoundBufferImpl *dsb, DWORD writepos, DWORD mixlen)
+static DWORD DSOUND_MixOne(struct mix_worker *worker, IDirectSoundBufferImpl *dsb, DWORD writepos, DWORD mixlen)
 {
 	DWORD primary_done = 0;
 
@@ -531,7 +598,7 @@ static DWORD DSOUND_MixOne(IDirectSoundBufferImpl *dsb, DWORD writepos, DWORD mi
 	/* First try to mix to the end of the buffer if possible
 	 * Theoretically it would allow for better optimization
 	*/
-	primary_done += DSOUND_MixInBuffer(dsb, writepos, mixlen);
+	primary_done += DSOUND_MixInBuffer(worker, dsb, writepos, mixlen);
 
 	TRACE("total mixed data=%d\n", primary_done);
 
@@ -539,10 +606,182 @@ static DWORD DSOUND_MixOne(IDirectSoundBufferImpl *dsb, DWORD writepos, DWORD mi
 	return primary_done;
 }
 
+/* Secondary buffers are summed in groups of this many, each group into its
+ * own buffer, and the groups are spread over the mixing threads. */
+#define MIX_BUFFERS_PER_GROUP 16
+
+/**
+ * Go through the given range of groups of the device's buffers and mix the
+ * currently playing ones into the buffer of their group.
+ */
+static void DSOUND_MixRange(struct mix_worker *worker)
+{
+	DirectSoundDevice *device = worker->device;
+	UINT samples = worker->mixlen / device->pwfx->nBlockAlign * device->pwfx->nChannels;
+	IDirectSoundBufferImpl	*dsb;
+	INT group, i, last;
+
+	/* unless we find a running buffer, all have stopped */
+	worker->all_stopped = TRUE;
+
+	for (group = worker->first; group < worker->last; group++) {
+		/* the first group goes straight into the device mix buffer */
+		if (group && device->group_buffers) {
+			worker->mix_buffer = device->group_buffers + (group - 1) * samples;
+			ZeroMemory(worker->mix_buffer, samples * sizeof(float));
+		} else
+			worker->mix_buffer = device->mix_buffer;
+
+		last = min((group + 1) * MIX_BUFFERS_PER_GROUP, device->nrofbuffers);
+		for (i = group * MIX_BUFFERS_PER_GROUP; i < last; i++) {
+			dsb = device->buffers[i];
+
+			TRACE("MixToPrimary for %p, state=%d\n", dsb, dsb->state);
+
+			if (dsb->buflen && dsb->state) {
+				TRACE("Checking %p, mixlen=%d\n", dsb, worker->mixlen);
+				RtlAcquireResourceShared(&dsb->lock, TRUE);
+				/* if buffer is stopping it is stopped now */
+				if (dsb->state == STATE_STOPPING) {
+					dsb->state = STATE_STOPPED;
+					if (dsb->nrofnotifies) {
+						dsb->notify_pending = TRUE;
+						dsb->notify_stopped = TRUE;
+					}
+				} else if (dsb->state != STATE_STOPPED) {
+
+					/* if the buffer was starting, it must be playing now */
+					if (dsb->state == STATE_STARTING)
+						dsb->state = STATE_PLAYING;
+
+					/* mix next buffer into the main buffer */
+					DSOUND_MixOne(worker, dsb, worker->writepos, worker->mixlen);
+
+					worker->all_stopped = FALSE;
+				}
+				RtlReleaseResource(&dsb->lock);
+			}
+		}
+	}
+}
+
+/**
+ * Signal the notifications found while mixing, in the order of the device's
+ * buffers. Only called by the mixer thread, once the workers are done.
+ */
+static void DSOUND_SignalPending(DirectSoundDevice *device)
+{
+	IDirectSoundBufferImpl *dsb;
+	INT i;
+
+	for (i = 0; i < device->nrofbuffers; i++) {
+		dsb = device->buffers[i];
+		if (!dsb->notify_pending)
+			continue;
+
+		RtlAcquireResourceShared(&dsb->lock, TRUE);
+		dsb->notify_pending = FALSE;
+		if (dsb->notify_stopped)
+			DSOUND_SignalStop(dsb);
+		else
+			DSOUND_SignalRange(dsb, dsb->notify_pos, dsb->notify_len);
+		RtlReleaseResource(&dsb->lock);
+	}
+}
+
+static DWORD CALLBACK DSOUND_mixworker(void *p)
+{
+	struct mix_worker *worker = p;
+
+	for (;;) {
+		WaitForSingleObject(worker->start_event, INFINITE);
+		if (worker->quit)
+			break;
+
+		DSOUND_MixRange(worker);
+
+		SetEvent(worker->done_event);
+	}
+	return 0;
+}
+
+/**
+ * Decide how many threads share the mixing of the device's buffers, starting
+ * worker threads and growing the group buffers as needed.
+ *
+ * Returns: the number of threads to use, including the mixer thread itself.
+ */
+static int DSOUND_PrepareMixWorkers(DirectSoundDevice *device, UINT samples, int groups)
+{
+	UINT size_bytes = (groups - 1) * samples * sizeof(float);
+	int i, count;
+
+	if (device->group_buffers_len < size_bytes) {
+		float *group_buffers;
+
+		if (device->group_buffers)
+			group_buffers = HeapReAlloc(GetProcessHeap(), 0, device->group_buffers, size_bytes);
+		else
+			group_buffers = HeapAlloc(GetProcessHeap(), 0, size_bytes);
+		if (!group_buffers) {
+			/* mix everything into the device mix buffer on this thread */
+			WARN("out of memory, mixing %d buffers on one thread\n", device->nrofbuffers);
+			HeapFree(GetProcessHeap(), 0, device->group_buffers);
+			device->group_buffers = NULL;
+			device->group_buffers_len = 0;
+			return 1;
+		}
+		device->group_buffers = group_buffers;
+		device->group_buffers_len = size_bytes;
+	}
+
+	if (!device->nrofworkers) {
+		SYSTEM_INFO si;
+
+		GetSystemInfo(&si);
+		device->nrofworkers = max(1, min(si.dwNumberOfProcessors, MAX_MIX_WORKERS));
+		TRACE("using up to %d mixing threads\n", device->nrofworkers);
+	}
+
+	/* only use other threads for full groups, to make up for the synchronization */
+	count = min(device->nrofbuffers / MIX_BUFFERS_PER_GROUP, device->nrofworkers);
+
+	for (i = 1; i < count; i++) {
+		struct mix_worker *worker = &device->workers[i];
+
+		if (!worker->thread) {
+			worker->device = device;
+			worker->start_event = CreateEventW(NULL, FALSE, FALSE, NULL);
+			worker->done_event = CreateEventW(NULL, FALSE, FALSE, NULL);
+			if (worker->start_event && worker->done_event)
+				worker->thread = CreateThread(NULL, 0, DSOUND_mixworker, worker, 0, NULL);
+			if (!worker->thread) {
+				WARN("failed to start mixing thread %d\n", i);
+				if (worker->start_event)
+					CloseHandle(worker->start_event);
+				if (worker->done_event)
+					CloseHandle(worker->done_event);
+				worker->start_event = worker->done_event = NULL;
+				break;
+			}
+			SetThreadPriority(worker->thread, THREAD_PRIORITY_TIME_CRITICAL);
+		}
+	}
+
+	return max(i, 1);
+}
+
 /**
  * For a DirectSoundDevice, go through all the currently playing buffers and
  * mix them in to the device buffer.
  *
+ * The buffers are summed in fixed groups of MIX_BUFFERS_PER_GROUP, each into
+ * its own group buffer, and the group buffers are then added to the device mix
+ * buffer in group order. Which thread mixes a group makes no difference, so
+ * the result does not depend on the number of threads or their timing. Every
+ * buffer is still mixed while holding its lock, as in the single threaded case,
+ * and position notifications are signalled by this thread once all are done.
+ *
  * writepos = the current safe-to-write position in the primary buffer
  * mixlen = the maximum amount to mix into the primary buffer
  *          (beyond the current writepos)
@@ -553,41 +792,49 @@ static DWORD DSOUND_MixOne(IDirectSoundBufferImpl *dsb, DWORD writepos, DWORD mi
  * Returns:  the length beyond the writepos that was mixed to.
  */
 
-static void DSOUND_MixToPrimary(const DirectSoundDevice *device, DWORD writepos, DWORD mixlen, BOOL recover, BOOL *all_stopped)
+static void DSOUND_MixToPrimary(DirectSoundDevice *device, DWORD writepos, DWORD mixlen, BOOL recover, BOOL *all_stopped)
 {
-	INT i;
-	IDirectSoundBufferImpl	*dsb;
-
-	/* unless we find a running buffer, all have stopped */
-	*all_stopped = TRUE;
+	UINT samples = mixlen / device->pwfx->nBlockAlign * device->pwfx->nChannels;
+	int groups = (device->nrofbuffers + MIX_BUFFERS_PER_GROUP - 1) / MIX_BUFFERS_PER_GROUP;
+	HANDLE done[MAX_MIX_WORKERS];
+	int i, count;
 
 	TRACE("(%d,%d,%d)\n", writepos, mixlen, recover);
-	for (i = 0; i < device->nrofbuffers; i++) {
-		dsb = device->buffers[i];
 
-		TRACE("MixToPrimary for %p, state=%d\n", dsb, dsb->state);
+	count = DSOUND_PrepareMixWorkers(device, samples, max(groups, 1));
 
-		if (dsb->buflen && dsb->state) {
-			TRACE("Checking %p, mixlen=%d\n", dsb, mixlen);
-			RtlAcquireResourceShared(&dsb->lock, TRUE);
-			/* if buffer is stopping it is stopped now */
-			if (dsb->state == STATE_STOPPING) {
-				dsb->state = STATE_STOPPED;
-				DSOUND_CheckEvent(dsb, 0, 0);
-			} else if (dsb->state != STATE_STOPPED) {
+	for (i = 0; i < count; i++) {
+		struct mix_worker *worker = &device->workers[i];
 
-				/* if the buffer was starting, it must be playing now */
-				if (dsb->state == STATE_STARTING)
-					dsb->state = STATE_PLAYING;
+		worker->first = groups * i / count;
+		worker->last = groups * (i + 1) / count;
+		worker->writepos = writepos;
+		worker->mixlen = mixlen;
+		if (i) {
+			done[i - 1] = worker->done_event;
+			SetEvent(worker->start_event);
+		}
+	}
 
-				/* mix next buffer into the main buffer */
-				DSOUND_MixOne(dsb, writepos, mixlen);
+	/* the mixer thread takes the first range, including the first group */
+	device->workers[0].device = device;
+	DSOUND_MixRange(&device->workers[0]);
+	*all_stopped = device->workers[0].all_stopped;
 
-				*all_stopped = FALSE;
-			}
-			RtlReleaseResource(&dsb->lock);
-		}
+	if (count > 1)
+		WaitForMultipleObjects(count - 1, done, TRUE, INFINITE);
+
+	for (i = 1; i < count; i++) {
+		if (!device->workers[i].all_stopped)
+			*all_stopped = FALSE;
 	}
+
+	if (device->group_buffers) {
+		for (i = 1; i < groups; i++)
+			mixieee32(device->group_buffers + (i - 1) * samples, device->mix_buffer, samples);
+	}
+
+	DSOUND_SignalPending(device);
 }
 
 /**
@@ -690,9 +937,9 @@ static void DSOUND_WaveQueue(DirectSoundDevice *device, BOOL force)
  * The mixing procedure goes:
  *
  * secondary->buffer (secondary format)
- *   =[Resample]=> device->tmp_buffer (float format)
- *   =[Volume]=> device->tmp_buffer (float format)
- *   =[Mix]=> device->mix_buffer (float format)
+ *   =[Resample]=> worker->tmp_buffer (float format)
+ *   =[Volume and Mix]=> device->group_buffers (float format)
+ *   =[Sum of groups]=> device->mix_buffer (float format)
  *   =[Reformat]=> device->buffer (device format)
  */
 static void DSOUND_PerformMix(DirectSoundDevice *device)
@@ -898,3 +1145,24 @@ DWORD CALLBACK DSOUND_mixthread(void *p)
 	}
 	return 0;
 }
+
+/* Called once the mixer thread has exited. */
+void DSOUND_DestroyMixWorkers(DirectSoundDevice *device)
+{
+	int i;
+
+	for (i = 0; i < MAX_MIX_WORKERS; i++) {
+		struct mix_worker *worker = &device->workers[i];
+
+		if (worker->thread) {
+			worker->quit = TRUE;
+			SetEvent(worker->start_event);
+			WaitForSingleObject(worker->thread, INFINITE);
+			CloseHandle(worker->thread);
+			CloseHandle(worker->start_event);
+			CloseHandle(worker->done_event);
+		}
+		HeapFree(GetProcessHeap(), 0, worker->tmp_buffer);
+	}
+	HeapFree(GetProcessHeap(), 0, device->group_buffers);
+}
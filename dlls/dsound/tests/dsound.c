@@ -1566,6 +1566,121 @@ static void test_notifications(LPGUID lpGuid)
     IDirectSound_Release(dso);
 }
 
+/* enough buffers for the mixer to spread them over several threads */
+#define NOTIFY_BUFFERS 32
+
+static void test_notifications_multiple(LPGUID lpGuid)
+{
+    HRESULT rc;
+    IDirectSound *dso;
+    IDirectSoundBuffer *bufs[NOTIFY_BUFFERS];
+    IDirectSoundNotify *buf_notif;
+    DSBUFFERDESC bufdesc;
+    WAVEFORMATEX wfx;
+    DSBPOSITIONNOTIFY notifies[3];
+    HANDLE handles[NOTIFY_BUFFERS * 2], stop_handles[NOTIFY_BUFFERS];
+    int expect[NOTIFY_BUFFERS], count[NOTIFY_BUFFERS];
+    DWORD wait;
+    int i, total;
+
+    rc = pDirectSoundCreate(lpGuid, &dso, NULL);
+    ok(rc == DS_OK || rc == DSERR_NODRIVER || rc == DSERR_ALLOCATED,
+           "DirectSoundCreate() failed: %08x\n", rc);
+    if(rc != DS_OK)
+        return;
+
+    rc = IDirectSound_SetCooperativeLevel(dso, get_hwnd(), DSSCL_PRIORITY);
+    ok(rc == DS_OK, "IDirectSound_SetCooperativeLevel() failed: %08x\n", rc);
+    if(rc != DS_OK){
+        IDirectSound_Release(dso);
+        return;
+    }
+
+    wfx.wFormatTag = WAVE_FORMAT_PCM;
+    wfx.nChannels = 1;
+    wfx.nSamplesPerSec = 44100;
+    wfx.wBitsPerSample = 16;
+    wfx.nBlockAlign = wfx.nChannels * wfx.wBitsPerSample / 8;
+    wfx.nAvgBytesPerSec = wfx.nSamplesPerSec * wfx.nBlockAlign;
+    wfx.cbSize = 0;
+
+    ZeroMemory(&bufdesc, sizeof(bufdesc));
+    bufdesc.dwSize = sizeof(bufdesc);
+    bufdesc.dwFlags = DSBCAPS_CTRLPOSITIONNOTIFY;
+    bufdesc.dwBufferBytes = wfx.nSamplesPerSec * wfx.nBlockAlign / 2; /* 0.5s */
+    bufdesc.lpwfxFormat = &wfx;
+
+    for(i = 0; i < NOTIFY_BUFFERS; ++i){
+        rc = IDirectSound_CreateSoundBuffer(dso, &bufdesc, &bufs[i], NULL);
+        ok(rc == DS_OK && bufs[i] != NULL, "IDirectSound_CreateSoundBuffer() failed "
+               "to create buffer %d: %08x\n", i, rc);
+        if(rc != DS_OK){
+            while(i--)
+                IDirectSoundBuffer_Release(bufs[i]);
+            IDirectSound_Release(dso);
+            return;
+        }
+
+        rc = IDirectSoundBuffer_QueryInterface(bufs[i], &IID_IDirectSoundNotify, (void**)&buf_notif);
+        ok(rc == DS_OK, "QueryInterface(IID_IDirectSoundNotify): %08x\n", rc);
+
+        notifies[0].dwOffset = 0;
+        handles[2 * i] = notifies[0].hEventNotify = CreateEventW(NULL, FALSE, FALSE, NULL);
+        notifies[1].dwOffset = bufdesc.dwBufferBytes / 2;
+        handles[2 * i + 1] = notifies[1].hEventNotify = CreateEventW(NULL, FALSE, FALSE, NULL);
+        notifies[2].dwOffset = DSBPN_OFFSETSTOP;
+        stop_handles[i] = notifies[2].hEventNotify = CreateEventW(NULL, FALSE, FALSE, NULL);
+
+        rc = IDirectSoundNotify_SetNotificationPositions(buf_notif, 3, notifies);
+        ok(rc == DS_OK, "SetNotificationPositions: %08x\n", rc);
+
+        IDirectSoundNotify_Release(buf_notif);
+
+        expect[i] = 0;
+        count[i] = 0;
+    }
+
+    for(i = 0; i < NOTIFY_BUFFERS; ++i){
+        rc = IDirectSoundBuffer_Play(bufs[i], 0, 0, DSBPLAY_LOOPING);
+        ok(rc == DS_OK, "Play: %08x\n", rc);
+    }
+
+    /* every buffer sees its positions in order, whichever thread mixed it */
+    for(total = 0; total < NOTIFY_BUFFERS * 4; ++total){
+        wait = WaitForMultipleObjects(NOTIFY_BUFFERS * 2, handles, FALSE, 1000);
+        ok(wait < WAIT_OBJECT_0 + NOTIFY_BUFFERS * 2, "timed out waiting for notifications: %u\n", wait);
+        if(wait >= WAIT_OBJECT_0 + NOTIFY_BUFFERS * 2)
+            break;
+
+        i = (wait - WAIT_OBJECT_0) / 2;
+        ok((wait - WAIT_OBJECT_0) % 2 == expect[i],
+           "buffer %d: got unexpected notification order: %u\n", i, wait);
+        expect[i] = !((wait - WAIT_OBJECT_0) % 2);
+        ++count[i];
+    }
+
+    for(i = 0; i < NOTIFY_BUFFERS; ++i)
+        ok(count[i] >= 2, "buffer %d: got %d notifications\n", i, count[i]);
+
+    for(i = 0; i < NOTIFY_BUFFERS; ++i){
+        rc = IDirectSoundBuffer_Stop(bufs[i]);
+        ok(rc == DS_OK, "Stop: %08x\n", rc);
+    }
+
+    for(i = 0; i < NOTIFY_BUFFERS; ++i){
+        wait = WaitForSingleObject(stop_handles[i], 1000);
+        ok(wait == WAIT_OBJECT_0, "buffer %d: stop notification not signalled: %u\n", i, wait);
+    }
+
+    for(i = 0; i < NOTIFY_BUFFERS; ++i){
+        CloseHandle(handles[2 * i]);
+        CloseHandle(handles[2 * i + 1]);
+        CloseHandle(stop_handles[i]);
+        IDirectSoundBuffer_Release(bufs[i]);
+    }
+    IDirectSound_Release(dso);
+}
+
 static unsigned int number;
 
 static BOOL WINAPI dsenum_callback(LPGUID lpGuid, LPCSTR lpcstrDescription,
@@ -1597,6 +1712,7 @@ static BOOL WINAPI dsenum_callback(LPGUID lpGuid, LPCSTR lpcstrDescription,
         test_duplicate(lpGuid);
         test_invalid_fmts(lpGuid);
         test_notifications(lpGuid);
+        test_notifications_multiple(lpGuid);
     }
 
     return TRUE;
@@ -353,23 +353,60 @@ static GpStatus get_clip_hrgn(GpGraphics *graphics, HRGN *hrgn)
     return GdipGetRegionHRgn(graphics->clip, NULL, hrgn);
 }
 
-/* Draw non-premultiplied ARGB data to the given graphics object */
-static GpStatus alpha_blend_bmp_pixels(GpGraphics *graphics, INT dst_x, INT dst_y,
-    const BYTE *src, INT src_width, INT src_height, INT src_stride)
+/* Draw a span of non-premultiplied ARGB pixels to a bitmap. A src_step of 0
+ * repeats the first source pixel along the whole span. */
+static void alpha_blend_bmp_span(GpBitmap *dst_bitmap, INT dst_x, INT dst_y,
+    const ARGB *src, INT src_step, INT count)
 {
-    GpBitmap *dst_bitmap = (GpBitmap*)graphics->image;
-    INT x, y;
+    ARGB *dst;
+    INT i;
+
+    if (dst_y < 0 || dst_y >= dst_bitmap->height)
+        return;
+
+    if (dst_x < 0)
+    {
+        src -= dst_x * src_step;
+        count += dst_x;
+        dst_x = 0;
+    }
 
-    for (x=0; x<src_width; x++)
+    if (count > dst_bitmap->width - dst_x)
+        count = dst_bitmap->width - dst_x;
+
+    switch (dst_bitmap->format)
     {
-        for (y=0; y<src_height; y++)
+    case PixelFormat32bppARGB:
+        dst = (ARGB*)(dst_bitmap->bits + dst_bitmap->stride * dst_y) + dst_x;
+        for (i=0; i<count; i++, src += src_step)
+            dst[i] = color_over(dst[i], *src);
+        break;
+    case PixelFormat32bppRGB:
+        dst = (ARGB*)(dst_bitmap->bits + dst_bitmap->stride * dst_y) + dst_x;
+        for (i=0; i<count; i++, src += src_step)
+            dst[i] = color_over(dst[i] | 0xff000000, *src) & 0xffffff;
+        break;
+    default:
+        for (i=0; i<count; i++, src += src_step)
         {
-            ARGB dst_color, src_color;
-            GdipBitmapGetPixel(dst_bitmap, x+dst_x, y+dst_y, &dst_color);
-            src_color = ((ARGB*)(src + src_stride * y))[x];
-            GdipBitmapSetPixel(dst_bitmap, x+dst_x, y+dst_y, color_over(dst_color, src_color));
+            ARGB dst_color;
+            GdipBitmapGetPixel(dst_bitmap, dst_x+i, dst_y, &dst_color);
+            GdipBitmapSetPixel(dst_bitmap, dst_x+i, dst_y, color_over(dst_color, *src));
         }
+        break;
     }
+}
+
+/* Draw non-premultiplied ARGB data to the given graphics object */
+static GpStatus alpha_blend_bmp_pixels(GpGraphics *graphics, INT dst_x, INT dst_y,
+    const BYTE *src, INT src_width, INT src_height, INT src_stride)
+{
+    GpBitmap *dst_bitmap = (GpBitmap*)graphics->image;
+    INT y;
+
+    for (y=0; y<src_height; y++)
+        alpha_blend_bmp_span(dst_bitmap, dst_x, dst_y+y,
+            (const ARGB*)(src + src_stride * y), 1, src_width);
 
     return Ok;
 }
@@ -414,6 +451,81 @@ static GpStatus alpha_blend_hdc_pixels(GpGraphics *graphics, INT dst_x, INT dst_
     return Ok;
 }
 
+/* Get the rectangles of the given area that are inside hregion (if any)
+ * and the clipping region of the graphics object. */
+static GpStatus get_visible_rects(GpGraphics *graphics, INT x, INT y,
+    INT width, INT height, HRGN hregion, RGNDATA **rgndata)
+{
+    GpStatus stat;
+    int size;
+    HRGN hrgn, visible_rgn;
+
+    hrgn = CreateRectRgn(x, y, x + width, y + height);
+    if (!hrgn)
+        return OutOfMemory;
+
+    stat = get_clip_hrgn(graphics, &visible_rgn);
+    if (stat != Ok)
+    {
+        DeleteObject(hrgn);
+        return stat;
+    }
+
+    if (visible_rgn)
+    {
+        CombineRgn(hrgn, hrgn, visible_rgn, RGN_AND);
+        DeleteObject(visible_rgn);
+    }
+
+    if (hregion)
+        CombineRgn(hrgn, hrgn, hregion, RGN_AND);
+
+    size = GetRegionData(hrgn, 0, NULL);
+
+    *rgndata = GdipAlloc(size);
+    if (!*rgndata)
+    {
+        DeleteObject(hrgn);
+        return OutOfMemory;
+    }
+
+    GetRegionData(hrgn, size, *rgndata);
+
+    DeleteObject(hrgn);
+
+    return Ok;
+}
+
+/* Fill the visible part of hregion in a bitmap with a single color, one
+ * span at a time, without building an intermediate pixel buffer. */
+static GpStatus alpha_blend_bmp_solid_hrgn(GpGraphics *graphics, const RECT *bound_rect,
+    ARGB color, HRGN hregion)
+{
+    GpBitmap *dst_bitmap = (GpBitmap*)graphics->image;
+    GpStatus stat;
+    RGNDATA *rgndata;
+    RECT *rects;
+    DWORD i;
+    INT y;
+
+    stat = get_visible_rects(graphics, bound_rect->left, bound_rect->top,
+        bound_rect->right - bound_rect->left, bound_rect->bottom - bound_rect->top,
+        hregion, &rgndata);
+    if (stat != Ok)
+        return stat;
+
+    rects = (RECT*)rgndata->Buffer;
+
+    for (i=0; i<rgndata->rdh.nCount; i++)
+        for (y=rects[i].top; y<rects[i].bottom; y++)
+            alpha_blend_bmp_span(dst_bitmap, rects[i].left, y, &color, 0,
+                rects[i].right - rects[i].left);
+
+    GdipFree(rgndata);
+
+    return Ok;
+}
+
 static GpStatus alpha_blend_pixels_hrgn(GpGraphics *graphics, INT dst_x, INT dst_y,
     const BYTE *src, INT src_width, INT src_height, INT src_stride, HRGN hregion)
 {
@@ -422,41 +534,13 @@ static GpStatus alpha_blend_pixels_hrgn(GpGraphics *graphics, INT dst_x, INT dst
     if (graphics->image && graphics->image->type == ImageTypeBitmap)
     {
         DWORD i;
-        int size;
         RGNDATA *rgndata;
         RECT *rects;
-        HRGN hrgn, visible_rgn;
 
-        hrgn = CreateRectRgn(dst_x, dst_y, dst_x + src_width, dst_y + src_height);
-        if (!hrgn)
-            return OutOfMemory;
-
-        stat = get_clip_hrgn(graphics, &visible_rgn);
+        stat = get_visible_rects(graphics, dst_x, dst_y, src_width, src_height,
+            hregion, &rgndata);
         if (stat != Ok)
-        {
-            DeleteObject(hrgn);
             return stat;
-        }
-
-        if (visible_rgn)
-        {
-            CombineRgn(hrgn, hrgn, visible_rgn, RGN_AND);
-            DeleteObject(visible_rgn);
-        }
-
-        if (hregion)
-            CombineRgn(hrgn, hrgn, hregion, RGN_AND);
-
-        size = GetRegionData(hrgn, 0, NULL);
-
-        rgndata = GdipAlloc(size);
-        if (!rgndata)
-        {
-            DeleteObject(hrgn);
-            return OutOfMemory;
-        }
-
-        GetRegionData(hrgn, size, rgndata);
 
         rects = (RECT*)rgndata->Buffer;
 
@@ -470,8 +554,6 @@ static GpStatus alpha_blend_pixels_hrgn(GpGraphics *graphics, INT dst_x, INT dst
 
         GdipFree(rgndata);
 
-        DeleteObject(hrgn);
-
         return stat;
     }
     else if (graphics->image && graphics->image->type == ImageTypeMetafile)
@@ -675,8 +757,8 @@ static void apply_image_attributes(const GpImageAttributes *attributes, LPBYTE d
         max_green = (key->high>>8)&0xff;
         max_red = (key->high>>16)&0xff;
 
-        for (x=0; x<width; x++)
-            for (y=0; y<height; y++)
+        for (y=0; y<height; y++)
+            for (x=0; x<width; x++)
             {
                 ARGB *src_color;
                 BYTE blue, green, red;
@@ -700,8 +782,8 @@ static void apply_image_attributes(const GpImageAttributes *attributes, LPBYTE d
         else
             table = &attributes->colorremaptables[ColorAdjustTypeDefault];
 
-        for (x=0; x<width; x++)
-            for (y=0; y<height; y++)
+        for (y=0; y<height; y++)
+            for (x=0; x<width; x++)
             {
                 ARGB *src_color;
                 src_color = (ARGB*)(data + stride * y + sizeof(ARGB) * x);
@@ -736,9 +818,9 @@ static void apply_image_attributes(const GpImageAttributes *attributes, LPBYTE d
 
         if (!identity)
         {
-            for (x=0; x<width; x++)
+            for (y=0; y<height; y++)
             {
-                for (y=0; y<height; y++)
+                for (x=0; x<width; x++)
                 {
                     ARGB *src_color;
                     src_color = (ARGB*)(data + stride * y + sizeof(ARGB) * x);
@@ -761,27 +843,26 @@ static void apply_image_attributes(const GpImageAttributes *attributes, LPBYTE d
         attributes->gamma_enabled[ColorAdjustTypeDefault])
     {
         REAL gamma;
+        BYTE gamma_table[256];
 
         if (attributes->gamma_enabled[type])
             gamma = attributes->gamma[type];
         else
             gamma = attributes->gamma[ColorAdjustTypeDefault];
 
-        for (x=0; x<width; x++)
-            for (y=0; y<height; y++)
+        for (i=0; i<256; i++)
+            gamma_table[i] = floorf(powf(i / 255.0, gamma) * 255.0);
+
+        for (y=0; y<height; y++)
+            for (x=0; x<width; x++)
             {
                 ARGB *src_color;
                 BYTE blue, green, red;
                 src_color = (ARGB*)(data + stride * y + sizeof(ARGB) * x);
 
-                blue = *src_color&0xff;
-                green = (*src_color>>8)&0xff;
-                red = (*src_color>>16)&0xff;
-
-                /* FIXME: We should probably use a table for this. */
-                blue = floorf(powf(blue / 255.0, gamma) * 255.0);
-                green = floorf(powf(green / 255.0, gamma) * 255.0);
-                red = floorf(powf(red / 255.0, gamma) * 255.0);
+                blue = gamma_table[*src_color&0xff];
+                green = gamma_table[(*src_color>>8)&0xff];
+                red = gamma_table[(*src_color>>16)&0xff];
 
                 *src_color = (*src_color & 0xff000000) | (red << 16) | (green << 8) | blue;
             }
@@ -856,44 +937,39 @@ static void get_bitmap_sample_size(InterpolationMode interpolation, WrapMode wra
     rect->Height = bottom - top + 1;
 }
 
-static ARGB sample_bitmap_pixel(GDIPCONST GpRect *src_rect, LPBYTE bits, UINT width,
-    UINT height, INT x, INT y, GDIPCONST GpImageAttributes *attributes)
+/* Map a sample co-ordinate along one axis of the bitmap according to the
+ * wrap mode. Returns FALSE if it falls outside a clamped bitmap. */
+static BOOL wrap_sample_coordinate(WrapMode wrap, BOOL flip, UINT size, INT *coord)
 {
-    if (attributes->wrap == WrapModeClamp)
+    INT c = *coord;
+
+    if (wrap == WrapModeClamp)
+        return c >= 0 && c < size;
+
+    /* Tiling. Make sure co-ordinates are positive as it simplifies the math. */
+    if (c < 0)
+        c = size*2 + c % (size * 2);
+
+    if (flip)
     {
-        if (x < 0 || y < 0 || x >= width || y >= height)
-            return attributes->outside_color;
+        if ((c / size) % 2 == 0)
+            c = c % size;
+        else
+            c = size - 1 - c % size;
     }
     else
-    {
-        /* Tiling. Make sure co-ordinates are positive as it simplifies the math. */
-        if (x < 0)
-            x = width*2 + x % (width * 2);
-        if (y < 0)
-            y = height*2 + y % (height * 2);
+        c = c % size;
 
-        if ((attributes->wrap & 1) == 1)
-        {
-            /* Flip X */
-            if ((x / width) % 2 == 0)
-                x = x % width;
-            else
-                x = width - 1 - x % width;
-        }
-        else
-            x = x % width;
+    *coord = c;
+    return TRUE;
+}
 
-        if ((attributes->wrap & 2) == 2)
-        {
-            /* Flip Y */
-            if ((y / height) % 2 == 0)
-                y = y % height;
-            else
-                y = height - 1 - y % height;
-        }
-        else
-            y = y % height;
-    }
+static ARGB sample_bitmap_pixel(GDIPCONST GpRect *src_rect, LPBYTE bits, UINT width,
+    UINT height, INT x, INT y, GDIPCONST GpImageAttributes *attributes)
+{
+    if (!wrap_sample_coordinate(attributes->wrap, (attributes->wrap & 1) == 1, width, &x) ||
+        !wrap_sample_coordinate(attributes->wrap, (attributes->wrap & 2) == 2, height, &y))
+        return attributes->outside_color;
 
     if (x < src_rect->X || y < src_rect->Y || x >= src_rect->X + src_rect->Width || y >= src_rect->Y + src_rect->Height)
     {
@@ -904,6 +980,21 @@ static ARGB sample_bitmap_pixel(GDIPCONST GpRect *src_rect, LPBYTE bits, UINT wi
     return ((DWORD*)(bits))[(x - src_rect->X) + (y - src_rect->Y) * src_rect->Width];
 }
 
+static FLOAT nearest_pixel_offset(PixelOffsetMode offset_mode)
+{
+    switch (offset_mode)
+    {
+    default:
+    case PixelOffsetModeNone:
+    case PixelOffsetModeHighSpeed:
+        return 0.5;
+
+    case PixelOffsetModeHalf:
+    case PixelOffsetModeHighQuality:
+        return 0.0;
+    }
+}
+
 static ARGB resample_bitmap_pixel(GDIPCONST GpRect *src_rect, LPBYTE bits, UINT width,
     UINT height, GpPointF *point, GDIPCONST GpImageAttributes *attributes,
     InterpolationMode interpolation, PixelOffsetMode offset_mode)
@@ -952,20 +1043,7 @@ static ARGB resample_bitmap_pixel(GDIPCONST GpRect *src_rect, LPBYTE bits, UINT
     }
     case InterpolationModeNearestNeighbor:
     {
-        FLOAT pixel_offset;
-        switch (offset_mode)
-        {
-        default:
-        case PixelOffsetModeNone:
-        case PixelOffsetModeHighSpeed:
-            pixel_offset = 0.5;
-            break;
-
-        case PixelOffsetModeHalf:
-        case PixelOffsetModeHighQuality:
-            pixel_offset = 0.0;
-            break;
-        }
+        FLOAT pixel_offset = nearest_pixel_offset(offset_mode);
         return sample_bitmap_pixel(src_rect, bits, width, height,
             floorf(point->X + pixel_offset), floorf(point->Y + pixel_offset), attributes);
     }
@@ -973,6 +1051,41 @@ static ARGB resample_bitmap_pixel(GDIPCONST GpRect *src_rect, LPBYTE bits, UINT
     }
 }
 
+/* Nearest neighbor sampling of an axis-aligned transform: the source column
+ * only depends on the destination x and the source row on the destination y,
+ * so work out each one once. Entries are an offset into the source area, or
+ * one of the values below. */
+#define SAMPLE_TRANSPARENT -1
+#define SAMPLE_OUTSIDE     -2
+#define SAMPLE_INVALID     -3
+
+static void get_nearest_sample_offsets(INT *offsets, INT dst_start, INT dst_count,
+    REAL origin, REAL step, REAL src_start, REAL src_size, INT area_start, INT area_size,
+    UINT bitmap_size, WrapMode wrap, BOOL flip, FLOAT pixel_offset)
+{
+    INT i, coord;
+
+    for (i=0; i<dst_count; i++)
+    {
+        REAL pos = origin + (dst_start + i) * step;
+
+        if (!(pos >= src_start && pos < src_start + src_size))
+        {
+            offsets[i] = SAMPLE_TRANSPARENT;
+            continue;
+        }
+
+        coord = floorf(pos + pixel_offset);
+
+        if (!wrap_sample_coordinate(wrap, flip, bitmap_size, &coord))
+            offsets[i] = SAMPLE_OUTSIDE;
+        else if (coord < area_start || coord >= area_start + area_size)
+            offsets[i] = SAMPLE_INVALID;
+        else
+            offsets[i] = coord - area_start;
+    }
+}
+
 static REAL intersect_line_scanline(const GpPointF *p1, const GpPointF *p2, REAL y)
 {
     return (p1->X - p2->X) * (p2->Y - y) / (p2->Y - p1->Y) + p2->X;
@@ -1070,8 +1183,8 @@ static GpStatus brush_fill_pixels(GpGraphics *graphics, GpBrush *brush,
     {
         int x, y;
         GpSolidFill *fill = (GpSolidFill*)brush;
-        for (x=0; x<fill_area->Width; x++)
-            for (y=0; y<fill_area->Height; y++)
+        for (y=0; y<fill_area->Height; y++)
+            for (x=0; x<fill_area->Width; x++)
                 argb_pixels[x + y*cdwStride] = fill->color;
         return Ok;
     }
@@ -1084,8 +1197,8 @@ static GpStatus brush_fill_pixels(GpGraphics *graphics, GpBrush *brush,
         if (get_hatch_data(fill->hatchstyle, &hatch_data) != Ok)
             return NotImplemented;
 
-        for (x=0; x<fill_area->Width; x++)
-            for (y=0; y<fill_area->Height; y++)
+        for (y=0; y<fill_area->Height; y++)
+            for (x=0; x<fill_area->Width; x++)
             {
                 int hx, hy;
 
@@ -2918,6 +3031,7 @@ GpStatus WINGDIPAPI GdipDrawImagePointsRect(GpGraphics *graphics, GpImage *image
             GpMatrix dst_to_src;
             REAL m11, m12, m21, m22, mdx, mdy;
             LPBYTE src_data, dst_data, dst_dyn_data=NULL;
+            INT *src_cols=NULL, *src_rows=NULL;
             BitmapData lockeddata;
             InterpolationMode interpolation = graphics->interpolation;
             PixelOffsetMode offset_mode = graphics->pixeloffset;
@@ -3025,25 +3139,67 @@ GpStatus WINGDIPAPI GdipDrawImagePointsRect(GpGraphics *graphics, GpImage *image
                 y_dx = dst_to_src_points[2].X - dst_to_src_points[0].X;
                 y_dy = dst_to_src_points[2].Y - dst_to_src_points[0].Y;
 
-                for (x=dst_area.left; x<dst_area.right; x++)
+                if (interpolation == InterpolationModeNearestNeighbor &&
+                    x_dy == 0.0 && y_dx == 0.0 &&
+                    (src_cols = GdipAlloc(sizeof(INT) * (dst_area.right - dst_area.left))) &&
+                    (src_rows = GdipAlloc(sizeof(INT) * (dst_area.bottom - dst_area.top))))
+                {
+                    FLOAT pixel_offset = nearest_pixel_offset(offset_mode);
+
+                    get_nearest_sample_offsets(src_cols, dst_area.left, dst_area.right - dst_area.left,
+                        dst_to_src_points[0].X, x_dx, srcx, srcwidth, src_area.X, src_area.Width,
+                        bitmap->width, imageAttributes->wrap, (imageAttributes->wrap & 1) == 1, pixel_offset);
+                    get_nearest_sample_offsets(src_rows, dst_area.top, dst_area.bottom - dst_area.top,
+                        dst_to_src_points[0].Y, y_dy, srcy, srcheight, src_area.Y, src_area.Height,
+                        bitmap->height, imageAttributes->wrap, (imageAttributes->wrap & 2) == 2, pixel_offset);
+
+                    for (y=0; y<dst_area.bottom - dst_area.top; y++)
+                    {
+                        ARGB *dst_color = (ARGB*)(dst_data + dst_stride * y);
+                        const ARGB *src_row = (const ARGB*)(src_data + src_stride * max(src_rows[y], 0));
+
+                        for (x=0; x<dst_area.right - dst_area.left; x++)
+                        {
+                            INT col = src_cols[x], row = src_rows[y];
+
+                            if (row >= 0 && col >= 0)
+                                dst_color[x] = src_row[col];
+                            else if (row == SAMPLE_TRANSPARENT || col == SAMPLE_TRANSPARENT)
+                                dst_color[x] = 0;
+                            else if (row == SAMPLE_OUTSIDE || col == SAMPLE_OUTSIDE)
+                                dst_color[x] = imageAttributes->outside_color;
+                            else
+                            {
+                                ERR("out of range pixel requested\n");
+                                dst_color[x] = 0xffcd0084;
+                            }
+                        }
+                    }
+                }
+                else
                 {
                     for (y=dst_area.top; y<dst_area.bottom; y++)
                     {
-                        GpPointF src_pointf;
-                        ARGB *dst_color;
+                        ARGB *dst_color = (ARGB*)(dst_data + dst_stride * (y - dst_area.top));
 
-                        src_pointf.X = dst_to_src_points[0].X + x * x_dx + y * y_dx;
-                        src_pointf.Y = dst_to_src_points[0].Y + x * x_dy + y * y_dy;
+                        for (x=dst_area.left; x<dst_area.right; x++, dst_color++)
+                        {
+                            GpPointF src_pointf;
 
-                        dst_color = (ARGB*)(dst_data + dst_stride * (y - dst_area.top) + sizeof(ARGB) * (x - dst_area.left));
+                            src_pointf.X = dst_to_src_points[0].X + x * x_dx + y * y_dx;
+                            src_pointf.Y = dst_to_src_points[0].Y + x * x_dy + y * y_dy;
 
-                        if (src_pointf.X >= srcx && src_pointf.X < srcx + srcwidth && src_pointf.Y >= srcy && src_pointf.Y < srcy+srcheight)
-                            *dst_color = resample_bitmap_pixel(&src_area, src_data, bitmap->width, bitmap->height, &src_pointf,
-                                                               imageAttributes, interpolation, offset_mode);
-                        else
-                            *dst_color = 0;
+                            if (src_pointf.X >= srcx && src_pointf.X < srcx + srcwidth && src_pointf.Y >= srcy && src_pointf.Y < srcy+srcheight)
+                                *dst_color = resample_bitmap_pixel(&src_area, src_data, bitmap->width, bitmap->height, &src_pointf,
+                                                                   imageAttributes, interpolation, offset_mode);
+                            else
+                                *dst_color = 0;
+                        }
                     }
                 }
+
+                GdipFree(src_cols);
+                GdipFree(src_rows);
             }
             else
             {
@@ -3983,6 +4139,17 @@ static GpStatus SOFTWARE_GdipFillRegion(GpGraphics *graphics, GpBrush *brush,
         return Ok;
     }
 
+    if (stat == Ok && brush->bt == BrushTypeSolidColor &&
+        graphics->image && graphics->image->type == ImageTypeBitmap)
+    {
+        stat = alpha_blend_bmp_solid_hrgn(graphics, &bound_rect,
+            ((GpSolidFill*)brush)->color, hregion);
+
+        DeleteObject(hregion);
+
+        return stat;
+    }
+
     if (stat == Ok)
     {
         gp_bound_rect.X = bound_rect.left;
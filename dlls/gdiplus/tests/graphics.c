@@ -5548,6 +5548,153 @@ static void test_GdipFillRectangles(void)
     ReleaseDC(hwnd, hdc);
 }
 
+static BOOL color_match(ARGB c1, ARGB c2, BYTE max_diff)
+{
+    if (abs((c1 & 0xff) - (c2 & 0xff)) > max_diff) return FALSE;
+    c1 >>= 8; c2 >>= 8;
+    if (abs((c1 & 0xff) - (c2 & 0xff)) > max_diff) return FALSE;
+    c1 >>= 8; c2 >>= 8;
+    if (abs((c1 & 0xff) - (c2 & 0xff)) > max_diff) return FALSE;
+    c1 >>= 8; c2 >>= 8;
+    if (abs((c1 & 0xff) - (c2 & 0xff)) > max_diff) return FALSE;
+    return TRUE;
+}
+
+static void reset_bitmap(GpBitmap *bitmap, ARGB color)
+{
+    INT x, y;
+
+    for (y = 0; y < 4; y++)
+        for (x = 0; x < 8; x++)
+            GdipBitmapSetPixel(bitmap, x, y, color);
+}
+
+static void check_bitmap_pixels(GpBitmap *bitmap, ARGB expected[4][8], PixelFormat format, int line)
+{
+    ARGB color;
+    INT x, y;
+
+    for (y = 0; y < 4; y++)
+        for (x = 0; x < 8; x++)
+        {
+            color = 0xdeadbeef;
+            GdipBitmapGetPixel(bitmap, x, y, &color);
+            ok_(__FILE__, line)(color_match(color, expected[y][x], 1),
+                "format %x: expected %08x at (%d,%d), got %08x\n", format, expected[y][x], x, y, color);
+        }
+}
+
+/* check that the pixels of an 8x4 bitmap are "inside" in the given rectangle and "outside" elsewhere */
+static void check_bitmap_fill(GpBitmap *bitmap, INT left, INT top, INT right, INT bottom,
+    ARGB inside, ARGB outside, PixelFormat format, int line)
+{
+    ARGB expected[4][8];
+    INT x, y;
+
+    for (y = 0; y < 4; y++)
+        for (x = 0; x < 8; x++)
+            expected[y][x] = (x >= left && x < right && y >= top && y < bottom) ? inside : outside;
+    check_bitmap_pixels(bitmap, expected, format, line);
+}
+
+static void test_fill_bitmap_spans(void)
+{
+    static const PixelFormat formats[] = {PixelFormat32bppARGB, PixelFormat32bppRGB, PixelFormat24bppRGB};
+    static ARGB src_pixels[4] = {0x00ff0000, 0x80ff0000, 0xffff0000, 0xff0000ff};
+    const ARGB background = 0xff102030;
+    /* 0x80ff0000 over the background */
+    const ARGB blended = 0xff870f17;
+    GpStatus status;
+    GpGraphics *graphics;
+    GpBitmap *bitmap, *src;
+    GpSolidFill *brush;
+    ARGB expected[4][8];
+    int i, x, y;
+
+    status = GdipCreateBitmapFromScan0(4, 1, 16, PixelFormat32bppARGB, (BYTE*)src_pixels, &src);
+    expect(Ok, status);
+
+    for (i = 0; i < sizeof(formats)/sizeof(formats[0]); i++)
+    {
+        status = GdipCreateBitmapFromScan0(8, 4, 0, formats[i], NULL, &bitmap);
+        expect(Ok, status);
+        status = GdipGetImageGraphicsContext((GpImage*)bitmap, &graphics);
+        expect(Ok, status);
+
+        /* opaque fill, clipped to the middle of the bitmap */
+        reset_bitmap(bitmap, background);
+        status = GdipSetClipRectI(graphics, 2, 1, 4, 2, CombineModeReplace);
+        expect(Ok, status);
+        status = GdipCreateSolidFill(0xff00ff00, &brush);
+        expect(Ok, status);
+        status = GdipFillRectangleI(graphics, (GpBrush*)brush, 0, 0, 8, 4);
+        expect(Ok, status);
+        GdipDeleteBrush((GpBrush*)brush);
+        check_bitmap_fill(bitmap, 2, 1, 6, 3, 0xff00ff00, background, formats[i], __LINE__);
+
+        /* transparent fill */
+        reset_bitmap(bitmap, background);
+        status = GdipCreateSolidFill(0x00ff0000, &brush);
+        expect(Ok, status);
+        status = GdipFillRectangleI(graphics, (GpBrush*)brush, 0, 0, 8, 4);
+        expect(Ok, status);
+        GdipDeleteBrush((GpBrush*)brush);
+        check_bitmap_fill(bitmap, 0, 0, 0, 0, background, background, formats[i], __LINE__);
+
+        /* translucent fill */
+        reset_bitmap(bitmap, background);
+        status = GdipCreateSolidFill(0x80ff0000, &brush);
+        expect(Ok, status);
+        status = GdipFillRectangleI(graphics, (GpBrush*)brush, 0, 0, 8, 4);
+        expect(Ok, status);
+        GdipDeleteBrush((GpBrush*)brush);
+        check_bitmap_fill(bitmap, 2, 1, 6, 3, blended, background, formats[i], __LINE__);
+
+        /* spans cut by the left and right edges of the bitmap */
+        status = GdipResetClip(graphics);
+        expect(Ok, status);
+        reset_bitmap(bitmap, background);
+        status = GdipCreateSolidFill(0xff00ff00, &brush);
+        expect(Ok, status);
+        status = GdipFillRectangleI(graphics, (GpBrush*)brush, -3, 1, 5, 2);
+        expect(Ok, status);
+        check_bitmap_fill(bitmap, 0, 1, 2, 3, 0xff00ff00, background, formats[i], __LINE__);
+        reset_bitmap(bitmap, background);
+        status = GdipFillRectangleI(graphics, (GpBrush*)brush, 6, 2, 5, 5);
+        expect(Ok, status);
+        GdipDeleteBrush((GpBrush*)brush);
+        check_bitmap_fill(bitmap, 6, 2, 8, 4, 0xff00ff00, background, formats[i], __LINE__);
+
+        /* image with transparent, translucent and opaque pixels, cut by the clip */
+        reset_bitmap(bitmap, background);
+        status = GdipSetInterpolationMode(graphics, InterpolationModeNearestNeighbor);
+        expect(Ok, status);
+        status = GdipSetClipRectI(graphics, 0, 1, 3, 1, CombineModeReplace);
+        expect(Ok, status);
+        status = GdipDrawImageI(graphics, (GpImage*)src, 0, 1);
+        expect(Ok, status);
+        status = GdipSetClipRectI(graphics, 5, 2, 2, 1, CombineModeReplace);
+        expect(Ok, status);
+        status = GdipDrawImageI(graphics, (GpImage*)src, 4, 2);
+        expect(Ok, status);
+        for (y = 0; y < 4; y++)
+            for (x = 0; x < 8; x++)
+                expected[y][x] = background;
+        /* the first draw covers x 0-3, the clip keeps 0-2 */
+        expected[1][1] = blended;
+        expected[1][2] = 0xffff0000;
+        /* the second draw covers x 4-7, the clip keeps 5-6 */
+        expected[2][5] = blended;
+        expected[2][6] = 0xffff0000;
+        check_bitmap_pixels(bitmap, expected, formats[i], __LINE__);
+
+        GdipDeleteGraphics(graphics);
+        GdipDisposeImage((GpImage*)bitmap);
+    }
+
+    GdipDisposeImage((GpImage*)src);
+}
+
 static void test_GdipGetVisibleClipBounds_memoryDC(void)
 {
     HDC hdc,dc;
@@ -5674,6 +5821,7 @@ START_TEST(graphics)
     test_alpha_hdc();
     test_bitmapfromgraphics();
     test_GdipFillRectangles();
+    test_fill_bitmap_spans();
     test_GdipGetVisibleClipBounds_memoryDC();
 
     GdiplusShutdown(gdiplusToken);
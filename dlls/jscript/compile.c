@@ -335,6 +335,24 @@ static HRESULT push_instr_uint(compiler_ctx_t *ctx, jsop_t op, unsigned arg)
     return S_OK;
 }
 
+static HRESULT push_instr_uint_uint(compiler_ctx_t *ctx, jsop_t op, unsigned arg1, unsigned arg2)
+{
+    unsigned instr;
+
+    instr = push_instr(ctx, op);
+    if(!instr)
+        return E_OUTOFMEMORY;
+
+    instr_ptr(ctx, instr)->u.arg[0].uint = arg1;
+    instr_ptr(ctx, instr)->u.arg[1].uint = arg2;
+    return S_OK;
+}
+
+static inline unsigned alloc_prop_cache(compiler_ctx_t *ctx)
+{
+    return ctx->code->prop_cache_cnt++;
+}
+
 static HRESULT compile_binary_expression(compiler_ctx_t *ctx, binary_expression_t *expr, jsop_t op)
 {
     HRESULT hres;
@@ -370,7 +388,7 @@ static HRESULT compile_member_expression(compiler_ctx_t *ctx, member_expression_
     if(FAILED(hres))
         return hres;
 
-    return push_instr_bstr(ctx, OP_member, expr->identifier);
+    return push_instr_bstr_uint(ctx, OP_member, expr->identifier, alloc_prop_cache(ctx));
 }
 
 #define LABEL_FLAG 0x80000000
@@ -429,7 +447,7 @@ static HRESULT compile_memberid_expression(compiler_ctx_t *ctx, expression_t *ex
         if(FAILED(hres))
             return hres;
 
-        hres = push_instr_uint(ctx, OP_memberid, flags);
+        hres = push_instr_uint_uint(ctx, OP_memberid, flags, alloc_prop_cache(ctx));
         break;
     }
     case EXPR_MEMBER: {
@@ -444,7 +462,7 @@ static HRESULT compile_memberid_expression(compiler_ctx_t *ctx, expression_t *ex
         if(FAILED(hres))
             return hres;
 
-        hres = push_instr_uint(ctx, OP_memberid, flags);
+        hres = push_instr_uint_uint(ctx, OP_memberid, flags, alloc_prop_cache(ctx));
         break;
     }
     DEFAULT_UNREACHABLE;
@@ -864,7 +882,7 @@ static HRESULT compile_function_expression(compiler_ctx_t *ctx, function_express
     /* FIXME: not exactly right */
     if(expr->identifier) {
         ctx->func->func_cnt++;
-        return push_instr_bstr(ctx, OP_ident, expr->identifier);
+        return push_instr_bstr_uint(ctx, OP_ident, expr->identifier, alloc_prop_cache(ctx));
     }
 
     return push_instr_uint(ctx, OP_func, ctx->func->func_cnt++);
@@ -961,7 +979,8 @@ static HRESULT compile_expression(compiler_ctx_t *ctx, expression_t *expr, BOOL
         hres = compile_binary_expression(ctx, (binary_expression_t*)expr, OP_gteq);
         break;
     case EXPR_IDENT:
-        hres = push_instr_bstr(ctx, OP_ident, ((identifier_expression_t*)expr)->identifier);
+        hres = push_instr_bstr_uint(ctx, OP_ident, ((identifier_expression_t*)expr)->identifier,
+                alloc_prop_cache(ctx));
         break;
     case EXPR_IN:
         hres = compile_binary_expression(ctx, (binary_expression_t*)expr, OP_in);
@@ -1805,6 +1824,7 @@ void release_bytecode(bytecode_t *code)
     heap_pool_free(&code->heap);
     heap_free(code->bstr_pool);
     heap_free(code->str_pool);
+    heap_free(code->prop_caches);
     heap_free(code->instrs);
     heap_free(code);
 }
@@ -1835,6 +1855,117 @@ static HRESULT init_code(compiler_ctx_t *compiler, const WCHAR *source)
     return S_OK;
 }
 
+static int find_local(BSTR *locals, unsigned cnt, const WCHAR *name)
+{
+    unsigned i;
+
+    for(i = 0; i < cnt; i++) {
+        if(!strcmpW(locals[i], name))
+            return i;
+    }
+
+    return -1;
+}
+
+/*
+ * Functions that don't contain nested functions, with statements or references to eval
+ * or arguments can't have their variables accessed by name from their own code, so we
+ * resolve them to stack slots and skip creating the variable object on each call. Indirect
+ * eval calls and Function.arguments still create it, see setup_locals_scope.
+ */
+static HRESULT resolve_locals(compiler_ctx_t *ctx, function_code_t *func, unsigned off)
+{
+    instr_t *instr, *end = ctx->code->instrs + ctx->code_off;
+    unsigned i, cnt = 0;
+    BSTR *locals;
+    int idx;
+
+    static const WCHAR argumentsW[] = {'a','r','g','u','m','e','n','t','s',0};
+    static const WCHAR evalW[] = {'e','v','a','l',0};
+
+    if(func->func_cnt)
+        return S_OK;
+
+    locals = heap_alloc((func->param_cnt + func->var_cnt) * sizeof(*locals));
+    if(!locals)
+        return E_OUTOFMEMORY;
+
+    for(i = 0; i < func->param_cnt; i++) {
+        if(find_local(locals, cnt, func->params[i]) != -1)
+            goto done;
+        locals[cnt++] = func->params[i];
+    }
+    for(i = 0; i < func->var_cnt; i++) {
+        if(find_local(locals, cnt, func->variables[i]) == -1)
+            locals[cnt++] = func->variables[i];
+    }
+
+    for(instr = ctx->code->instrs + off; instr < end; instr++) {
+        switch(instr->op) {
+        case OP_push_scope:
+            goto done;
+        case OP_push_except:
+            if(instr->u.arg[1].bstr && find_local(locals, cnt, instr->u.arg[1].bstr) != -1)
+                goto done;
+            break;
+        case OP_delete_ident:
+            if(find_local(locals, cnt, instr->u.arg->bstr) != -1)
+                goto done;
+            /* fall through */
+        case OP_ident:
+        case OP_identid:
+        case OP_typeofident:
+        case OP_var_set:
+            if(!strcmpW(instr->u.arg->bstr, argumentsW) || !strcmpW(instr->u.arg->bstr, evalW))
+                goto done;
+            break;
+        default:
+            break;
+        }
+    }
+
+    for(instr = ctx->code->instrs + off; instr < end; instr++) {
+        switch(instr->op) {
+        case OP_ident:
+        case OP_identid:
+        case OP_typeofident:
+        case OP_var_set:
+            idx = find_local(locals, cnt, instr->u.arg->bstr);
+            if(idx == -1)
+                break;
+
+            switch(instr->op) {
+            case OP_ident:       instr->op = OP_local; break;
+            case OP_identid:     instr->op = OP_local_ref; break;
+            case OP_typeofident: instr->op = OP_local_typeof; break;
+            default:             instr->op = OP_local_set; break;
+            }
+            instr->u.arg[0].uint = idx;
+            instr->u.arg[1].uint = 0;
+            break;
+        default:
+            break;
+        }
+    }
+
+    if(cnt) {
+        func->locals = compiler_alloc(ctx->code, cnt * sizeof(*func->locals));
+        if(!func->locals) {
+            heap_free(locals);
+            return E_OUTOFMEMORY;
+        }
+        memcpy(func->locals, locals, cnt * sizeof(*func->locals));
+    }
+
+    TRACE("using %u stack slots\n", cnt);
+    func->use_locals = TRUE;
+    func->local_cnt = cnt;
+
+done:
+    heap_free(locals);
+    return S_OK;
+}
+
 static HRESULT compile_function(compiler_ctx_t *ctx, source_elements_t *source, function_expression_t *func_expr,
         BOOL from_eval, function_code_t *func)
 {
@@ -1860,9 +1991,6 @@ static HRESULT compile_function(compiler_ctx_t *ctx, source_elements_t *source,
     if(!push_instr(ctx, OP_ret))
         return E_OUTOFMEMORY;
 
-    if(TRACE_ON(jscript_disas))
-        dump_code(ctx, off);
-
     func->instr_off = off;
 
     if(func_expr && func_expr->identifier) {
@@ -1903,6 +2031,15 @@ static HRESULT compile_function(compiler_ctx_t *ctx, source_elements_t *source,
 
     assert(i == func->var_cnt);
 
+    if(func_expr) {
+        hres = resolve_locals(ctx, func, off);
+        if(FAILED(hres))
+            return hres;
+    }
+
+    if(TRACE_ON(jscript_disas))
+        dump_code(ctx, off);
+
     func->funcs = compiler_alloc(ctx->code, func->func_cnt * sizeof(*func->funcs));
     if(!func->funcs)
         return E_OUTOFMEMORY;
@@ -2026,6 +2163,14 @@ HRESULT compile_script(script_ctx_t *ctx, const WCHAR *code, const WCHAR *args,
         return hres;
     }
 
+    if(compiler.code->prop_cache_cnt) {
+        compiler.code->prop_caches = heap_alloc_zero(compiler.code->prop_cache_cnt * sizeof(prop_cache_t));
+        if(!compiler.code->prop_caches) {
+            release_bytecode(compiler.code);
+            return E_OUTOFMEMORY;
+        }
+    }
+
     *ret = compiler.code;
     return S_OK;
 }
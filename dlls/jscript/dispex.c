@@ -1035,6 +1035,34 @@ jsdisp_t *iface_to_jsdisp(IUnknown *iface)
     return ret;
 }
 
+/*
+ * Property slots are never reused, so a property keeps its DISPID for the lifetime of
+ * the object. The cache remembers the DISPID found by the previous lookup, which is also
+ * valid for other objects with the same property layout (like objects created by the same
+ * constructor). Checking the name of the cached slot is enough to validate it, so no
+ * invalidation is needed when properties are added or deleted.
+ */
+HRESULT jsdisp_get_id_cached(jsdisp_t *jsdisp, const WCHAR *name, DWORD flags, prop_cache_t *cache, DISPID *id)
+{
+    dispex_prop_t *prop;
+    HRESULT hres;
+
+    if(cache->id > 0 && cache->id < jsdisp->prop_cnt) {
+        prop = jsdisp->props + cache->id;
+        if(prop->hash == cache->hash && prop->type != PROP_DELETED && !strcmpW(prop->name, name)) {
+            *id = cache->id;
+            return S_OK;
+        }
+    }
+
+    hres = jsdisp_get_id(jsdisp, name, flags, id);
+    if(SUCCEEDED(hres)) {
+        cache->id = *id;
+        cache->hash = jsdisp->props[*id].hash;
+    }
+    return hres;
+}
+
 HRESULT jsdisp_get_id(jsdisp_t *jsdisp, const WCHAR *name, DWORD flags, DISPID *id)
 {
     dispex_prop_t *prop;
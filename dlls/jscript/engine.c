@@ -194,6 +194,57 @@ static inline IDispatch *stack_topn_objid(exec_ctx_t *ctx, unsigned n, DISPID *i
     return get_object(stack_topn(ctx, n+1));
 }
 
+/*
+ * Functions using stack slots for their locals keep them at the bottom of the stack.
+ * References to them are pushed as a NULL object with the slot index as id (invalid
+ * references use NULL object with a negative error code).
+ *
+ * If the variable object of such call is needed later (by eval or Function.arguments),
+ * it's created from the slots and holds the locals from that point on.
+ */
+static inline BOOL is_local_ref(IDispatch *disp, DISPID id)
+{
+    return !disp && id >= 0;
+}
+
+static HRESULT local_get(exec_ctx_t *ctx, unsigned idx, jsval_t *r)
+{
+    if(ctx->var_disp)
+        return jsdisp_propget_name(ctx->var_disp, ctx->func_code->locals[idx], r);
+    return jsval_copy(ctx->stack[idx], r);
+}
+
+static HRESULT local_put(exec_ctx_t *ctx, unsigned idx, jsval_t val)
+{
+    jsval_t v;
+    HRESULT hres;
+
+    if(ctx->var_disp)
+        return jsdisp_propput_name(ctx->var_disp, ctx->func_code->locals[idx], val);
+
+    hres = jsval_copy(val, &v);
+    if(FAILED(hres))
+        return hres;
+
+    jsval_release(ctx->stack[idx]);
+    ctx->stack[idx] = v;
+    return S_OK;
+}
+
+static HRESULT ref_propget(exec_ctx_t *ctx, IDispatch *disp, DISPID id, jsval_t *r)
+{
+    if(is_local_ref(disp, id))
+        return local_get(ctx, id, r);
+    return disp_propget(ctx->script, disp, id, r);
+}
+
+static HRESULT ref_propput(exec_ctx_t *ctx, IDispatch *disp, DISPID id, jsval_t val)
+{
+    if(is_local_ref(disp, id))
+        return local_put(ctx, id, val);
+    return disp_propput(ctx->script, disp, id, val);
+}
+
 static void exprval_release(exprval_t *val)
 {
     switch(val->type) {
@@ -252,7 +303,8 @@ HRESULT scope_push(scope_chain_t *scope, jsdisp_t *jsobj, IDispatch *obj, scope_
 
     new_scope->ref = 1;
 
-    IDispatch_AddRef(obj);
+    if(obj)
+        IDispatch_AddRef(obj);
     new_scope->jsobj = jsobj;
     new_scope->obj = obj;
 
@@ -291,7 +343,8 @@ void scope_release(scope_chain_t *scope)
     if(scope->next)
         scope_release(scope->next);
 
-    IDispatch_Release(scope->obj);
+    if(scope->obj)
+        IDispatch_Release(scope->obj);
     heap_free(scope);
 }
 
@@ -328,8 +381,8 @@ HRESULT create_exec_ctx(script_ctx_t *script_ctx, IDispatch *this_obj, jsdisp_t
         ctx->this_obj = to_disp(script_ctx->global);
     IDispatch_AddRef(ctx->this_obj);
 
-    jsdisp_addref(var_disp);
-    ctx->var_disp = var_disp;
+    if(var_disp)
+        ctx->var_disp = jsdisp_addref(var_disp);
 
     script_addref(script_ctx);
     ctx->script = script_ctx;
@@ -361,7 +414,8 @@ void exec_release(exec_ctx_t *ctx)
     heap_free(ctx);
 }
 
-static HRESULT disp_get_id(script_ctx_t *ctx, IDispatch *disp, const WCHAR *name, BSTR name_bstr, DWORD flags, DISPID *id)
+static HRESULT disp_get_id(script_ctx_t *ctx, IDispatch *disp, const WCHAR *name, BSTR name_bstr, DWORD flags,
+        prop_cache_t *cache, DISPID *id)
 {
     IDispatchEx *dispex;
     jsdisp_t *jsdisp;
@@ -370,7 +424,10 @@ static HRESULT disp_get_id(script_ctx_t *ctx, IDispatch *disp, const WCHAR *name
 
     jsdisp = iface_to_jsdisp((IUnknown*)disp);
     if(jsdisp) {
-        hres = jsdisp_get_id(jsdisp, name, flags, id);
+        if(cache)
+            hres = jsdisp_get_id_cached(jsdisp, name, flags, cache, id);
+        else
+            hres = jsdisp_get_id(jsdisp, name, flags, id);
         jsdisp_release(jsdisp);
         return hres;
     }
@@ -489,7 +546,7 @@ static BOOL lookup_global_members(script_ctx_t *ctx, BSTR identifier, exprval_t
 
     for(item = ctx->named_items; item; item = item->next) {
         if(item->flags & SCRIPTITEM_GLOBALMEMBERS) {
-            hres = disp_get_id(ctx, item->disp, identifier, identifier, 0, &id);
+            hres = disp_get_id(ctx, item->disp, identifier, identifier, 0, NULL, &id);
             if(SUCCEEDED(hres)) {
                 if(ret)
                     exprval_set_idref(ret, item->disp, id);
@@ -502,7 +559,7 @@ static BOOL lookup_global_members(script_ctx_t *ctx, BSTR identifier, exprval_t
 }
 
 /* ECMA-262 3rd Edition    10.1.4 */
-static HRESULT identifier_eval(script_ctx_t *ctx, BSTR identifier, exprval_t *ret)
+static HRESULT identifier_eval(script_ctx_t *ctx, BSTR identifier, prop_cache_t *cache, exprval_t *ret)
 {
     scope_chain_t *scope;
     named_item_t *item;
@@ -512,17 +569,26 @@ static HRESULT identifier_eval(script_ctx_t *ctx, BSTR identifier, exprval_t *re
     TRACE("%s\n", debugstr_w(identifier));
 
     for(scope = ctx->exec_ctx->scope_chain; scope; scope = scope->next) {
-        if(scope->jsobj)
+        /* variable object of a function using stack slots, not created yet */
+        if(!scope->obj)
+            continue;
+
+        if(scope->jsobj && cache)
+            hres = jsdisp_get_id_cached(scope->jsobj, identifier, fdexNameImplicit, cache, &id);
+        else if(scope->jsobj)
             hres = jsdisp_get_id(scope->jsobj, identifier, fdexNameImplicit, &id);
         else
-            hres = disp_get_id(ctx, scope->obj, identifier, identifier, fdexNameImplicit, &id);
+            hres = disp_get_id(ctx, scope->obj, identifier, identifier, fdexNameImplicit, NULL, &id);
         if(SUCCEEDED(hres)) {
             exprval_set_idref(ret, scope->obj, id);
             return S_OK;
         }
     }
 
-    hres = jsdisp_get_id(ctx->global, identifier, 0, &id);
+    if(cache)
+        hres = jsdisp_get_id_cached(ctx->global, identifier, 0, cache, &id);
+    else
+        hres = jsdisp_get_id(ctx->global, identifier, 0, &id);
     if(SUCCEEDED(hres)) {
         exprval_set_idref(ret, to_disp(ctx->global), id);
         return S_OK;
@@ -585,6 +651,10 @@ static inline double get_op_double(exec_ctx_t *ctx){
     return ctx->code->instrs[ctx->ip].u.dbl;
 }
 
+static inline prop_cache_t *get_op_prop_cache(exec_ctx_t *ctx, int i){
+    return ctx->code->prop_caches + ctx->code->instrs[ctx->ip].u.arg[i].uint;
+}
+
 /* ECMA-262 3rd Edition    12.2 */
 static HRESULT interp_var_set(exec_ctx_t *ctx)
 {
@@ -616,7 +686,7 @@ static HRESULT interp_forin(exec_ctx_t *ctx)
     id = get_number(stack_top(ctx));
 
     var_obj = stack_topn_objid(ctx, 1, &var_id);
-    if(!var_obj) {
+    if(!var_obj && !is_local_ref(var_obj, var_id)) {
         FIXME("invalid ref\n");
         return E_FAIL;
     }
@@ -649,7 +719,7 @@ static HRESULT interp_forin(exec_ctx_t *ctx)
         stack_pop(ctx);
         stack_push(ctx, jsval_number(id)); /* safe, just after pop() */
 
-        hres = disp_propput(ctx->script, var_obj, var_id, jsval_string(str));
+        hres = ref_propput(ctx, var_obj, var_id, jsval_string(str));
         jsstr_release(str);
         if(FAILED(hres))
             return hres;
@@ -863,7 +933,7 @@ static HRESULT interp_array(exec_ctx_t *ctx)
         return hres;
     }
 
-    hres = disp_get_id(ctx->script, obj, name, NULL, 0, &id);
+    hres = disp_get_id(ctx->script, obj, name, NULL, 0, NULL, &id);
     jsstr_release(name_str);
     if(SUCCEEDED(hres)) {
         hres = disp_propget(ctx->script, obj, id, &v);
@@ -893,7 +963,7 @@ static HRESULT interp_member(exec_ctx_t *ctx)
     if(FAILED(hres))
         return hres;
 
-    hres = disp_get_id(ctx->script, obj, arg, arg, 0, &id);
+    hres = disp_get_id(ctx->script, obj, arg, arg, 0, get_op_prop_cache(ctx, 1), &id);
     if(SUCCEEDED(hres)) {
         hres = disp_propget(ctx->script, obj, id, &v);
     }else if(hres == DISP_E_UNKNOWNNAME) {
@@ -934,7 +1004,7 @@ static HRESULT interp_memberid(exec_ctx_t *ctx)
     if(FAILED(hres))
         return hres;
 
-    hres = disp_get_id(ctx->script, obj, name, NULL, arg, &id);
+    hres = disp_get_id(ctx->script, obj, name, NULL, arg, get_op_prop_cache(ctx, 1), &id);
     jsstr_release(name_str);
     if(FAILED(hres)) {
         IDispatch_Release(obj);
@@ -961,10 +1031,10 @@ static HRESULT interp_refval(exec_ctx_t *ctx)
     TRACE("\n");
 
     disp = stack_topn_objid(ctx, 0, &id);
-    if(!disp)
+    if(!disp && !is_local_ref(disp, id))
         return throw_reference_error(ctx->script, JS_E_ILLEGAL_ASSIGN, NULL);
 
-    hres = disp_propget(ctx->script, disp, id, &v);
+    hres = ref_propget(ctx, disp, id, &v);
     if(FAILED(hres))
         return hres;
 
@@ -1035,10 +1105,26 @@ static HRESULT interp_call_member(exec_ctx_t *ctx)
     TRACE("%d %d\n", argn, do_ret);
 
     obj = stack_topn_objid(ctx, argn, &id);
-    if(!obj)
-        return throw_type_error(ctx->script, id, NULL);
+    if(is_local_ref(obj, id)) {
+        jsval_t func;
+
+        hres = local_get(ctx, id, &func);
+        if(FAILED(hres))
+            return hres;
 
-    hres = disp_call(ctx->script, obj, id, DISPATCH_METHOD, argn, stack_args(ctx, argn), do_ret ? &r : NULL);
+        if(!is_object_instance(func) || !get_object(func)) {
+            jsval_release(func);
+            return throw_type_error(ctx->script, JS_E_INVALID_PROPERTY, NULL);
+        }
+
+        hres = disp_call_value(ctx->script, get_object(func), NULL, DISPATCH_METHOD, argn, stack_args(ctx, argn),
+                do_ret ? &r : NULL);
+        jsval_release(func);
+    }else if(!obj) {
+        return throw_type_error(ctx->script, id, NULL);
+    }else {
+        hres = disp_call(ctx->script, obj, id, DISPATCH_METHOD, argn, stack_args(ctx, argn), do_ret ? &r : NULL);
+    }
     if(FAILED(hres))
         return hres;
 
@@ -1066,7 +1152,7 @@ static HRESULT interp_ident(exec_ctx_t *ctx)
 
     TRACE("%s\n", debugstr_w(arg));
 
-    hres = identifier_eval(ctx->script, arg, &exprval);
+    hres = identifier_eval(ctx->script, arg, get_op_prop_cache(ctx, 1), &exprval);
     if(FAILED(hres))
         return hres;
 
@@ -1091,7 +1177,7 @@ static HRESULT interp_identid(exec_ctx_t *ctx)
 
     TRACE("%s %x\n", debugstr_w(arg), flags);
 
-    hres = identifier_eval(ctx->script, arg, &exprval);
+    hres = identifier_eval(ctx->script, arg, NULL, &exprval);
     if(FAILED(hres))
         return hres;
 
@@ -1114,6 +1200,59 @@ static HRESULT interp_identid(exec_ctx_t *ctx)
     return stack_push_objid(ctx, exprval.u.idref.disp, exprval.u.idref.id);
 }
 
+static HRESULT interp_local(exec_ctx_t *ctx)
+{
+    const unsigned arg = get_op_uint(ctx, 0);
+    jsval_t v;
+    HRESULT hres;
+
+    TRACE("%u\n", arg);
+
+    hres = local_get(ctx, arg, &v);
+    if(FAILED(hres))
+        return hres;
+
+    return stack_push(ctx, v);
+}
+
+static HRESULT interp_local_ref(exec_ctx_t *ctx)
+{
+    const unsigned arg = get_op_uint(ctx, 0);
+    DISPID id;
+    HRESULT hres;
+
+    TRACE("%u\n", arg);
+
+    if(!ctx->var_disp)
+        return stack_push_objid(ctx, NULL, arg);
+
+    hres = jsdisp_get_id(ctx->var_disp, ctx->func_code->locals[arg], fdexNameEnsure, &id);
+    if(FAILED(hres))
+        return hres;
+
+    return stack_push_objid(ctx, to_disp(jsdisp_addref(ctx->var_disp)), id);
+}
+
+static HRESULT interp_local_set(exec_ctx_t *ctx)
+{
+    const unsigned arg = get_op_uint(ctx, 0);
+    jsval_t val;
+    HRESULT hres;
+
+    TRACE("%u\n", arg);
+
+    if(!ctx->var_disp) {
+        jsval_release(ctx->stack[arg]);
+        ctx->stack[arg] = stack_pop(ctx);
+        return S_OK;
+    }
+
+    val = stack_pop(ctx);
+    hres = jsdisp_propput_name(ctx->var_disp, ctx->func_code->locals[arg], val);
+    jsval_release(val);
+    return hres;
+}
+
 /* ECMA-262 3rd Edition    7.8.1 */
 static HRESULT interp_null(exec_ctx_t *ctx)
 {
@@ -1428,7 +1567,7 @@ static HRESULT interp_in(exec_ctx_t *ctx)
         return hres;
     }
 
-    hres = disp_get_id(ctx->script, get_object(obj), str, NULL, 0, &id);
+    hres = disp_get_id(ctx->script, get_object(obj), str, NULL, 0, NULL, &id);
     IDispatch_Release(get_object(obj));
     jsstr_release(jsstr);
     if(SUCCEEDED(hres))
@@ -1636,7 +1775,7 @@ static HRESULT interp_delete_ident(exec_ctx_t *ctx)
 
     TRACE("%s\n", debugstr_w(arg));
 
-    hres = identifier_eval(ctx->script, arg, &exprval);
+    hres = identifier_eval(ctx->script, arg, NULL, &exprval);
     if(FAILED(hres))
         return hres;
 
@@ -1719,11 +1858,12 @@ static HRESULT interp_typeofid(exec_ctx_t *ctx)
     TRACE("\n");
 
     obj = stack_pop_objid(ctx, &id);
-    if(!obj)
+    if(!obj && !is_local_ref(obj, id))
         return stack_push(ctx, jsval_string(jsstr_undefined()));
 
-    hres = disp_propget(ctx->script, obj, id, &v);
-    IDispatch_Release(obj);
+    hres = ref_propget(ctx, obj, id, &v);
+    if(obj)
+        IDispatch_Release(obj);
     if(FAILED(hres))
         return stack_push_string(ctx, unknownW);
 
@@ -1746,7 +1886,7 @@ static HRESULT interp_typeofident(exec_ctx_t *ctx)
 
     TRACE("%s\n", debugstr_w(arg));
 
-    hres = identifier_eval(ctx->script, arg, &exprval);
+    hres = identifier_eval(ctx->script, arg, NULL, &exprval);
     if(FAILED(hres))
         return hres;
 
@@ -1769,6 +1909,27 @@ static HRESULT interp_typeofident(exec_ctx_t *ctx)
     return stack_push_string(ctx, ret);
 }
 
+static HRESULT interp_local_typeof(exec_ctx_t *ctx)
+{
+    const unsigned arg = get_op_uint(ctx, 0);
+    const WCHAR *ret;
+    jsval_t v;
+    HRESULT hres;
+
+    TRACE("%u\n", arg);
+
+    hres = local_get(ctx, arg, &v);
+    if(FAILED(hres))
+        return hres;
+
+    hres = typeof_string(v, &ret);
+    jsval_release(v);
+    if(FAILED(hres))
+        return hres;
+
+    return stack_push_string(ctx, ret);
+}
+
 /* ECMA-262 3rd Edition    11.4.3 */
 static HRESULT interp_typeof(exec_ctx_t *ctx)
 {
@@ -1832,20 +1993,21 @@ static HRESULT interp_postinc(exec_ctx_t *ctx)
     TRACE("%d\n", arg);
 
     obj = stack_pop_objid(ctx, &id);
-    if(!obj)
+    if(!obj && !is_local_ref(obj, id))
         return throw_type_error(ctx->script, JS_E_OBJECT_EXPECTED, NULL);
 
-    hres = disp_propget(ctx->script, obj, id, &v);
+    hres = ref_propget(ctx, obj, id, &v);
     if(SUCCEEDED(hres)) {
         double n;
 
         hres = to_number(ctx->script, v, &n);
         if(SUCCEEDED(hres))
-            hres = disp_propput(ctx->script, obj, id, jsval_number(n+(double)arg));
+            hres = ref_propput(ctx, obj, id, jsval_number(n+(double)arg));
         if(FAILED(hres))
             jsval_release(v);
     }
-    IDispatch_Release(obj);
+    if(obj)
+        IDispatch_Release(obj);
     if(FAILED(hres))
         return hres;
 
@@ -1857,7 +2019,7 @@ static HRESULT interp_preinc(exec_ctx_t *ctx)
 {
     const int arg = get_op_int(ctx, 0);
     IDispatch *obj;
-    double ret;
+    double ret = 0;
     DISPID id;
     jsval_t v;
     HRESULT hres;
@@ -1865,10 +2027,10 @@ static HRESULT interp_preinc(exec_ctx_t *ctx)
     TRACE("%d\n", arg);
 
     obj = stack_pop_objid(ctx, &id);
-    if(!obj)
+    if(!obj && !is_local_ref(obj, id))
         return throw_type_error(ctx->script, JS_E_OBJECT_EXPECTED, NULL);
 
-    hres = disp_propget(ctx->script, obj, id, &v);
+    hres = ref_propget(ctx, obj, id, &v);
     if(SUCCEEDED(hres)) {
         double n;
 
@@ -1876,10 +2038,11 @@ static HRESULT interp_preinc(exec_ctx_t *ctx)
         jsval_release(v);
         if(SUCCEEDED(hres)) {
             ret = n+(double)arg;
-            hres = disp_propput(ctx->script, obj, id, jsval_number(ret));
+            hres = ref_propput(ctx, obj, id, jsval_number(ret));
         }
     }
-    IDispatch_Release(obj);
+    if(obj)
+        IDispatch_Release(obj);
     if(FAILED(hres))
         return hres;
 
@@ -2272,13 +2435,14 @@ static HRESULT interp_assign(exec_ctx_t *ctx)
     v = stack_pop(ctx);
 
     disp = stack_pop_objid(ctx, &id);
-    if(!disp) {
+    if(!disp && !is_local_ref(disp, id)) {
         jsval_release(v);
         return throw_reference_error(ctx->script, JS_E_ILLEGAL_ASSIGN, NULL);
     }
 
-    hres = disp_propput(ctx->script, disp, id, v);
-    IDispatch_Release(disp);
+    hres = ref_propput(ctx, disp, id, v);
+    if(disp)
+        IDispatch_Release(disp);
     if(FAILED(hres)) {
         jsval_release(v);
         return hres;
@@ -2504,13 +2668,36 @@ static HRESULT enter_bytecode(script_ctx_t *ctx, bytecode_t *code, function_code
     return S_OK;
 }
 
-HRESULT exec_source(exec_ctx_t *ctx, bytecode_t *code, function_code_t *func, BOOL from_eval, jsval_t *ret)
+HRESULT exec_source(exec_ctx_t *ctx, bytecode_t *code, function_code_t *func, BOOL from_eval,
+        unsigned argc, jsval_t *argv, jsval_t *ret)
 {
     exec_ctx_t *prev_ctx;
     jsval_t val;
     unsigned i;
     HRESULT hres = S_OK;
 
+    if(func->use_locals) {
+        assert(!ctx->top && !ctx->var_disp);
+
+        for(i = 0; i < func->local_cnt; i++) {
+            if(i < func->param_cnt && i < argc) {
+                hres = jsval_copy(argv[i], &val);
+                if(FAILED(hres))
+                    break;
+            }else {
+                val = jsval_undefined();
+            }
+
+            hres = stack_push(ctx, val);
+            if(FAILED(hres))
+                break;
+        }
+        if(FAILED(hres)) {
+            stack_popn(ctx, ctx->top);
+            return hres;
+        }
+    }
+
     for(i = 0; i < func->func_cnt; i++) {
         jsdisp_t *func_obj;
 
@@ -2527,7 +2714,7 @@ HRESULT exec_source(exec_ctx_t *ctx, bytecode_t *code, function_code_t *func, BO
             return hres;
     }
 
-    for(i=0; i < func->var_cnt; i++) {
+    for(i=0; i < func->var_cnt && !func->use_locals; i++) {
         if(!ctx->is_global || !lookup_global_members(ctx->script, func->variables[i], NULL)) {
             DISPID id = 0;
 
@@ -2543,6 +2730,8 @@ HRESULT exec_source(exec_ctx_t *ctx, bytecode_t *code, function_code_t *func, BO
     hres = enter_bytecode(ctx->script, code, func, &val);
     assert(ctx->script->exec_ctx == ctx);
     ctx->script->exec_ctx = prev_ctx;
+    if(func->use_locals)
+        stack_popn(ctx, func->local_cnt);
     if(FAILED(hres))
         return hres;
 
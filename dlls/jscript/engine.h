@@ -41,18 +41,22 @@
     X(func,       1, ARG_UINT,   0)        \
     X(gt,         1, 0,0)                  \
     X(gteq,       1, 0,0)                  \
-    X(ident,      1, ARG_BSTR,   0)        \
+    X(ident,      1, ARG_BSTR,   ARG_UINT) \
     X(identid,    1, ARG_BSTR,   ARG_INT)  \
     X(in,         1, 0,0)                  \
     X(instanceof, 1, 0,0)                  \
     X(int,        1, ARG_INT,    0)        \
     X(jmp,        0, ARG_ADDR,   0)        \
     X(jmp_z,      0, ARG_ADDR,   0)        \
+    X(local,      1, ARG_UINT,   0)        \
+    X(local_ref,  1, ARG_UINT,   0)        \
+    X(local_set,  1, ARG_UINT,   0)        \
+    X(local_typeof,1,ARG_UINT,   0)        \
     X(lshift,     1, 0,0)                  \
     X(lt,         1, 0,0)                  \
     X(lteq,       1, 0,0)                  \
-    X(member,     1, ARG_BSTR,   0)        \
-    X(memberid,   1, ARG_UINT,   0)        \
+    X(member,     1, ARG_BSTR,   ARG_UINT) \
+    X(memberid,   1, ARG_UINT,   ARG_UINT) \
     X(minus,      1, 0,0)                  \
     X(mod,        1, 0,0)                  \
     X(mul,        1, 0,0)                  \
@@ -140,6 +144,11 @@ typedef struct _function_code_t {
 
     unsigned param_cnt;
     BSTR *params;
+
+    /* parameters and variables are kept in stack slots, no variable object is needed */
+    BOOL use_locals;
+    unsigned local_cnt;
+    BSTR *locals;
 } function_code_t;
 
 typedef struct _bytecode_t {
@@ -160,6 +169,9 @@ typedef struct _bytecode_t {
     unsigned str_pool_size;
     unsigned str_cnt;
 
+    prop_cache_t *prop_caches;
+    unsigned prop_cache_cnt;
+
     struct _bytecode_t *next;
 } bytecode_t;
 
@@ -201,6 +213,9 @@ struct _exec_ctx_t {
     function_code_t *func_code;
     BOOL is_global;
 
+    /* function using stack slots for its locals, its variable object is created on demand */
+    jsdisp_t *function;
+
     jsval_t *stack;
     unsigned stack_size;
     unsigned top;
@@ -217,5 +232,6 @@ static inline void exec_addref(exec_ctx_t *ctx)
 
 void exec_release(exec_ctx_t*) DECLSPEC_HIDDEN;
 HRESULT create_exec_ctx(script_ctx_t*,IDispatch*,jsdisp_t*,scope_chain_t*,BOOL,exec_ctx_t**) DECLSPEC_HIDDEN;
-HRESULT exec_source(exec_ctx_t*,bytecode_t*,function_code_t*,BOOL,jsval_t*) DECLSPEC_HIDDEN;
+HRESULT exec_source(exec_ctx_t*,bytecode_t*,function_code_t*,BOOL,unsigned,jsval_t*,jsval_t*) DECLSPEC_HIDDEN;
 HRESULT create_source_function(script_ctx_t*,bytecode_t*,function_code_t*,scope_chain_t*,jsdisp_t**) DECLSPEC_HIDDEN;
+HRESULT setup_locals_scope(exec_ctx_t*) DECLSPEC_HIDDEN;
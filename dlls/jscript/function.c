@@ -35,6 +35,11 @@ typedef struct {
     function_code_t *func_code;
     DWORD length;
     jsdisp_t *arguments;
+
+    /* active call of a function using stack slots for its locals */
+    exec_ctx_t *exec_ctx;
+    unsigned argc;
+    jsval_t *argv;
 } FunctionInstance;
 
 typedef struct {
@@ -202,6 +207,106 @@ static HRESULT create_var_disp(script_ctx_t *ctx, FunctionInstance *function, un
     return S_OK;
 }
 
+/*
+ * Creates the variable object and the arguments object of an active call of a function using
+ * stack slots for its locals, for an indirect eval call or Function.arguments. The locals are
+ * moved to the variable object, so that they are shared with the evaluated code and aliased
+ * by the arguments object like for other functions.
+ */
+HRESULT setup_locals_scope(exec_ctx_t *ctx)
+{
+    FunctionInstance *function;
+    jsdisp_t *var_disp, *arg_disp;
+    scope_chain_t *scope;
+    unsigned i;
+    HRESULT hres;
+
+    if(ctx->var_disp || !ctx->function)
+        return S_OK;
+
+    function = function_from_jsdisp(ctx->function);
+    assert(function->exec_ctx == ctx);
+
+    hres = create_dispex(ctx->script, NULL, NULL, &var_disp);
+    if(FAILED(hres))
+        return hres;
+
+    for(i = 0; i < function->func_code->local_cnt; i++) {
+        hres = jsdisp_propput_name(var_disp, function->func_code->locals[i], ctx->stack[i]);
+        if(FAILED(hres))
+            break;
+    }
+
+    if(SUCCEEDED(hres)) {
+        hres = create_arguments(ctx->script, function, var_disp, function->argc, function->argv, &arg_disp);
+        if(SUCCEEDED(hres)) {
+            hres = jsdisp_propput(var_disp, argumentsW, PROPF_DONTDELETE, jsval_obj(arg_disp));
+            if(FAILED(hres))
+                jsdisp_release(arg_disp);
+        }
+    }
+    if(FAILED(hres)) {
+        jsdisp_release(var_disp);
+        return hres;
+    }
+
+    /* Fill the scope pushed by invoke_source_locals. It may be below catch scopes. */
+    for(scope = ctx->scope_chain; scope->obj; scope = scope->next);
+    scope->jsobj = var_disp;
+    scope->obj = to_disp(jsdisp_addref(var_disp));
+
+    ctx->var_disp = var_disp;
+    function->arguments = arg_disp;
+    return S_OK;
+}
+
+static HRESULT invoke_source_locals(script_ctx_t *ctx, FunctionInstance *function, IDispatch *this_obj,
+        unsigned argc, jsval_t *argv, jsval_t *r)
+{
+    exec_ctx_t *exec_ctx, *prev_ctx;
+    scope_chain_t *scope;
+    jsdisp_t *prev_args;
+    jsval_t *prev_argv;
+    unsigned prev_argc;
+    HRESULT hres;
+
+    /* the scope object is set if the variable object is created */
+    hres = scope_push(function->scope_chain, NULL, NULL, &scope);
+    if(FAILED(hres))
+        return hres;
+
+    hres = create_exec_ctx(ctx, this_obj, NULL, scope, FALSE, &exec_ctx);
+    scope_release(scope);
+    if(FAILED(hres))
+        return hres;
+
+    exec_ctx->function = &function->dispex;
+
+    prev_args = function->arguments;
+    prev_ctx = function->exec_ctx;
+    prev_argc = function->argc;
+    prev_argv = function->argv;
+    function->arguments = NULL;
+    function->exec_ctx = exec_ctx;
+    function->argc = argc;
+    function->argv = argv;
+
+    hres = exec_source(exec_ctx, function->code, function->func_code, FALSE, argc, argv, r);
+
+    /* the variable object and the arguments object are only created if they were needed */
+    if(exec_ctx->var_disp)
+        jsdisp_propput_name(exec_ctx->var_disp, argumentsW, jsval_undefined());
+    if(function->arguments)
+        jsdisp_release(function->arguments);
+    function->arguments = prev_args;
+    function->exec_ctx = prev_ctx;
+    function->argc = prev_argc;
+    function->argv = prev_argv;
+
+    exec_release(exec_ctx);
+    return hres;
+}
+
 static HRESULT invoke_source(script_ctx_t *ctx, FunctionInstance *function, IDispatch *this_obj, unsigned argc, jsval_t *argv,
         jsval_t *r)
 {
@@ -220,6 +325,9 @@ static HRESULT invoke_source(script_ctx_t *ctx, FunctionInstance *function, IDis
         return E_FAIL;
     }
 
+    if(function->func_code->use_locals)
+        return invoke_source_locals(ctx, function, this_obj, argc, argv, r);
+
     hres = create_var_disp(ctx, function, argc, argv, &var_disp);
     if(FAILED(hres))
         return hres;
@@ -247,7 +355,7 @@ static HRESULT invoke_source(script_ctx_t *ctx, FunctionInstance *function, IDis
 
             prev_args = function->arguments;
             function->arguments = arg_disp;
-            hres = exec_source(exec_ctx, function->code, function->func_code, FALSE, r);
+            hres = exec_source(exec_ctx, function->code, function->func_code, FALSE, argc, argv, r);
             function->arguments = prev_args;
 
             exec_release(exec_ctx);
@@ -559,9 +667,16 @@ HRESULT Function_get_value(script_ctx_t *ctx, jsdisp_t *jsthis, jsval_t *r)
 static HRESULT Function_get_arguments(script_ctx_t *ctx, jsdisp_t *jsthis, jsval_t *r)
 {
     FunctionInstance *function = function_from_jsdisp(jsthis);
+    HRESULT hres;
 
     TRACE("\n");
 
+    if(function->exec_ctx) {
+        hres = setup_locals_scope(function->exec_ctx);
+        if(FAILED(hres))
+            return hres;
+    }
+
     *r = function->arguments ? jsval_obj(jsdisp_addref(function->arguments)) : jsval_null();
     return S_OK;
 }
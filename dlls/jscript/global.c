@@ -221,7 +221,10 @@ static HRESULT JSGlobal_eval(script_ctx_t *ctx, vdisp_t *jsthis, WORD flags, uns
         return throw_syntax_error(ctx, hres, NULL);
     }
 
-    hres = exec_source(ctx->exec_ctx, code, &code->global_code, TRUE, r);
+    /* functions using stack slots for their locals can only get here through an indirect call */
+    hres = setup_locals_scope(ctx->exec_ctx);
+    if(SUCCEEDED(hres))
+        hres = exec_source(ctx->exec_ctx, code, &code->global_code, TRUE, 0, NULL, r);
     release_bytecode(code);
     return hres;
 }
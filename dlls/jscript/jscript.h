@@ -227,6 +227,12 @@ struct jsdisp_t {
     const builtin_info_t *builtin_info;
 };
 
+/* Result of the last property lookup done by an instruction, see jsdisp_get_id_cached */
+typedef struct {
+    DISPID id;
+    unsigned hash;
+} prop_cache_t;
+
 static inline IDispatch *to_disp(jsdisp_t *jsdisp)
 {
     return (IDispatch*)&jsdisp->IDispatchEx_iface;
@@ -283,6 +289,7 @@ HRESULT jsdisp_propput_idx(jsdisp_t*,DWORD,jsval_t) DECLSPEC_HIDDEN;
 HRESULT jsdisp_propget_name(jsdisp_t*,LPCWSTR,jsval_t*) DECLSPEC_HIDDEN;
 HRESULT jsdisp_get_idx(jsdisp_t*,DWORD,jsval_t*) DECLSPEC_HIDDEN;
 HRESULT jsdisp_get_id(jsdisp_t*,const WCHAR*,DWORD,DISPID*) DECLSPEC_HIDDEN;
+HRESULT jsdisp_get_id_cached(jsdisp_t*,const WCHAR*,DWORD,prop_cache_t*,DISPID*) DECLSPEC_HIDDEN;
 HRESULT disp_delete(IDispatch*,DISPID,BOOL*) DECLSPEC_HIDDEN;
 HRESULT disp_delete_name(script_ctx_t*,IDispatch*,jsstr_t*,BOOL*);
 HRESULT jsdisp_delete_idx(jsdisp_t*,DWORD) DECLSPEC_HIDDEN;
@@ -34,6 +34,18 @@
  */
 #define JSSTR_MAX_ROPE_DEPTH 100
 
+static inline jsstr_builder_t *jsstr_builder_addref(jsstr_builder_t *builder)
+{
+    builder->ref++;
+    return builder;
+}
+
+static inline void jsstr_builder_release(jsstr_builder_t *builder)
+{
+    if(!--builder->ref)
+        heap_free(builder);
+}
+
 const char *debugstr_jsstr(jsstr_t *str)
 {
     return jsstr_is_inline(str) ? debugstr_wn(jsstr_as_inline(str)->buf, jsstr_length(str))
@@ -44,9 +56,14 @@ const char *debugstr_jsstr(jsstr_t *str)
 void jsstr_free(jsstr_t *str)
 {
     switch(jsstr_tag(str)) {
-    case JSSTR_HEAP:
-        heap_free(jsstr_as_heap(str)->buf);
+    case JSSTR_HEAP: {
+        jsstr_heap_t *heap = jsstr_as_heap(str);
+        if(heap->builder)
+            jsstr_builder_release(heap->builder);
+        else
+            heap_free(heap->buf);
         break;
+    }
     case JSSTR_ROPE: {
         jsstr_rope_t *rope = jsstr_as_rope(str);
         jsstr_release(rope->left);
@@ -95,6 +112,75 @@ jsstr_t *jsstr_alloc_len(const WCHAR *buf, unsigned len)
     return ret;
 }
 
+/*
+ * Allocates a builder for len characters. If grow is set, the builder gets room for
+ * the same amount of characters appended later, so that a string growing by repeated
+ * concatenation is copied only a logarithmic number of times.
+ */
+static jsstr_builder_t *jsstr_builder_alloc(unsigned len, BOOL grow)
+{
+    jsstr_builder_t *builder;
+    unsigned size = len+1;
+
+    if(len > JSSTR_MAX_LENGTH)
+        return NULL;
+    if(grow)
+        size += min(len, JSSTR_MAX_LENGTH-len);
+
+    builder = heap_alloc(FIELD_OFFSET(jsstr_builder_t, buf[size]));
+    if(!builder)
+        return NULL;
+
+    builder->ref = 1;
+    builder->len = len;
+    builder->size = size;
+    builder->sealed = FALSE;
+    builder->buf[len] = 0;
+    return builder;
+}
+
+static inline void jsstr_init_builder(jsstr_heap_t *heap, unsigned len, jsstr_builder_t *builder)
+{
+    jsstr_init(&heap->str, len, JSSTR_HEAP);
+    heap->buf = builder->buf;
+    heap->builder = builder;
+}
+
+static jsstr_t *jsstr_alloc_builder(unsigned len, BOOL grow, WCHAR **buf)
+{
+    jsstr_builder_t *builder;
+    jsstr_heap_t *ret;
+
+    ret = heap_alloc(sizeof(*ret));
+    if(!ret)
+        return NULL;
+
+    builder = jsstr_builder_alloc(len, grow);
+    if(!builder) {
+        heap_free(ret);
+        return NULL;
+    }
+
+    jsstr_init_builder(ret, len, builder);
+    *buf = builder->buf;
+    return &ret->str;
+}
+
+/*
+ * Returns builder of the string if the string may be extended in place by len characters.
+ * A sealed builder holds the terminating zero of a buffer returned by jsstr_flatten, so
+ * it is never extended.
+ */
+static jsstr_builder_t *jsstr_get_tail_builder(jsstr_t *str, unsigned len)
+{
+    jsstr_builder_t *builder;
+
+    if(!jsstr_is_heap(str) || !(builder = jsstr_as_heap(str)->builder) || builder->sealed)
+        return NULL;
+
+    return builder->len == jsstr_length(str) && builder->size - builder->len > len ? builder : NULL;
+}
+
 static void jsstr_rope_extract(jsstr_rope_t *str, unsigned off, unsigned len, WCHAR *buf)
 {
     unsigned left_len = jsstr_length(str->left);
@@ -209,6 +295,7 @@ int jsstr_cmp(jsstr_t *str1, jsstr_t *str2)
 
 jsstr_t *jsstr_concat(jsstr_t *str1, jsstr_t *str2)
 {
+    jsstr_builder_t *builder;
     unsigned len1, len2;
     jsstr_t *ret;
     WCHAR *ptr;
@@ -221,6 +308,22 @@ jsstr_t *jsstr_concat(jsstr_t *str1, jsstr_t *str2)
     if(!len2)
         return jsstr_addref(str1);
 
+    builder = jsstr_get_tail_builder(str1, len2);
+    if(builder) {
+        jsstr_heap_t *heap;
+
+        heap = heap_alloc(sizeof(*heap));
+        if(!heap)
+            return NULL;
+
+        /* str2 may share the builder, but it never reaches past its used part. */
+        jsstr_flush(str2, builder->buf+len1);
+        builder->len += len2;
+        builder->buf[builder->len] = 0;
+        jsstr_init_builder(heap, len1+len2, jsstr_builder_addref(builder));
+        return &heap->str;
+    }
+
     if(len1 + len2 >= JSSTR_SHORT_STRING_LENGTH) {
         unsigned depth, depth2;
         jsstr_rope_t *rope;
@@ -246,35 +349,77 @@ jsstr_t *jsstr_concat(jsstr_t *str1, jsstr_t *str2)
         }
     }
 
-    ptr = jsstr_alloc_buf(len1+len2, &ret);
-    if(!ret)
-        return NULL;
+    if(len1+len2 >= JSSTR_SHORT_STRING_LENGTH) {
+        ret = jsstr_alloc_builder(len1+len2, TRUE, &ptr);
+        if(!ret)
+            return NULL;
+    }else {
+        ptr = jsstr_alloc_buf(len1+len2, &ret);
+        if(!ptr)
+            return NULL;
+    }
 
     jsstr_flush(str1, ptr);
     jsstr_flush(str2, ptr+len1);
     return ret;
-
 }
 
 C_ASSERT(sizeof(jsstr_heap_t) <= sizeof(jsstr_rope_t));
 
-const WCHAR *jsstr_rope_flatten(jsstr_rope_t *str)
+/*
+ * Gives a prefix string sharing a builder a zero-terminated buffer of its own. Such a string
+ * never had its buffer handed out: that would have sealed the builder while the string was
+ * its tail, and a sealed builder is never extended past it.
+ */
+const WCHAR *jsstr_heap_flatten(jsstr_heap_t *str)
 {
+    unsigned len = jsstr_length(&str->str);
     WCHAR *buf;
 
-    buf = heap_alloc((jsstr_length(&str->str)+1) * sizeof(WCHAR));
+    buf = heap_alloc((len+1) * sizeof(WCHAR));
     if(!buf)
         return NULL;
 
-    jsstr_flush(str->left, buf);
-    jsstr_flush(str->right, buf+jsstr_length(str->left));
-    buf[jsstr_length(&str->str)] = 0;
+    memcpy(buf, str->buf, len*sizeof(WCHAR));
+    buf[len] = 0;
+
+    jsstr_builder_release(str->builder);
+    str->builder = NULL;
+    return str->buf = buf;
+}
+
+const WCHAR *jsstr_rope_flatten(jsstr_rope_t *str)
+{
+    unsigned len = jsstr_length(&str->str), leaf_len;
+    jsstr_builder_t *builder;
+    jsstr_t *leaf;
+
+    for(leaf = str->left; jsstr_is_rope(leaf); leaf = jsstr_as_rope(leaf)->left);
+    leaf_len = jsstr_length(leaf);
+
+    builder = jsstr_get_tail_builder(leaf, len-leaf_len);
+    if(builder) {
+        /* The leftmost string is already in place, append the rest of the rope to its builder. */
+        jsstr_rope_extract(str, leaf_len, len-leaf_len, builder->buf+leaf_len);
+        builder->len = len;
+        builder->buf[len] = 0;
+        jsstr_builder_addref(builder);
+    }else {
+        builder = jsstr_builder_alloc(len, jsstr_is_heap(leaf) && jsstr_as_heap(leaf)->builder);
+        if(!builder)
+            return NULL;
+
+        jsstr_flush(str->left, builder->buf);
+        jsstr_flush(str->right, builder->buf+jsstr_length(str->left));
+    }
 
     /* Trasform to heap string */
     jsstr_release(str->left);
     jsstr_release(str->right);
     str->str.length_flags |= JSSTR_FLAG_FLAT;
-    return jsstr_as_heap(&str->str)->buf = buf;
+    builder->sealed = TRUE;
+    jsstr_as_heap(&str->str)->builder = builder;
+    return jsstr_as_heap(&str->str)->buf = builder->buf;
 }
 
 static jsstr_t *empty_str, *nan_str, *undefined_str, *null_bstr_str;
@@ -31,6 +31,15 @@
  * and the new buffer is stored in the string, so that subsequent operations requiring
  * a flat string won't need to flatten it again.
  *
+ * Heap strings created by flattening or by long concatenations keep their characters in
+ * a builder, a buffer shared by all strings that are prefixes of its content. The string
+ * as long as the used part of the builder owns its tail and may be extended in place by
+ * appending to the builder, until its buffer is handed out by jsstr_flatten. From then on
+ * the builder is sealed: callers may rely on the terminating zero and on the buffer staying
+ * alive as long as the string, so later concatenations copy the string instead. Other
+ * strings sharing a builder were never handed out, are not zero-terminated and get a
+ * buffer of their own when a flat buffer is needed.
+ *
  * In the future more layouts and transformations may be added.
  */
 struct _jsstr_t {
@@ -82,9 +91,18 @@ typedef struct {
     WCHAR buf[1];
 } jsstr_inline_t;
 
+typedef struct {
+    unsigned ref;
+    unsigned len;
+    unsigned size;
+    BOOL sealed;
+    WCHAR buf[1];
+} jsstr_builder_t;
+
 typedef struct {
     jsstr_t str;
     WCHAR *buf;
+    jsstr_builder_t *builder;
 } jsstr_heap_t;
 
 typedef struct {
@@ -135,13 +153,26 @@ static inline jsstr_rope_t *jsstr_as_rope(jsstr_t *str)
     return CONTAINING_RECORD(str, jsstr_rope_t, str);
 }
 
+const WCHAR *jsstr_heap_flatten(jsstr_heap_t*) DECLSPEC_HIDDEN;
 const WCHAR *jsstr_rope_flatten(jsstr_rope_t*) DECLSPEC_HIDDEN;
 
 static inline const WCHAR *jsstr_flatten(jsstr_t *str)
 {
-    return jsstr_is_inline(str) ? jsstr_as_inline(str)->buf
-        : jsstr_is_heap(str) ? jsstr_as_heap(str)->buf
-        : jsstr_rope_flatten(jsstr_as_rope(str));
+    jsstr_heap_t *heap;
+
+    if(jsstr_is_inline(str))
+        return jsstr_as_inline(str)->buf;
+    if(jsstr_is_rope(str))
+        return jsstr_rope_flatten(jsstr_as_rope(str));
+
+    heap = jsstr_as_heap(str);
+    if(!heap->builder)
+        return heap->buf;
+    if(heap->builder->len != jsstr_length(str))
+        return jsstr_heap_flatten(heap);
+
+    heap->builder->sealed = TRUE;
+    return heap->buf;
 }
 
 void jsstr_extract(jsstr_t*,unsigned,unsigned,WCHAR*) DECLSPEC_HIDDEN;
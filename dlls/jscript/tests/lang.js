@@ -1146,6 +1146,36 @@ tmp.testWith = true;
 with(tmp)
     ok(testWith === true, "testWith !== true");
 
+function PropCacheTest(a, b) {
+    this.a = a;
+    this.b = b;
+}
+PropCacheTest.prototype.c = "prot";
+
+function getPropCacheTestProps(o) {
+    return o.a + "," + o.b + "," + o.c;
+}
+
+tmp = [new PropCacheTest(1, 2), new PropCacheTest(3, 4), {b: 5, a: 6}, {a: 7}, new PropCacheTest(8, 9)];
+tmp[1].c = "own";
+tmp[3].b = 10;
+delete tmp[4].a;
+for(i = 0; i < 2; i++) {
+    ok(getPropCacheTestProps(tmp[0]) === "1,2,prot", "tmp[0] props = " + getPropCacheTestProps(tmp[0]));
+    ok(getPropCacheTestProps(tmp[1]) === "3,4,own", "tmp[1] props = " + getPropCacheTestProps(tmp[1]));
+    ok(getPropCacheTestProps(tmp[2]) === "6,5,undefined", "tmp[2] props = " + getPropCacheTestProps(tmp[2]));
+    ok(getPropCacheTestProps(tmp[3]) === "7,10,undefined", "tmp[3] props = " + getPropCacheTestProps(tmp[3]));
+    ok(getPropCacheTestProps(tmp[4]) === "undefined,9,prot", "tmp[4] props = " + getPropCacheTestProps(tmp[4]));
+    delete tmp[1].c;
+    tmp[1].c = "own";
+}
+delete tmp[1].c;
+ok(getPropCacheTestProps(tmp[1]) === "3,4,prot", "tmp[1] props = " + getPropCacheTestProps(tmp[1]));
+PropCacheTest.prototype.c = "prot2";
+ok(getPropCacheTestProps(tmp[0]) === "1,2,prot2", "tmp[0] props = " + getPropCacheTestProps(tmp[0]));
+tmp[4].a = 11;
+ok(getPropCacheTestProps(tmp[4]) === "11,9,prot2", "tmp[4] props = " + getPropCacheTestProps(tmp[4]));
+
 if(false) {
     var varTest1 = true;
 }
@@ -1166,6 +1196,138 @@ function varTestFunc(varTest3) {
 
 varTestFunc(3);
 
+function localsTestFunc(a, b, f) {
+    ok(c === undefined, "c = " + c);
+    ok(typeof(c) === "undefined", "typeof(c) = " + typeof(c));
+
+    var c = a + b, d, i, s = "";
+
+    ok(c === 3, "c = " + c);
+    ok(typeof(a) === "number", "typeof(a) = " + typeof(a));
+    ok(b === 2, "b = " + b);
+
+    d = c++;
+    ok(d === 3, "d = " + d);
+    ok(c === 4, "c = " + c);
+    ok(--c === 3, "c = " + c);
+    c += 10;
+    ok(c === 13, "c = " + c);
+
+    for(i in {x: 1, y: 2})
+        s += i;
+    ok(s === "xy", "s = " + s);
+
+    try {
+        throw c;
+    }catch(ex) {
+        ok(ex === 13, "ex = " + ex);
+        ok(a === 1, "a = " + a);
+        a = ex;
+    }
+    ok(a === 13, "a = " + a);
+
+    localsTestGlobal = c;
+
+    return f ? f(a) : localsTestFunc.arguments;
+}
+
+ok(localsTestFunc(1, 2, function(x) { return x * 2; }) === 26, "localsTestFunc returned unexpected value");
+ok(localsTestGlobal === 13, "localsTestGlobal = " + localsTestGlobal);
+tmp = localsTestFunc(1, 2);
+ok(tmp.length === 2, "tmp.length = " + tmp.length);
+ok(tmp[0] === 13, "tmp[0] = " + tmp[0]);
+ok(tmp[1] === 2, "tmp[1] = " + tmp[1]);
+ok(localsTestFunc.arguments === null, "localsTestFunc.arguments = " + localsTestFunc.arguments);
+
+function localsRecTestFunc(n) {
+    var r = n;
+    if(n > 0)
+        r += localsRecTestFunc(n - 1);
+    return r;
+}
+
+ok(localsRecTestFunc(10) === 55, "localsRecTestFunc(10) = " + localsRecTestFunc(10));
+
+function localsEvalTestFunc(e) {
+    var localsEvalTest = 1, t;
+    t = e("typeof(localsEvalTest)");
+    ok(t === "number", "typeof(localsEvalTest) = " + t);
+    e("localsEvalTest = 2; var localsEvalNew = 3;");
+    ok(localsEvalTest === 2, "localsEvalTest = " + localsEvalTest);
+    ok(typeof(localsEvalNew) === "number", "typeof(localsEvalNew) = " + typeof(localsEvalNew));
+    return localsEvalTest;
+}
+
+tmp = localsEvalTestFunc(eval);
+ok(tmp === 2, "localsEvalTestFunc(eval) = " + tmp);
+ok(typeof(localsEvalTest) === "undefined", "typeof(localsEvalTest) = " + typeof(localsEvalTest));
+ok(typeof(localsEvalNew) === "undefined", "typeof(localsEvalNew) = " + typeof(localsEvalNew));
+
+function localsArgsTestFunc(a, f) {
+    f();
+    return a;
+}
+
+tmp = localsArgsTestFunc(1, function() { localsArgsTestFunc.arguments[0] = 5; });
+ok(tmp === 5, "localsArgsTestFunc returned " + tmp);
+
+function concatTestFunc() {
+    var s = "", prefixes = [], i;
+
+    for(i = 0; i < 300; i++) {
+        s += "<td>" + i + "</td>";
+        if(!(i % 50))
+            prefixes.push(s);
+        if(!(i % 7))
+            ok(s.charAt(s.length - 1) === ">", "s.charAt(s.length - 1) = " + s.charAt(s.length - 1));
+    }
+    ok(s.length === 3490, "s.length = " + s.length);
+    ok(s.indexOf("<td>299</td>") === 3478, "s.indexOf(\"<td>299</td>\") = " + s.indexOf("<td>299</td>"));
+
+    ok(prefixes[0] === "<td>0</td>", "prefixes[0] = " + prefixes[0]);
+    ok(prefixes[1].length === 551, "prefixes[1].length = " + prefixes[1].length);
+    ok(prefixes[1].substr(540) === "<td>50</td>", "prefixes[1].substr(540) = " + prefixes[1].substr(540));
+    ok(s.substr(0, 551) === prefixes[1], "s.substr(0, 551) != prefixes[1]");
+    ok(prefixes[2] + "x" !== prefixes[2] + "y", "prefixes[2] + \"x\" === prefixes[2] + \"y\"");
+    ok((prefixes[2] + "x").substr(-2) === ">x", "(prefixes[2] + \"x\").substr(-2) = " + (prefixes[2] + "x").substr(-2));
+
+    tmp = s + s;
+    ok(tmp.length === 6980, "tmp.length = " + tmp.length);
+    ok(tmp.substr(3480, 20) === "d>299</td><td>0</td>", "tmp.substr(3480, 20) = " + tmp.substr(3480, 20));
+    ok(tmp === s.concat(s), "tmp !== s.concat(s)");
+}
+
+concatTestFunc();
+
+function concatReuseTestFunc() {
+    var s = "", t, i;
+
+    for(i = 0; i < 20; i++)
+        s += "x" + i;
+
+    /* flatten s, extend it and use the original string again */
+    ok(s.indexOf("x19") === 47, "s.indexOf(\"x19\") = " + s.indexOf("x19"));
+    t = s + "y";
+    ok(t.length === 51, "t.length = " + t.length);
+    ok(s.length === 50, "s.length = " + s.length);
+    ok(s.indexOf("y") === -1, "s.indexOf(\"y\") = " + s.indexOf("y"));
+    ok(s + "z" !== t, "s + \"z\" === t");
+    t = null;
+    ok(s.indexOf("x19") === 47, "s.indexOf(\"x19\") = " + s.indexOf("x19"));
+    ok(s.substr(47) === "x19", "s.substr(47) = " + s.substr(47));
+
+    /* the string being searched is extended while replace still uses it */
+    t = s.replace(/x1/g, function(m) {
+        var u = s + "y";
+        u = null;
+        return s.indexOf("x19") === 47 ? "X" : "!";
+    });
+    ok(t === s.split("x1").join("X"), "t = " + t);
+    ok(s.charAt(s.length - 1) === "9", "s.charAt(s.length - 1) = " + s.charAt(s.length - 1));
+}
+
+concatReuseTestFunc();
+
 deleteTest = 1;
 delete deleteTest;
 try {
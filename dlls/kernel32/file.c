@@ -685,6 +685,32 @@ BOOL WINAPI CancelIo(HANDLE handle)
     return TRUE;
 }
 
+/***********************************************************************
+ *             CancelSynchronousIo        (KERNEL32.@)
+ *
+ * Cancels the synchronous I/O operation a thread is blocked in.
+ *
+ * PARAMS
+ *  thread [I] Thread handle.
+ *
+ * RETURNS
+ *  Success: TRUE.
+ *  Failure: FALSE, check GetLastError().
+ */
+BOOL WINAPI CancelSynchronousIo(HANDLE thread)
+{
+    IO_STATUS_BLOCK    io_status;
+    NTSTATUS           status;
+
+    status = NtCancelSynchronousIoFile(thread, NULL, &io_status);
+    if (status)
+    {
+        SetLastError( RtlNtStatusToDosError( status ) );
+        return FALSE;
+    }
+    return TRUE;
+}
+
 /***********************************************************************
  *           _hread   (KERNEL32.@)
  */
@@ -25,6 +25,7 @@
 #define WIN32_NO_STATUS
 #include "windef.h"
 #include "winbase.h"
+#include "winreg.h"
 #include "winternl.h"
 #include "wine/test.h"
 
@@ -2149,9 +2150,353 @@ todo_wine
     CloseHandle(event);
 }
 
+static HANDLE create_sync_pipe(DWORD pipemode, HANDLE *client, BOOL inherit)
+{
+    SECURITY_ATTRIBUTES sa = { sizeof(sa), NULL, TRUE };
+    HANDLE server;
+
+    server = CreateNamedPipeA(PIPENAME, PIPE_ACCESS_DUPLEX, pipemode | PIPE_WAIT,
+        /* nMaxInstances */ 1,
+        /* nOutBufSize */ 4096,
+        /* nInBufSize */ 4096,
+        /* nDefaultWait */ NMPWAIT_USE_DEFAULT_WAIT,
+        /* lpSecurityAttrib */ NULL);
+    ok(server != INVALID_HANDLE_VALUE, "CreateNamedPipe failed with %u\n", GetLastError());
+
+    *client = CreateFileA(PIPENAME, GENERIC_READ | GENERIC_WRITE, 0, inherit ? &sa : NULL,
+                          OPEN_EXISTING, 0, 0);
+    ok(*client != INVALID_HANDLE_VALUE, "CreateFile failed with %u\n", GetLastError());
+    return server;
+}
+
+static void fill_message(char *buf, DWORD size, DWORD seed)
+{
+    DWORD i;
+
+    for (i = 0; i < size; i++) buf[i] = (char)(seed * 31 + i);
+}
+
+static void test_message_boundaries(void)
+{
+    static const DWORD sizes[] = { 1, 100, 5000, 4096 };
+    char obuf[5000], ibuf[10000];
+    HANDLE server, client;
+    DWORD i, written, readden;
+    BOOL ret;
+
+    server = create_sync_pipe(PIPE_TYPE_MESSAGE | PIPE_READMODE_MESSAGE, &client, FALSE);
+
+    /* every read returns exactly one message */
+    for (i = 0; i < sizeof(sizes)/sizeof(sizes[0]); i++)
+    {
+        fill_message(obuf, sizes[i], i);
+        ret = WriteFile(client, obuf, sizes[i], &written, NULL);
+        ok(ret && written == sizes[i], "%u: WriteFile returned %d, %u bytes\n", i, ret, written);
+    }
+    for (i = 0; i < sizeof(sizes)/sizeof(sizes[0]); i++)
+    {
+        fill_message(obuf, sizes[i], i);
+        ret = ReadFile(server, ibuf, sizeof(ibuf), &readden, NULL);
+        ok(ret, "%u: ReadFile failed with %u\n", i, GetLastError());
+        ok(readden == sizes[i], "%u: read %u bytes\n", i, readden);
+        ok(!memcmp(ibuf, obuf, sizes[i]), "%u: content check\n", i);
+    }
+
+    /* a message larger than the buffer is returned in pieces */
+    fill_message(obuf, 100, 42);
+    ret = WriteFile(client, obuf, 100, &written, NULL);
+    ok(ret && written == 100, "WriteFile returned %d, %u bytes\n", ret, written);
+    SetLastError(0xdeadbeef);
+    ret = ReadFile(server, ibuf, 40, &readden, NULL);
+    ok(!ret && GetLastError() == ERROR_MORE_DATA, "ReadFile returned %d, error %u\n", ret, GetLastError());
+    ok(readden == 40, "read %u bytes\n", readden);
+    ret = ReadFile(server, ibuf + 40, sizeof(ibuf) - 40, &readden, NULL);
+    ok(ret, "ReadFile failed with %u\n", GetLastError());
+    ok(readden == 60, "read %u bytes\n", readden);
+    ok(!memcmp(ibuf, obuf, 100), "content check\n");
+
+    /* a byte mode read ignores the message boundaries */
+    ret = WriteFile(server, obuf, 10, &written, NULL);
+    ok(ret && written == 10, "WriteFile returned %d, %u bytes\n", ret, written);
+    ret = WriteFile(server, obuf + 10, 20, &written, NULL);
+    ok(ret && written == 20, "WriteFile returned %d, %u bytes\n", ret, written);
+    ret = ReadFile(client, ibuf, sizeof(ibuf), &readden, NULL);
+    ok(ret, "ReadFile failed with %u\n", GetLastError());
+    ok(readden == 30, "read %u bytes\n", readden);
+    ok(!memcmp(ibuf, obuf, 30), "content check\n");
+
+    CloseHandle(client);
+    CloseHandle(server);
+}
+
+#define WRAP_MESSAGES 300
+#define WRAP_MAX_SIZE 0x24000
+
+static DWORD wrap_message_size(DWORD i)
+{
+    /* mostly small messages, with a few larger than any pipe buffer */
+    return (i % 50 == 49) ? WRAP_MAX_SIZE : 1 + (i * 7919) % 9000;
+}
+
+static DWORD CALLBACK wrap_writer_thread(LPVOID arg)
+{
+    HANDLE pipe = arg;
+    char *buf = HeapAlloc(GetProcessHeap(), 0, WRAP_MAX_SIZE);
+    DWORD i, written;
+    BOOL ret;
+
+    for (i = 0; i < WRAP_MESSAGES; i++)
+    {
+        fill_message(buf, wrap_message_size(i), i);
+        ret = WriteFile(pipe, buf, wrap_message_size(i), &written, NULL);
+        ok(ret && written == wrap_message_size(i), "%u: WriteFile returned %d, %u bytes\n", i, ret, written);
+    }
+    HeapFree(GetProcessHeap(), 0, buf);
+    return 0;
+}
+
+static void test_wrap_around(DWORD pipemode)
+{
+    char *obuf = HeapAlloc(GetProcessHeap(), 0, WRAP_MAX_SIZE);
+    char *ibuf = HeapAlloc(GetProcessHeap(), 0, WRAP_MAX_SIZE);
+    HANDLE server, client, thread;
+    DWORD i, size, readden, total;
+    BOOL ret;
+
+    server = create_sync_pipe(pipemode, &client, FALSE);
+    thread = CreateThread(NULL, 0, wrap_writer_thread, client, 0, NULL);
+    ok(thread != NULL, "CreateThread failed with %u\n", GetLastError());
+
+    for (i = 0; i < WRAP_MESSAGES; i++)
+    {
+        size = wrap_message_size(i);
+        fill_message(obuf, size, i);
+
+        /* byte mode may return less than a whole write */
+        for (total = 0; total < size; total += readden)
+        {
+            ret = ReadFile(server, ibuf + total, size - total, &readden, NULL);
+            ok(ret, "%u: ReadFile failed with %u\n", i, GetLastError());
+            if (!ret || !readden) break;
+            if (pipemode & PIPE_READMODE_MESSAGE) ok(readden == size, "%u: read %u bytes\n", i, readden);
+        }
+        ok(total == size, "%u: read %u bytes, expected %u\n", i, total, size);
+        if (total != size || memcmp(ibuf, obuf, size))
+        {
+            ok(0, "%u: content check\n", i);
+            break;
+        }
+    }
+
+    ok(WaitForSingleObject(thread, 10000) == WAIT_OBJECT_0, "writer thread didn't finish\n");
+    CloseHandle(thread);
+    CloseHandle(client);
+    CloseHandle(server);
+    HeapFree(GetProcessHeap(), 0, obuf);
+    HeapFree(GetProcessHeap(), 0, ibuf);
+}
+
+#define DEAD_WRITER_SIZE 0x30000
+
+static void child_dead_writer(HANDLE pipe)
+{
+    char *buf = HeapAlloc(GetProcessHeap(), 0, DEAD_WRITER_SIZE);
+    DWORD written;
+
+    /* blocks until the parent kills us, nobody reads the pipe */
+    memset(buf, 'a', DEAD_WRITER_SIZE);
+    WriteFile(pipe, buf, DEAD_WRITER_SIZE, &written, NULL);
+    HeapFree(GetProcessHeap(), 0, buf);
+}
+
+static DWORD CALLBACK small_writer_thread(LPVOID arg)
+{
+    HANDLE pipe = arg;
+    DWORD written;
+    BOOL ret;
+
+    ret = WriteFile(pipe, "bbbbbbbbbb", 10, &written, NULL);
+    ok(ret && written == 10, "WriteFile returned %d, %u bytes\n", ret, written);
+    return 0;
+}
+
+static void test_peer_death(const char *argv0)
+{
+    char cmd[MAX_PATH + 32], *ibuf;
+    PROCESS_INFORMATION info;
+    STARTUPINFOA startup;
+    HANDLE server, client, thread;
+    DWORD i, avail, readden;
+    BOOL ret;
+
+    server = create_sync_pipe(PIPE_TYPE_MESSAGE | PIPE_READMODE_MESSAGE, &client, TRUE);
+
+    memset(&startup, 0, sizeof(startup));
+    startup.cb = sizeof(startup);
+    sprintf(cmd, "\"%s\" pipe writer %x", argv0, (DWORD)(ULONG_PTR)client);
+    ret = CreateProcessA(NULL, cmd, NULL, NULL, TRUE, 0, NULL, NULL, &startup, &info);
+    ok(ret, "CreateProcess failed with %u\n", GetLastError());
+    if (!ret)
+    {
+        CloseHandle(client);
+        CloseHandle(server);
+        return;
+    }
+
+    /* wait until the child is blocked in the middle of its write */
+    for (i = 0; i < 100; i++)
+    {
+        avail = 0;
+        if (PeekNamedPipe(server, NULL, 0, NULL, &avail, NULL) && avail) break;
+        Sleep(50);
+    }
+    Sleep(100);
+    TerminateProcess(info.hProcess, 0);
+    ok(WaitForSingleObject(info.hProcess, 10000) == WAIT_OBJECT_0, "child didn't terminate\n");
+    CloseHandle(info.hThread);
+    CloseHandle(info.hProcess);
+
+    /* our handle still refers to the same end, writing must not hang */
+    thread = CreateThread(NULL, 0, small_writer_thread, client, 0, NULL);
+    ok(thread != NULL, "CreateThread failed with %u\n", GetLastError());
+    ok(WaitForSingleObject(thread, 10000) == WAIT_OBJECT_0, "write after the peer died hangs\n");
+    CloseHandle(thread);
+
+    /* whatever the killed write left behind comes first */
+    ibuf = HeapAlloc(GetProcessHeap(), 0, DEAD_WRITER_SIZE);
+    for (i = 0; i < 4; i++)
+    {
+        readden = 0;
+        ret = ReadFile(server, ibuf, DEAD_WRITER_SIZE, &readden, NULL);
+        if (!ret && GetLastError() != ERROR_MORE_DATA) break;
+        if (readden == 10 && !memcmp(ibuf, "bbbbbbbbbb", 10)) break;
+        ok(readden && ibuf[0] == 'a', "%u: unexpected data, %u bytes\n", i, readden);
+    }
+    ok(ret && readden == 10, "message written after the peer died not received, ret %d, %u bytes\n",
+       ret, readden);
+    HeapFree(GetProcessHeap(), 0, ibuf);
+
+    CloseHandle(client);
+    CloseHandle(server);
+}
+
+static DWORD CALLBACK blocked_reader_thread(LPVOID arg)
+{
+    HANDLE pipe = arg;
+    char buf[16];
+    DWORD readden;
+    BOOL ret;
+
+    SetLastError(0xdeadbeef);
+    ret = ReadFile(pipe, buf, sizeof(buf), &readden, NULL);
+    ok(!ret && GetLastError() == ERROR_OPERATION_ABORTED,
+       "ReadFile returned %d, error %u\n", ret, GetLastError());
+    return 0;
+}
+
+static void test_cancel_synchronous_io(void)
+{
+    BOOL (WINAPI *pCancelSynchronousIo)(HANDLE);
+    HANDLE server, client, thread;
+    DWORD i, written, readden;
+    char buf[16];
+    BOOL ret;
+
+    pCancelSynchronousIo = (void *)GetProcAddress(GetModuleHandleA("kernel32.dll"), "CancelSynchronousIo");
+    if (!pCancelSynchronousIo)
+    {
+        win_skip("CancelSynchronousIo is not available\n");
+        return;
+    }
+
+    SetLastError(0xdeadbeef);
+    ret = pCancelSynchronousIo(GetCurrentThread());
+    ok(!ret && GetLastError() == ERROR_NOT_FOUND,
+       "CancelSynchronousIo returned %d, error %u\n", ret, GetLastError());
+
+    server = create_sync_pipe(PIPE_TYPE_BYTE | PIPE_READMODE_BYTE, &client, FALSE);
+    thread = CreateThread(NULL, 0, blocked_reader_thread, server, 0, NULL);
+    ok(thread != NULL, "CreateThread failed with %u\n", GetLastError());
+
+    /* nothing is found until the reader is blocked */
+    for (i = 0; i < 100; i++)
+    {
+        Sleep(50);
+        SetLastError(0xdeadbeef);
+        if ((ret = pCancelSynchronousIo(thread))) break;
+        ok(GetLastError() == ERROR_NOT_FOUND, "CancelSynchronousIo failed with %u\n", GetLastError());
+    }
+    ok(ret, "blocked read not cancelled\n");
+    ok(WaitForSingleObject(thread, 10000) == WAIT_OBJECT_0, "reader thread didn't finish\n");
+    CloseHandle(thread);
+
+    /* the pipe is still usable afterwards */
+    ret = WriteFile(client, "data", 4, &written, NULL);
+    ok(ret && written == 4, "WriteFile returned %d, %u bytes\n", ret, written);
+    ret = ReadFile(server, buf, sizeof(buf), &readden, NULL);
+    ok(ret && readden == 4, "ReadFile returned %d, %u bytes\n", ret, readden);
+    ok(!memcmp(buf, "data", 4), "content check\n");
+
+    CloseHandle(client);
+    CloseHandle(server);
+}
+
+/* run the transport tests in a child process with the shared memory transport enabled */
+static void test_pipe_transport(const char *argv0)
+{
+    char cmd[MAX_PATH + 32];
+    PROCESS_INFORMATION info;
+    STARTUPINFOA startup;
+    DWORD disposition;
+    HKEY hkey;
+    LONG err;
+    BOOL ret;
+
+    err = RegCreateKeyExA(HKEY_CURRENT_USER, "Software\\Wine\\Pipes", 0, NULL, 0, KEY_ALL_ACCESS,
+                          NULL, &hkey, &disposition);
+    ok(!err, "RegCreateKeyEx failed with %d\n", err);
+    if (err) return;
+    RegSetValueExA(hkey, "SharedMemory", 0, REG_SZ, (const BYTE *)"Y", 2);
+
+    memset(&startup, 0, sizeof(startup));
+    startup.cb = sizeof(startup);
+    sprintf(cmd, "\"%s\" pipe transport", argv0);
+    ret = CreateProcessA(NULL, cmd, NULL, NULL, FALSE, 0, NULL, NULL, &startup, &info);
+    ok(ret, "CreateProcess failed with %u\n", GetLastError());
+    if (ret)
+    {
+        winetest_wait_child_process(info.hProcess);
+        CloseHandle(info.hThread);
+        CloseHandle(info.hProcess);
+    }
+
+    RegDeleteValueA(hkey, "SharedMemory");
+    RegCloseKey(hkey);
+    if (disposition == REG_CREATED_NEW_KEY)
+        RegDeleteKeyA(HKEY_CURRENT_USER, "Software\\Wine\\Pipes");
+}
+
 START_TEST(pipe)
 {
     HMODULE hmod;
+    char **argv;
+    int argc;
+
+    argc = winetest_get_mainargs(&argv);
+    if (argc >= 4 && !strcmp(argv[2], "writer"))
+    {
+        child_dead_writer((HANDLE)(ULONG_PTR)strtoul(argv[3], NULL, 16));
+        return;
+    }
+    if (argc >= 3 && !strcmp(argv[2], "transport"))
+    {
+        test_message_boundaries();
+        test_wrap_around(PIPE_TYPE_BYTE | PIPE_READMODE_BYTE);
+        test_wrap_around(PIPE_TYPE_MESSAGE | PIPE_READMODE_MESSAGE);
+        test_peer_death(argv[0]);
+        test_cancel_synchronous_io();
+        return;
+    }
 
     hmod = GetModuleHandleA("advapi32.dll");
     pDuplicateTokenEx = (void *) GetProcAddress(hmod, "DuplicateTokenEx");
@@ -2169,4 +2514,5 @@ START_TEST(pipe)
     test_overlapped();
     test_NamedPipeHandleState();
     test_readfileex_pending();
+    test_pipe_transport(argv[0]);
 }
@@ -125,6 +125,155 @@ static MSICABINETSTREAM *msi_get_cabinet_stream( MSIPACKAGE *package, UINT disk_
     return NULL;
 }
 
+/* Files at least this large are preallocated and written by a separate
+ * thread, so that writing a block overlaps with decompressing the next one. */
+#define CABINET_WRITER_BUFFER_SIZE 0x100000
+
+struct cabinet_writer
+{
+    HANDLE      handle;
+    HANDLE      thread;
+    HANDLE      ready;      /* signaled when a buffer is ready to be written */
+    HANDLE      idle;       /* signaled when the thread is done writing */
+    BYTE       *buffer[2];
+    UINT        current;    /* buffer being filled, the other one is written */
+    DWORD       len;        /* bytes in the current buffer */
+    DWORD       write_len;  /* bytes in the buffer being written */
+    LONG        failed;     /* set by the thread, read with interlocked operations */
+    BOOL        quit;
+};
+
+/* what the FDI callbacks get as file handle */
+struct cabinet_file
+{
+    HANDLE                 handle;
+    struct cabinet_writer *writer;  /* background writer of an extracted file, if any */
+    WCHAR                 *path;    /* path of an extracted file */
+    BOOL                   failed;  /* some data couldn't be written */
+};
+
+static DWORD WINAPI cabinet_writer_thread( void *arg )
+{
+    struct cabinet_writer *writer = arg;
+    DWORD written;
+
+    for (;;)
+    {
+        WaitForSingleObject( writer->ready, INFINITE );
+        if (writer->quit) break;
+
+        if (!WriteFile( writer->handle, writer->buffer[!writer->current], writer->write_len,
+                        &written, NULL ) || written != writer->write_len)
+            InterlockedExchange( &writer->failed, TRUE );
+
+        SetEvent( writer->idle );
+    }
+    return 0;
+}
+
+static BOOL cabinet_writer_failed( struct cabinet_writer *writer )
+{
+    return InterlockedCompareExchange( &writer->failed, FALSE, FALSE );
+}
+
+static void free_cabinet_writer( struct cabinet_writer *writer )
+{
+    if (writer->thread) CloseHandle( writer->thread );
+    if (writer->ready) CloseHandle( writer->ready );
+    if (writer->idle) CloseHandle( writer->idle );
+    msi_free( writer->buffer[0] );
+    msi_free( writer->buffer[1] );
+    msi_free( writer );
+}
+
+static struct cabinet_writer *start_cabinet_writer( HANDLE handle, ULONG size )
+{
+    struct cabinet_writer *writer;
+    LARGE_INTEGER pos;
+
+    /* let the file system allocate the whole file at once */
+    pos.QuadPart = size;
+    if (SetFilePointerEx( handle, pos, NULL, FILE_BEGIN ))
+    {
+        SetEndOfFile( handle );
+        pos.QuadPart = 0;
+        SetFilePointerEx( handle, pos, NULL, FILE_BEGIN );
+    }
+
+    if (!(writer = msi_alloc_zero( sizeof(*writer) ))) return NULL;
+
+    writer->handle = handle;
+    writer->buffer[0] = msi_alloc( CABINET_WRITER_BUFFER_SIZE );
+    writer->buffer[1] = msi_alloc( CABINET_WRITER_BUFFER_SIZE );
+    writer->ready = CreateEventW( NULL, FALSE, FALSE, NULL );
+    writer->idle = CreateEventW( NULL, FALSE, TRUE, NULL );
+    if (!writer->buffer[0] || !writer->buffer[1] || !writer->ready || !writer->idle ||
+        !(writer->thread = CreateThread( NULL, 0, cabinet_writer_thread, writer, 0, NULL )))
+    {
+        /* fall back to writing synchronously */
+        free_cabinet_writer( writer );
+        return NULL;
+    }
+    return writer;
+}
+
+static void submit_cabinet_writer( struct cabinet_writer *writer )
+{
+    WaitForSingleObject( writer->idle, INFINITE );
+    writer->write_len = writer->len;
+    writer->current = !writer->current;
+    writer->len = 0;
+    SetEvent( writer->ready );
+}
+
+/* writes out the remaining data and stops the thread */
+static BOOL finish_cabinet_writer( struct cabinet_writer *writer )
+{
+    BOOL ret;
+
+    if (writer->len) submit_cabinet_writer( writer );
+    WaitForSingleObject( writer->idle, INFINITE );
+
+    writer->quit = TRUE;
+    SetEvent( writer->ready );
+    WaitForSingleObject( writer->thread, INFINITE );
+
+    /* drop the preallocated space if less data was written */
+    SetEndOfFile( writer->handle );
+
+    ret = !cabinet_writer_failed( writer );
+    free_cabinet_writer( writer );
+    return ret;
+}
+
+/* takes ownership of the handle */
+static struct cabinet_file *create_cabinet_file( HANDLE handle )
+{
+    struct cabinet_file *file;
+
+    if (!(file = msi_alloc_zero( sizeof(*file) )))
+    {
+        CloseHandle( handle );
+        return NULL;
+    }
+    file->handle = handle;
+    return file;
+}
+
+/* stops the background writer, returns FALSE if any data was lost */
+static BOOL flush_cabinet_file( struct cabinet_file *file )
+{
+    if (file->writer && !finish_cabinet_writer( file->writer )) file->failed = TRUE;
+    file->writer = NULL;
+    return !file->failed;
+}
+
+static void free_cabinet_file( struct cabinet_file *file )
+{
+    msi_free( file->path );
+    msi_free( file );
+}
+
 static void * CDECL cabinet_alloc(ULONG cb)
 {
     return msi_alloc(cb);
@@ -140,6 +289,8 @@ static INT_PTR CDECL cabinet_open(char *pszFile, int oflag, int pmode)
     DWORD dwAccess = 0;
     DWORD dwShareMode = 0;
     DWORD dwCreateDisposition = OPEN_EXISTING;
+    struct cabinet_file *file;
+    HANDLE handle;
 
     switch (oflag & _O_ACCMODE)
     {
@@ -162,13 +313,17 @@ static INT_PTR CDECL cabinet_open(char *pszFile, int oflag, int pmode)
     else if (oflag & _O_CREAT)
         dwCreateDisposition = CREATE_ALWAYS;
 
-    return (INT_PTR)CreateFileA(pszFile, dwAccess, dwShareMode, NULL,
-                                dwCreateDisposition, 0, NULL);
+    handle = CreateFileA(pszFile, dwAccess, dwShareMode, NULL,
+                         dwCreateDisposition, 0, NULL);
+    if (handle == INVALID_HANDLE_VALUE || !(file = create_cabinet_file(handle)))
+        return -1;
+
+    return (INT_PTR)file;
 }
 
 static UINT CDECL cabinet_read(INT_PTR hf, void *pv, UINT cb)
 {
-    HANDLE handle = (HANDLE)hf;
+    HANDLE handle = ((struct cabinet_file *)hf)->handle;
     DWORD read;
 
     if (ReadFile(handle, pv, cb, &read, NULL))
@@ -177,26 +332,52 @@ static UINT CDECL cabinet_read(INT_PTR hf, void *pv, UINT cb)
     return 0;
 }
 
+/* FDI ignores the result, failures are reported when the file is closed */
 static UINT CDECL cabinet_write(INT_PTR hf, void *pv, UINT cb)
 {
-    HANDLE handle = (HANDLE)hf;
+    struct cabinet_file *file = (struct cabinet_file *)hf;
+    struct cabinet_writer *writer = file->writer;
     DWORD written;
 
-    if (WriteFile(handle, pv, cb, &written, NULL))
+    if (writer)
+    {
+        const BYTE *data = pv;
+        UINT left = cb;
+
+        while (left && !cabinet_writer_failed( writer ))
+        {
+            DWORD len = min( left, CABINET_WRITER_BUFFER_SIZE - writer->len );
+
+            memcpy( writer->buffer[writer->current] + writer->len, data, len );
+            writer->len += len;
+            data += len;
+            left -= len;
+            if (writer->len == CABINET_WRITER_BUFFER_SIZE) submit_cabinet_writer( writer );
+        }
+        /* an earlier buffer may have failed to reach the disk */
+        return cabinet_writer_failed( writer ) ? -1 : cb;
+    }
+
+    if (WriteFile(file->handle, pv, cb, &written, NULL) && written == cb)
         return written;
 
-    return 0;
+    file->failed = TRUE;
+    return -1;
 }
 
 static int CDECL cabinet_close(INT_PTR hf)
 {
-    HANDLE handle = (HANDLE)hf;
-    return CloseHandle(handle) ? 0 : -1;
+    struct cabinet_file *file = (struct cabinet_file *)hf;
+    BOOL ret = flush_cabinet_file( file );
+
+    ret = CloseHandle( file->handle ) && ret;
+    free_cabinet_file( file );
+    return ret ? 0 : -1;
 }
 
 static LONG CDECL cabinet_seek(INT_PTR hf, LONG dist, int seektype)
 {
-    HANDLE handle = (HANDLE)hf;
+    HANDLE handle = ((struct cabinet_file *)hf)->handle;
     /* flags are compatible and so are passed straight through */
     return SetFilePointer(handle, dist, NULL, seektype);
 }
@@ -424,9 +605,13 @@ static INT_PTR cabinet_copy_file(FDINOTIFICATIONTYPE fdint,
 {
     MSICABDATA *data = pfdin->pv;
     HANDLE handle = 0;
-    LPWSTR path = NULL;
+    LPWSTR path = NULL, target = NULL;
+    struct cabinet_file *file;
     DWORD attrs;
 
+    /* don't go on after a file couldn't be written */
+    if (data->failed_file) return -1;
+
     data->curfile = strdupAtoW(pfdin->psz1);
     if (!data->cb(data->package, data->curfile, MSICABEXTRACT_BEGINEXTRACT, &path,
                   &attrs, data->user))
@@ -442,6 +627,7 @@ static INT_PTR cabinet_copy_file(FDINOTIFICATIONTYPE fdint,
     attrs = attrs & (FILE_ATTRIBUTE_READONLY|FILE_ATTRIBUTE_HIDDEN|FILE_ATTRIBUTE_SYSTEM);
     if (!attrs) attrs = FILE_ATTRIBUTE_NORMAL;
 
+    target = path;
     handle = CreateFileW(path, GENERIC_READ | GENERIC_WRITE, 0,
                          NULL, CREATE_ALWAYS, attrs, NULL);
     if (handle == INVALID_HANDLE_VALUE)
@@ -470,13 +656,13 @@ static INT_PTR cabinet_copy_file(FDINOTIFICATIONTYPE fdint,
 
             TRACE("file in use, scheduling rename operation\n");
 
-            if (!(tmppathW = strdupW( path ))) return ERROR_OUTOFMEMORY;
+            if (!(tmppathW = strdupW( path ))) goto done;
             if ((p = strrchrW(tmppathW, '\\'))) *p = 0;
             len = strlenW( tmppathW ) + 16;
             if (!(tmpfileW = msi_alloc(len * sizeof(WCHAR))))
             {
                 msi_free( tmppathW );
-                return ERROR_OUTOFMEMORY;
+                goto done;
             }
             if (!GetTempFileNameW(tmppathW, szMsi, 0, tmpfileW)) tmpfileW[0] = 0;
             msi_free( tmppathW );
@@ -494,16 +680,26 @@ static INT_PTR cabinet_copy_file(FDINOTIFICATIONTYPE fdint,
                 WARN("failed to schedule rename operation %s (error %d)\n", debugstr_w(path), GetLastError());
                 DeleteFileW( tmpfileW );
             }
-            msi_free(tmpfileW);
+            /* the data goes to the temporary file */
+            target = tmpfileW;
         }
         else
             WARN("failed to create %s (error %d)\n", debugstr_w(path), err);
     }
 
 done:
-    msi_free(path);
+    if (!handle || handle == INVALID_HANDLE_VALUE || !(file = create_cabinet_file( handle )))
+    {
+        if (target != path) msi_free(target);
+        msi_free(path);
+        return handle ? -1 : 0;
+    }
+    file->path = target;
+    if (target != path) msi_free(path);
+    if (pfdin->cb >= CABINET_WRITER_BUFFER_SIZE)
+        file->writer = start_cabinet_writer( handle, pfdin->cb );
 
-    return (INT_PTR)handle;
+    return (INT_PTR)file;
 }
 
 static INT_PTR cabinet_close_file_info(FDINOTIFICATIONTYPE fdint,
@@ -512,10 +708,23 @@ static INT_PTR cabinet_close_file_info(FDINOTIFICATIONTYPE fdint,
     MSICABDATA *data = pfdin->pv;
     FILETIME ft;
     FILETIME ftLocal;
-    HANDLE handle = (HANDLE)pfdin->hf;
+    struct cabinet_file *file = (struct cabinet_file *)pfdin->hf;
+    HANDLE handle = file->handle;
 
     data->mi->is_continuous = FALSE;
 
+    /* FDI ignores our result, msi_cabextract fails the extraction and removes the file */
+    if (!flush_cabinet_file( file ))
+    {
+        ERR("failed to write %s\n", debugstr_w(data->curfile));
+        CloseHandle(handle);
+        data->failed_file = file->path;
+        file->path = NULL;
+        free_cabinet_file( file );
+        return -1;
+    }
+    free_cabinet_file( file );
+
     if (!DosDateTimeToFileTime(pfdin->date, pfdin->time, &ft))
         return -1;
     if (!LocalFileTimeToFileTime(&ft, &ftLocal))
@@ -655,11 +864,25 @@ static BOOL extract_cabinet_stream( MSIPACKAGE *package, MSIMEDIAINFO *mi, LPVOI
  */
 BOOL msi_cabextract(MSIPACKAGE* package, MSIMEDIAINFO *mi, LPVOID data)
 {
+    MSICABDATA *cab_data = data;
+    BOOL ret;
+
+    cab_data->failed_file = NULL;
     if (mi->cabinet[0] == '#')
+        ret = extract_cabinet_stream( package, mi, data );
+    else
+        ret = extract_cabinet( package, mi, data );
+
+    if (cab_data->failed_file)
     {
-        return extract_cabinet_stream( package, mi, data );
+        /* don't leave a truncated file behind */
+        DeleteFileW( cab_data->failed_file );
+        msi_free( cab_data->failed_file );
+        cab_data->failed_file = NULL;
+        mi->is_extracted = FALSE;
+        ret = FALSE;
     }
-    return extract_cabinet( package, mi, data );
+    return ret;
 }
 
 void msi_free_media_info(MSIMEDIAINFO *mi)
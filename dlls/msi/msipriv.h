@@ -1057,6 +1057,7 @@ typedef struct
     PMSICABEXTRACTCB cb;
     LPWSTR curfile;
     PVOID user;
+    LPWSTR failed_file; /* extracted file that couldn't be written */
 } MSICABDATA;
 
 extern UINT ready_media(MSIPACKAGE *package, BOOL compressed, MSIMEDIAINFO *mi) DECLSPEC_HIDDEN;
@@ -41,7 +41,7 @@
 
 WINE_DEFAULT_DEBUG_CHANNEL(msidb);
 
-#define MSITABLE_HASH_TABLE_SIZE 37
+#define MSITABLE_HASH_TABLE_SIZE 37 /* minimum number of buckets */
 
 typedef struct tagMSICOLUMNHASHENTRY
 {
@@ -60,6 +60,7 @@ typedef struct tagMSICOLUMNINFO
     INT     ref_count;
     BOOL    temporary;
     MSICOLUMNHASHENTRY **hash_table;
+    UINT    hash_size;
 } MSICOLUMNINFO;
 
 struct tagMSITABLE
@@ -1652,6 +1653,13 @@ static UINT TABLE_insert_row( struct tagMSIVIEW *view, MSIRECORD *rec, UINT row,
         tv->table->data_persistent[i] = tv->table->data_persistent[i - 1];
     }
 
+    /* reset the hash tables, the row numbers have changed */
+    for (i = 0; i < tv->num_cols; i++)
+    {
+        msi_free( tv->columns[i].hash_table );
+        tv->columns[i].hash_table = NULL;
+    }
+
     /* Re-set the persistence flag */
     tv->table->data_persistent[row] = !temporary;
     return TABLE_set_row( view, row, rec, (1<<tv->num_cols) - 1 );
@@ -1875,6 +1883,7 @@ static UINT TABLE_find_matching_rows( struct tagMSIVIEW *view, UINT col,
     {
         UINT i;
         UINT num_rows = tv->table->row_count;
+        UINT hash_size = max( num_rows | 1, MSITABLE_HASH_TABLE_SIZE );
         MSICOLUMNHASHENTRY **hash_table;
         MSICOLUMNHASHENTRY *new_entry;
 
@@ -1887,40 +1896,36 @@ static UINT TABLE_find_matching_rows( struct tagMSIVIEW *view, UINT col,
 
         /* allocate contiguous memory for the table and its entries so we
          * don't have to do an expensive cleanup */
-        hash_table = msi_alloc(MSITABLE_HASH_TABLE_SIZE * sizeof(MSICOLUMNHASHENTRY*) +
+        hash_table = msi_alloc(hash_size * sizeof(MSICOLUMNHASHENTRY*) +
             num_rows * sizeof(MSICOLUMNHASHENTRY));
         if (!hash_table)
             return ERROR_OUTOFMEMORY;
 
-        memset(hash_table, 0, MSITABLE_HASH_TABLE_SIZE * sizeof(MSICOLUMNHASHENTRY*));
+        memset(hash_table, 0, hash_size * sizeof(MSICOLUMNHASHENTRY*));
         tv->columns[col-1].hash_table = hash_table;
+        tv->columns[col-1].hash_size = hash_size;
 
-        new_entry = (MSICOLUMNHASHENTRY *)(hash_table + MSITABLE_HASH_TABLE_SIZE);
+        new_entry = (MSICOLUMNHASHENTRY *)(hash_table + hash_size) + num_rows;
 
-        for (i = 0; i < num_rows; i++, new_entry++)
+        /* insert the rows backwards at the head of the buckets, so that
+         * each bucket is in row order */
+        for (i = num_rows; i > 0; i--)
         {
             UINT row_value;
 
-            if (view->ops->fetch_int( view, i, col, &row_value ) != ERROR_SUCCESS)
+            new_entry--;
+            if (view->ops->fetch_int( view, i - 1, col, &row_value ) != ERROR_SUCCESS)
                 continue;
 
-            new_entry->next = NULL;
             new_entry->value = row_value;
-            new_entry->row = i;
-            if (hash_table[row_value % MSITABLE_HASH_TABLE_SIZE])
-            {
-                MSICOLUMNHASHENTRY *prev_entry = hash_table[row_value % MSITABLE_HASH_TABLE_SIZE];
-                while (prev_entry->next)
-                    prev_entry = prev_entry->next;
-                prev_entry->next = new_entry;
-            }
-            else
-                hash_table[row_value % MSITABLE_HASH_TABLE_SIZE] = new_entry;
+            new_entry->row = i - 1;
+            new_entry->next = hash_table[row_value % hash_size];
+            hash_table[row_value % hash_size] = new_entry;
         }
     }
 
     if( !*handle )
-        entry = tv->columns[col-1].hash_table[val % MSITABLE_HASH_TABLE_SIZE];
+        entry = tv->columns[col-1].hash_table[val % tv->columns[col-1].hash_size];
     else
         entry = (*handle)->next;
 
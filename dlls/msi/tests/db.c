@@ -2136,6 +2136,112 @@ static void test_where(void)
     MsiViewClose(view);
     MsiCloseHandle(view);
 
+    rec = MsiCreateRecord(2);
+    MsiRecordSetInteger(rec, 1, 1);
+    MsiRecordSetStringA(rec, 2, "one.cab");
+
+    query = "SELECT `DiskId` FROM `Media` WHERE `LastSequence` = ? AND `Cabinet` = ?";
+    r = MsiDatabaseOpenViewA(hdb, query, &view);
+    ok(r == ERROR_SUCCESS, "Expected ERROR_SUCCESS, got %d\n", r);
+    r = MsiViewExecute(view, rec);
+    ok(r == ERROR_SUCCESS, "Expected ERROR_SUCCESS, got %d\n", r);
+
+    MsiCloseHandle(rec);
+
+    r = MsiViewFetch(view, &rec);
+    ok(r == ERROR_SUCCESS, "Expected ERROR_SUCCESS, got %d\n", r);
+    r = MsiRecordGetInteger(rec, 1);
+    ok(r == 2, "Expected 2, got %d\n", r);
+    MsiCloseHandle(rec);
+
+    r = MsiViewFetch(view, &rec);
+    ok(r == ERROR_NO_MORE_ITEMS, "Expected ERROR_NO_MORE_ITEMS, got %d\n", r);
+
+    MsiViewClose(view);
+
+    rec = MsiCreateRecord(2);
+    MsiRecordSetInteger(rec, 1, 1);
+    MsiRecordSetStringA(rec, 2, "two.cab");
+
+    r = MsiViewExecute(view, rec);
+    ok(r == ERROR_SUCCESS, "Expected ERROR_SUCCESS, got %d\n", r);
+
+    MsiCloseHandle(rec);
+
+    r = MsiViewFetch(view, &rec);
+    ok(r == ERROR_NO_MORE_ITEMS, "Expected ERROR_NO_MORE_ITEMS, got %d\n", r);
+
+    MsiViewClose(view);
+    MsiCloseHandle(view);
+
+    r = run_query( hdb, 0,
+            "CREATE TABLE `Disk` ("
+            "`Id` SHORT NOT NULL, "
+            "`Sequence` LONG, "
+            "`Name` CHAR(32) "
+            "PRIMARY KEY `Id`)" );
+    ok( r == S_OK, "cannot create Disk table: %d\n", r );
+
+    r = run_query( hdb, 0, "INSERT INTO `Disk` ( `Id`, `Sequence`, `Name` ) VALUES ( 1, 1, 'first' )" );
+    ok( r == S_OK, "cannot add row to the Disk table: %d\n", r );
+    r = run_query( hdb, 0, "INSERT INTO `Disk` ( `Id`, `Sequence`, `Name` ) VALUES ( 2, 2, 'second' )" );
+    ok( r == S_OK, "cannot add row to the Disk table: %d\n", r );
+
+    /* the join condition and the name lookup both compare columns for equality */
+    query = "SELECT `Media`.`Cabinet` FROM `Media`, `Disk` "
+            "WHERE `Media`.`LastSequence` = `Disk`.`Sequence` AND `Disk`.`Name` = ?";
+    r = MsiDatabaseOpenViewA(hdb, query, &view);
+    ok(r == ERROR_SUCCESS, "Expected ERROR_SUCCESS, got %d\n", r);
+
+    rec = MsiCreateRecord(1);
+    MsiRecordSetStringA(rec, 1, "second");
+    r = MsiViewExecute(view, rec);
+    ok(r == ERROR_SUCCESS, "Expected ERROR_SUCCESS, got %d\n", r);
+    MsiCloseHandle(rec);
+
+    r = MsiViewFetch(view, &rec);
+    ok(r == ERROR_SUCCESS, "Expected ERROR_SUCCESS, got %d\n", r);
+    ok( check_record( rec, 1, "two.cab"), "wrong cabinet\n");
+    MsiCloseHandle(rec);
+
+    r = MsiViewFetch(view, &rec);
+    ok(r == ERROR_NO_MORE_ITEMS, "Expected ERROR_NO_MORE_ITEMS, got %d\n", r);
+    MsiViewClose(view);
+
+    /* changing the key columns must be seen by the next execution */
+    r = run_query( hdb, 0, "UPDATE `Disk` SET `Sequence` = 0 WHERE `Name` = 'second'" );
+    ok( r == S_OK, "cannot update the Disk table: %d\n", r );
+
+    rec = MsiCreateRecord(1);
+    MsiRecordSetStringA(rec, 1, "second");
+    r = MsiViewExecute(view, rec);
+    ok(r == ERROR_SUCCESS, "Expected ERROR_SUCCESS, got %d\n", r);
+    MsiCloseHandle(rec);
+
+    r = MsiViewFetch(view, &rec);
+    ok(r == ERROR_SUCCESS, "Expected ERROR_SUCCESS, got %d\n", r);
+    ok( check_record( rec, 1, "zero.cab"), "wrong cabinet\n");
+    MsiCloseHandle(rec);
+
+    r = MsiViewFetch(view, &rec);
+    ok(r == ERROR_NO_MORE_ITEMS, "Expected ERROR_NO_MORE_ITEMS, got %d\n", r);
+    MsiViewClose(view);
+
+    r = run_query( hdb, 0, "UPDATE `Media` SET `LastSequence` = 5 WHERE `DiskId` = 1" );
+    ok( r == S_OK, "cannot update the Media table: %d\n", r );
+
+    rec = MsiCreateRecord(1);
+    MsiRecordSetStringA(rec, 1, "second");
+    r = MsiViewExecute(view, rec);
+    ok(r == ERROR_SUCCESS, "Expected ERROR_SUCCESS, got %d\n", r);
+    MsiCloseHandle(rec);
+
+    r = MsiViewFetch(view, &rec);
+    ok(r == ERROR_NO_MORE_ITEMS, "Expected ERROR_NO_MORE_ITEMS, got %d\n", r);
+
+    MsiViewClose(view);
+    MsiCloseHandle(view);
+
     MsiCloseHandle( hdb );
     DeleteFileA(msifile);
 }
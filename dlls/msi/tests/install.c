@@ -3315,6 +3315,55 @@ error:
     DeleteFileA(msifile);
 }
 
+static void test_unwritable_target_cab(void)
+{
+    CHAR path[MAX_PATH];
+    DWORD attrs;
+    UINT r;
+
+    if (is_process_limited())
+    {
+        skip("process is limited\n");
+        return;
+    }
+
+    /* large enough to be written in the background */
+    CreateDirectoryA("msitest", NULL);
+    create_file("maximus", 0x180000);
+    create_cab_file("test1.cab", MEDIA_SIZE, "maximus\0");
+    DeleteFileA("maximus");
+
+    create_database(msifile, rofc_tables, sizeof(rofc_tables) / sizeof(msi_table));
+
+    MsiSetInternalUI(INSTALLUILEVEL_NONE, NULL);
+
+    /* a directory is in the way of the target file */
+    lstrcpyA(path, PROG_FILES_DIR);
+    lstrcatA(path, "\\msitest");
+    CreateDirectoryA(path, NULL);
+    lstrcatA(path, "\\maximus");
+    CreateDirectoryA(path, NULL);
+
+    r = MsiInstallProductA(msifile, NULL);
+    if (r == ERROR_INSTALL_PACKAGE_REJECTED)
+    {
+        skip("Not enough rights to perform tests\n");
+        goto error;
+    }
+    ok(r == ERROR_INSTALL_FAILURE, "Expected ERROR_INSTALL_FAILURE, got %u\n", r);
+
+    attrs = GetFileAttributesA(path);
+    ok(attrs != INVALID_FILE_ATTRIBUTES && (attrs & FILE_ATTRIBUTE_DIRECTORY),
+       "Expected the directory to be left alone, got %08x\n", attrs);
+
+error:
+    delete_pf("msitest\\maximus", FALSE);
+    delete_pf("msitest", FALSE);
+    delete_cab_files();
+    RemoveDirectoryA("msitest");
+    DeleteFileA(msifile);
+}
+
 static void test_setdirproperty(void)
 {
     UINT r;
@@ -5900,6 +5949,7 @@ START_TEST(install)
     test_uiLevelFlags();
     test_readonlyfile();
     test_readonlyfile_cab();
+    test_unwritable_target_cab();
     test_setdirproperty();
     test_cabisextracted();
     test_transformprop();
@@ -52,6 +52,7 @@ typedef struct tagJOINTABLE
     UINT col_count;
     UINT row_count;
     UINT table_index;
+    BOOL has_hash; /* whether find_matching_rows uses a hash of the column */
 } JOINTABLE;
 
 typedef struct tagMSIORDERINFO
@@ -599,15 +600,148 @@ static UINT WHERE_evaluate( MSIWHEREVIEW *wv, const UINT rows[],
     return ERROR_SUCCESS;
 }
 
+static UINT count_wildcards( const struct expr *expr )
+{
+    switch (expr->type)
+    {
+    case EXPR_WILDCARD:
+        return 1;
+    case EXPR_COMPLEX:
+    case EXPR_STRCMP:
+        return count_wildcards( expr->u.expr.left ) + count_wildcards( expr->u.expr.right );
+    default:
+        return 0;
+    }
+}
+
+/* gets the value that a column of the given type must have to be equal to
+ * expr, as it is stored in the table, if it is known before iterating over
+ * the rows of table */
+static BOOL get_lookup_value( MSIWHEREVIEW *wv, const struct expr *expr, UINT type,
+                              JOINTABLE *table, const UINT rows[], MSIRECORD *record,
+                              UINT wildcard, UINT *value )
+{
+    const WCHAR *str;
+    JOINTABLE *other;
+
+    switch (expr->type)
+    {
+    case EXPR_UVAL:
+        if (type == EXPR_COL_NUMBER)
+            *value = expr->u.uval + 0x8000;
+        else if (type == EXPR_COL_NUMBER32)
+            *value = expr->u.uval + 0x80000000;
+        else
+            return FALSE;
+        return TRUE;
+
+    case EXPR_SVAL:
+    case EXPR_WILDCARD:
+        if (type != EXPR_COL_NUMBER_STRING)
+        {
+            if (expr->type == EXPR_SVAL)
+                return FALSE;
+            *value = MSI_RecordGetInteger( record, wildcard );
+            *value += (type == EXPR_COL_NUMBER) ? 0x8000 : 0x80000000;
+            return TRUE;
+        }
+        str = (expr->type == EXPR_SVAL) ? expr->u.sval : MSI_RecordGetString( record, wildcard );
+        /* empty strings compare equal to null strings */
+        if (!str || !*str)
+            return FALSE;
+        /* no row can match a string that isn't in the string table */
+        if (msi_string2id( wv->db->strings, str, -1, value ) != ERROR_SUCCESS)
+            *value = ~0u;
+        return TRUE;
+
+    case EXPR_COL_NUMBER:
+    case EXPR_COL_NUMBER32:
+    case EXPR_COL_NUMBER_STRING:
+        other = expr->u.column.parsed.table;
+        if (expr->type != type || other == table ||
+            rows[other->table_index] == INVALID_ROW_INDEX)
+            return FALSE;
+        return other->view->ops->fetch_int( other->view, rows[other->table_index],
+                                            expr->u.column.parsed.column, value ) == ERROR_SUCCESS;
+
+    default:
+        return FALSE;
+    }
+}
+
+/* looks for an equality between a column of table and a known value that the
+ * whole condition depends on, so that only the rows of table with that value
+ * need to be checked */
+static BOOL find_lookup_column( MSIWHEREVIEW *wv, const struct expr *cond, JOINTABLE *table,
+                                const UINT rows[], MSIRECORD *record, UINT *wildcard,
+                                UINT *column, UINT *value )
+{
+    const struct expr *left, *right;
+    UINT first = *wildcard;
+
+    if (cond->type == EXPR_COMPLEX && cond->u.expr.op == OP_AND)
+    {
+        if (find_lookup_column( wv, cond->u.expr.left, table, rows, record, wildcard, column, value ))
+            return TRUE;
+        return find_lookup_column( wv, cond->u.expr.right, table, rows, record, wildcard, column, value );
+    }
+
+    *wildcard = first + count_wildcards( cond );
+
+    if ((cond->type != EXPR_COMPLEX && cond->type != EXPR_STRCMP) || cond->u.expr.op != OP_EQ)
+        return FALSE;
+
+    left = cond->u.expr.left;
+    right = cond->u.expr.right;
+
+    if ((left->type == EXPR_COL_NUMBER || left->type == EXPR_COL_NUMBER32 ||
+         left->type == EXPR_COL_NUMBER_STRING) && left->u.column.parsed.table == table &&
+        get_lookup_value( wv, right, left->type, table, rows, record,
+                          first + count_wildcards( left ) + 1, value ))
+    {
+        *column = left->u.column.parsed.column;
+        return TRUE;
+    }
+
+    if ((right->type == EXPR_COL_NUMBER || right->type == EXPR_COL_NUMBER32 ||
+         right->type == EXPR_COL_NUMBER_STRING) && right->u.column.parsed.table == table &&
+        get_lookup_value( wv, left, right->type, table, rows, record, first + 1, value ))
+    {
+        *column = right->u.column.parsed.column;
+        return TRUE;
+    }
+
+    return FALSE;
+}
+
 static UINT check_condition( MSIWHEREVIEW *wv, MSIRECORD *record, JOINTABLE **tables,
                              UINT table_rows[] )
 {
+    JOINTABLE *table = *tables;
     UINT r = ERROR_FUNCTION_FAILED;
+    UINT wildcard = 0, column, value;
+    MSIITERHANDLE handle = NULL;
+    BOOL lookup = FALSE;
     INT val;
 
-    for (table_rows[(*tables)->table_index] = 0;
-         table_rows[(*tables)->table_index] < (*tables)->row_count;
-         table_rows[(*tables)->table_index]++)
+    /* use the column's hash table instead of scanning the whole table if
+     * the condition requires the column to have a given value */
+    if (table->has_hash && wv->cond && find_lookup_column( wv, wv->cond, table, table_rows, record,
+                                        &wildcard, &column, &value ))
+    {
+        r = table->view->ops->find_matching_rows( table->view, column, value,
+                                                  &table_rows[table->table_index], &handle );
+        if (r == ERROR_NO_MORE_ITEMS)
+        {
+            table_rows[table->table_index] = INVALID_ROW_INDEX;
+            return ERROR_SUCCESS;
+        }
+        lookup = (r == ERROR_SUCCESS);
+    }
+    if (!lookup)
+        table_rows[table->table_index] = 0;
+
+    for (;;)
     {
         val = 0;
         wv->rec_index = 0;
@@ -629,8 +763,18 @@ static UINT check_condition( MSIWHEREVIEW *wv, MSIRECORD *record, JOINTABLE **ta
                 add_row (wv, table_rows);
             }
         }
+
+        if (lookup)
+        {
+            if (table->view->ops->find_matching_rows( table->view, column, value,
+                                                      &table_rows[table->table_index],
+                                                      &handle ) != ERROR_SUCCESS)
+                break;
+        }
+        else if (++table_rows[table->table_index] >= table->row_count)
+            break;
     }
-    table_rows[(*tables)->table_index] = INVALID_ROW_INDEX;
+    table_rows[table->table_index] = INVALID_ROW_INDEX;
     return r;
 }
 
@@ -1258,6 +1402,9 @@ UINT WHERE_CreateView( MSIDATABASE *db, MSIVIEW **view, LPWSTR tables,
             goto end;
         }
 
+        /* the _Streams and _Storages views only scan their name column */
+        table->has_hash = strcmpW(tables, szStreams) && strcmpW(tables, szStorages);
+
         wv->col_count += table->col_count;
         table->table_index = wv->table_count++;
 
@@ -123,6 +123,9 @@ static unsigned long (__cdecl *p_byteswap_ulong)(unsigned long);
 static void** (__cdecl *p__pxcptinfoptrs)(void);
 static void* (__cdecl *p__AdjustPointer)(void*, const void*);
 static int (__cdecl *p_fflush_nolock)(FILE*);
+static int (__cdecl *p_fputc_nolock)(int, FILE*);
+static size_t (__cdecl *p_fwrite_nolock)(const void*, size_t, size_t, FILE*);
+static size_t (__cdecl *p_fread_nolock)(void*, size_t, size_t, FILE*);
 
 /* make sure we use the correct errno */
 #undef errno
@@ -383,6 +386,9 @@ static BOOL init(void)
     SET(p__pxcptinfoptrs, "__pxcptinfoptrs");
     SET(p__AdjustPointer, "__AdjustPointer");
     SET(p_fflush_nolock, "_fflush_nolock");
+    SET(p_fputc_nolock, "_fputc_nolock");
+    SET(p_fwrite_nolock, "_fwrite_nolock");
+    SET(p_fread_nolock, "_fread_nolock");
     if (sizeof(void *) == 8)
     {
         SET(p_type_info_name_internal_method, "?_name_internal_method@type_info@@QEBAPEBDPEAU__type_info_node@@@Z");
@@ -1237,6 +1243,7 @@ static void test_nonblocking_file_access(void)
     HANDLE thread;
     struct block_file_arg arg;
     FILE *filer, *filew;
+    char buf[16];
     int ret;
 
     if(!p_lock_file || !p_unlock_file) {
@@ -1297,6 +1304,11 @@ static void test_nonblocking_file_access(void)
     ret = p_fflush_nolock(filew);
     ok(ret==0, "_fflush_nolock(filew) returned %d\n", ret);
 
+    ret = p_fputc_nolock('b', filew);
+    ok(ret=='b', "_fputc_nolock(filew) returned %d\n", ret);
+    ret = p_fwrite_nolock("c\n", 1, 2, filew);
+    ok(ret==2, "_fwrite_nolock(filew) returned %d\n", ret);
+
     SetEvent(arg.finish);
 
     ret = p_fflush_nolock(NULL);
@@ -1310,6 +1322,14 @@ static void test_nonblocking_file_access(void)
     CloseHandle(thread);
     p_fclose(filer);
     p_fclose(filew);
+
+    /* the text mode translation still applies without the lock */
+    filer = p_fopen("test_file", "rb");
+    ok(filer != NULL, "unable to open test file\n");
+    ret = p_fread_nolock(buf, 1, sizeof(buf), filer);
+    ok(ret==5, "_fread_nolock(filer) returned %d\n", ret);
+    ok(!memcmp(buf, "abc\r\n", 5), "wrong data read\n");
+    p_fclose(filer);
     p_unlink("test_file");
 }
 
@@ -3316,21 +3316,25 @@ int CDECL MSVCRT__write(int fd, const void* buf, unsigned int count)
 
         if (!(info->exflag & (EF_UTF8|EF_UTF16)))
         {
+            const char *lf;
+
             /* find number of \n */
-            for (nr_lf=0, i=0; i<count; i++)
-                if (s[i] == '\n')
-                    nr_lf++;
+            for (nr_lf=0, lf=memchr(s, '\n', count); lf; lf=memchr(lf+1, '\n', s+count-lf-1))
+                nr_lf++;
             if (nr_lf)
             {
                 size = count+nr_lf;
                 if ((q = p = MSVCRT_malloc(size)))
                 {
-                    for (s = buf, i = 0, j = 0; i < count; i++)
+                    /* copy the text between line feeds in bulk */
+                    for (i = 0, j = 0; (lf = memchr(s+i, '\n', count-i)); i += lf-(s+i)+1)
                     {
-                        if (s[i] == '\n')
-                            p[j++] = '\r';
-                        p[j++] = s[i];
+                        memcpy(p+j, s+i, lf-(s+i));
+                        j += lf-(s+i);
+                        p[j++] = '\r';
+                        p[j++] = '\n';
                     }
+                    memcpy(p+j, s+i, count-i);
                 }
                 else
                 {
@@ -4839,31 +4843,24 @@ int CDECL MSVCRT_tmpfile_s(MSVCRT_FILE** file)
     return 0;
 }
 
+/* the printf callbacks are called with the file already locked */
 static int puts_clbk_file_a(void *file, int len, const char *str)
 {
-    return MSVCRT_fwrite(str, sizeof(char), len, file);
+    return MSVCRT__fwrite_nolock(str, sizeof(char), len, file);
 }
 
 static int puts_clbk_file_w(void *file, int len, const MSVCRT_wchar_t *str)
 {
-    int i, ret;
-
-    MSVCRT__lock_file(file);
+    int i;
 
-    if(!(get_ioinfo_nolock(((MSVCRT_FILE*)file)->_file)->wxflag & WX_TEXT)) {
-        ret = MSVCRT__fwrite_nolock(str, sizeof(MSVCRT_wchar_t), len, file);
-        MSVCRT__unlock_file(file);
-        return ret;
-    }
+    if(!(get_ioinfo_nolock(((MSVCRT_FILE*)file)->_file)->wxflag & WX_TEXT))
+        return MSVCRT__fwrite_nolock(str, sizeof(MSVCRT_wchar_t), len, file);
 
     for(i=0; i<len; i++) {
-        if(MSVCRT__fputwc_nolock(str[i], file) == MSVCRT_WEOF) {
-            MSVCRT__unlock_file(file);
+        if(MSVCRT__fputwc_nolock(str[i], file) == MSVCRT_WEOF)
             return -1;
-        }
     }
 
-    MSVCRT__unlock_file(file);
     return len;
 }
 
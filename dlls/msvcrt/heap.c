@@ -22,7 +22,9 @@
  */
 
 #include "msvcrt.h"
+#include "winreg.h"
 #include "mtdll.h"
+#include "wine/list.h"
 #include "wine/debug.h"
 
 WINE_DEFAULT_DEBUG_CHANNEL(msvcrt);
@@ -52,6 +54,268 @@ static unsigned int MSVCRT_amblksiz = 16;
 /* FIXME - According to documentation it should be 480 bytes, at runtime default is 0 */
 static MSVCRT_size_t MSVCRT_sbh_threshold = 0;
 
+/* Thread caching allocator for small blocks, enabled with the HeapCache registry value.
+ *
+ * Small blocks are carved from 64k slabs in a reserved region, each slab holding
+ * objects of a single size class. Every thread keeps a magazine of free objects
+ * per size class, so that most allocations don't need any lock. Freed objects go
+ * to the magazine of the freeing thread, and full magazines are drained back to
+ * the slabs. The requested sizes are kept in the slab header for _msize and
+ * _heapwalk, the objects themselves never contain any bookkeeping data.
+ */
+#define HEAP_CACHE_GRANULARITY 16
+#define HEAP_CACHE_CLASSES     16
+#define HEAP_CACHE_MAX_SIZE    (HEAP_CACHE_CLASSES * HEAP_CACHE_GRANULARITY)
+#define HEAP_MAGAZINE_SIZE     32
+#define HEAP_SLAB_SIZE         0x10000
+#ifdef _WIN64
+#define HEAP_CACHE_REGION_SIZE 0x40000000
+#else
+#define HEAP_CACHE_REGION_SIZE 0x4000000
+#endif
+
+/* class, count, objects and sizes are set before the slab is published and never change
+ * afterwards, so they can be used without holding heap_cache_cs */
+struct heap_slab
+{
+    struct list     entry;        /* entry in the list of slabs with free objects */
+    unsigned int    class;        /* size class of the objects */
+    unsigned int    count;        /* number of objects in the slab */
+    unsigned int    nb_free;      /* number of objects in the free list */
+    char           *objects;      /* start of the objects */
+    unsigned short *sizes;        /* requested size of each object, 0 if free */
+    unsigned short  free_list[1]; /* indices of the free objects */
+};
+
+struct heap_magazine
+{
+    unsigned int count;
+    void        *objects[HEAP_MAGAZINE_SIZE];
+};
+
+struct heap_cache
+{
+    struct heap_magazine magazines[HEAP_CACHE_CLASSES];
+};
+
+static char *heap_cache_base;           /* reserved region, NULL if the cache is disabled */
+static LONG heap_cache_slabs;           /* number of published slabs */
+static struct list heap_cache_partial[HEAP_CACHE_CLASSES];
+
+static CRITICAL_SECTION heap_cache_cs;
+static CRITICAL_SECTION_DEBUG heap_cache_cs_debug =
+{
+    0, 0, &heap_cache_cs,
+    { &heap_cache_cs_debug.ProcessLocksList, &heap_cache_cs_debug.ProcessLocksList },
+      0, 0, { (DWORD_PTR)(__FILE__ ": heap_cache_cs") }
+};
+static CRITICAL_SECTION heap_cache_cs = { &heap_cache_cs_debug, -1, 0, 0, 0, 0 };
+
+static inline BOOL heap_cache_contains(const void *ptr)
+{
+    return heap_cache_base &&
+        (DWORD_PTR)((const char *)ptr - heap_cache_base) <
+        (DWORD_PTR)*(volatile LONG *)&heap_cache_slabs * HEAP_SLAB_SIZE;
+}
+
+static inline unsigned int heap_cache_object_size(const struct heap_slab *slab)
+{
+    return (slab->class + 1) * HEAP_CACHE_GRANULARITY;
+}
+
+static inline struct heap_slab *heap_cache_slab(const void *ptr, unsigned int *index)
+{
+    DWORD_PTR offset = (const char *)ptr - heap_cache_base;
+    struct heap_slab *slab = (struct heap_slab *)(heap_cache_base + (offset & ~(DWORD_PTR)(HEAP_SLAB_SIZE - 1)));
+
+    *index = ((const char *)ptr - slab->objects) / heap_cache_object_size(slab);
+    return slab;
+}
+
+/* commit a new slab, must be called with heap_cache_cs held */
+static struct heap_slab *heap_cache_new_slab(unsigned int class)
+{
+    unsigned int size = (class + 1) * HEAP_CACHE_GRANULARITY, count, i;
+    struct heap_slab *slab;
+
+    if ((heap_cache_slabs + 1) * (DWORD_PTR)HEAP_SLAB_SIZE > HEAP_CACHE_REGION_SIZE)
+        return NULL;
+    slab = (struct heap_slab *)(heap_cache_base + heap_cache_slabs * (DWORD_PTR)HEAP_SLAB_SIZE);
+    if (!VirtualAlloc(slab, HEAP_SLAB_SIZE, MEM_COMMIT, PAGE_READWRITE))
+        return NULL;
+
+    /* every object also needs an entry in the free list and in the sizes array */
+    count = (HEAP_SLAB_SIZE - FIELD_OFFSET(struct heap_slab, free_list) - HEAP_CACHE_GRANULARITY) /
+            (size + 2 * sizeof(unsigned short));
+    slab->class = class;
+    slab->count = slab->nb_free = count;
+    slab->sizes = slab->free_list + count;
+    slab->objects = (char *)(((DWORD_PTR)(slab->sizes + count) + HEAP_CACHE_GRANULARITY - 1) &
+                             ~(DWORD_PTR)(HEAP_CACHE_GRANULARITY - 1));
+    for (i = 0; i < count; i++) slab->free_list[i] = count - 1 - i;
+    list_add_head(&heap_cache_partial[class], &slab->entry);
+    /* publish the slab only once its header is complete */
+    InterlockedIncrement(&heap_cache_slabs);
+    return slab;
+}
+
+static void heap_cache_refill(struct heap_magazine *mag, unsigned int class)
+{
+    unsigned int size = (class + 1) * HEAP_CACHE_GRANULARITY;
+    struct heap_slab *slab;
+
+    EnterCriticalSection(&heap_cache_cs);
+    while (mag->count < HEAP_MAGAZINE_SIZE / 2)
+    {
+        if (list_empty(&heap_cache_partial[class]) && !heap_cache_new_slab(class))
+            break;
+        slab = LIST_ENTRY(list_head(&heap_cache_partial[class]), struct heap_slab, entry);
+        while (slab->nb_free && mag->count < HEAP_MAGAZINE_SIZE / 2)
+            mag->objects[mag->count++] = slab->objects + slab->free_list[--slab->nb_free] * size;
+        if (!slab->nb_free) list_remove(&slab->entry);
+    }
+    LeaveCriticalSection(&heap_cache_cs);
+}
+
+static void heap_cache_drain(struct heap_magazine *mag, unsigned int keep)
+{
+    struct heap_slab *slab;
+    unsigned int index;
+
+    EnterCriticalSection(&heap_cache_cs);
+    while (mag->count > keep)
+    {
+        slab = heap_cache_slab(mag->objects[--mag->count], &index);
+        if (!slab->nb_free) list_add_tail(&heap_cache_partial[slab->class], &slab->entry);
+        slab->free_list[slab->nb_free++] = index;
+    }
+    LeaveCriticalSection(&heap_cache_cs);
+}
+
+static struct heap_cache *heap_cache_get(BOOL create)
+{
+    thread_data_t *data = msvcrt_get_thread_data();
+
+    if (!data->heap_cache && create)
+        data->heap_cache = HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, sizeof(*data->heap_cache));
+    return data->heap_cache;
+}
+
+static void *heap_cache_alloc(DWORD flags, MSVCRT_size_t size)
+{
+    unsigned int class = (size - 1) / HEAP_CACHE_GRANULARITY, index;
+    struct heap_cache *cache = heap_cache_get(TRUE);
+    struct heap_magazine *mag;
+    struct heap_slab *slab;
+    void *ptr;
+
+    if (!cache) return NULL;
+    mag = &cache->magazines[class];
+    if (!mag->count) heap_cache_refill(mag, class);
+    if (!mag->count) return NULL;
+
+    ptr = mag->objects[--mag->count];
+    slab = heap_cache_slab(ptr, &index);
+    slab->sizes[index] = size;
+    if (flags & HEAP_ZERO_MEMORY) memset(ptr, 0, size);
+    return ptr;
+}
+
+static BOOL heap_cache_free(void *ptr)
+{
+    /* don't create a cache only to hold freed objects, it would be leaked
+     * if the thread's cache has already been released */
+    struct heap_cache *cache = heap_cache_get(FALSE);
+    struct heap_magazine *mag, tmp;
+    struct heap_slab *slab;
+    unsigned int index;
+
+    slab = heap_cache_slab(ptr, &index);
+    if (!slab->sizes[index])
+    {
+        WARN("%p is already free\n", ptr);
+        return FALSE;
+    }
+    slab->sizes[index] = 0;
+
+    if (!cache)
+    {
+        tmp.count = 1;
+        tmp.objects[0] = ptr;
+        heap_cache_drain(&tmp, 0);
+        return TRUE;
+    }
+
+    mag = &cache->magazines[slab->class];
+    if (mag->count == HEAP_MAGAZINE_SIZE) heap_cache_drain(mag, HEAP_MAGAZINE_SIZE / 2);
+    mag->objects[mag->count++] = ptr;
+    return TRUE;
+}
+
+static void *heap_cache_realloc(DWORD flags, void *ptr, MSVCRT_size_t size)
+{
+    struct heap_slab *slab;
+    unsigned int index;
+    MSVCRT_size_t old_size;
+    void *ret;
+
+    slab = heap_cache_slab(ptr, &index);
+    if (!(old_size = slab->sizes[index])) return NULL;
+
+    if (size && size <= heap_cache_object_size(slab))
+    {
+        slab->sizes[index] = size;
+        return ptr;
+    }
+    if (flags & HEAP_REALLOC_IN_PLACE_ONLY) return NULL;
+
+    flags &= ~HEAP_REALLOC_IN_PLACE_ONLY;
+    if (size && size <= HEAP_CACHE_MAX_SIZE && (ret = heap_cache_alloc(flags, size)))
+        ;
+    else if (!(ret = HeapAlloc(heap, flags, size)))
+        return NULL;
+    memcpy(ret, ptr, min(old_size, size));
+    heap_cache_free(ptr);
+    return ret;
+}
+
+static int heap_cache_walk(struct MSVCRT__heapinfo *next)
+{
+    unsigned int slab_index = 0, index = 0;
+    struct heap_slab *slab;
+    int ret = MSVCRT__HEAPEND;
+
+    if (next->_pentry)
+    {
+        slab = heap_cache_slab(next->_pentry, &index);
+        slab_index = ((char *)slab - heap_cache_base) / HEAP_SLAB_SIZE;
+        index++;
+    }
+
+    EnterCriticalSection(&heap_cache_cs);
+    for (; slab_index < (unsigned int)heap_cache_slabs; slab_index++, index = 0)
+    {
+        slab = (struct heap_slab *)(heap_cache_base + slab_index * (DWORD_PTR)HEAP_SLAB_SIZE);
+        if (index >= slab->count) continue;
+
+        next->_pentry = (int *)(slab->objects + index * heap_cache_object_size(slab));
+        if (slab->sizes[index])
+        {
+            next->_size = slab->sizes[index];
+            next->_useflag = MSVCRT__USEDENTRY;
+        }
+        else
+        {
+            next->_size = heap_cache_object_size(slab);
+            next->_useflag = MSVCRT__FREEENTRY;
+        }
+        ret = MSVCRT__HEAPOK;
+        break;
+    }
+    LeaveCriticalSection(&heap_cache_cs);
+    return ret;
+}
+
 static void* msvcrt_heap_alloc(DWORD flags, MSVCRT_size_t size)
 {
     if(size < MSVCRT_sbh_threshold)
@@ -67,11 +331,20 @@ static void* msvcrt_heap_alloc(DWORD flags, MSVCRT_size_t size)
         return memblock;
     }
 
+    if(heap_cache_base && size && size <= HEAP_CACHE_MAX_SIZE)
+    {
+        void *ret = heap_cache_alloc(flags, size);
+        if(ret) return ret;
+    }
+
     return HeapAlloc(heap, flags, size);
 }
 
 static void* msvcrt_heap_realloc(DWORD flags, void *ptr, MSVCRT_size_t size)
 {
+    if(heap_cache_contains(ptr))
+        return heap_cache_realloc(flags, ptr, size);
+
     if(sb_heap && ptr && !HeapValidate(heap, 0, ptr))
     {
         /* TODO: move data to normal heap if it exceeds sbh_threshold limit */
@@ -104,6 +377,9 @@ static void* msvcrt_heap_realloc(DWORD flags, void *ptr, MSVCRT_size_t size)
 
 static BOOL msvcrt_heap_free(void *ptr)
 {
+    if(heap_cache_contains(ptr))
+        return heap_cache_free(ptr);
+
     if(sb_heap && ptr && !HeapValidate(heap, 0, ptr))
     {
         void **saved = SAVED_PTR(ptr);
@@ -115,6 +391,13 @@ static BOOL msvcrt_heap_free(void *ptr)
 
 static MSVCRT_size_t msvcrt_heap_size(void *ptr)
 {
+    if(heap_cache_contains(ptr))
+    {
+        unsigned int index;
+        struct heap_slab *slab = heap_cache_slab(ptr, &index);
+        return slab->sizes[index] ? slab->sizes[index] : ~(MSVCRT_size_t)0;
+    }
+
     if(sb_heap && ptr && !HeapValidate(heap, 0, ptr))
     {
         void **saved = SAVED_PTR(ptr);
@@ -286,6 +569,9 @@ int CDECL _heapwalk(struct MSVCRT__heapinfo* next)
   if (sb_heap)
       FIXME("small blocks heap not supported\n");
 
+  if (heap_cache_contains(next->_pentry))
+      return heap_cache_walk(next);
+
   LOCK_HEAP;
   phe.lpData = next->_pentry;
   phe.cbData = next->_size;
@@ -305,7 +591,12 @@ int CDECL _heapwalk(struct MSVCRT__heapinfo* next)
     {
       UNLOCK_HEAP;
       if (GetLastError() == ERROR_NO_MORE_ITEMS)
-         return MSVCRT__HEAPEND;
+      {
+         /* the blocks of the thread cache come after the heap */
+         if (!heap_cache_base) return MSVCRT__HEAPEND;
+         next->_pentry = NULL;
+         return heap_cache_walk(next);
+      }
       msvcrt_set_errno(GetLastError());
       if (!phe.lpData)
         return MSVCRT__HEAPBADBEGIN;
@@ -810,15 +1101,53 @@ int CDECL MSVCRT_strncpy_s(char *dest, MSVCRT_size_t numberOfElements,
     return MSVCRT_EINVAL;
 }
 
+#define IS_OPTION_TRUE(ch) ((ch) == 'y' || (ch) == 'Y' || (ch) == 't' || (ch) == 'T' || (ch) == '1')
+
 BOOL msvcrt_init_heap(void)
 {
+    char buffer[16];
+    DWORD size = sizeof(buffer);
+    BOOL use_cache = FALSE;
+    HKEY hkey;
+    int i;
+
     heap = HeapCreate(0, 0, 0);
+
+    /* @@ Wine registry key: HKCU\Software\Wine\MSVCRT */
+    if (!RegOpenKeyA(HKEY_CURRENT_USER, "Software\\Wine\\MSVCRT", &hkey))
+    {
+        if (!RegQueryValueExA(hkey, "HeapCache", 0, NULL, (LPBYTE)buffer, &size))
+            use_cache = size && IS_OPTION_TRUE(buffer[0]);
+        RegCloseKey(hkey);
+    }
+
+    if (use_cache)
+    {
+        for (i = 0; i < HEAP_CACHE_CLASSES; i++) list_init(&heap_cache_partial[i]);
+        heap_cache_base = VirtualAlloc(NULL, HEAP_CACHE_REGION_SIZE, MEM_RESERVE, PAGE_NOACCESS);
+        TRACE("thread heap cache at %p\n", heap_cache_base);
+    }
     return heap != NULL;
 }
 
+void msvcrt_free_heap_cache(thread_data_t *data)
+{
+    struct heap_cache *cache = data->heap_cache;
+    int i;
+
+    if (!cache) return;
+    /* objects freed while draining go straight back to the slabs */
+    data->heap_cache = NULL;
+    for (i = 0; i < HEAP_CACHE_CLASSES; i++)
+        heap_cache_drain(&cache->magazines[i], 0);
+    HeapFree(GetProcessHeap(), 0, cache);
+}
+
 void msvcrt_destroy_heap(void)
 {
     HeapDestroy(heap);
     if(sb_heap)
         HeapDestroy(sb_heap);
+    if(heap_cache_base)
+        VirtualFree(heap_cache_base, 0, MEM_RELEASE);
 }
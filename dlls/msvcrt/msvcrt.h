@@ -222,6 +222,7 @@ struct __thread_data {
     int                             unk7;
     EXCEPTION_RECORD               *exc_record;
     void                           *unk8[100];
+    struct heap_cache              *heap_cache;         /* small blocks cached by the thread */
 };
 
 typedef struct __thread_data thread_data_t;
@@ -281,6 +282,7 @@ extern void msvcrt_free_signals(void) DECLSPEC_HIDDEN;
 extern void msvcrt_free_popen_data(void) DECLSPEC_HIDDEN;
 extern BOOL msvcrt_init_heap(void) DECLSPEC_HIDDEN;
 extern void msvcrt_destroy_heap(void) DECLSPEC_HIDDEN;
+extern void msvcrt_free_heap_cache(thread_data_t*) DECLSPEC_HIDDEN;
 
 extern unsigned msvcrt_create_io_inherit_block(WORD*, BYTE**) DECLSPEC_HIDDEN;
 
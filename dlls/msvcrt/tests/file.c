@@ -49,6 +49,8 @@ static HANDLE proc_handles[2];
 
 static int (__cdecl *p_fopen_s)(FILE**, const char*, const char*);
 static int (__cdecl *p__wfopen_s)(FILE**, const wchar_t*, const wchar_t*);
+static void (__cdecl *p__lock_file)(FILE*);
+static void (__cdecl *p__unlock_file)(FILE*);
 
 static const char* get_base_name(const char *path)
 {
@@ -71,6 +73,8 @@ static void init(void)
     p_fopen_s = (void*)GetProcAddress(hmod, "fopen_s");
     p__wfopen_s = (void*)GetProcAddress(hmod, "_wfopen_s");
     __pioinfo = (void*)GetProcAddress(hmod, "__pioinfo");
+    p__lock_file = (void*)GetProcAddress(hmod, "_lock_file");
+    p__unlock_file = (void*)GetProcAddress(hmod, "_unlock_file");
 }
 
 static void test_filbuf( void )
@@ -2312,6 +2316,172 @@ static void test_write_flush(void)
     free(tempf);
 }
 
+static void check_text_write(const char *tempf, const char *data, int len)
+{
+    char expect[4096], buf[4096];
+    int fd, ret, i, j;
+
+    for (i = 0, j = 0; i < len; i++)
+    {
+        if (data[i] == '\n') expect[j++] = '\r';
+        expect[j++] = data[i];
+    }
+
+    fd = _open(tempf, _O_CREAT|_O_TRUNC|_O_TEXT|_O_WRONLY, _S_IREAD|_S_IWRITE);
+    ok(fd != -1, "_open failed: %d\n", errno);
+    ret = _write(fd, data, len);
+    ok(ret == len, "_write returned %d, expected %d\n", ret, len);
+    _close(fd);
+
+    fd = _open(tempf, _O_RDONLY|_O_BINARY, 0);
+    ok(fd != -1, "_open failed: %d\n", errno);
+    ret = _read(fd, buf, sizeof(buf));
+    ok(ret == j, "read %d bytes, expected %d\n", ret, j);
+    ok(!memcmp(buf, expect, j), "wrong data written for %d bytes\n", len);
+    _close(fd);
+}
+
+static void test_write_text_lf(void)
+{
+    static const char *tests[] =
+    {
+        "\n", "\n\n", "a\nb", "no line feed", "ends with\n", "\nstarts with", "a\n\n\nb\n"
+    };
+    char big[3000];
+    char *tempf;
+    int i;
+
+    tempf = _tempnam(".","wne");
+
+    for (i = 0; i < sizeof(tests)/sizeof(tests[0]); i++)
+        check_text_write(tempf, tests[i], strlen(tests[i]));
+
+    for (i = 0; i < sizeof(big); i++)
+        big[i] = (i % 7 == 6) ? '\n' : 'a' + i % 26;
+    check_text_write(tempf, big, sizeof(big));
+    check_text_write(tempf, big + 1, sizeof(big) - 2);
+
+    unlink(tempf);
+    free(tempf);
+}
+
+static void test_fprintf_locked(void)
+{
+    static const WCHAR wideW[] = {'%','s','\n',0};
+    static const WCHAR textW[] = {'w','i','d','e',0};
+    static const char wide_binary[] = {'w',0,'i',0,'d',0,'e',0,'\n',0};
+    char long_str[1025], buf[2048];
+    char *tempf;
+    FILE *file;
+    int fd, ret;
+
+    if (!p__lock_file || !p__unlock_file)
+    {
+        win_skip("_lock_file not available\n");
+        return;
+    }
+
+    memset(long_str, 'x', sizeof(long_str) - 1);
+    long_str[sizeof(long_str) - 1] = 0;
+    tempf = _tempnam(".","wne");
+
+    /* the output callbacks run with the stream already locked, possibly more than once */
+    file = fopen(tempf, "w");
+    ok(file != NULL, "unable to create test file\n");
+    p__lock_file(file);
+    p__lock_file(file);
+    ret = fprintf(file, "%s\n%d\n", long_str, 42);
+    ok(ret == sizeof(long_str) + 3, "fprintf returned %d\n", ret);
+    ret = fwprintf(file, wideW, textW);
+    ok(ret == 5, "fwprintf returned %d\n", ret);
+    p__unlock_file(file);
+    p__unlock_file(file);
+    fclose(file);
+
+    fd = _open(tempf, _O_RDONLY|_O_BINARY, 0);
+    ret = _read(fd, buf, sizeof(buf));
+    ok(ret == sizeof(long_str) + 11, "read %d bytes\n", ret);
+    ok(!memcmp(buf, long_str, sizeof(long_str) - 1), "wrong data written\n");
+    ok(!memcmp(buf + sizeof(long_str) - 1, "\r\n42\r\nwide\r\n", 12), "wrong data written\n");
+    _close(fd);
+
+    /* binary streams get the wide characters as they are */
+    file = fopen(tempf, "wb");
+    ok(file != NULL, "unable to create test file\n");
+    ret = fwprintf(file, wideW, textW);
+    ok(ret == 5, "fwprintf returned %d\n", ret);
+    fclose(file);
+
+    fd = _open(tempf, _O_RDONLY|_O_BINARY, 0);
+    ret = _read(fd, buf, sizeof(buf));
+    ok(ret == sizeof(wide_binary), "read %d bytes\n", ret);
+    ok(!memcmp(buf, wide_binary, sizeof(wide_binary)), "wrong data written\n");
+    _close(fd);
+
+    unlink(tempf);
+    free(tempf);
+}
+
+static DWORD WINAPI lock_file_thread(void *arg)
+{
+    FILE *file = arg;
+
+    fputc('b', file);
+    p__lock_file(file);
+    p__lock_file(file);
+    fputc('c', file);
+    p__unlock_file(file);
+    fputc('d', file);
+    p__unlock_file(file);
+    return 0;
+}
+
+static void test_lock_file_nesting(void)
+{
+    char *tempf, buf[16];
+    HANDLE thread;
+    FILE *file;
+    DWORD ret;
+
+    if (!p__lock_file || !p__unlock_file)
+    {
+        win_skip("_lock_file not available\n");
+        return;
+    }
+
+    tempf = _tempnam(".","wne");
+    file = fopen(tempf, "w+");
+    ok(file != NULL, "unable to create test file\n");
+
+    p__lock_file(file);
+    p__lock_file(file);
+    thread = CreateThread(NULL, 0, lock_file_thread, file, 0, NULL);
+    ok(thread != NULL, "CreateThread failed\n");
+
+    fputc('a', file);
+    ret = WaitForSingleObject(thread, 100);
+    ok(ret == WAIT_TIMEOUT, "thread got the lock while it was held twice: %u\n", ret);
+    p__unlock_file(file);
+    ret = WaitForSingleObject(thread, 100);
+    ok(ret == WAIT_TIMEOUT, "thread got the lock while it was held once: %u\n", ret);
+    p__unlock_file(file);
+    ret = WaitForSingleObject(thread, 5000);
+    ok(ret == WAIT_OBJECT_0, "thread didn't get the lock: %u\n", ret);
+    CloseHandle(thread);
+
+    /* the lock is free again */
+    p__lock_file(file);
+    rewind(file);
+    memset(buf, 0, sizeof(buf));
+    ok(fread(buf, 1, sizeof(buf), file) == 4, "fread failed\n");
+    ok(!strcmp(buf, "abcd"), "got %s\n", buf);
+    p__unlock_file(file);
+
+    fclose(file);
+    unlink(tempf);
+    free(tempf);
+}
+
 START_TEST(file)
 {
     int arg_c;
@@ -2378,6 +2548,9 @@ START_TEST(file)
     test_mktemp();
     test__open_osfhandle();
     test_write_flush();
+    test_write_text_lf();
+    test_fprintf_locked();
+    test_lock_file_nesting();
 
     /* Wait for the (_P_NOWAIT) spawned processes to finish to make sure the report
      * file contains lines in the correct order
@@ -21,6 +21,10 @@
 #include <stdlib.h>
 #include <malloc.h>
 #include <errno.h>
+#include <stdio.h>
+#include <windef.h>
+#include <winbase.h>
+#include <winreg.h>
 #include "wine/test.h"
 
 static void (__cdecl *p_aligned_free)(void*) = NULL;
@@ -456,9 +460,135 @@ static void test_sbheap(void)
     free(mem);
 }
 
+static DWORD WINAPI free_blocks_thread(void *arg)
+{
+    char **blocks = arg;
+    int i;
+
+    for (i = 0; i < 64; i += 2)
+    {
+        free(blocks[i]);
+        blocks[i] = NULL;
+    }
+    return 0;
+}
+
+static void test_small_blocks(void)
+{
+    struct _heapinfo hi;
+    char *blocks[64], *mem;
+    HANDLE thread;
+    int i, j, found, ret;
+
+    for (i = 0; i < 64; i++)
+    {
+        blocks[i] = malloc(i * 4 + 1);
+        ok(blocks[i] != NULL, "malloc failed\n");
+        ok(_msize(blocks[i]) == i * 4 + 1, "_msize returned %d\n", (int)_msize(blocks[i]));
+        memset(blocks[i], i, i * 4 + 1);
+    }
+
+    found = 0;
+    memset(&hi, 0, sizeof(hi));
+    while ((ret = _heapwalk(&hi)) == _HEAPOK)
+    {
+        for (i = 0; i < 64; i++)
+        {
+            if (hi._pentry != (int *)blocks[i]) continue;
+            ok(hi._useflag == _USEDENTRY, "block %d is not used\n", i);
+            ok(hi._size >= i * 4 + 1, "block %d has size %d\n", i, (int)hi._size);
+            found++;
+        }
+    }
+    ok(ret == _HEAPEND, "_heapwalk returned %d\n", ret);
+    ok(found == 64, "found %d blocks\n", found);
+
+    mem = realloc(blocks[40], 20);
+    ok(mem != NULL, "realloc failed\n");
+    ok(_msize(mem) == 20, "_msize returned %d\n", (int)_msize(mem));
+    for (j = 0; j < 20; j++)
+        if (mem[j] != 40) break;
+    ok(j == 20, "realloc didn't preserve the content\n");
+    blocks[40] = mem;
+
+    mem = realloc(blocks[41], 1000);
+    ok(mem != NULL, "realloc failed\n");
+    ok(_msize(mem) == 1000, "_msize returned %d\n", (int)_msize(mem));
+    for (j = 0; j < 41 * 4 + 1; j++)
+        if (mem[j] != 41) break;
+    ok(j == 41 * 4 + 1, "realloc didn't preserve the content\n");
+    blocks[41] = mem;
+
+    mem = _expand(blocks[42], 100);
+    ok(mem == blocks[42], "_expand returned %p, expected %p\n", mem, blocks[42]);
+    ok(_msize(mem) == 100, "_msize returned %d\n", (int)_msize(mem));
+
+    thread = CreateThread(NULL, 0, free_blocks_thread, blocks, 0, NULL);
+    ok(thread != NULL, "CreateThread failed\n");
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+
+    for (i = 1; i < 64; i += 2)
+    {
+        for (j = 0; j < i * 4 + 1; j++)
+            if (blocks[i][j] != i) break;
+        ok(j == i * 4 + 1, "block %d was corrupted\n", i);
+        free(blocks[i]);
+    }
+
+    for (i = 0; i < 64; i++)
+    {
+        blocks[i] = calloc(1, i + 1);
+        ok(blocks[i] != NULL, "calloc failed\n");
+        for (j = 0; j <= i; j++)
+            if (blocks[i][j]) break;
+        ok(j == i + 1, "calloc returned memory that is not zeroed\n");
+    }
+    for (i = 0; i < 64; i++) free(blocks[i]);
+}
+
+static void test_small_blocks_cache(const char *argv0)
+{
+    char cmdline[MAX_PATH];
+    PROCESS_INFORMATION proc;
+    STARTUPINFOA startup;
+    DWORD disposition;
+    HKEY hkey;
+    LONG err;
+
+    /* only used by Wine, the value is ignored on Windows */
+    err = RegCreateKeyExA(HKEY_CURRENT_USER, "Software\\Wine\\MSVCRT", 0, NULL, 0, KEY_ALL_ACCESS,
+                          NULL, &hkey, &disposition);
+    ok(!err, "RegCreateKeyEx failed with %d\n", err);
+    if (err) return;
+    RegSetValueExA(hkey, "HeapCache", 0, REG_SZ, (const BYTE *)"Y", 2);
+
+    sprintf(cmdline, "%s heap small_blocks", argv0);
+    memset(&startup, 0, sizeof(startup));
+    startup.cb = sizeof(startup);
+    CreateProcessA(NULL, cmdline, NULL, NULL, TRUE, CREATE_DEFAULT_ERROR_MODE|NORMAL_PRIORITY_CLASS, NULL, NULL, &startup, &proc);
+    winetest_wait_child_process(proc.hProcess);
+    CloseHandle(proc.hProcess);
+    CloseHandle(proc.hThread);
+
+    RegDeleteValueA(hkey, "HeapCache");
+    RegCloseKey(hkey);
+    if (disposition == REG_CREATED_NEW_KEY)
+        RegDeleteKeyA(HKEY_CURRENT_USER, "Software\\Wine\\MSVCRT");
+}
+
 START_TEST(heap)
 {
     void *mem;
+    char **argv;
+    int argc;
+
+    argc = winetest_get_mainargs(&argv);
+    if (argc >= 3 && !strcmp(argv[2], "small_blocks"))
+    {
+        test_small_blocks();
+        return;
+    }
 
     mem = malloc(0);
     ok(mem != NULL, "memory not allocated for size 0\n");
@@ -480,4 +610,6 @@ START_TEST(heap)
 
     test_aligned();
     test_sbheap();
+    test_small_blocks();
+    test_small_blocks_cache(argv[0]);
 }
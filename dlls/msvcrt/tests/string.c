@@ -91,6 +91,8 @@ static size_t (__cdecl *p_mbrtowc)(wchar_t*, const char*, size_t, mbstate_t*);
 static int (__cdecl *p__atodbl_l)(_CRT_DOUBLE*,char*,_locale_t);
 static int (__cdecl *p__strnset_s)(char*,size_t,int,size_t);
 static int (__cdecl *p__wcsset_s)(wchar_t*,size_t,wchar_t);
+static size_t (__cdecl *p_wcslen)(const wchar_t*);
+static int (__cdecl *p_wcscmp)(const wchar_t*,const wchar_t*);
 
 #define SETNOFAIL(x,y) x = (void*)GetProcAddress(hMsvcrt,y)
 #define SET(x,y) SETNOFAIL(x,y); ok(x != NULL, "Export '%s' not found\n", y)
@@ -2784,6 +2786,43 @@ static void test__wcsset_s(void)
     ok(str[2] == 'b', "str[2] = %d\n", str[2]);
 }
 
+static void test_wcslen_wcscmp(void)
+{
+    wchar_t str1[40], str2[40];
+    size_t len;
+    int off1, off2, i, ret;
+
+    for (off1 = 0; off1 < 4; off1++)
+    {
+        for (len = 0; len < 20; len++)
+        {
+            for (i = 0; i < len; i++) str1[off1 + i] = 'a' + i;
+            str1[off1 + len] = 0;
+            str1[off1 + len + 1] = 'x';
+            ok(p_wcslen(str1 + off1) == len, "%d: wcslen returned %d, expected %d\n",
+               off1, (int)p_wcslen(str1 + off1), (int)len);
+
+            for (off2 = 0; off2 < 4; off2++)
+            {
+                memcpy(str2 + off2, str1 + off1, (len + 2) * sizeof(wchar_t));
+                ret = p_wcscmp(str1 + off1, str2 + off2);
+                ok(!ret, "%d,%d,%d: wcscmp returned %d\n", off1, off2, (int)len, ret);
+
+                if (!len) continue;
+                str2[off2 + len - 1] = 0xfffe;
+                ret = p_wcscmp(str1 + off1, str2 + off2);
+                ok(ret < 0, "%d,%d,%d: wcscmp returned %d\n", off1, off2, (int)len, ret);
+                ret = p_wcscmp(str2 + off2, str1 + off1);
+                ok(ret > 0, "%d,%d,%d: wcscmp returned %d\n", off1, off2, (int)len, ret);
+
+                str2[off2 + len - 1] = 0;
+                ret = p_wcscmp(str1 + off1, str2 + off2);
+                ok(ret > 0, "%d,%d,%d: wcscmp returned %d\n", off1, off2, (int)len, ret);
+            }
+        }
+    }
+}
+
 START_TEST(string)
 {
     char mem[100];
@@ -2833,6 +2872,8 @@ START_TEST(string)
     p__atodbl_l = (void*)GetProcAddress(hMsvcrt, "_atodbl_l");
     p__strnset_s = (void*)GetProcAddress(hMsvcrt, "_strnset_s");
     p__wcsset_s = (void*)GetProcAddress(hMsvcrt, "_wcsset_s");
+    SET(p_wcslen, "wcslen");
+    SET(p_wcscmp, "wcscmp");
 
     /* MSVCRT memcpy behaves like memmove for overlapping moves,
        MFC42 CString::Insert seems to rely on that behaviour */
@@ -2888,4 +2929,5 @@ START_TEST(string)
     test_strxfrm();
     test__strnset_s();
     test__wcsset_s();
+    test_wcslen_wcscmp();
 }
@@ -2092,12 +2092,67 @@ MSVCRT_wchar_t* CDECL MSVCRT_wcschr(const MSVCRT_wchar_t *str, MSVCRT_wchar_t ch
     return strchrW(str, ch);
 }
 
+/* the strings are scanned one machine word at a time, these masks
+ * select the low and high bits of each wchar in a word */
+#define WCHAR_LOW_BITS  (~(ULONG_PTR)0 / 0xffff)
+#define WCHAR_HIGH_BITS (WCHAR_LOW_BITS * 0x8000)
+
+static inline BOOL word_has_null_wchar( ULONG_PTR word )
+{
+    return ((word - WCHAR_LOW_BITS) & ~word & WCHAR_HIGH_BITS) != 0;
+}
+
 /***********************************************************************
  *              wcslen (MSVCRT.@)
  */
 int CDECL MSVCRT_wcslen(const MSVCRT_wchar_t *str)
 {
-    return strlenW(str);
+    const MSVCRT_wchar_t *s = str;
+    const ULONG_PTR *word;
+
+    /* an aligned word never crosses a page boundary, so it is safe
+     * to read past the terminating null */
+    while ((ULONG_PTR)s % sizeof(ULONG_PTR))
+    {
+        if (!*s) return s - str;
+        s++;
+    }
+    for (word = (const ULONG_PTR *)s; !word_has_null_wchar( *word ); word++) ;
+    for (s = (const MSVCRT_wchar_t *)word; *s; s++) ;
+    return s - str;
+}
+
+/***********************************************************************
+ *              wcscmp (MSVCRT.@)
+ */
+int CDECL MSVCRT_wcscmp(const MSVCRT_wchar_t *str1, const MSVCRT_wchar_t *str2)
+{
+    if (!(((ULONG_PTR)str1 ^ (ULONG_PTR)str2) % sizeof(ULONG_PTR)))
+    {
+        const ULONG_PTR *word1, *word2;
+
+        while ((ULONG_PTR)str1 % sizeof(ULONG_PTR))
+        {
+            if (!*str1 || *str1 != *str2) return *str1 - *str2;
+            str1++;
+            str2++;
+        }
+        word1 = (const ULONG_PTR *)str1;
+        word2 = (const ULONG_PTR *)str2;
+        while (*word1 == *word2 && !word_has_null_wchar( *word1 ))
+        {
+            word1++;
+            word2++;
+        }
+        str1 = (const MSVCRT_wchar_t *)word1;
+        str2 = (const MSVCRT_wchar_t *)word2;
+    }
+    while (*str1 && *str1 == *str2)
+    {
+        str1++;
+        str2++;
+    }
+    return *str1 - *str2;
 }
 
 /*********************************************************************
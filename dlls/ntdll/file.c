@@ -24,6 +24,8 @@
 #include <stdio.h>
 #include <errno.h>
 #include <assert.h>
+#include <limits.h>
+#include <signal.h>
 #ifdef HAVE_UNISTD_H
 # include <unistd.h>
 #endif
@@ -36,6 +38,9 @@
 #ifdef HAVE_SYS_PARAM_H
 # include <sys/param.h>
 #endif
+#ifdef HAVE_SYS_MMAN_H
+# include <sys/mman.h>
+#endif
 #ifdef HAVE_SYS_SYSCALL_H
 # include <sys/syscall.h>
 #endif
@@ -83,6 +88,7 @@
 #include "wine/unicode.h"
 #include "wine/debug.h"
 #include "wine/server.h"
+#include "wine/list.h"
 #include "ntdll_misc.h"
 
 #include "winternl.h"
@@ -604,6 +610,741 @@ static NTSTATUS get_io_avail_mode( HANDLE handle, enum server_fd_type type, BOOL
 }
 
 
+
+/***********************************************************************
+ * Named pipe shared memory transport
+ *
+ * When both ends of a pipe use synchronous I/O and the pipe was created
+ * with NAMED_PIPE_SHARED_MEMORY, the server sets up a pair of rings in
+ * shared memory and the data bypasses the socket. Each ring has a single
+ * reader and a single writer at a time; the locks and the wait queue are
+ * futexes shared between all processes holding a handle to the pipe.
+ * A thread blocked on a ring registers itself so that closing the handle
+ * or NtCancelSynchronousIoFile can interrupt the wait.
+ */
+
+#define IS_OPTION_TRUE(ch) ((ch) == 'y' || (ch) == 'Y' || (ch) == 't' || (ch) == 'T' || (ch) == '1')
+
+struct pipe_ring_view
+{
+    struct pipe_ring *ring;
+    char             *data;       /* start of the data area */
+    unsigned int      size;       /* size of the data area */
+};
+
+struct pipe_ring_cache
+{
+    struct list           entry;
+    HANDLE                handle;
+    LONG                  refcount;
+    void                 *base;   /* base of the mapping, NULL if the pipe has no rings */
+    SIZE_T                size;   /* size of the mapping */
+    struct pipe_ring_view read;   /* ring read by this end */
+    struct pipe_ring_view write;  /* ring written by this end */
+};
+
+static struct list pipe_ring_cache = LIST_INIT( pipe_ring_cache );
+
+static RTL_CRITICAL_SECTION pipe_ring_section;
+static RTL_CRITICAL_SECTION_DEBUG pipe_ring_critsect_debug =
+{
+    0, 0, &pipe_ring_section,
+    { &pipe_ring_critsect_debug.ProcessLocksList, &pipe_ring_critsect_debug.ProcessLocksList },
+      0, 0, { (DWORD_PTR)(__FILE__ ": pipe_ring_section") }
+};
+static RTL_CRITICAL_SECTION pipe_ring_section = { &pipe_ring_critsect_debug, -1, 0, 0, 0, 0 };
+
+/* a synchronous operation on a ring */
+struct pipe_ring_op
+{
+    struct list       entry;
+    HANDLE            handle;
+    HANDLE            tid;        /* thread doing the I/O */
+    IO_STATUS_BLOCK  *io;
+    struct pipe_ring *ring;       /* ring the thread is blocked on */
+    LONG              cancelled;
+    BOOL              registered; /* only blocked operations are in the list */
+};
+
+static struct list pipe_ring_ops = LIST_INIT( pipe_ring_ops );
+
+static RTL_RUN_ONCE pipe_init_once = RTL_RUN_ONCE_INIT;
+static BOOL pipe_shared_memory;
+
+static void init_pipe_ring_op( struct pipe_ring_op *op, HANDLE handle, IO_STATUS_BLOCK *io )
+{
+    op->handle     = handle;
+    op->tid        = NtCurrentTeb()->ClientId.UniqueThread;
+    op->io         = io;
+    op->ring       = NULL;
+    op->cancelled  = FALSE;
+    op->registered = FALSE;
+}
+
+/* called before the first wait, so that uncontended operations don't need the lock */
+static void register_pipe_ring_op( struct pipe_ring_op *op, struct pipe_ring *ring )
+{
+    if (op->registered) return;
+    RtlEnterCriticalSection( &pipe_ring_section );
+    op->ring = ring;
+    list_add_tail( &pipe_ring_ops, &op->entry );
+    op->registered = TRUE;
+    RtlLeaveCriticalSection( &pipe_ring_section );
+}
+
+static void unregister_pipe_ring_op( struct pipe_ring_op *op )
+{
+    if (!op->registered) return;
+    RtlEnterCriticalSection( &pipe_ring_section );
+    list_remove( &op->entry );
+    RtlLeaveCriticalSection( &pipe_ring_section );
+}
+
+#ifdef __linux__
+
+/* the rings are shared between processes, so we can't use private futexes */
+static inline int shared_futex_wait( int *addr, int val, const struct timespec *timeout )
+{
+    return syscall( __NR_futex, addr, 0 /* FUTEX_WAIT */, val, timeout, 0, 0 );
+}
+
+static inline int shared_futex_wake( int *addr, int val )
+{
+    return syscall( __NR_futex, addr, 1 /* FUTEX_WAKE */, val, NULL, 0, 0 );
+}
+
+/* how long to sleep before checking again whether the other side is still there */
+static const struct timespec pipe_ring_timeout = { 0, 500000000 };
+
+/* snapshot the sequence number before checking the ring state */
+static inline int pipe_ring_seq( struct pipe_ring *ring )
+{
+    return interlocked_xchg_add( &ring->seq, 0 );
+}
+
+/* wait until the ring state changed since the sequence number was taken,
+ * or until the timeout expires; callers check the state again either way.
+ * Returns FALSE if the operation was cancelled. */
+static BOOL pipe_ring_wait( struct pipe_ring_op *op, struct pipe_ring *ring, int seq )
+{
+    register_pipe_ring_op( op, ring );
+    if (op->cancelled) return FALSE;
+    interlocked_xchg_add( &ring->waiters, 1 );
+    shared_futex_wait( &ring->seq, seq, &pipe_ring_timeout );
+    interlocked_xchg_add( &ring->waiters, -1 );
+    return !op->cancelled;
+}
+
+static void pipe_ring_notify( struct pipe_ring *ring )
+{
+    interlocked_xchg_add( &ring->seq, 1 );
+    if (ring->waiters) shared_futex_wake( &ring->seq, INT_MAX );
+}
+
+/* stop using a ring, both ends switch to the socket once the remaining data is read */
+static void abandon_pipe_ring( struct pipe_ring *ring, unsigned int how )
+{
+    unsigned int closed;
+
+    while ((closed = ring->closed) < how)
+        if (interlocked_cmpxchg( (int *)&ring->closed, how, closed ) == (int)closed) break;
+    pipe_ring_notify( ring );
+}
+
+/* the lock holds the unix tid of its owner, plus a flag if there may be waiters */
+#define PIPE_RING_LOCK_WAITERS 0x40000000
+
+static BOOL pipe_ring_owner_dead( int owner )
+{
+    return kill( owner, 0 ) == -1 && errno == ESRCH;
+}
+
+/* if the owner of the lock died while holding it, the ring can't be trusted
+ * anymore; it is then abandoned in the given state and the lock is taken over.
+ * Returns FALSE without the lock if the operation was cancelled. */
+static BOOL pipe_ring_lock( struct pipe_ring_op *op, struct pipe_ring *ring, int *lock, unsigned int how )
+{
+    int tid = syscall( __NR_gettid ), owner = tid, val;
+
+    while ((val = interlocked_cmpxchg( lock, owner, 0 )))
+    {
+        register_pipe_ring_op( op, ring );
+        if (op->cancelled) return FALSE;
+
+        /* once we had to wait, there may be other waiters too */
+        owner = tid | PIPE_RING_LOCK_WAITERS;
+        if (!(val & PIPE_RING_LOCK_WAITERS) &&
+            interlocked_cmpxchg( lock, val | PIPE_RING_LOCK_WAITERS, val ) != val)
+            continue;
+        val |= PIPE_RING_LOCK_WAITERS;
+
+        if (shared_futex_wait( lock, val, &pipe_ring_timeout ) == -1 && errno == ETIMEDOUT &&
+            pipe_ring_owner_dead( val & ~PIPE_RING_LOCK_WAITERS ) &&
+            interlocked_cmpxchg( lock, owner, val ) == val)
+        {
+            WARN( "owner %d of pipe ring %p died with the lock held\n",
+                  val & ~PIPE_RING_LOCK_WAITERS, ring );
+            abandon_pipe_ring( ring, how );
+            return TRUE;
+        }
+    }
+    return TRUE;
+}
+
+static void pipe_ring_unlock( int *lock )
+{
+    if (interlocked_xchg( lock, 0 ) & PIPE_RING_LOCK_WAITERS) shared_futex_wake( lock, 1 );
+}
+
+/* caller must hold pipe_ring_section */
+static void cancel_pipe_ring_op( struct pipe_ring_op *op )
+{
+    op->cancelled = TRUE;
+    /* the waits re-check their state when woken up, spurious wakeups are harmless */
+    pipe_ring_notify( op->ring );
+    shared_futex_wake( &op->ring->read_lock, INT_MAX );
+    shared_futex_wake( &op->ring->write_lock, INT_MAX );
+}
+
+static void copy_from_ring( const struct pipe_ring_view *view, unsigned int pos, void *buffer,
+                            unsigned int len )
+{
+    unsigned int offset = pos & (view->size - 1), count = min( len, view->size - offset );
+
+    memcpy( buffer, view->data + offset, count );
+    memcpy( (char *)buffer + count, view->data, len - count );
+}
+
+static void copy_to_ring( const struct pipe_ring_view *view, unsigned int pos, const void *buffer,
+                          unsigned int len )
+{
+    unsigned int offset = pos & (view->size - 1), count = min( len, view->size - offset );
+
+    memcpy( view->data + offset, buffer, count );
+    memcpy( view->data, (const char *)buffer + count, len - count );
+}
+
+/* move the read position forward, len is the amount of data bytes consumed */
+static void consume_ring( struct pipe_ring *ring, unsigned int tail, unsigned int len )
+{
+    interlocked_xchg( (int *)&ring->tail, tail );
+    if (len) interlocked_xchg_add( (int *)&ring->avail, -len );
+    pipe_ring_notify( ring );
+}
+
+static DWORD WINAPI init_pipe_options( RTL_RUN_ONCE *once, void *param, void **context )
+{
+    static const WCHAR pipesW[] = {'S','o','f','t','w','a','r','e','\\','W','i','n','e','\\',
+                                   'P','i','p','e','s',0};
+    static const WCHAR shared_memoryW[] = {'S','h','a','r','e','d','M','e','m','o','r','y',0};
+    char tmp[80];
+    HANDLE root, hkey;
+    DWORD dummy;
+    OBJECT_ATTRIBUTES attr;
+    UNICODE_STRING nameW;
+    int futex = 0;
+
+    RtlOpenCurrentUser( KEY_ALL_ACCESS, &root );
+    attr.Length = sizeof(attr);
+    attr.RootDirectory = root;
+    attr.ObjectName = &nameW;
+    attr.Attributes = 0;
+    attr.SecurityDescriptor = NULL;
+    attr.SecurityQualityOfService = NULL;
+    RtlInitUnicodeString( &nameW, pipesW );
+
+    /* @@ Wine registry key: HKCU\Software\Wine\Pipes */
+    if (!NtOpenKey( &hkey, KEY_ALL_ACCESS, &attr ))
+    {
+        RtlInitUnicodeString( &nameW, shared_memoryW );
+        if (!NtQueryValueKey( hkey, &nameW, KeyValuePartialInformation, tmp, sizeof(tmp), &dummy ))
+        {
+            WCHAR *str = (WCHAR *)((KEY_VALUE_PARTIAL_INFORMATION *)tmp)->Data;
+            pipe_shared_memory = IS_OPTION_TRUE( str[0] );
+        }
+        NtClose( hkey );
+    }
+    NtClose( root );
+
+    if (pipe_shared_memory && shared_futex_wait( &futex, 1, NULL ) == -1 && errno == ENOSYS)
+    {
+        WARN( "futexes not supported, not using the shared memory transport for pipes\n" );
+        pipe_shared_memory = FALSE;
+    }
+    return TRUE;
+}
+
+static BOOL init_ring_view( struct pipe_ring_view *view, char *base, SIZE_T size, int index )
+{
+    struct pipe_ring *ring = (struct pipe_ring *)base + index;
+    unsigned int ring_size = ring->size, offset = ring->offset;
+
+    if (size < 2 * sizeof(*ring) || !ring_size || (ring_size & (ring_size - 1)) ||
+        offset > size || ring_size > size - offset)
+        return FALSE;
+    view->ring = ring;
+    view->data = base + offset;
+    view->size = ring_size;
+    return TRUE;
+}
+
+static void release_pipe_ring( struct pipe_ring_cache *cache )
+{
+    if (interlocked_xchg_add( &cache->refcount, -1 ) != 1) return;
+    if (cache->base) munmap( cache->base, cache->size );
+    RtlFreeHeap( GetProcessHeap(), 0, cache );
+}
+
+/***********************************************************************
+ *           grab_pipe_ring
+ *
+ * Get the shared memory rings of a synchronous pipe handle, or NULL if
+ * the data goes through the socket.
+ */
+static struct pipe_ring_cache *grab_pipe_ring( HANDLE handle )
+{
+    struct pipe_ring_cache *cache, *ret = NULL;
+    SIZE_T size;
+    int fd, end;
+    NTSTATUS status;
+
+    RtlEnterCriticalSection( &pipe_ring_section );
+    LIST_FOR_EACH_ENTRY( cache, &pipe_ring_cache, struct pipe_ring_cache, entry )
+    {
+        if (cache->handle != handle) continue;
+        if (cache->base)
+        {
+            interlocked_xchg_add( &cache->refcount, 1 );
+            ret = cache;
+        }
+        RtlLeaveCriticalSection( &pipe_ring_section );
+        return ret;
+    }
+    RtlLeaveCriticalSection( &pipe_ring_section );
+
+    /* the pipe may be disconnected, only remember a definitive answer */
+    status = server_get_named_pipe_ring( handle, &fd, &size, &end );
+    if (status && status != STATUS_NOT_SUPPORTED) return NULL;
+
+    if (!(cache = RtlAllocateHeap( GetProcessHeap(), HEAP_ZERO_MEMORY, sizeof(*cache) )))
+    {
+        if (fd != -1) close( fd );
+        return NULL;
+    }
+    cache->handle = handle;
+    cache->refcount = 1;
+    if (fd != -1)
+    {
+        void *base = mmap( NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+
+        close( fd );
+        if (base != MAP_FAILED)
+        {
+            if (init_ring_view( &cache->read, base, size, !end ) &&
+                init_ring_view( &cache->write, base, size, end ))
+            {
+                cache->base = base;
+                cache->size = size;
+                TRACE( "using shared memory transport for %p\n", handle );
+            }
+            else
+            {
+                ERR( "invalid shared memory rings for %p\n", handle );
+                munmap( base, size );
+            }
+        }
+    }
+
+    RtlEnterCriticalSection( &pipe_ring_section );
+    LIST_FOR_EACH_ENTRY( ret, &pipe_ring_cache, struct pipe_ring_cache, entry )
+    {
+        if (ret->handle != handle) continue;
+        /* somebody else was faster */
+        release_pipe_ring( cache );
+        cache = ret;
+        break;
+    }
+    if (cache != ret) list_add_head( &pipe_ring_cache, &cache->entry );
+    if (cache->base) interlocked_xchg_add( &cache->refcount, 1 );
+    else cache = NULL;
+    RtlLeaveCriticalSection( &pipe_ring_section );
+    return cache;
+}
+
+/* read from a ring, returns STATUS_NOT_SUPPORTED if the socket has to be used instead */
+static NTSTATUS read_pipe_ring( struct pipe_ring_op *op, struct pipe_ring_view *view, char *buffer,
+                                ULONG length, ULONG *total )
+{
+    struct pipe_ring *ring = view->ring;
+    unsigned int flags = ring->flags, head, tail, closed, len, count, want = 0;
+    NTSTATUS status = STATUS_NOT_SUPPORTED;
+    BOOL started = FALSE;
+    int seq;
+
+    *total = 0;
+    if (!pipe_ring_lock( op, ring, &ring->read_lock, PIPE_RING_DISCARDED )) return STATUS_CANCELLED;
+    for (;;)
+    {
+        seq = pipe_ring_seq( ring );
+        if ((closed = ring->closed) == PIPE_RING_DISCARDED) break;
+        head = ring->head;
+        tail = ring->tail;
+
+        if (!(flags & NAMED_PIPE_MESSAGE_STREAM_WRITE))
+        {
+            /* byte stream, no framing */
+            if ((count = min( head - tail, length )))
+            {
+                copy_from_ring( view, tail, buffer, count );
+                consume_ring( ring, tail + count, count );
+                *total = count;
+                status = STATUS_SUCCESS;
+                break;
+            }
+        }
+        else if (!(flags & NAMED_PIPE_MESSAGE_STREAM_READ))
+        {
+            /* byte mode read of a message pipe, ignore message boundaries */
+            unsigned int consumed = 0, old_tail = tail;
+
+            while (*total < length)
+            {
+                if (!ring->partial)
+                {
+                    if (head - tail < sizeof(len)) break;
+                    copy_from_ring( view, tail, &len, sizeof(len) );
+                    tail += sizeof(len);
+                    if (!(ring->partial = len)) interlocked_xchg_add( (int *)&ring->messages, -1 );
+                    continue;
+                }
+                if (!(count = min( min( ring->partial, head - tail ), length - *total ))) break;
+                copy_from_ring( view, tail, buffer + *total, count );
+                tail += count;
+                *total += count;
+                consumed += count;
+                if (!(ring->partial -= count)) interlocked_xchg_add( (int *)&ring->messages, -1 );
+            }
+            if (tail != old_tail) consume_ring( ring, tail, consumed );
+            if (*total)
+            {
+                status = STATUS_SUCCESS;
+                break;
+            }
+        }
+        else
+        {
+            /* message mode read, return at most one message */
+            if (!started && !ring->partial && head - tail >= sizeof(len))
+            {
+                copy_from_ring( view, tail, &len, sizeof(len) );
+                tail += sizeof(len);
+                ring->partial = len;
+                consume_ring( ring, tail, 0 );
+                want = min( length, len );
+                started = TRUE;
+            }
+            else if (!started && ring->partial)
+            {
+                want = min( length, ring->partial );
+                started = TRUE;
+            }
+            if (started)
+            {
+                if ((count = min( want - *total, head - tail )))
+                {
+                    copy_from_ring( view, tail, buffer + *total, count );
+                    *total += count;
+                    ring->partial -= count;
+                    consume_ring( ring, tail + count, count );
+                }
+                if (*total == want)
+                {
+                    if (ring->partial) status = STATUS_BUFFER_OVERFLOW;
+                    else
+                    {
+                        interlocked_xchg_add( (int *)&ring->messages, -1 );
+                        status = STATUS_SUCCESS;
+                    }
+                    break;
+                }
+            }
+        }
+
+        if (closed)
+        {
+            /* the writer is gone in the middle of a message, return what we have */
+            if (*total) status = STATUS_SUCCESS;
+            break;
+        }
+        if (!pipe_ring_wait( op, ring, seq ))
+        {
+            /* the rest of a partially read message stays in the ring */
+            status = STATUS_CANCELLED;
+            break;
+        }
+    }
+    pipe_ring_unlock( &ring->read_lock );
+    return status;
+}
+
+/* write to a ring, returns STATUS_NOT_SUPPORTED if the socket has to be used instead */
+static NTSTATUS write_pipe_ring( struct pipe_ring_op *op, struct pipe_ring_view *view,
+                                 const char *buffer, ULONG length, ULONG *total )
+{
+    struct pipe_ring *ring = view->ring;
+    BOOL message = (ring->flags & NAMED_PIPE_MESSAGE_STREAM_WRITE) != 0, header = message;
+    unsigned int head, start, space, count;
+    NTSTATUS status;
+    int seq;
+
+    *total = 0;
+    if (!length && !header) return STATUS_SUCCESS;
+
+    if (!pipe_ring_lock( op, ring, &ring->write_lock, PIPE_RING_CLOSED )) return STATUS_CANCELLED;
+    for (;;)
+    {
+        seq = pipe_ring_seq( ring );
+        if (ring->closed)
+        {
+            status = *total ? STATUS_SUCCESS : STATUS_NOT_SUPPORTED;
+            break;
+        }
+        head = start = ring->head;
+        space = view->size - (head - ring->tail);
+        count = 0;
+
+        if (header && space >= sizeof(length))
+        {
+            copy_to_ring( view, head, &length, sizeof(length) );
+            head += sizeof(length);
+            space -= sizeof(length);
+            header = FALSE;
+            interlocked_xchg_add( (int *)&ring->messages, 1 );
+        }
+        if (!header && (count = min( space, length - *total )))
+        {
+            copy_to_ring( view, head, buffer + *total, count );
+            head += count;
+            *total += count;
+        }
+        if (head != start)
+        {
+            interlocked_xchg( (int *)&ring->head, head );
+            if (count) interlocked_xchg_add( (int *)&ring->avail, count );
+            pipe_ring_notify( ring );
+        }
+        if (!header && *total == length)
+        {
+            status = STATUS_SUCCESS;
+            break;
+        }
+        /* no progress, either the ring is full or the message header doesn't fit */
+        if (head == start && !pipe_ring_wait( op, ring, seq ))
+        {
+            /* the reader would wait forever for the rest of the message,
+             * make it return the partial message and use the socket from now on */
+            if (message && !header) abandon_pipe_ring( ring, PIPE_RING_CLOSED );
+            status = STATUS_CANCELLED;
+            break;
+        }
+    }
+    pipe_ring_unlock( &ring->write_lock );
+    return status;
+}
+
+/* peek at a ring, returns STATUS_NOT_SUPPORTED if the socket has to be used instead */
+static NTSTATUS peek_pipe_ring( struct pipe_ring_op *op, struct pipe_ring_view *view,
+                                FILE_PIPE_PEEK_BUFFER *buffer, ULONG size, ULONG_PTR *info )
+{
+    struct pipe_ring *ring = view->ring;
+    unsigned int closed, head, tail, len = 0, count;
+
+    if (!pipe_ring_lock( op, ring, &ring->read_lock, PIPE_RING_DISCARDED )) return STATUS_CANCELLED;
+    closed = ring->closed;
+    head = ring->head;
+    tail = ring->tail;
+    if (closed == PIPE_RING_DISCARDED || (closed && head == tail))
+    {
+        pipe_ring_unlock( &ring->read_lock );
+        return STATUS_NOT_SUPPORTED;
+    }
+
+    buffer->NamedPipeState   = 0;  /* FIXME */
+    buffer->NumberOfMessages = 0;
+    buffer->MessageLength    = 0;
+    if (!(ring->flags & NAMED_PIPE_MESSAGE_STREAM_WRITE))
+    {
+        buffer->ReadDataAvailable = head - tail;
+        count = min( head - tail, size );
+    }
+    else
+    {
+        /* only the current message is returned */
+        buffer->ReadDataAvailable = ring->avail;
+        buffer->NumberOfMessages  = ring->messages;
+        if (!(len = ring->partial) && head - tail >= sizeof(len))
+        {
+            copy_from_ring( view, tail, &len, sizeof(len) );
+            tail += sizeof(len);
+        }
+        buffer->MessageLength = len;
+        count = min( min( len, head - tail ), size );
+    }
+    copy_from_ring( view, tail, buffer->Data, count );
+    pipe_ring_unlock( &ring->read_lock );
+
+    *info = FIELD_OFFSET( FILE_PIPE_PEEK_BUFFER, Data[count] );
+    return STATUS_SUCCESS;
+}
+
+/* wait for the reader to consume all the data, returns STATUS_NOT_SUPPORTED if there is no reader */
+static NTSTATUS flush_pipe_ring( struct pipe_ring_op *op, struct pipe_ring_view *view )
+{
+    struct pipe_ring *ring = view->ring;
+    int seq;
+
+    for (;;)
+    {
+        seq = pipe_ring_seq( ring );
+        if (ring->closed) return STATUS_NOT_SUPPORTED;
+        if (ring->tail == ring->head) return STATUS_SUCCESS;
+        if (!pipe_ring_wait( op, ring, seq )) return STATUS_CANCELLED;
+    }
+}
+
+#else  /* __linux__ */
+
+static DWORD WINAPI init_pipe_options( RTL_RUN_ONCE *once, void *param, void **context )
+{
+    return TRUE;
+}
+
+static void release_pipe_ring( struct pipe_ring_cache *cache )
+{
+}
+
+static struct pipe_ring_cache *grab_pipe_ring( HANDLE handle )
+{
+    return NULL;
+}
+
+static void cancel_pipe_ring_op( struct pipe_ring_op *op )
+{
+    op->cancelled = TRUE;
+}
+
+static NTSTATUS read_pipe_ring( struct pipe_ring_op *op, struct pipe_ring_view *view, char *buffer,
+                                ULONG length, ULONG *total )
+{
+    return STATUS_NOT_SUPPORTED;
+}
+
+static NTSTATUS write_pipe_ring( struct pipe_ring_op *op, struct pipe_ring_view *view,
+                                 const char *buffer, ULONG length, ULONG *total )
+{
+    return STATUS_NOT_SUPPORTED;
+}
+
+static NTSTATUS peek_pipe_ring( struct pipe_ring_op *op, struct pipe_ring_view *view,
+                                FILE_PIPE_PEEK_BUFFER *buffer, ULONG size, ULONG_PTR *info )
+{
+    return STATUS_NOT_SUPPORTED;
+}
+
+static NTSTATUS flush_pipe_ring( struct pipe_ring_op *op, struct pipe_ring_view *view )
+{
+    return STATUS_NOT_SUPPORTED;
+}
+
+#endif  /* __linux__ */
+
+/***********************************************************************
+ *           FILE_remove_pipe_ring
+ *
+ * Forget the shared memory rings of a pipe handle that is closed or disconnected,
+ * and interrupt the operations blocked on it.
+ */
+void FILE_remove_pipe_ring( HANDLE handle )
+{
+    struct pipe_ring_cache *cache;
+    struct pipe_ring_op *op;
+
+    if (list_empty( &pipe_ring_cache ) && list_empty( &pipe_ring_ops )) return;
+
+    RtlEnterCriticalSection( &pipe_ring_section );
+    LIST_FOR_EACH_ENTRY( op, &pipe_ring_ops, struct pipe_ring_op, entry )
+        if (op->handle == handle) cancel_pipe_ring_op( op );
+    LIST_FOR_EACH_ENTRY( cache, &pipe_ring_cache, struct pipe_ring_cache, entry )
+    {
+        if (cache->handle != handle) continue;
+        list_remove( &cache->entry );
+        RtlLeaveCriticalSection( &pipe_ring_section );
+        release_pipe_ring( cache );
+        return;
+    }
+    RtlLeaveCriticalSection( &pipe_ring_section );
+}
+
+static NTSTATUS read_shared_pipe( HANDLE handle, IO_STATUS_BLOCK *io, void *buffer, ULONG length,
+                                  ULONG *total )
+{
+    struct pipe_ring_cache *cache;
+    struct pipe_ring_op op;
+    NTSTATUS status;
+
+    if (!(cache = grab_pipe_ring( handle ))) return STATUS_NOT_SUPPORTED;
+    init_pipe_ring_op( &op, handle, io );
+    status = read_pipe_ring( &op, &cache->read, buffer, length, total );
+    unregister_pipe_ring_op( &op );
+    release_pipe_ring( cache );
+    return status;
+}
+
+static NTSTATUS write_shared_pipe( HANDLE handle, IO_STATUS_BLOCK *io, const void *buffer, ULONG length,
+                                   ULONG *total )
+{
+    struct pipe_ring_cache *cache;
+    struct pipe_ring_op op;
+    NTSTATUS status;
+
+    if (!(cache = grab_pipe_ring( handle ))) return STATUS_NOT_SUPPORTED;
+    init_pipe_ring_op( &op, handle, io );
+    status = write_pipe_ring( &op, &cache->write, buffer, length, total );
+    unregister_pipe_ring_op( &op );
+    release_pipe_ring( cache );
+    return status;
+}
+
+static NTSTATUS peek_shared_pipe( HANDLE handle, IO_STATUS_BLOCK *io, FILE_PIPE_PEEK_BUFFER *buffer,
+                                  ULONG size )
+{
+    struct pipe_ring_cache *cache;
+    struct pipe_ring_op op;
+    NTSTATUS status;
+
+    if (!(cache = grab_pipe_ring( handle ))) return STATUS_NOT_SUPPORTED;
+    init_pipe_ring_op( &op, handle, io );
+    status = peek_pipe_ring( &op, &cache->read, buffer, size, &io->Information );
+    unregister_pipe_ring_op( &op );
+    release_pipe_ring( cache );
+    return status;
+}
+
+static NTSTATUS flush_shared_pipe( HANDLE handle, IO_STATUS_BLOCK *io )
+{
+    struct pipe_ring_cache *cache;
+    struct pipe_ring_op op;
+    NTSTATUS status;
+
+    if (!(cache = grab_pipe_ring( handle ))) return STATUS_NOT_SUPPORTED;
+    init_pipe_ring_op( &op, handle, io );
+    status = flush_pipe_ring( &op, &cache->write );
+    unregister_pipe_ring_op( &op );
+    release_pipe_ring( cache );
+    return status;
+}
+
+
 /******************************************************************************
  *  NtReadFile					[NTDLL.@]
  *  ZwReadFile					[NTDLL.@]
@@ -631,7 +1372,7 @@ NTSTATUS WINAPI NtReadFile(HANDLE hFile, HANDLE hEvent,
                            PIO_STATUS_BLOCK io_status, void* buffer, ULONG length,
                            PLARGE_INTEGER offset, PULONG key)
 {
-    int result, unix_handle, needs_close;
+    int result, unix_handle, needs_close, pipe_ring;
     unsigned int options;
     struct io_timeouts timeouts;
     NTSTATUS status;
@@ -645,8 +1386,8 @@ NTSTATUS WINAPI NtReadFile(HANDLE hFile, HANDLE hEvent,
 
     if (!io_status) return STATUS_ACCESS_VIOLATION;
 
-    status = server_get_unix_fd( hFile, FILE_READ_DATA, &unix_handle,
-                                 &needs_close, &type, &options );
+    status = server_get_pipe_unix_fd( hFile, FILE_READ_DATA, &unix_handle,
+                                      &needs_close, &type, &options, &pipe_ring );
     if (status) return status;
 
     async_read = !(options & (FILE_SYNCHRONOUS_IO_ALERT | FILE_SYNCHRONOUS_IO_NONALERT));
@@ -693,6 +1434,12 @@ NTSTATUS WINAPI NtReadFile(HANDLE hFile, HANDLE hEvent,
             goto done;
         }
     }
+    else if (pipe_ring && !async_read)
+    {
+        status = read_shared_pipe( hFile, io_status, buffer, length, &total );
+        if (status != STATUS_NOT_SUPPORTED) goto done;
+        status = STATUS_SUCCESS;
+    }
 
     for (;;)
     {
@@ -810,7 +1557,8 @@ done:
 
 err:
     if (needs_close) close( unix_handle );
-    if (status == STATUS_SUCCESS || (status == STATUS_END_OF_FILE && !async_read))
+    if (status == STATUS_SUCCESS || status == STATUS_BUFFER_OVERFLOW ||
+        (status == STATUS_END_OF_FILE && !async_read))
     {
         io_status->u.Status = status;
         io_status->Information = total;
@@ -1010,7 +1758,7 @@ NTSTATUS WINAPI NtWriteFile(HANDLE hFile, HANDLE hEvent,
                             const void* buffer, ULONG length,
                             PLARGE_INTEGER offset, PULONG key)
 {
-    int result, unix_handle, needs_close;
+    int result, unix_handle, needs_close, pipe_ring;
     unsigned int options;
     struct io_timeouts timeouts;
     NTSTATUS status;
@@ -1025,12 +1773,12 @@ NTSTATUS WINAPI NtWriteFile(HANDLE hFile, HANDLE hEvent,
 
     if (!io_status) return STATUS_ACCESS_VIOLATION;
 
-    status = server_get_unix_fd( hFile, FILE_WRITE_DATA, &unix_handle,
-                                 &needs_close, &type, &options );
+    status = server_get_pipe_unix_fd( hFile, FILE_WRITE_DATA, &unix_handle,
+                                      &needs_close, &type, &options, &pipe_ring );
     if (status == STATUS_ACCESS_DENIED)
     {
-        status = server_get_unix_fd( hFile, FILE_APPEND_DATA, &unix_handle,
-                                     &needs_close, &type, &options );
+        status = server_get_pipe_unix_fd( hFile, FILE_APPEND_DATA, &unix_handle,
+                                          &needs_close, &type, &options, &pipe_ring );
         append_write = TRUE;
     }
     if (status) return status;
@@ -1108,6 +1856,12 @@ NTSTATUS WINAPI NtWriteFile(HANDLE hFile, HANDLE hEvent,
             goto done;
         }
     }
+    else if (pipe_ring && !async_write)
+    {
+        status = write_shared_pipe( hFile, io_status, buffer, length, &total );
+        if (status != STATUS_NOT_SUPPORTED) goto done;
+        status = STATUS_SUCCESS;
+    }
 
     for (;;)
     {
@@ -1562,7 +2316,7 @@ NTSTATUS WINAPI NtFsControlFile(HANDLE handle, HANDLE event, PIO_APC_ROUTINE apc
     case FSCTL_PIPE_PEEK:
         {
             FILE_PIPE_PEEK_BUFFER *buffer = out_buffer;
-            int avail = 0, fd, needs_close;
+            int avail = 0, fd, needs_close, pipe_ring;
 
             if (out_size < FIELD_OFFSET( FILE_PIPE_PEEK_BUFFER, Data ))
             {
@@ -1570,8 +2324,18 @@ NTSTATUS WINAPI NtFsControlFile(HANDLE handle, HANDLE event, PIO_APC_ROUTINE apc
                 break;
             }
 
-            if ((status = server_get_unix_fd( handle, FILE_READ_DATA, &fd, &needs_close, NULL, NULL )))
+            if ((status = server_get_pipe_unix_fd( handle, FILE_READ_DATA, &fd, &needs_close,
+                                                   NULL, NULL, &pipe_ring )))
+                break;
+
+            if (pipe_ring &&
+                (status = peek_shared_pipe( handle, io, buffer,
+                                            out_size - FIELD_OFFSET( FILE_PIPE_PEEK_BUFFER, Data ) ))
+                != STATUS_NOT_SUPPORTED)
+            {
+                if (needs_close) close( fd );
                 break;
+            }
 
 #ifdef FIONREAD
             if (ioctl( fd, FIONREAD, &avail ) != 0)
@@ -1624,6 +2388,7 @@ NTSTATUS WINAPI NtFsControlFile(HANDLE handle, HANDLE event, PIO_APC_ROUTINE apc
         {
             int fd = server_remove_fd_from_cache( handle );
             if (fd != -1) close( fd );
+            FILE_remove_pipe_ring( handle );
         }
         break;
 
@@ -2945,14 +3710,21 @@ NTSTATUS WINAPI NtFlushBuffersFile( HANDLE hFile, IO_STATUS_BLOCK* IoStatusBlock
     NTSTATUS ret;
     HANDLE hEvent = NULL;
     enum server_fd_type type;
-    int fd, needs_close;
+    unsigned int options;
+    int fd, needs_close, pipe_ring;
 
-    ret = server_get_unix_fd( hFile, FILE_WRITE_DATA, &fd, &needs_close, &type, NULL );
+    ret = server_get_pipe_unix_fd( hFile, FILE_WRITE_DATA, &fd, &needs_close, &type, &options, &pipe_ring );
 
     if (!ret && type == FD_TYPE_SERIAL)
     {
         ret = COMM_FlushBuffersFile( fd );
     }
+    else if (!ret && pipe_ring &&
+             (options & (FILE_SYNCHRONOUS_IO_ALERT | FILE_SYNCHRONOUS_IO_NONALERT)) &&
+             (ret = flush_shared_pipe( hFile, IoStatusBlock )) != STATUS_NOT_SUPPORTED)
+    {
+        /* the reader consumed everything from the shared memory ring */
+    }
     else
     {
         SERVER_START_REQ( flush_file )
@@ -3102,6 +3874,8 @@ NTSTATUS WINAPI NtCreateNamedPipeFile( PHANDLE handle, ULONG access,
     if (timeout->QuadPart > 0)
         FIXME("Wrong time %s\n", wine_dbgstr_longlong(timeout->QuadPart));
 
+    RtlRunOnceExecuteOnce( &pipe_init_once, init_pipe_options, NULL, NULL );
+
     objattr.rootdir = wine_server_obj_handle( attr->RootDirectory );
     objattr.sd_len = 0;
     objattr.name_len = attr->ObjectName->Length;
@@ -3118,7 +3892,8 @@ NTSTATUS WINAPI NtCreateNamedPipeFile( PHANDLE handle, ULONG access,
         req->flags = 
             (pipe_type ? NAMED_PIPE_MESSAGE_STREAM_WRITE   : 0) |
             (read_mode ? NAMED_PIPE_MESSAGE_STREAM_READ    : 0) |
-            (completion_mode ? NAMED_PIPE_NONBLOCKING_MODE : 0);
+            (completion_mode ? NAMED_PIPE_NONBLOCKING_MODE : 0) |
+            (pipe_shared_memory ? NAMED_PIPE_SHARED_MEMORY : 0);
         req->maxinstances = max_inst;
         req->outsize = outbound_quota;
         req->insize  = inbound_quota;
@@ -3219,6 +3994,39 @@ NTSTATUS WINAPI NtCancelIoFile( HANDLE hFile, PIO_STATUS_BLOCK io_status )
     return io_status->u.Status;
 }
 
+/******************************************************************
+ *		NtCancelSynchronousIoFile    (NTDLL.@)
+ *
+ * Only synchronous I/O blocked on a named pipe shared memory ring
+ * can be interrupted, the other synchronous operations run to completion.
+ */
+NTSTATUS WINAPI NtCancelSynchronousIoFile( HANDLE thread, PIO_STATUS_BLOCK iosb, PIO_STATUS_BLOCK io_status )
+{
+    THREAD_BASIC_INFORMATION info;
+    struct pipe_ring_op *op;
+    NTSTATUS status;
+
+    TRACE("%p %p %p\n", thread, iosb, io_status );
+
+    status = NtQueryInformationThread( thread, ThreadBasicInformation, &info, sizeof(info), NULL );
+    if (status) return status;
+
+    status = STATUS_NOT_FOUND;
+    RtlEnterCriticalSection( &pipe_ring_section );
+    LIST_FOR_EACH_ENTRY( op, &pipe_ring_ops, struct pipe_ring_op, entry )
+    {
+        if (op->tid != info.ClientId.UniqueThread) continue;
+        if (iosb && op->io != iosb) continue;
+        cancel_pipe_ring_op( op );
+        status = STATUS_SUCCESS;
+    }
+    RtlLeaveCriticalSection( &pipe_ring_section );
+
+    io_status->u.Status = status;
+    io_status->Information = 0;
+    return status;
+}
+
 /******************************************************************************
  *  NtCreateMailslotFile	[NTDLL.@]
  *  ZwCreateMailslotFile	[NTDLL.@]
@@ -336,6 +336,7 @@ NTSTATUS WINAPI NtDuplicateObject( HANDLE source_process, HANDLE source,
             {
                 int fd = server_remove_fd_from_cache( source );
                 if (fd != -1) close( fd );
+                FILE_remove_pipe_ring( source );
             }
         }
     }
@@ -356,6 +357,7 @@ NTSTATUS close_handle( HANDLE handle )
     }
     SERVER_END_REQ;
     if (fd != -1) close( fd );
+    FILE_remove_pipe_ring( handle );
     return ret;
 }
 
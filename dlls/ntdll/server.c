@@ -795,6 +795,7 @@ struct fd_cache_entry
     enum server_fd_type type : 5;
     unsigned int        access : 3;
     unsigned int        options : 24;
+    unsigned int        pipe_ring : 1;
 };
 
 #define FD_CACHE_BLOCK_SIZE  (65536 / sizeof(struct fd_cache_entry))
@@ -817,7 +818,7 @@ static inline unsigned int handle_to_index( HANDLE handle, unsigned int *entry )
  * Caller must hold fd_cache_section.
  */
 static BOOL add_fd_to_cache( HANDLE handle, int fd, enum server_fd_type type,
-                            unsigned int access, unsigned int options )
+                            unsigned int access, unsigned int options, int pipe_ring )
 {
     unsigned int entry, idx = handle_to_index( handle, &entry );
     int prev_fd;
@@ -844,6 +845,7 @@ static BOOL add_fd_to_cache( HANDLE handle, int fd, enum server_fd_type type,
     fd_cache[entry][idx].type = type;
     fd_cache[entry][idx].access = access;
     fd_cache[entry][idx].options = options;
+    fd_cache[entry][idx].pipe_ring = pipe_ring;
     if (prev_fd != -1) close( prev_fd );
     return TRUE;
 }
@@ -855,7 +857,7 @@ static BOOL add_fd_to_cache( HANDLE handle, int fd, enum server_fd_type type,
  * Caller must hold fd_cache_section.
  */
 static inline int get_cached_fd( HANDLE handle, enum server_fd_type *type,
-                                 unsigned int *access, unsigned int *options )
+                                 unsigned int *access, unsigned int *options, int *pipe_ring )
 {
     unsigned int entry, idx = handle_to_index( handle, &entry );
     int fd = -1;
@@ -866,6 +868,7 @@ static inline int get_cached_fd( HANDLE handle, enum server_fd_type *type,
         if (type) *type = fd_cache[entry][idx].type;
         if (access) *access = fd_cache[entry][idx].access;
         if (options) *options = fd_cache[entry][idx].options;
+        if (pipe_ring) *pipe_ring = fd_cache[entry][idx].pipe_ring;
     }
     return fd;
 }
@@ -887,12 +890,14 @@ int server_remove_fd_from_cache( HANDLE handle )
 
 
 /***********************************************************************
- *           server_get_unix_fd
+ *           server_get_pipe_unix_fd
  *
+ * Same as server_get_unix_fd, but also tells whether the handle is a named
+ * pipe end that has a shared memory transport.
  * The returned unix_fd should be closed iff needs_close is non-zero.
  */
-int server_get_unix_fd( HANDLE handle, unsigned int wanted_access, int *unix_fd,
-                        int *needs_close, enum server_fd_type *type, unsigned int *options )
+int server_get_pipe_unix_fd( HANDLE handle, unsigned int wanted_access, int *unix_fd, int *needs_close,
+                             enum server_fd_type *type, unsigned int *options, int *pipe_ring )
 {
     sigset_t sigset;
     obj_handle_t fd_handle;
@@ -905,7 +910,8 @@ int server_get_unix_fd( HANDLE handle, unsigned int wanted_access, int *unix_fd,
 
     server_enter_uninterrupted_section( &fd_cache_section, &sigset );
 
-    fd = get_cached_fd( handle, type, &access, options );
+    if (pipe_ring) *pipe_ring = 0;
+    fd = get_cached_fd( handle, type, &access, options, pipe_ring );
     if (fd != -1) goto done;
 
     SERVER_START_REQ( get_handle_fd )
@@ -915,13 +921,14 @@ int server_get_unix_fd( HANDLE handle, unsigned int wanted_access, int *unix_fd,
         {
             if (type) *type = reply->type;
             if (options) *options = reply->options;
+            if (pipe_ring) *pipe_ring = reply->pipe_ring;
             access = reply->access;
             if ((fd = receive_fd( &fd_handle )) != -1)
             {
                 assert( wine_server_ptr_handle(fd_handle) == handle );
                 *needs_close = (!reply->cacheable ||
-                                !add_fd_to_cache( handle, fd, reply->type,
-                                                  reply->access, reply->options ));
+                                !add_fd_to_cache( handle, fd, reply->type, reply->access,
+                                                  reply->options, reply->pipe_ring ));
             }
             else ret = STATUS_TOO_MANY_OPENED_FILES;
         }
@@ -940,6 +947,53 @@ done:
 }
 
 
+/***********************************************************************
+ *           server_get_unix_fd
+ *
+ * The returned unix_fd should be closed iff needs_close is non-zero.
+ */
+int server_get_unix_fd( HANDLE handle, unsigned int wanted_access, int *unix_fd,
+                        int *needs_close, enum server_fd_type *type, unsigned int *options )
+{
+    return server_get_pipe_unix_fd( handle, wanted_access, unix_fd, needs_close, type, options, NULL );
+}
+
+
+/***********************************************************************
+ *           server_get_named_pipe_ring
+ *
+ * Retrieve the shared memory transport of a connected named pipe.
+ * The returned unix_fd must be closed by the caller.
+ */
+NTSTATUS server_get_named_pipe_ring( HANDLE handle, int *unix_fd, SIZE_T *size, int *end )
+{
+    sigset_t sigset;
+    obj_handle_t fd_handle;
+    NTSTATUS ret;
+
+    *unix_fd = -1;
+    server_enter_uninterrupted_section( &fd_cache_section, &sigset );
+
+    SERVER_START_REQ( get_named_pipe_ring )
+    {
+        req->handle = wine_server_obj_handle( handle );
+        if (!(ret = wine_server_call( req )))
+        {
+            *size = reply->size;
+            *end  = reply->end;
+            if ((*unix_fd = receive_fd( &fd_handle )) != -1)
+                assert( wine_server_ptr_handle(fd_handle) == handle );
+            else
+                ret = STATUS_TOO_MANY_OPENED_FILES;
+        }
+    }
+    SERVER_END_REQ;
+
+    server_leave_uninterrupted_section( &fd_cache_section, &sigset );
+    return ret;
+}
+
+
 /***********************************************************************
  *           wine_server_fd_to_handle   (NTDLL.@)
  *
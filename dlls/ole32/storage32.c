@@ -3020,6 +3020,7 @@ static HRESULT StorageImpl_Refresh(StorageImpl *This, BOOL new_object, BOOL crea
   DirEntry currentEntry;
   DirRef      currentEntryRef;
   BlockChainStream *blockChainStream;
+  ULONG i;
 
   if (create)
   {
@@ -3086,7 +3087,12 @@ static HRESULT StorageImpl_Refresh(StorageImpl *This, BOOL new_object, BOOL crea
   /*
    * There is no block depot cached yet.
    */
-  This->indexBlockDepotCached = 0xFFFFFFFF;
+  for (i=0; i<BLOCKDEPOT_CACHE_SIZE; i++)
+  {
+    This->blockDepotCache[i].depotIndex = 0xFFFFFFFF;
+    This->blockDepotCache[i].lastUse = 0;
+  }
+  This->blockDepotCacheTick = 0;
   This->indexExtBlockDepotCached = 0xFFFFFFFF;
 
   /*
@@ -3101,7 +3107,6 @@ static HRESULT StorageImpl_Refresh(StorageImpl *This, BOOL new_object, BOOL crea
   {
     ULONG current_block = This->extBigBlockDepotStart;
     ULONG cache_size = This->extBigBlockDepotCount * 2;
-    ULONG i;
 
     This->extBigBlockDepotLocations = HeapAlloc(GetProcessHeap(), 0, sizeof(ULONG) * cache_size);
     if (!This->extBigBlockDepotLocations)
@@ -3218,7 +3223,6 @@ static HRESULT StorageImpl_Refresh(StorageImpl *This, BOOL new_object, BOOL crea
 
   if (!new_object)
   {
-    int i;
     for (i=0; i<BLOCKCHAIN_CACHE_SIZE; i++)
     {
       BlockChainStream_Destroy(This->blockChainCache[i]);
@@ -3737,6 +3741,7 @@ static HRESULT StorageImpl_GetNextBlockInChain(
   BYTE depotBuffer[MAX_BIG_BLOCK_SIZE];
   ULONG read;
   ULONG depotBlockIndexPos;
+  struct BlockDepotCache *cached = NULL;
   int index, num_blocks;
 
   *nextBlockIndex   = BLOCK_SPECIAL;
@@ -3749,12 +3754,22 @@ static HRESULT StorageImpl_GetNextBlockInChain(
   }
 
   /*
-   * Cache the currently accessed depot block.
+   * Look for the depot block in the cache, evicting the least recently
+   * used one if it isn't there.
    */
-  if (depotBlockCount != This->indexBlockDepotCached)
+  for (index = 0; index < BLOCKDEPOT_CACHE_SIZE; index++)
   {
-    This->indexBlockDepotCached = depotBlockCount;
+    if (This->blockDepotCache[index].depotIndex == depotBlockCount)
+    {
+      cached = &This->blockDepotCache[index];
+      break;
+    }
+    if (!cached || This->blockDepotCache[index].lastUse < cached->lastUse)
+      cached = &This->blockDepotCache[index];
+  }
 
+  if (cached->depotIndex != depotBlockCount)
+  {
     if (depotBlockCount < COUNT_BBDEPOTINHEADER)
     {
       depotBlockIndexPos = This->bigBlockDepotStart[depotBlockCount];
@@ -3767,6 +3782,8 @@ static HRESULT StorageImpl_GetNextBlockInChain(
       depotBlockIndexPos = Storage32Impl_GetExtDepotBlock(This, depotBlockCount);
     }
 
+    cached->depotIndex = 0xFFFFFFFF;
+
     StorageImpl_ReadBigBlock(This, depotBlockIndexPos, depotBuffer, &read);
 
     if (!read)
@@ -3775,13 +3792,14 @@ static HRESULT StorageImpl_GetNextBlockInChain(
     num_blocks = This->bigBlockSize / 4;
 
     for (index = 0; index < num_blocks; index++)
-    {
-      StorageUtl_ReadDWord(depotBuffer, index*sizeof(ULONG), nextBlockIndex);
-      This->blockDepotCached[index] = *nextBlockIndex;
-    }
+      StorageUtl_ReadDWord(depotBuffer, index*sizeof(ULONG), &cached->blocks[index]);
+
+    cached->depotIndex = depotBlockCount;
   }
 
-  *nextBlockIndex = This->blockDepotCached[depotBlockOffset/sizeof(ULONG)];
+  cached->lastUse = ++This->blockDepotCacheTick;
+
+  *nextBlockIndex = cached->blocks[depotBlockOffset/sizeof(ULONG)];
 
   return S_OK;
 }
@@ -3835,6 +3853,7 @@ static void StorageImpl_SetNextBlockInChain(
   ULONG depotBlockCount  = offsetInDepot / This->bigBlockSize;
   ULONG depotBlockOffset = offsetInDepot % This->bigBlockSize;
   ULONG depotBlockIndexPos;
+  int i;
 
   assert(depotBlockCount < This->bigBlockDepotCount);
   assert(blockIndex != nextBlock);
@@ -3863,9 +3882,13 @@ static void StorageImpl_SetNextBlockInChain(
   /*
    * Update the cached block depot, if necessary.
    */
-  if (depotBlockCount == This->indexBlockDepotCached)
+  for (i=0; i<BLOCKDEPOT_CACHE_SIZE; i++)
   {
-    This->blockDepotCached[depotBlockOffset/sizeof(ULONG)] = nextBlock;
+    if (This->blockDepotCache[i].depotIndex == depotBlockCount)
+    {
+      This->blockDepotCache[i].blocks[depotBlockOffset/sizeof(ULONG)] = nextBlock;
+      break;
+    }
   }
 }
 
@@ -6867,6 +6890,11 @@ ULONG BlockChainStream_GetSectorOfOffset(BlockChainStream *This, ULONG offset)
   return This->indexCache[min_run].firstSector + offset - This->indexCache[min_run].firstOffset;
 }
 
+static BOOL BlockChainStream_IsBlockCached(BlockChainStream *This, ULONG index)
+{
+  return This->cachedBlocks[0].index == index || This->cachedBlocks[1].index == index;
+}
+
 HRESULT BlockChainStream_GetBlockAtOffset(BlockChainStream *This,
     ULONG index, BlockChainBlock **block, ULONG *sector, BOOL create)
 {
@@ -7029,7 +7057,7 @@ HRESULT BlockChainStream_ReadAt(BlockChainStream* This,
   ULONG blockNoInSequence = offset.QuadPart / This->parentStorage->bigBlockSize;
   ULONG offsetInBlock     = offset.QuadPart % This->parentStorage->bigBlockSize;
   ULONG bytesToReadInBuffer;
-  ULONG blockIndex;
+  ULONG blockIndex, blocksToRead;
   BYTE* bufferWalker;
   ULARGE_INTEGER stream_size;
   HRESULT hr;
@@ -7071,9 +7099,22 @@ HRESULT BlockChainStream_ReadAt(BlockChainStream* This,
     if (FAILED(hr))
       return hr;
 
+    blocksToRead = 1;
+
     if (!cachedBlock)
     {
-      /* Not in cache, and we're going to read past the end of the block. */
+      /* Not in cache, and we're going to read past the end of the block.
+       * Read the following blocks in the same call as long as they are
+       * stored in consecutive sectors, aren't cached, and aren't the last
+       * one. */
+      while (size - bytesToReadInBuffer > This->parentStorage->bigBlockSize &&
+             !BlockChainStream_IsBlockCached(This, blockNoInSequence + blocksToRead) &&
+             BlockChainStream_GetSectorOfOffset(This, blockNoInSequence + blocksToRead) == blockIndex + blocksToRead)
+      {
+        bytesToReadInBuffer += This->parentStorage->bigBlockSize;
+        blocksToRead++;
+      }
+
       ulOffset.QuadPart = StorageImpl_GetBigBlockOffset(This->parentStorage, blockIndex) +
                                offsetInBlock;
 
@@ -7098,7 +7139,7 @@ HRESULT BlockChainStream_ReadAt(BlockChainStream* This,
       bytesReadAt = bytesToReadInBuffer;
     }
 
-    blockNoInSequence++;
+    blockNoInSequence += blocksToRead;
     bufferWalker += bytesReadAt;
     size         -= bytesReadAt;
     *bytesRead   += bytesReadAt;
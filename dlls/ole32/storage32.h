@@ -364,6 +364,16 @@ void StorageBaseImpl_RemoveStream(StorageBaseImpl * stg, StgStreamImpl * strm) D
 /* Number of BlockChainStream objects to cache in a StorageImpl */
 #define BLOCKCHAIN_CACHE_SIZE 4
 
+/* Number of big block depot sectors to cache in a StorageImpl */
+#define BLOCKDEPOT_CACHE_SIZE 8
+
+struct BlockDepotCache
+{
+  ULONG depotIndex; /* 0xffffffff if unused */
+  ULONG lastUse;
+  ULONG blocks[MAX_BIG_BLOCK_SIZE / 4];
+};
+
 /****************************************************************************
  * Storage32Impl definitions.
  *
@@ -395,8 +405,9 @@ struct StorageImpl
   ULONG extBlockDepotCached[MAX_BIG_BLOCK_SIZE / 4];
   ULONG indexExtBlockDepotCached;
 
-  ULONG blockDepotCached[MAX_BIG_BLOCK_SIZE / 4];
-  ULONG indexBlockDepotCached;
+  /* Most recently used sectors of the big block depot */
+  struct BlockDepotCache blockDepotCache[BLOCKDEPOT_CACHE_SIZE];
+  ULONG blockDepotCacheTick;
   ULONG prevFreeBlock;
 
   /* All small blocks before this one are known to be in use. */
@@ -839,6 +839,23 @@ static HRESULT WINAPI Widget_neg_restrict(IWidget* iface, INT *i)
     return S_OK;
 }
 
+static HRESULT WINAPI Widget_Scalars(IWidget* iface, BYTE b, short s, VARIANT_BOOL vb, int i, double d,
+                                     STATE st, OLE_COLOR clr, int *sum, double *dval)
+{
+    trace("Scalars(%u, %d, %d, %d, %f, %d, %08x, %p, %p)\n", b, s, vb, i, d, st, clr, sum, dval);
+    ok(b == 0xfe, "got b=%u\n", b);
+    ok(s == -2, "got s=%d\n", s);
+    ok(vb == VARIANT_TRUE, "got vb=%d\n", vb);
+    ok(i == -100000, "got i=%d\n", i);
+    ok(d == 2.5, "got d=%f\n", d);
+    ok(st == STATE_WIDGETIFIED, "got st=%d\n", st);
+    ok(clr == 0x00ff8040, "got clr=%08x\n", clr);
+    ok(*dval == 1.5, "got *dval=%f\n", *dval);
+    *sum = b + s + i;
+    *dval *= d;
+    return S_OK;
+}
+
 static const struct IWidgetVtbl Widget_VTable =
 {
     Widget_QueryInterface,
@@ -876,7 +893,8 @@ static const struct IWidgetVtbl Widget_VTable =
     Widget_put_prop_opt_arg,
     Widget_put_prop_req_arg,
     Widget__restrict,
-    Widget_neg_restrict
+    Widget_neg_restrict,
+    Widget_Scalars
 };
 
 static HRESULT WINAPI StaticWidget_QueryInterface(IStaticWidget *iface, REFIID riid, void **ppvObject)
@@ -1214,6 +1232,8 @@ static void test_typelibmarshal(void)
     MYSTRUCT mystruct;
     MYSTRUCT mystructArray[5];
     UINT uval;
+    int ival;
+    double dval;
 
     ok(pKEW != NULL, "Widget creation failed\n");
 
@@ -1721,6 +1741,14 @@ static void test_typelibmarshal(void)
     ok(V_I4(&varresult) == DISPID_TM_NEG_RESTRICTED, "got %x\n", V_I4(&varresult));
     VariantClear(&varresult);
 
+    /* scalar [in] parameters of every width, with [out] pointers after them */
+    ival = 0xdeadbeef;
+    dval = 1.5;
+    hr = IWidget_Scalars(pWidget, 0xfe, -2, VARIANT_TRUE, -100000, 2.5, STATE_WIDGETIFIED, 0x00ff8040, &ival, &dval);
+    ok_ole_success(hr, IWidget_Scalars);
+    ok(ival == 0xfe - 2 - 100000, "got %d\n", ival);
+    ok(dval == 3.75, "got %f\n", dval);
+
     IDispatch_Release(pDispatch);
     IWidget_Release(pWidget);
 
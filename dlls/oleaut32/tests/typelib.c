@@ -4193,6 +4193,77 @@ static void test_create_typelibs(void)
 }
 
 
+static void test_dual_GetRefTypeInfo(void)
+{
+    static WCHAR testW[] = {'t','e','s','t',0};
+    LPOLESTR names[1] = { testW };
+    WCHAR filename[MAX_PATH];
+    const char *filenameA;
+    ITypeLib *typelib;
+    ITypeInfo *typeinfo, *dual_info, *ti;
+    TYPEATTR *attr;
+    FUNCDESC *desc;
+    HREFTYPE reftype;
+    MEMBERID memid, dual_memid;
+    UINT count, i;
+    HRESULT hr;
+
+    filenameA = create_test_typelib(3);
+    MultiByteToWideChar(CP_ACP, 0, filenameA, -1, filename, MAX_PATH);
+
+    hr = LoadTypeLib(filename, &typelib);
+    ok(hr == S_OK, "got %08x\n", hr);
+
+    /* get the alternate version before anything decodes the members */
+    hr = ITypeLib_GetTypeInfoOfGuid(typelib, &IID_Iole_dual_from_disp, &typeinfo);
+    ok(hr == S_OK, "got %08x\n", hr);
+
+    hr = ITypeInfo_GetRefTypeOfImplType(typeinfo, -1, &reftype);
+    ok(hr == S_OK, "got %08x\n", hr);
+
+    hr = ITypeInfo_GetRefTypeInfo(typeinfo, reftype, &dual_info);
+    ok(hr == S_OK, "got %08x\n", hr);
+
+    hr = ITypeInfo_GetTypeAttr(dual_info, &attr);
+    ok(hr == S_OK, "got %08x\n", hr);
+    ok(attr->typekind == TKIND_INTERFACE, "got kind %d\n", attr->typekind);
+    ok(attr->cFuncs == 1, "got %d funcs\n", attr->cFuncs);
+    ITypeInfo_ReleaseTypeAttr(dual_info, attr);
+
+    hr = ITypeInfo_GetFuncDesc(dual_info, 0, &desc);
+    ok(hr == S_OK, "got %08x\n", hr);
+    ITypeInfo_ReleaseFuncDesc(dual_info, desc);
+
+    dual_memid = 0xdeadbeef;
+    hr = ITypeInfo_GetIDsOfNames(dual_info, names, 1, &dual_memid);
+    ok(hr == S_OK, "got %08x\n", hr);
+
+    ITypeInfo_Release(dual_info);
+
+    memid = 0xdeadbeef;
+    hr = ITypeInfo_GetIDsOfNames(typeinfo, names, 1, &memid);
+    ok(hr == S_OK, "got %08x\n", hr);
+    ok(memid == dual_memid, "got %08x, expected %08x\n", memid, dual_memid);
+
+    ITypeInfo_Release(typeinfo);
+
+    /* the members of every other typeinfo must still be readable */
+    count = ITypeLib_GetTypeInfoCount(typelib);
+    for (i = 0; i < count; i++)
+    {
+        hr = ITypeLib_GetTypeInfo(typelib, i, &ti);
+        ok(hr == S_OK, "%u: got %08x\n", i, hr);
+
+        hr = ITypeInfo_GetIDsOfNames(ti, names, 1, &memid);
+        ok(hr == S_OK || hr == DISP_E_UNKNOWNNAME, "%u: got %08x\n", i, hr);
+
+        ITypeInfo_Release(ti);
+    }
+
+    ITypeLib_Release(typelib);
+    DeleteFileA(filenameA);
+}
+
 static void test_register_typelib(BOOL system_registration)
 {
     HRESULT hr;
@@ -5637,6 +5708,7 @@ START_TEST(typelib)
 
     test_register_typelib(TRUE);
     test_register_typelib(FALSE);
+    test_dual_GetRefTypeInfo();
     test_create_typelibs();
     test_LoadTypeLib();
     test_TypeInfo2_GetContainingTypeLib();
@@ -417,6 +417,26 @@ static HRESULT num_of_funcs(ITypeInfo *tinfo, unsigned int *num,
     return hr;
 }
 
+/* what a method needs to be marshalled, computed from its FUNCDESC once */
+typedef struct _param_plan {
+    DWORD	argsize;	/* stack size in DWORDs, see _argsize() */
+    DWORD	outsize;	/* bytes to clear behind an [out] only pointer */
+    WORD	wiresize;	/* bytes on the wire of a plain scalar, 0 if it needs serialize_param() */
+    WORD	valuesize;	/* bytes of the scalar in the argument */
+    BOOL	in;
+    BOOL	out;
+} param_plan;
+
+typedef struct _method_plan {
+    ITypeInfo		*tinfo;		/* typeinfo declaring the method */
+    const FUNCDESC	*fdesc;
+    BOOL		dispatch;	/* method of IDispatch itself */
+    DWORD		nrofargs;	/* stack size of all parameters in DWORDs */
+    param_plan		params[1];
+} method_plan;
+
+static void free_method_plans(method_plan **plans, unsigned int count);
+
 #ifdef __i386__
 
 #include "pshpack1.h"
@@ -454,6 +474,8 @@ typedef struct _TMProxyImpl {
     IUnknown				*outerunknown;
     IDispatch				*dispatch;
     IRpcProxyBuffer			*dispatch_proxy;
+    method_plan				**plans;
+    unsigned int			nr_plans;
 } TMProxyImpl;
 
 static inline TMProxyImpl *impl_from_IRpcProxyBuffer( IRpcProxyBuffer *iface )
@@ -501,6 +523,7 @@ TMProxyImpl_Release(LPRPCPROXYBUFFER iface)
         if (This->chanbuf) IRpcChannelBuffer_Release(This->chanbuf);
         VirtualFree(This->asmstubs, 0, MEM_RELEASE);
         HeapFree(GetProcessHeap(), 0, This->lpvtbl);
+        free_method_plans(This->plans, This->nr_plans);
         ITypeInfo_Release(This->tinfo);
         CoTaskMemFree(This);
     }
@@ -1340,10 +1363,166 @@ static inline BOOL is_out_elem(const ELEMDESC *elem)
     return (elem->u.paramdesc.wParamFlags & PARAMFLAG_FOUT || !elem->u.paramdesc.wParamFlags);
 }
 
+/* Types that serialize_param() copies to the wire as they are. */
+static BOOL get_scalar_size(ITypeInfo *tinfo, const TYPEDESC *tdesc, WORD *wiresize, WORD *valuesize)
+{
+    switch (tdesc->vt) {
+    case VT_DATE:
+    case VT_I8:
+    case VT_UI8:
+    case VT_R8:
+    case VT_CY:
+        *wiresize = *valuesize = 8;
+        return TRUE;
+    case VT_ERROR:
+    case VT_INT:
+    case VT_UINT:
+    case VT_I4:
+    case VT_R4:
+    case VT_UI4:
+        *wiresize = *valuesize = sizeof(DWORD);
+        return TRUE;
+    case VT_I2:
+    case VT_UI2:
+    case VT_BOOL:
+        *wiresize = sizeof(DWORD);
+        *valuesize = 2;
+        return TRUE;
+    case VT_I1:
+    case VT_UI1:
+        *wiresize = sizeof(DWORD);
+        *valuesize = 1;
+        return TRUE;
+    case VT_USERDEFINED: {
+        ITypeInfo *tinfo2;
+        TYPEATTR *tattr;
+        BOOL ret = FALSE;
+
+        if (FAILED(ITypeInfo_GetRefTypeInfo(tinfo, tdesc->u.hreftype, &tinfo2)))
+            return FALSE;
+        if (SUCCEEDED(ITypeInfo_GetTypeAttr(tinfo2, &tattr)))
+        {
+            if (tattr->typekind == TKIND_ENUM)
+            {
+                *wiresize = *valuesize = sizeof(DWORD);
+                ret = TRUE;
+            }
+            else if (tattr->typekind == TKIND_ALIAS)
+                ret = get_scalar_size(tinfo2, &tattr->tdescAlias, wiresize, valuesize);
+            ITypeInfo_ReleaseTypeAttr(tinfo2, tattr);
+        }
+        ITypeInfo_Release(tinfo2);
+        return ret;
+    }
+    default:
+        return FALSE;
+    }
+}
+
+static HRESULT build_method_plan(ITypeInfo *tinfo, int method, method_plan **ret)
+{
+    const FUNCDESC *fdesc;
+    ITypeInfo *tactual;
+    method_plan *plan;
+    HRESULT hres;
+    BSTR iname;
+    int i;
+
+    hres = get_funcdesc(tinfo, method, &tactual, &fdesc, &iname, NULL, NULL);
+    if (hres)
+        return hres;
+
+    plan = HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, FIELD_OFFSET(method_plan, params[fdesc->cParams]));
+    if (!plan)
+    {
+        SysFreeString(iname);
+        ITypeInfo_Release(tactual);
+        return E_OUTOFMEMORY;
+    }
+
+    plan->tinfo = tactual;
+    plan->fdesc = fdesc;
+    plan->dispatch = iname && !lstrcmpW(iname, IDispatchW);
+    SysFreeString(iname);
+
+    for (i = 0; i < fdesc->cParams; i++)
+    {
+        ELEMDESC *elem = &fdesc->lprgelemdescParam[i];
+        param_plan *param = &plan->params[i];
+
+        param->argsize = _argsize(&elem->tdesc, tactual);
+        param->in = is_in_elem(elem);
+        param->out = is_out_elem(elem);
+        if (!param->in && elem->tdesc.vt == VT_PTR)
+            param->outsize = _xsize(elem->tdesc.u.lptdesc, tactual);
+        if (!get_scalar_size(tactual, &elem->tdesc, &param->wiresize, &param->valuesize))
+            param->wiresize = param->valuesize = 0;
+        plan->nrofargs += param->argsize;
+    }
+
+    *ret = plan;
+    return S_OK;
+}
+
+static void free_method_plans(method_plan **plans, unsigned int count)
+{
+    unsigned int i;
+
+    if (!plans) return;
+
+    for (i = 0; i < count; i++)
+    {
+        if (!plans[i]) continue;
+        ITypeInfo_Release(plans[i]->tinfo);
+        HeapFree(GetProcessHeap(), 0, plans[i]);
+    }
+    HeapFree(GetProcessHeap(), 0, plans);
+}
+
+/* Returns the plan of a method, building it on its first call. */
+static HRESULT get_method_plan(ITypeInfo *tinfo, method_plan **plans, unsigned int count,
+                               int method, const method_plan **ret)
+{
+    method_plan *plan;
+    HRESULT hres;
+
+    if (method < 0 || method >= count)
+        return E_INVALIDARG;
+
+    if (!(plan = plans[method]))
+    {
+        hres = build_method_plan(tinfo, method, &plan);
+        if (hres)
+            return hres;
+
+        if (InterlockedCompareExchangePointer((void **)&plans[method], plan, NULL))
+        {
+            ITypeInfo_Release(plan->tinfo);
+            HeapFree(GetProcessHeap(), 0, plan);
+            plan = plans[method];
+        }
+    }
+
+    *ret = plan;
+    return S_OK;
+}
+
+static HRESULT read_scalar(marshal_state *buf, const param_plan *param, DWORD *arg)
+{
+    DWORD x[2];
+    HRESULT hres;
+
+    hres = xbuf_get(buf, (LPBYTE)x, param->wiresize);
+    if (hres == S_OK)
+        memcpy(arg, x, param->valuesize);
+    return hres;
+}
+
 static DWORD WINAPI xCall(int method, void **args)
 {
     TMProxyImpl *tpinfo = args[0];
     DWORD *xargs;
+    const method_plan	*plan;
     const FUNCDESC	*fdesc;
     HRESULT		hres;
     int			i;
@@ -1352,14 +1531,14 @@ static DWORD WINAPI xCall(int method, void **args)
     ULONG		status;
     BSTR		fname,iname;
     BSTR		names[10];
-    UINT		nrofnames;
+    UINT		nrofnames = 0;
     DWORD		remoteresult = 0;
     ITypeInfo 		*tinfo;
     IRpcChannelBuffer *chanbuf;
 
     EnterCriticalSection(&tpinfo->crit);
 
-    hres = get_funcdesc(tpinfo->tinfo,method,&tinfo,&fdesc,&iname,&fname,NULL);
+    hres = get_method_plan(tpinfo->tinfo,tpinfo->plans,tpinfo->nr_plans,method,&plan);
     if (hres) {
         ERR("Did not find typeinfo/funcdesc entry for method %d!\n",method);
         LeaveCriticalSection(&tpinfo->crit);
@@ -1369,7 +1548,6 @@ static DWORD WINAPI xCall(int method, void **args)
     if (!tpinfo->chanbuf)
     {
         WARN("Tried to use disconnected proxy\n");
-        ITypeInfo_Release(tinfo);
         LeaveCriticalSection(&tpinfo->crit);
         return RPC_E_DISCONNECTED;
     }
@@ -1378,7 +1556,15 @@ static DWORD WINAPI xCall(int method, void **args)
 
     LeaveCriticalSection(&tpinfo->crit);
 
+    tinfo = plan->tinfo;
+    fdesc = plan->fdesc;
+
+    /* names are only needed for the relay trace */
+    memset(names,0,sizeof(names));
     if (TRACE_ON(olerelay)) {
+        ITypeInfo_GetDocumentation(tinfo,-1,&iname,NULL,NULL,NULL);
+        ITypeInfo_GetDocumentation(tinfo,fdesc->memid,&fname,NULL,NULL,NULL);
+
        TRACE_(olerelay)("->");
 	if (iname)
 	    TRACE_(olerelay)("%s:",relaystr(iname));
@@ -1387,60 +1573,62 @@ static DWORD WINAPI xCall(int method, void **args)
 	else
 	    TRACE_(olerelay)("%d",method);
 	TRACE_(olerelay)("(");
-    }
 
-    SysFreeString(iname);
-    SysFreeString(fname);
+        SysFreeString(iname);
+        SysFreeString(fname);
+
+        if (ITypeInfo_GetNames(tinfo,fdesc->memid,names,sizeof(names)/sizeof(names[0]),&nrofnames))
+            nrofnames = 0;
+        if (nrofnames > sizeof(names)/sizeof(names[0]))
+            ERR("Need more names!\n");
+    }
 
     memset(&buf,0,sizeof(buf));
 
     /* normal typelib driven serializing */
 
-    /* Need them for hack below */
-    memset(names,0,sizeof(names));
-    if (ITypeInfo_GetNames(tinfo,fdesc->memid,names,sizeof(names)/sizeof(names[0]),&nrofnames))
-	nrofnames = 0;
-    if (nrofnames > sizeof(names)/sizeof(names[0]))
-	ERR("Need more names!\n");
-
     xargs = (DWORD *)(args + 1);
     for (i=0;i<fdesc->cParams;i++) {
 	ELEMDESC	*elem = fdesc->lprgelemdescParam+i;
+	const param_plan *param = &plan->params[i];
 	if (TRACE_ON(olerelay)) {
 	    if (i) TRACE_(olerelay)(",");
 	    if (i+1<nrofnames && names[i+1])
 		TRACE_(olerelay)("%s=",relaystr(names[i+1]));
 	}
 	/* No need to marshal other data than FIN and any VT_PTR. */
-        if (!is_in_elem(elem))
+        if (!param->in)
         {
             if (elem->tdesc.vt != VT_PTR)
             {
-                xargs+=_argsize(&elem->tdesc, tinfo);
+                xargs+=param->argsize;
                 TRACE_(olerelay)("[out]");
                 continue;
             }
             else
             {
-                memset( *(void **)xargs, 0, _xsize( elem->tdesc.u.lptdesc, tinfo ) );
+                memset( *(void **)xargs, 0, param->outsize );
             }
         }
 
-	hres = serialize_param(
-	    tinfo,
-	    is_in_elem(elem),
-	    TRACE_ON(olerelay),
-	    FALSE,
-	    &elem->tdesc,
-	    xargs,
-	    &buf
-	);
+	if (param->wiresize && !TRACE_ON(olerelay))
+	    hres = xbuf_add(&buf,(LPBYTE)xargs,param->wiresize);
+	else
+	    hres = serialize_param(
+		tinfo,
+		param->in,
+		TRACE_ON(olerelay),
+		FALSE,
+		&elem->tdesc,
+		xargs,
+		&buf
+	    );
 
 	if (hres) {
 	    ERR("Failed to serialize param, hres %x\n",hres);
 	    break;
 	}
-	xargs+=_argsize(&elem->tdesc, tinfo);
+	xargs+=param->argsize;
     }
     TRACE_(olerelay)(")");
 
@@ -1474,31 +1662,35 @@ static DWORD WINAPI xCall(int method, void **args)
     status = S_OK;
     for (i=0;i<fdesc->cParams;i++) {
 	ELEMDESC	*elem = fdesc->lprgelemdescParam+i;
+	const param_plan *param = &plan->params[i];
 
         if (i) TRACE_(olerelay)(",");
         if (i+1<nrofnames && names[i+1]) TRACE_(olerelay)("%s=",relaystr(names[i+1]));
 
 	/* No need to marshal other data than FOUT and any VT_PTR */
-	if (!is_out_elem(elem) && (elem->tdesc.vt != VT_PTR)) {
-	    xargs += _argsize(&elem->tdesc, tinfo);
+	if (!param->out && (elem->tdesc.vt != VT_PTR)) {
+	    xargs += param->argsize;
 	    TRACE_(olerelay)("[in]");
 	    continue;
 	}
-	hres = deserialize_param(
-	    tinfo,
-	    is_out_elem(elem),
-	    TRACE_ON(olerelay),
-	    FALSE,
-	    &(elem->tdesc),
-	    xargs,
-	    &buf
-        );
+	if (param->wiresize && !TRACE_ON(olerelay))
+	    hres = read_scalar(&buf, param, xargs);
+	else
+	    hres = deserialize_param(
+		tinfo,
+		param->out,
+		TRACE_ON(olerelay),
+		FALSE,
+		&(elem->tdesc),
+		xargs,
+		&buf
+	    );
 	if (hres) {
 	    ERR("Failed to unmarshall param, hres %x\n",hres);
 	    status = hres;
 	    break;
 	}
-	xargs += _argsize(&elem->tdesc, tinfo);
+	xargs += param->argsize;
     }
 
     hres = xbuf_get(&buf, (LPBYTE)&remoteresult, sizeof(DWORD));
@@ -1514,7 +1706,6 @@ exit:
         SysFreeString(names[i]);
     HeapFree(GetProcessHeap(),0,buf.base);
     IRpcChannelBuffer_Release(chanbuf);
-    ITypeInfo_Release(tinfo);
     TRACE("-- 0x%08x\n", hres);
     return hres;
 }
@@ -1727,26 +1918,22 @@ static inline HRESULT get_facbuf_for_iid(REFIID riid, IPSFactoryBuffer **facbuf)
 
 static HRESULT init_proxy_entry_point(TMProxyImpl *proxy, unsigned int num)
 {
-    int j;
     /* nrofargs including This */
     int nrofargs = 1;
-    ITypeInfo *tinfo2;
     TMAsmProxy	*xasm = proxy->asmstubs + num;
     HRESULT hres;
-    const FUNCDESC *fdesc;
+    const method_plan *plan;
 
-    hres = get_funcdesc(proxy->tinfo, num, &tinfo2, &fdesc, NULL, NULL, NULL);
+    hres = get_method_plan(proxy->tinfo, proxy->plans, proxy->nr_plans, num, &plan);
     if (hres) {
         ERR("GetFuncDesc %x should not fail here.\n",hres);
         return hres;
     }
-    ITypeInfo_Release(tinfo2);
     /* some args take more than 4 byte on the stack */
-    for (j=0;j<fdesc->cParams;j++)
-        nrofargs += _argsize(&fdesc->lprgelemdescParam[j].tdesc, proxy->tinfo);
+    nrofargs += plan->nrofargs;
 
 #ifdef __i386__
-    if (fdesc->callconv != CC_STDCALL) {
+    if (plan->fdesc->callconv != CC_STDCALL) {
         ERR("calling convention is not stdcall????\n");
         return E_FAIL;
     }
@@ -1765,7 +1952,7 @@ static HRESULT init_proxy_entry_point(TMProxyImpl *proxy, unsigned int num)
     xasm->lret          = 0xc2;
     xasm->bytestopop    = nrofargs * 4;
     xasm->nop           = 0x9090;
-    proxy->lpvtbl[fdesc->oVft / sizeof(void *)] = xasm;
+    proxy->lpvtbl[plan->fdesc->oVft / sizeof(void *)] = xasm;
 #else
     FIXME("not implemented on non i386\n");
     return E_FAIL;
@@ -1824,6 +2011,12 @@ PSFacBuf_CreateProxy(
     proxy->crit.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": TMProxyImpl.crit");
 
     proxy->lpvtbl = HeapAlloc(GetProcessHeap(), 0, vtbl_size);
+    proxy->plans = HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, nroffuncs * sizeof(*proxy->plans));
+    proxy->nr_plans = nroffuncs;
+    if (!proxy->lpvtbl || !proxy->plans) {
+        TMProxyImpl_Release(&proxy->IRpcProxyBuffer_iface);
+        return E_OUTOFMEMORY;
+    }
 
     /* if we derive from IDispatch then defer to its proxy for its methods */
     hres = ITypeInfo_GetTypeAttr(tinfo, &typeattr);
@@ -1906,6 +2099,8 @@ typedef struct _TMStubImpl {
     IID				iid;
     IRpcStubBuffer		*dispatch_stub;
     BOOL			dispatch_derivative;
+    method_plan			**plans;
+    unsigned int		nr_plans;
 } TMStubImpl;
 
 static inline TMStubImpl *impl_from_IRpcStubBuffer(IRpcStubBuffer *iface)
@@ -1950,6 +2145,7 @@ TMStubImpl_Release(LPRPCSTUBBUFFER iface)
         ITypeInfo_Release(This->tinfo);
         if (This->dispatch_stub)
             IRpcStubBuffer_Release(This->dispatch_stub);
+        free_method_plans(This->plans, This->nr_plans);
         CoTaskMemFree(This);
     }
     return refCount;
@@ -1994,15 +2190,13 @@ TMStubImpl_Invoke(
 {
 #ifdef __i386__
     int		i;
+    const method_plan *plan;
     const FUNCDESC *fdesc;
     TMStubImpl *This = impl_from_IRpcStubBuffer(iface);
     HRESULT	hres;
-    DWORD	*args = NULL, res, *xargs, nrofargs;
+    DWORD	*args = NULL, res, *xargs;
     marshal_state	buf;
-    UINT	nrofnames = 0;
-    BSTR	names[10];
-    BSTR	iname = NULL;
-    ITypeInfo 	*tinfo = NULL;
+    ITypeInfo 	*tinfo;
 
     TRACE("...\n");
 
@@ -2029,40 +2223,29 @@ TMStubImpl_Invoke(
         return IRpcStubBuffer_Invoke(This->dispatch_stub, xmsg, rpcchanbuf);
     }
 
+    hres = get_method_plan(This->tinfo,This->plans,This->nr_plans,xmsg->iMethod,&plan);
+    if (hres) {
+	ERR("GetFuncDesc on method %d failed with %x\n",xmsg->iMethod,hres);
+	return hres;
+    }
+    tinfo = plan->tinfo;
+    fdesc = plan->fdesc;
+
     memset(&buf,0,sizeof(buf));
     buf.size	= xmsg->cbBuffer;
     buf.base	= HeapAlloc(GetProcessHeap(), 0, xmsg->cbBuffer);
     memcpy(buf.base, xmsg->Buffer, xmsg->cbBuffer);
     buf.curoff	= 0;
 
-    hres = get_funcdesc(This->tinfo,xmsg->iMethod,&tinfo,&fdesc,&iname,NULL,NULL);
-    if (hres) {
-	ERR("GetFuncDesc on method %d failed with %x\n",xmsg->iMethod,hres);
-	return hres;
-    }
-
-    if (iname && !lstrcmpW(iname, IDispatchW))
+    if (plan->dispatch)
     {
         ERR("IDispatch cannot be marshaled by the typelib marshaler\n");
         hres = E_UNEXPECTED;
-        SysFreeString (iname);
         goto exit;
     }
 
-    SysFreeString (iname);
-
-    /* Need them for hack below */
-    memset(names,0,sizeof(names));
-    ITypeInfo_GetNames(tinfo,fdesc->memid,names,sizeof(names)/sizeof(names[0]),&nrofnames);
-    if (nrofnames > sizeof(names)/sizeof(names[0])) {
-	ERR("Need more names!\n");
-    }
-
     /*dump_FUNCDESC(fdesc);*/
-    nrofargs = 0;
-    for (i=0;i<fdesc->cParams;i++)
-	nrofargs += _argsize(&fdesc->lprgelemdescParam[i].tdesc, tinfo);
-    args = HeapAlloc(GetProcessHeap(),HEAP_ZERO_MEMORY,(nrofargs+1)*sizeof(DWORD));
+    args = HeapAlloc(GetProcessHeap(),HEAP_ZERO_MEMORY,(plan->nrofargs+1)*sizeof(DWORD));
     if (!args)
     {
         hres = E_OUTOFMEMORY;
@@ -2073,19 +2256,23 @@ TMStubImpl_Invoke(
     xargs = args+1;
     for (i=0;i<fdesc->cParams;i++) {
 	ELEMDESC	*elem = fdesc->lprgelemdescParam+i;
+	const param_plan *param = &plan->params[i];
 
-	hres = deserialize_param(
-	   tinfo,
-	   is_in_elem(elem),
-	   FALSE,
-	   TRUE,
-	   &(elem->tdesc),
-	   xargs,
-	   &buf
-	);
-	xargs += _argsize(&elem->tdesc, tinfo);
+	if (param->wiresize)
+	    hres = param->in ? read_scalar(&buf, param, xargs) : S_OK;
+	else
+	    hres = deserialize_param(
+	       tinfo,
+	       param->in,
+	       FALSE,
+	       TRUE,
+	       &(elem->tdesc),
+	       xargs,
+	       &buf
+	    );
+	xargs += param->argsize;
 	if (hres) {
-	    ERR("Failed to deserialize param %s, hres %x\n",relaystr(names[i+1]),hres);
+	    ERR("Failed to deserialize param %d, hres %x\n",i,hres);
 	    break;
 	}
     }
@@ -2120,16 +2307,21 @@ TMStubImpl_Invoke(
     xargs = args+1;
     for (i=0;i<fdesc->cParams;i++) {
 	ELEMDESC	*elem = fdesc->lprgelemdescParam+i;
-	hres = serialize_param(
-	   tinfo,
-	   is_out_elem(elem),
-	   FALSE,
-	   TRUE,
-	   &elem->tdesc,
-	   xargs,
-	   &buf
-	);
-	xargs += _argsize(&elem->tdesc, tinfo);
+	const param_plan *param = &plan->params[i];
+
+	if (param->wiresize)
+	    hres = param->out ? xbuf_add(&buf,(LPBYTE)xargs,param->wiresize) : S_OK;
+	else
+	    hres = serialize_param(
+	       tinfo,
+	       param->out,
+	       FALSE,
+	       TRUE,
+	       &elem->tdesc,
+	       xargs,
+	       &buf
+	    );
+	xargs += param->argsize;
 	if (hres) {
 	    ERR("Failed to stuballoc param, hres %x\n",hres);
 	    break;
@@ -2150,10 +2342,6 @@ TMStubImpl_Invoke(
         memcpy(xmsg->Buffer, buf.base, buf.curoff);
 
 exit:
-    for (i = 0; i < nrofnames; i++)
-        SysFreeString(names[i]);
-
-    ITypeInfo_Release(tinfo);
     HeapFree(GetProcessHeap(), 0, args);
 
     HeapFree(GetProcessHeap(), 0, buf.base);
@@ -2212,6 +2400,7 @@ PSFacBuf_CreateStub(
     ITypeInfo	*tinfo;
     TMStubImpl	*stub;
     TYPEATTR *typeattr;
+    unsigned int nroffuncs;
 
     TRACE("(%s,%p,%p)\n",debugstr_guid(riid),pUnkServer,ppStub);
 
@@ -2221,6 +2410,13 @@ PSFacBuf_CreateStub(
 	return hres;
     }
 
+    hres = num_of_funcs(tinfo, &nroffuncs, NULL);
+    if (FAILED(hres)) {
+        ERR("Cannot get number of functions for typeinfo %s\n",debugstr_guid(riid));
+        ITypeInfo_Release(tinfo);
+        return hres;
+    }
+
     stub = CoTaskMemAlloc(sizeof(TMStubImpl));
     if (!stub)
 	return E_OUTOFMEMORY;
@@ -2230,6 +2426,13 @@ PSFacBuf_CreateStub(
     stub->dispatch_stub = NULL;
     stub->dispatch_derivative = FALSE;
     stub->iid		= *riid;
+    stub->plans		= HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, nroffuncs * sizeof(*stub->plans));
+    stub->nr_plans	= nroffuncs;
+    if (!stub->plans) {
+        ITypeInfo_Release(tinfo);
+        CoTaskMemFree(stub);
+        return E_OUTOFMEMORY;
+    }
     hres = IRpcStubBuffer_Connect(&stub->IRpcStubBuffer_iface,pUnkServer);
     *ppStub = &stub->IRpcStubBuffer_iface;
     TRACE("IRpcStubBuffer: %p\n", stub);
@@ -1122,6 +1122,12 @@ typedef struct tagITypeLibImpl
     struct list ref_list;       /* list of ref types in this typelib */
     HREFTYPE dispatch_href;     /* reference to IDispatch, -1 if unused */
 
+    /* MSFT typelibs decode function and variable records on first use, from
+     * a private copy of the image that is freed once every typeinfo is done */
+    char *msft_image;
+    DWORD msft_image_len;
+    MSFT_SegDir msft_segdir;
+    int msft_pending;           /* number of typeinfos not decoded yet */
 
     /* typelibs are cached, keyed by path and index, so store the linked list info within them */
     struct list entry;
@@ -1264,6 +1270,9 @@ typedef struct tagITypeInfoImpl
     DWORD dwHelpContext;
     DWORD dwHelpStringContext;
 
+    /* offset of the MSFT member records, -1 once they are decoded */
+    LONG members_offset;
+
     /* functions  */
     TLBFuncDesc *funcdescs;
 
@@ -1581,9 +1590,12 @@ static void dump_TypeInfo(const ITypeInfoImpl * pty)
     TRACE("wTypeFlags: 0x%04x\n", pty->wTypeFlags);
     TRACE("parent tlb:%p index in TLB:%u\n",pty->pTypeLib, pty->index);
     if (pty->typekind == TKIND_MODULE) TRACE("dllname:%s\n", debugstr_w(TLB_get_bstr(pty->DllName)));
-    if (TRACE_ON(ole))
-        dump_TLBFuncDesc(pty->funcdescs, pty->cFuncs);
-    dump_TLBVarDesc(pty->vardescs, pty->cVars);
+    if (pty->members_offset == -1)
+    {
+        if (TRACE_ON(ole))
+            dump_TLBFuncDesc(pty->funcdescs, pty->cFuncs);
+        dump_TLBVarDesc(pty->vardescs, pty->cVars);
+    }
     dump_TLBImplType(pty->impltypes, pty->cImplTypes);
 }
 
@@ -2736,16 +2748,12 @@ static ITypeInfoImpl * MSFT_DoTypeInfo(
 /* note: InfoType's Help file and HelpStringDll come from the containing
  * library. Further HelpString and Docstring appear to be the same thing :(
  */
-    /* functions */
-    if(ptiRet->cFuncs >0 )
-        MSFT_DoFuncs(pcx, ptiRet, ptiRet->cFuncs,
-		    ptiRet->cVars,
-		    tiBase.memoffset, &ptiRet->funcdescs);
-    /* variables */
-    if(ptiRet->cVars >0 )
-        MSFT_DoVars(pcx, ptiRet, ptiRet->cFuncs,
-		   ptiRet->cVars,
-		   tiBase.memoffset, &ptiRet->vardescs);
+    /* functions and variables are decoded by ITypeInfoImpl_LoadMembers */
+    if(ptiRet->cFuncs > 0 || ptiRet->cVars > 0)
+    {
+        ptiRet->members_offset = tiBase.memoffset;
+        pLibInfo->msft_pending++;
+    }
     if(ptiRet->cImplTypes >0 ) {
         switch(ptiRet->typekind)
         {
@@ -2784,6 +2792,74 @@ static ITypeInfoImpl * MSFT_DoTypeInfo(
     return ptiRet;
 }
 
+static CRITICAL_SECTION members_section;
+static CRITICAL_SECTION_DEBUG members_section_debug =
+{
+    0, 0, &members_section,
+    { &members_section_debug.ProcessLocksList, &members_section_debug.ProcessLocksList },
+      0, 0, { (DWORD_PTR)(__FILE__ ": typeinfo members") }
+};
+static CRITICAL_SECTION members_section = { &members_section_debug, -1, 0, 0, 0, 0 };
+
+/*
+ * process the function and variable records of a typeinfo
+ */
+static void MSFT_DoMembers(TLBContext *pcx, ITypeInfoImpl *pTI)
+{
+    TRACE_(typelib)("decoding members of %s\n", debugstr_w(TLB_get_bstr(pTI->Name)));
+
+    if(pTI->cFuncs > 0)
+        MSFT_DoFuncs(pcx, pTI, pTI->cFuncs, pTI->cVars, pTI->members_offset, &pTI->funcdescs);
+    if(pTI->cVars > 0)
+        MSFT_DoVars(pcx, pTI, pTI->cFuncs, pTI->cVars, pTI->members_offset, &pTI->vardescs);
+
+    InterlockedExchange(&pTI->members_offset, -1);
+    pcx->pLibInfo->msft_pending--;
+}
+
+/*
+ * MSFT typeinfos only decode their functions and variables the first time
+ * something needs them
+ */
+static void ITypeInfoImpl_LoadMembers(ITypeInfoImpl *This)
+{
+    ITypeLibImpl *lib = This->pTypeLib;
+    TLBContext cx;
+
+    if (This->members_offset == -1)
+        return;
+
+    EnterCriticalSection(&members_section);
+
+    if (This->members_offset != -1)
+    {
+        cx.oStart = 0;
+        cx.pos = 0;
+        cx.length = lib->msft_image_len;
+        cx.mapping = lib->msft_image;
+        cx.pTblDir = &lib->msft_segdir;
+        cx.pLibInfo = lib;
+
+        MSFT_DoMembers(&cx, This);
+
+        if (!lib->msft_pending)
+        {
+            heap_free(lib->msft_image);
+            lib->msft_image = NULL;
+        }
+    }
+
+    LeaveCriticalSection(&members_section);
+}
+
+static void TLB_LoadAllMembers(ITypeLibImpl *This)
+{
+    int i;
+
+    for (i = 0; i < This->TypeInfoCount; ++i)
+        ITypeInfoImpl_LoadMembers(This->typeinfos[i]);
+}
+
 static HRESULT MSFT_ReadAllStrings(TLBContext *pcx)
 {
     char *string;
@@ -2874,7 +2950,9 @@ static HRESULT MSFT_ReadAllRefs(TLBContext *pcx)
  * place. This will cause a deliberate memory leak, but generally losing RAM for cycles is an acceptable
  * tradeoff here.
  */
-static struct list tlb_cache = LIST_INIT(tlb_cache);
+#define TLB_CACHE_HASH_SIZE 64
+
+static struct list tlb_cache[TLB_CACHE_HASH_SIZE];
 static CRITICAL_SECTION cache_section;
 static CRITICAL_SECTION_DEBUG cache_section_debug =
 {
@@ -2884,6 +2962,34 @@ static CRITICAL_SECTION_DEBUG cache_section_debug =
 };
 static CRITICAL_SECTION cache_section = { &cache_section_debug, -1, 0, 0, 0, 0 };
 
+/* must be called with cache_section held */
+static struct list *tlb_cache_bucket(const WCHAR *path, INT index)
+{
+    struct list *bucket;
+    UINT hash = index;
+
+    while(*path)
+        hash = hash * 31 + tolowerW(*path++);
+
+    bucket = &tlb_cache[hash % TLB_CACHE_HASH_SIZE];
+    if(!bucket->next)
+        list_init(bucket);
+    return bucket;
+}
+
+/* must be called with cache_section held */
+static ITypeLibImpl *tlb_cache_find(struct list *bucket, const WCHAR *path, INT index)
+{
+    ITypeLibImpl *entry;
+
+    LIST_FOR_EACH_ENTRY(entry, bucket, ITypeLibImpl, entry)
+    {
+        if (!strcmpiW(entry->path, path) && entry->index == index)
+            return entry;
+    }
+    return NULL;
+}
+
 
 typedef struct TLB_PEFile
 {
@@ -3311,6 +3417,7 @@ static HRESULT TLB_Mapping_Open(LPCWSTR path, LPVOID *ppBase, DWORD *pdwTLBLengt
 static HRESULT TLB_ReadTypeLib(LPCWSTR pszFileName, LPWSTR pszPath, UINT cchPath, ITypeLib2 **ppTypeLib)
 {
     ITypeLibImpl *entry;
+    struct list *bucket;
     HRESULT ret;
     INT index = 1;
     LPWSTR index_str, file = (LPWSTR)pszFileName;
@@ -3373,16 +3480,14 @@ static HRESULT TLB_ReadTypeLib(LPCWSTR pszFileName, LPWSTR pszPath, UINT cchPath
 
     /* We look the path up in the typelib cache. If found, we just addref it, and return the pointer. */
     EnterCriticalSection(&cache_section);
-    LIST_FOR_EACH_ENTRY(entry, &tlb_cache, ITypeLibImpl, entry)
+    entry = tlb_cache_find(tlb_cache_bucket(pszPath, index), pszPath, index);
+    if (entry)
     {
-        if (!strcmpiW(entry->path, pszPath) && entry->index == index)
-        {
-            TRACE("cache hit\n");
-            *ppTypeLib = &entry->ITypeLib2_iface;
-            ITypeLib2_AddRef(*ppTypeLib);
-            LeaveCriticalSection(&cache_section);
-            return S_OK;
-        }
+        TRACE("cache hit\n");
+        *ppTypeLib = &entry->ITypeLib2_iface;
+        ITypeLib2_AddRef(*ppTypeLib);
+        LeaveCriticalSection(&cache_section);
+        return S_OK;
     }
     LeaveCriticalSection(&cache_section);
 
@@ -3422,9 +3527,18 @@ static HRESULT TLB_ReadTypeLib(LPCWSTR pszFileName, LPWSTR pszPath, UINT cchPath
 	/* We should really canonicalise the path here. */
         impl->index = index;
 
-        /* FIXME: check if it has added already in the meantime */
         EnterCriticalSection(&cache_section);
-        list_add_head(&tlb_cache, &impl->entry);
+        bucket = tlb_cache_bucket(pszPath, index);
+        /* another thread may have loaded it in the meantime */
+        if ((entry = tlb_cache_find(bucket, pszPath, index)))
+        {
+            TRACE("cache hit\n");
+            ITypeLib2_Release(*ppTypeLib);
+            *ppTypeLib = &entry->ITypeLib2_iface;
+            ITypeLib2_AddRef(*ppTypeLib);
+        }
+        else
+            list_add_head(bucket, &impl->entry);
         LeaveCriticalSection(&cache_section);
         ret = S_OK;
     }
@@ -3675,6 +3789,22 @@ static ITypeLib2* ITypeLib2_Constructor_MSFT(LPVOID pLib, DWORD dwTLBLength)
         }
     }
 
+    /* keep what the members need, the mapping goes away once we return */
+    if(pTypeLibImpl->msft_pending)
+    {
+        pTypeLibImpl->msft_segdir = tlbSegDir;
+        pTypeLibImpl->msft_image_len = dwTLBLength;
+        pTypeLibImpl->msft_image = heap_alloc(dwTLBLength);
+        if(pTypeLibImpl->msft_image)
+            memcpy(pTypeLibImpl->msft_image, pLib, dwTLBLength);
+        else
+        {
+            for(i = 0; i < pTypeLibImpl->TypeInfoCount; i++)
+                if(pTypeLibImpl->typeinfos[i]->members_offset != -1)
+                    MSFT_DoMembers(&cx, pTypeLibImpl->typeinfos[i]);
+        }
+    }
+
 #ifdef _WIN64
     if(pTypeLibImpl->syskind == SYS_WIN32){
         for(i = 0; i < pTypeLibImpl->TypeInfoCount; ++i)
@@ -4722,6 +4852,7 @@ static HRESULT WINAPI ITypeLib2_fnQueryInterface(ITypeLib2 *iface, REFIID riid,
     else if(IsEqualIID(riid, &IID_ICreateTypeLib) ||
              IsEqualIID(riid, &IID_ICreateTypeLib2))
     {
+        TLB_LoadAllMembers(This);
         *ppv = &This->ICreateTypeLib2_iface;
     }
     else
@@ -4797,6 +4928,7 @@ static ULONG WINAPI ITypeLib2_fnRelease( ITypeLib2 *iface)
               heap_free(This->pTypeDesc[i].u.lpadesc);
 
       heap_free(This->pTypeDesc);
+      heap_free(This->msft_image);
 
       LIST_FOR_EACH_ENTRY_SAFE(pImpLib, pImpLibNext, &This->implib_list, TLBImpLib, entry)
       {
@@ -5067,6 +5199,8 @@ static HRESULT WINAPI ITypeLib2_fnIsName(
     int tic;
     UINT nNameBufLen = (lstrlenW(szNameBuf)+1)*sizeof(WCHAR), fdc, vrc;
 
+    TLB_LoadAllMembers(This);
+
     TRACE("(%p)->(%s,%08x,%p)\n", This, debugstr_w(szNameBuf), lHashVal,
 	  pfName);
 
@@ -5117,6 +5251,8 @@ static HRESULT WINAPI ITypeLib2_fnFindName(
     UINT count = 0;
     UINT len;
 
+    TLB_LoadAllMembers(This);
+
     TRACE("(%p)->(%s %u %p %p %p)\n", This, debugstr_w(name), hash, ppTInfo, memid, found);
 
     if ((!name && hash == 0) || !ppTInfo || !memid || !found)
@@ -5563,6 +5699,7 @@ static ITypeInfoImpl* ITypeInfoImpl_Constructor(void)
       pTypeInfoImpl->hreftype = -1;
       pTypeInfoImpl->memidConstructor = MEMBERID_NIL;
       pTypeInfoImpl->memidDestructor = MEMBERID_NIL;
+      pTypeInfoImpl->members_offset = -1;
       pTypeInfoImpl->pcustdata_list = &pTypeInfoImpl->custdata_list;
       list_init(pTypeInfoImpl->pcustdata_list);
     }
@@ -5588,7 +5725,10 @@ static HRESULT WINAPI ITypeInfo_fnQueryInterface(
         *ppvObject = This;
     else if(IsEqualIID(riid, &IID_ICreateTypeInfo) ||
              IsEqualIID(riid, &IID_ICreateTypeInfo2))
+    {
+        ITypeInfoImpl_LoadMembers(This);
         *ppvObject = &This->ICreateTypeInfo2_iface;
+    }
 
     if(*ppvObject){
         ITypeInfo2_AddRef(iface);
@@ -5620,7 +5760,7 @@ static void ITypeInfoImpl_Destroy(ITypeInfoImpl *This)
 
     TRACE("destroying ITypeInfo(%p)\n",This);
 
-    for (i = 0; i < This->cFuncs; ++i)
+    for (i = 0; This->funcdescs && i < This->cFuncs; ++i)
     {
         int j;
         TLBFuncDesc *pFInfo = &This->funcdescs[i];
@@ -5637,7 +5777,7 @@ static void ITypeInfoImpl_Destroy(ITypeInfoImpl *This)
     }
     heap_free(This->funcdescs);
 
-    for(i = 0; i < This->cVars; ++i)
+    for(i = 0; This->vardescs && i < This->cVars; ++i)
     {
         TLBVarDesc *pVInfo = &This->vardescs[i];
         if (pVInfo->vardesc_create) {
@@ -5923,6 +6063,8 @@ HRESULT ITypeInfoImpl_GetInternalFuncDesc( ITypeInfo *iface, UINT index, const F
 {
     ITypeInfoImpl *This = impl_from_ITypeInfo(iface);
 
+    ITypeInfoImpl_LoadMembers(This);
+
     if (index >= This->cFuncs)
         return TYPE_E_ELEMENTNOTFOUND;
 
@@ -6115,7 +6257,9 @@ static HRESULT WINAPI ITypeInfo_fnGetVarDesc( ITypeInfo2 *iface, UINT index,
         LPVARDESC  *ppVarDesc)
 {
     ITypeInfoImpl *This = impl_from_ITypeInfo2(iface);
-    const TLBVarDesc *pVDesc = &This->vardescs[index];
+    const TLBVarDesc *pVDesc;
+
+    ITypeInfoImpl_LoadMembers(This);
 
     TRACE("(%p) index %d\n", This, index);
 
@@ -6125,6 +6269,7 @@ static HRESULT WINAPI ITypeInfo_fnGetVarDesc( ITypeInfo2 *iface, UINT index,
     if (This->needs_layout)
         ICreateTypeInfo2_LayOut(&This->ICreateTypeInfo2_iface);
 
+    pVDesc = &This->vardescs[index];
     return TLB_AllocAndInitVarDesc(&pVDesc->vardesc, ppVarDesc);
 }
 
@@ -6141,6 +6286,9 @@ static HRESULT WINAPI ITypeInfo_fnGetNames( ITypeInfo2 *iface, MEMBERID memid,
     const TLBFuncDesc *pFDesc;
     const TLBVarDesc *pVDesc;
     int i;
+
+    ITypeInfoImpl_LoadMembers(This);
+
     TRACE("(%p) memid=0x%08x Maxname=%d\n", This, memid, cMaxNames);
 
     if(!rgBstrNames)
@@ -6300,6 +6448,8 @@ static HRESULT WINAPI ITypeInfo_fnGetIDsOfNames( ITypeInfo2 *iface,
     HRESULT ret=S_OK;
     UINT i, fdc;
 
+    ITypeInfoImpl_LoadMembers(This);
+
     TRACE("(%p) Name %s cNames %d\n", This, debugstr_w(*rgszNames),
             cNames);
 
@@ -6899,6 +7049,8 @@ static HRESULT WINAPI ITypeInfo_fnInvoke(
     const TLBFuncDesc *pFuncInfo;
     UINT fdc;
 
+    ITypeInfoImpl_LoadMembers(This);
+
     TRACE("(%p)(%p,id=%d,flags=0x%08x,%p,%p,%p,%p)\n",
       This,pIUnk,memid,wFlags,pDispParams,pVarResult,pExcepInfo,pArgErr
     );
@@ -7419,6 +7571,9 @@ static HRESULT WINAPI ITypeInfo_fnGetDocumentation( ITypeInfo2 *iface,
     ITypeInfoImpl *This = impl_from_ITypeInfo2(iface);
     const TLBFuncDesc *pFDesc;
     const TLBVarDesc *pVDesc;
+
+    ITypeInfoImpl_LoadMembers(This);
+
     TRACE("(%p) memid %d Name(%p) DocString(%p)"
           " HelpContext(%p) HelpFile(%p)\n",
         This, memid, pBstrName, pBstrDocString, pdwHelpContext, pBstrHelpFile);
@@ -7490,6 +7645,8 @@ static HRESULT WINAPI ITypeInfo_fnGetDllEntry( ITypeInfo2 *iface, MEMBERID memid
     ITypeInfoImpl *This = impl_from_ITypeInfo2(iface);
     const TLBFuncDesc *pFDesc;
 
+    ITypeInfoImpl_LoadMembers(This);
+
     TRACE("(%p)->(memid %x, %d, %p, %p, %p)\n", This, memid, invKind, pBstrDllName, pBstrName, pwOrdinal);
 
     if (pBstrDllName) *pBstrDllName = NULL;
@@ -7624,6 +7781,10 @@ static HRESULT WINAPI ITypeInfo_fnGetRefTypeInfo(
         */
         pTypeInfoImpl = ITypeInfoImpl_Constructor();
 
+        /* the copy shares the member lists, so they have to be decoded
+         * before it is made */
+        ITypeInfoImpl_LoadMembers(This);
+
         *pTypeInfoImpl = *This;
         pTypeInfoImpl->ref = 0;
         list_init(&pTypeInfoImpl->custdata_list);
@@ -7977,6 +8138,8 @@ static HRESULT WINAPI ITypeInfo2_fnGetFuncIndexOfMemId( ITypeInfo2 * iface,
     UINT fdc;
     HRESULT result;
 
+    ITypeInfoImpl_LoadMembers(This);
+
     for (fdc = 0; fdc < This->cFuncs; ++fdc){
         const TLBFuncDesc *pFuncInfo = &This->funcdescs[fdc];
         if(memid == pFuncInfo->funcdesc.memid && (invKind & pFuncInfo->funcdesc.invkind))
@@ -8005,6 +8168,8 @@ static HRESULT WINAPI ITypeInfo2_fnGetVarIndexOfMemId( ITypeInfo2 * iface,
     ITypeInfoImpl *This = impl_from_ITypeInfo2(iface);
     TLBVarDesc *pVarInfo;
 
+    ITypeInfoImpl_LoadMembers(This);
+
     TRACE("%p %d %p\n", iface, memid, pVarIndex);
 
     pVarInfo = TLB_get_vardesc_by_memberid(This->vardescs, This->cVars, memid);
@@ -8055,13 +8220,16 @@ static HRESULT WINAPI ITypeInfo2_fnGetFuncCustData(
 {
     ITypeInfoImpl *This = impl_from_ITypeInfo2(iface);
     TLBCustData *pCData;
-    TLBFuncDesc *pFDesc = &This->funcdescs[index];
+    TLBFuncDesc *pFDesc;
+
+    ITypeInfoImpl_LoadMembers(This);
 
     TRACE("%p %u %s %p\n", This, index, debugstr_guid(guid), pVarVal);
 
     if(index >= This->cFuncs)
         return TYPE_E_ELEMENTNOTFOUND;
 
+    pFDesc = &This->funcdescs[index];
     pCData = TLB_get_custdata_by_guid(&pFDesc->custdata_list, guid);
     if(!pCData)
         return TYPE_E_ELEMENTNOTFOUND;
@@ -8085,7 +8253,9 @@ static HRESULT WINAPI ITypeInfo2_fnGetParamCustData(
 {
     ITypeInfoImpl *This = impl_from_ITypeInfo2(iface);
     TLBCustData *pCData;
-    TLBFuncDesc *pFDesc = &This->funcdescs[indexFunc];
+    TLBFuncDesc *pFDesc;
+
+    ITypeInfoImpl_LoadMembers(This);
 
     TRACE("%p %u %u %s %p\n", This, indexFunc, indexParam,
             debugstr_guid(guid), pVarVal);
@@ -8093,6 +8263,7 @@ static HRESULT WINAPI ITypeInfo2_fnGetParamCustData(
     if(indexFunc >= This->cFuncs)
         return TYPE_E_ELEMENTNOTFOUND;
 
+    pFDesc = &This->funcdescs[indexFunc];
     if(indexParam >= pFDesc->funcdesc.cParams)
         return TYPE_E_ELEMENTNOTFOUND;
 
@@ -8118,13 +8289,16 @@ static HRESULT WINAPI ITypeInfo2_fnGetVarCustData(
 {
     ITypeInfoImpl *This = impl_from_ITypeInfo2(iface);
     TLBCustData *pCData;
-    TLBVarDesc *pVDesc = &This->vardescs[index];
+    TLBVarDesc *pVDesc;
+
+    ITypeInfoImpl_LoadMembers(This);
 
     TRACE("%p %s %p\n", This, debugstr_guid(guid), pVarVal);
 
     if(index >= This->cVars)
         return TYPE_E_ELEMENTNOTFOUND;
 
+    pVDesc = &This->vardescs[index];
     pCData = TLB_get_custdata_by_guid(&pVDesc->custdata_list, guid);
     if(!pCData)
         return TYPE_E_ELEMENTNOTFOUND;
@@ -8182,6 +8356,9 @@ static HRESULT WINAPI ITypeInfo2_fnGetDocumentation2(
     ITypeInfoImpl *This = impl_from_ITypeInfo2(iface);
     const TLBFuncDesc *pFDesc;
     const TLBVarDesc *pVDesc;
+
+    ITypeInfoImpl_LoadMembers(This);
+
     TRACE("(%p) memid %d lcid(0x%x)  HelpString(%p) "
           "HelpStringContext(%p) HelpStringDll(%p)\n",
           This, memid, lcid, pbstrHelpString, pdwHelpStringContext,
@@ -8253,13 +8430,16 @@ static HRESULT WINAPI ITypeInfo2_fnGetAllFuncCustData(
 	CUSTDATA *pCustData)
 {
     ITypeInfoImpl *This = impl_from_ITypeInfo2(iface);
-    TLBFuncDesc *pFDesc = &This->funcdescs[index];
+    TLBFuncDesc *pFDesc;
+
+    ITypeInfoImpl_LoadMembers(This);
 
     TRACE("%p %u %p\n", This, index, pCustData);
 
     if(index >= This->cFuncs)
         return TYPE_E_ELEMENTNOTFOUND;
 
+    pFDesc = &This->funcdescs[index];
     return TLB_copy_all_custdata(&pFDesc->custdata_list, pCustData);
 }
 
@@ -8272,13 +8452,16 @@ static HRESULT WINAPI ITypeInfo2_fnGetAllParamCustData( ITypeInfo2 * iface,
     UINT indexFunc, UINT indexParam, CUSTDATA *pCustData)
 {
     ITypeInfoImpl *This = impl_from_ITypeInfo2(iface);
-    TLBFuncDesc *pFDesc = &This->funcdescs[indexFunc];
+    TLBFuncDesc *pFDesc;
+
+    ITypeInfoImpl_LoadMembers(This);
 
     TRACE("%p %u %u %p\n", This, indexFunc, indexParam, pCustData);
 
     if(indexFunc >= This->cFuncs)
         return TYPE_E_ELEMENTNOTFOUND;
 
+    pFDesc = &This->funcdescs[indexFunc];
     if(indexParam >= pFDesc->funcdesc.cParams)
         return TYPE_E_ELEMENTNOTFOUND;
 
@@ -8294,13 +8477,16 @@ static HRESULT WINAPI ITypeInfo2_fnGetAllVarCustData( ITypeInfo2 * iface,
     UINT index, CUSTDATA *pCustData)
 {
     ITypeInfoImpl *This = impl_from_ITypeInfo2(iface);
-    TLBVarDesc * pVDesc = &This->vardescs[index];
+    TLBVarDesc * pVDesc;
+
+    ITypeInfoImpl_LoadMembers(This);
 
     TRACE("%p %u %p\n", This, index, pCustData);
 
     if(index >= This->cVars)
         return TYPE_E_ELEMENTNOTFOUND;
 
+    pVDesc = &This->vardescs[index];
     return TLB_copy_all_custdata(&pVDesc->custdata_list, pCustData);
 }
 
@@ -8528,6 +8714,8 @@ static HRESULT WINAPI ITypeComp_fnBind(
     HRESULT hr = DISP_E_MEMBERNOTFOUND;
     UINT fdc;
 
+    ITypeInfoImpl_LoadMembers(This);
+
     TRACE("(%p)->(%s, %x, 0x%x, %p, %p, %p)\n", This, debugstr_w(szName), lHash, wFlags, ppTInfo, pDescKind, pBindPtr);
 
     *pDescKind = DESCKIND_NONE;
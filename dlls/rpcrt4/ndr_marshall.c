@@ -780,6 +780,87 @@ static void validate_string_data(MIDL_STUB_MESSAGE *pStubMsg, ULONG bufsize, ULO
         }
 }
 
+/* Members of bogus structures and arrays that are laid out identically in
+ * memory and in the buffer can be copied in one go instead of one member at
+ * a time.  The member list is short, so it is simply walked on every call. */
+static ULONG analyse_blittable_members(PFORMAT_STRING pFormat, ULONG *align)
+{
+  PFORMAT_STRING desc;
+  ULONG size = 0, n;
+
+  *align = 1;
+  while (*pFormat != RPC_FC_END) {
+    switch (*pFormat) {
+    case RPC_FC_BYTE:
+    case RPC_FC_CHAR:
+    case RPC_FC_SMALL:
+    case RPC_FC_USMALL:
+      size += 1;
+      break;
+    case RPC_FC_WCHAR:
+    case RPC_FC_SHORT:
+    case RPC_FC_USHORT:
+      size += 2;
+      break;
+    case RPC_FC_LONG:
+    case RPC_FC_ULONG:
+    case RPC_FC_ENUM32:
+    case RPC_FC_FLOAT:
+      size += 4;
+      break;
+    case RPC_FC_HYPER:
+    case RPC_FC_DOUBLE:
+      size += 8;
+      break;
+    case RPC_FC_ALIGNM2:
+    case RPC_FC_ALIGNM4:
+    case RPC_FC_ALIGNM8:
+      /* memory-only alignment; fine as long as it doesn't add padding */
+      n = *pFormat == RPC_FC_ALIGNM2 ? 2 : *pFormat == RPC_FC_ALIGNM4 ? 4 : 8;
+      if (size & (n - 1)) return 0;
+      if (n > *align) *align = n;
+      break;
+    case RPC_FC_EMBEDDED_COMPLEX:
+      /* simple structures are copied as is, but they align the buffer */
+      if (pFormat[1]) return 0;
+      desc = pFormat + 2 + *(const SHORT*)(pFormat + 2);
+      if (*desc != RPC_FC_STRUCT) return 0;
+      n = desc[1] + 1;
+      if (size & (n - 1)) return 0;
+      if (n > *align) *align = n;
+      size += *(const WORD*)(desc + 2);
+      pFormat += 4;
+      continue;
+    case RPC_FC_PAD:
+      break;
+    default:
+      /* pointers, memory-only padding and types with a different wire
+       * representation */
+      return 0;
+    }
+    pFormat++;
+  }
+
+  if (size & (*align - 1)) return 0;
+  return size;
+}
+
+/* returns the size of the members if they can be copied directly to and
+ * from a buffer aligned to alignment, or 0 otherwise */
+static ULONG get_blittable_size(PFORMAT_STRING pFormat, unsigned int alignment)
+{
+  ULONG size, align;
+
+  size = analyse_blittable_members(pFormat, &align);
+  if (align > alignment) return 0;
+  return size;
+}
+
+static inline BOOL is_memory_aligned(const unsigned char *pMemory, unsigned int alignment)
+{
+  return !((ULONG_PTR)pMemory & (alignment - 1));
+}
+
 static inline void dump_pointer_attr(unsigned char attr)
 {
     if (attr & RPC_FC_P_ALLOCALLNODES)
@@ -1931,6 +2012,13 @@ static inline void array_buffer_size(
 
     align_length(&pStubMsg->BufferLength, alignment);
 
+    if ((esize = get_blittable_size(pFormat, alignment)))
+    {
+      size = safe_multiply(esize, pStubMsg->ActualCount);
+      safe_buffer_length_increment(pStubMsg, size);
+      break;
+    }
+
     size = pStubMsg->ActualCount;
     for (i = 0; i < size; i++)
       pMemory = ComplexBufferSize(pStubMsg, pMemory, pFormat, NULL);
@@ -2058,6 +2146,14 @@ static inline void array_write_variance_and_marshall(
 
     align_pointer_clear(&pStubMsg->Buffer, alignment);
 
+    if ((esize = get_blittable_size(pFormat, alignment)) &&
+        is_memory_aligned(pMemory, alignment))
+    {
+      size = safe_multiply(esize, pStubMsg->ActualCount);
+      safe_copy_to_buffer(pStubMsg, pMemory, size);
+      break;
+    }
+
     size = pStubMsg->ActualCount;
     for (i = 0; i < size; i++)
       pMemory = ComplexMarshall(pStubMsg, pMemory, pFormat, NULL);
@@ -2263,6 +2359,12 @@ static inline ULONG array_read_variance_and_unmarshall(
 
     pMemory = *ppMemory;
     count = pStubMsg->ActualCount;
+    if (get_blittable_size(pFormat, alignment) && is_memory_aligned(pMemory, alignment))
+    {
+      bufsize = safe_multiply(esize, count);
+      safe_copy_from_buffer(pStubMsg, pMemory, bufsize);
+      return bufsize;
+    }
     for (i = 0; i < count; i++)
         pMemory = ComplexUnmarshall(pStubMsg, pMemory, pFormat, NULL, fMustAlloc);
     return pStubMsg->Buffer - saved_buffer;
@@ -2363,7 +2465,10 @@ static inline void array_memory_size(
     memsize = safe_multiply(pStubMsg->MaxCount, esize);
 
     count = pStubMsg->ActualCount;
-    for (i = 0; i < count; i++)
+    if (get_blittable_size(pFormat, alignment))
+      safe_buffer_increment(pStubMsg, safe_multiply(esize, count));
+    else
+      for (i = 0; i < count; i++)
         ComplexStructMemorySize(pStubMsg, pFormat, NULL);
 
     pStubMsg->MemorySize = SavedMemorySize + memsize;
@@ -3572,6 +3677,15 @@ ULONG ComplexStructSize(PMIDL_STUB_MESSAGE pStubMsg, PFORMAT_STRING pFormat)
   return size;
 }
 
+/* returns the size of the members of a bogus structure that has neither a
+ * conformant array nor pointers and can be copied directly, or 0 */
+static ULONG get_blittable_struct_size(PFORMAT_STRING pFormat)
+{
+  if (*(const SHORT*)(pFormat + 4) || *(const WORD*)(pFormat + 6))
+    return 0;
+  return get_blittable_size(pFormat + 8, pFormat[1] + 1);
+}
+
 /***********************************************************************
  *           NdrComplexStructMarshall [RPCRT4.@]
  */
@@ -3586,9 +3700,19 @@ unsigned char * WINAPI NdrComplexStructMarshall(PMIDL_STUB_MESSAGE pStubMsg,
   ULONG count = 0;
   ULONG max_count = 0;
   ULONG offset = 0;
+  ULONG blittable_size;
 
   TRACE("(%p,%p,%p)\n", pStubMsg, pMemory, pFormat);
 
+  if ((blittable_size = get_blittable_struct_size(pFormat)) &&
+      is_memory_aligned(pMemory, pFormat[1] + 1))
+  {
+    align_pointer_clear(&pStubMsg->Buffer, pFormat[1] + 1);
+    safe_copy_to_buffer(pStubMsg, pMemory, blittable_size);
+    STD_OVERFLOW_CHECK(pStubMsg);
+    return NULL;
+  }
+
   if (!pStubMsg->PointerBufferMark)
   {
     int saved_ignore_embedded = pStubMsg->IgnoreEmbeddedPointers;
@@ -3673,9 +3797,26 @@ unsigned char * WINAPI NdrComplexStructUnmarshall(PMIDL_STUB_MESSAGE pStubMsg,
   ULONG max_count = 0;
   ULONG offset = 0;
   ULONG array_size = 0;
+  ULONG blittable_size;
 
   TRACE("(%p,%p,%p,%d)\n", pStubMsg, ppMemory, pFormat, fMustAlloc);
 
+  if ((blittable_size = get_blittable_struct_size(pFormat)))
+  {
+    align_pointer(&pStubMsg->Buffer, pFormat[1] + 1);
+
+    if (!fMustAlloc && !*ppMemory)
+      fMustAlloc = TRUE;
+    if (fMustAlloc)
+      *ppMemory = NdrAllocate(pStubMsg, size);
+
+    if (is_memory_aligned(*ppMemory, pFormat[1] + 1))
+      safe_copy_from_buffer(pStubMsg, *ppMemory, blittable_size);
+    else
+      ComplexUnmarshall(pStubMsg, *ppMemory, pFormat + 8, NULL, fMustAlloc);
+    return NULL;
+  }
+
   if (!pStubMsg->PointerBufferMark)
   {
     int saved_ignore_embedded = pStubMsg->IgnoreEmbeddedPointers;
@@ -3759,11 +3900,18 @@ void WINAPI NdrComplexStructBufferSize(PMIDL_STUB_MESSAGE pStubMsg,
   ULONG count = 0;
   ULONG max_count = 0;
   ULONG offset = 0;
+  ULONG blittable_size;
 
   TRACE("(%p,%p,%p)\n", pStubMsg, pMemory, pFormat);
 
   align_length(&pStubMsg->BufferLength, pFormat[1] + 1);
 
+  if ((blittable_size = get_blittable_struct_size(pFormat)))
+  {
+    safe_buffer_length_increment(pStubMsg, blittable_size);
+    return;
+  }
+
   if(!pStubMsg->IgnoreEmbeddedPointers && !pStubMsg->PointerLength)
   {
     int saved_ignore_embedded = pStubMsg->IgnoreEmbeddedPointers;
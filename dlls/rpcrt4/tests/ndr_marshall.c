@@ -2077,6 +2077,139 @@ cleanup:
     HeapFree(GetProcessHeap(), 0, memsrc.array);
 }
 
+static void test_blittable_complex(void)
+{
+    RPC_MESSAGE RpcMessage;
+    MIDL_STUB_MESSAGE StubMsg;
+    MIDL_STUB_DESC StubDesc;
+    void *ptr;
+    unsigned int i, j, size;
+    unsigned char *mem;
+    struct blittable_inner
+    {
+        LONG a, b;
+    };
+    struct blittable_outer
+    {
+        LONG l;
+        SHORT s1, s2;
+        struct blittable_inner inner;
+    };
+    static const struct blittable_outer src = { 0x11223344, 0x5566, 0x7788, { 0x01020304, 0x05060708 } };
+    static const struct blittable_inner src_array[3] = { { 1, 2 }, { 3, 4 }, { 5, 6 } };
+    DWORD membuf[16];
+
+    /* members that are laid out identically in memory and in the buffer */
+    static const unsigned char fmtstr_blittable[] =
+    {
+/*  0 */        0x15,           /* FC_STRUCT */
+                0x3,            /* 3 */
+/*  2 */        NdrFcShort( 0x8 ),      /* 8 */
+/*  4 */        0x8,            /* FC_LONG */
+                0x8,            /* FC_LONG */
+/*  6 */        0x5c,           /* FC_PAD */
+                0x5b,           /* FC_END */
+/*  8 */        0x1a,           /* FC_BOGUS_STRUCT */
+                0x3,            /* 3 */
+/* 10 */        NdrFcShort( 0x10 ),     /* 16 */
+/* 12 */        NdrFcShort( 0x0 ),      /* 0 */
+/* 14 */        NdrFcShort( 0x0 ),      /* Offset= 0 (14) */
+/* 16 */        0x8,            /* FC_LONG */
+                0x6,            /* FC_SHORT */
+/* 18 */        0x6,            /* FC_SHORT */
+                0x4c,           /* FC_EMBEDDED_COMPLEX */
+/* 20 */        0x0,            /* 0 */
+                NdrFcShort( 0xffeb ),   /* Offset= -21 (0) */
+/* 23 */        0x5b,           /* FC_END */
+/* 24 */        0x21,           /* FC_BOGUS_ARRAY */
+                0x3,            /* 3 */
+/* 26 */        NdrFcShort( 0x3 ),      /* 3 */
+/* 28 */        NdrFcLong( 0xffffffff ),        /* -1 */
+/* 32 */        NdrFcLong( 0xffffffff ),        /* -1 */
+/* 36 */        0x4c,           /* FC_EMBEDDED_COMPLEX */
+                0x0,            /* 0 */
+/* 38 */        NdrFcShort( 0xffda ),   /* Offset= -38 (0) */
+/* 40 */        0x5c,           /* FC_PAD */
+                0x5b,           /* FC_END */
+    };
+
+    StubDesc = Object_StubDesc;
+    StubDesc.pFormatTypes = fmtstr_blittable;
+
+    /* aligned memory, then misaligned memory that can't be copied as is */
+    for (i = 0; i < 2; i++)
+    {
+        mem = (unsigned char *)membuf + i;
+        memcpy(mem, &src, sizeof(src));
+
+        NdrClientInitializeNew(&RpcMessage, &StubMsg, &StubDesc, 0);
+        StubMsg.BufferLength = 0;
+        NdrComplexStructBufferSize(&StubMsg, mem, &fmtstr_blittable[8]);
+        ok(StubMsg.BufferLength == sizeof(src), "%u: length %d\n", i, StubMsg.BufferLength);
+
+        StubMsg.RpcMsg->Buffer = StubMsg.BufferStart = StubMsg.Buffer = HeapAlloc(GetProcessHeap(), 0, StubMsg.BufferLength);
+        StubMsg.BufferEnd = StubMsg.BufferStart + StubMsg.BufferLength;
+        ptr = NdrComplexStructMarshall(&StubMsg, mem, &fmtstr_blittable[8]);
+        ok(ptr == NULL, "%u: ret %p\n", i, ptr);
+        ok(StubMsg.Buffer - StubMsg.BufferStart == sizeof(src), "%u: wrote %d bytes\n", i,
+           (int)(StubMsg.Buffer - StubMsg.BufferStart));
+        ok(!memcmp(StubMsg.BufferStart, &src, sizeof(src)), "%u: buffer contents differ\n", i);
+
+        StubMsg.Buffer = StubMsg.BufferStart;
+        StubMsg.MemorySize = 0;
+        size = NdrComplexStructMemorySize(&StubMsg, &fmtstr_blittable[8]);
+        ok(size == sizeof(src), "%u: memory size %u\n", i, size);
+        ok(StubMsg.Buffer - StubMsg.BufferStart == sizeof(src), "%u: read %d bytes\n", i,
+           (int)(StubMsg.Buffer - StubMsg.BufferStart));
+
+        memset(mem, 0xcc, sizeof(src));
+        StubMsg.Buffer = StubMsg.BufferStart;
+        ptr = NdrComplexStructUnmarshall(&StubMsg, &mem, &fmtstr_blittable[8], 0);
+        ok(ptr == NULL, "%u: ret %p\n", i, ptr);
+        ok(mem == (unsigned char *)membuf + i, "%u: memory reallocated\n", i);
+        ok(!memcmp(mem, &src, sizeof(src)), "%u: memory contents differ\n", i);
+
+        HeapFree(GetProcessHeap(), 0, StubMsg.RpcMsg->Buffer);
+    }
+
+    for (i = 0; i < 2; i++)
+    {
+        mem = (unsigned char *)membuf + i;
+        memcpy(mem, src_array, sizeof(src_array));
+
+        NdrClientInitializeNew(&RpcMessage, &StubMsg, &StubDesc, 0);
+        StubMsg.BufferLength = 0;
+        NdrComplexArrayBufferSize(&StubMsg, mem, &fmtstr_blittable[24]);
+        ok(StubMsg.BufferLength == sizeof(src_array), "%u: length %d\n", i, StubMsg.BufferLength);
+
+        StubMsg.RpcMsg->Buffer = StubMsg.BufferStart = StubMsg.Buffer = HeapAlloc(GetProcessHeap(), 0, StubMsg.BufferLength);
+        StubMsg.BufferEnd = StubMsg.BufferStart + StubMsg.BufferLength;
+        ptr = NdrComplexArrayMarshall(&StubMsg, mem, &fmtstr_blittable[24]);
+        ok(ptr == NULL, "%u: ret %p\n", i, ptr);
+        ok(StubMsg.Buffer - StubMsg.BufferStart == sizeof(src_array), "%u: wrote %d bytes\n", i,
+           (int)(StubMsg.Buffer - StubMsg.BufferStart));
+        for (j = 0; j < 6; j++)
+            ok(((LONG *)StubMsg.BufferStart)[j] == j + 1, "%u: got %d at %u\n", i,
+               ((LONG *)StubMsg.BufferStart)[j], j);
+
+        StubMsg.Buffer = StubMsg.BufferStart;
+        StubMsg.MemorySize = 0;
+        size = NdrComplexArrayMemorySize(&StubMsg, &fmtstr_blittable[24]);
+        ok(size == sizeof(src_array), "%u: memory size %u\n", i, size);
+        ok(StubMsg.Buffer - StubMsg.BufferStart == sizeof(src_array), "%u: read %d bytes\n", i,
+           (int)(StubMsg.Buffer - StubMsg.BufferStart));
+
+        memset(mem, 0xcc, sizeof(src_array));
+        StubMsg.Buffer = StubMsg.BufferStart;
+        ptr = NdrComplexArrayUnmarshall(&StubMsg, &mem, &fmtstr_blittable[24], 0);
+        ok(ptr == NULL, "%u: ret %p\n", i, ptr);
+        ok(mem == (unsigned char *)membuf + i, "%u: memory reallocated\n", i);
+        ok(!memcmp(mem, src_array, sizeof(src_array)), "%u: memory contents differ\n", i);
+
+        HeapFree(GetProcessHeap(), 0, StubMsg.RpcMsg->Buffer);
+    }
+}
+
 static void test_ndr_buffer(void)
 {
     static unsigned char ncalrpc[] = "ncalrpc";
@@ -2422,6 +2555,7 @@ START_TEST( ndr_marshall )
     test_nonconformant_string();
     test_conf_complex_struct();
     test_conf_complex_array();
+    test_blittable_complex();
     test_ndr_buffer();
     test_NdrMapCommAndFaultStatus();
     test_NdrGetUserMarshalInfo();
@@ -1264,3 +1264,270 @@ void aes_ecb_decrypt(const unsigned char *ct, unsigned char *pt, aes_key *skey)
         rk[3];
     STORE32H(s3, pt+12);
 }
+
+/* The xmm registers can only be relied on without extra compiler flags on x86_64. */
+#if defined(__GNUC__) && defined(__x86_64__)
+
+#define AESNI_ASM
+
+static void aes_cpuid(unsigned int ax, unsigned int *p)
+{
+    __asm__("cpuid"
+            : "=a" (p[0]), "=b" (p[1]), "=c" (p[2]), "=d" (p[3])
+            : "0" (ax), "2" (0));
+}
+
+/* -1 until the CPU has been checked for the AES instructions */
+static int aesni_present = -1;
+
+static int aesni_available(void)
+{
+    unsigned int regs[4];
+
+    if (aesni_present < 0) {
+        aes_cpuid(0, regs);
+        if (regs[0] >= 1) {
+            aes_cpuid(1, regs);
+            aesni_present = (regs[2] >> 25) & 1;
+        } else {
+            aesni_present = 0;
+        }
+    }
+    return aesni_present;
+}
+
+/* The AES instructions want the round keys as byte strings in memory order,
+ * the equivalent inverse cipher keys in dK already are what aesdec expects. */
+static void aesni_round_keys(const ulong32 *rk, int Nr, unsigned char *out)
+{
+    int i;
+
+    for (i = 0; i < 4 * (Nr + 1); i++)
+        STORE32H(rk[i], out + 4 * i);
+}
+
+/* %[k] walks the round keys up to %[end], the last one */
+#define AESNI_ROUNDS1(op) \
+    "movdqu (%[k]), %%xmm4\n\t" \
+    "pxor %%xmm4, %%xmm0\n\t" \
+    "add $16, %[k]\n" \
+    "1:\tmovdqu (%[k]), %%xmm4\n\t" \
+    op " %%xmm4, %%xmm0\n\t" \
+    "add $16, %[k]\n\t" \
+    "cmp %[end], %[k]\n\t" \
+    "jb 1b\n\t" \
+    "movdqu (%[k]), %%xmm4\n\t" \
+    op "last %%xmm4, %%xmm0\n\t"
+
+#define AESNI_ROUNDS4(op) \
+    "movdqu (%[k]), %%xmm4\n\t" \
+    "pxor %%xmm4, %%xmm0\n\t" \
+    "pxor %%xmm4, %%xmm1\n\t" \
+    "pxor %%xmm4, %%xmm2\n\t" \
+    "pxor %%xmm4, %%xmm3\n\t" \
+    "add $16, %[k]\n" \
+    "1:\tmovdqu (%[k]), %%xmm4\n\t" \
+    op " %%xmm4, %%xmm0\n\t" \
+    op " %%xmm4, %%xmm1\n\t" \
+    op " %%xmm4, %%xmm2\n\t" \
+    op " %%xmm4, %%xmm3\n\t" \
+    "add $16, %[k]\n\t" \
+    "cmp %[end], %[k]\n\t" \
+    "jb 1b\n\t" \
+    "movdqu (%[k]), %%xmm4\n\t" \
+    op "last %%xmm4, %%xmm0\n\t" \
+    op "last %%xmm4, %%xmm1\n\t" \
+    op "last %%xmm4, %%xmm2\n\t" \
+    op "last %%xmm4, %%xmm3\n\t"
+
+#define AESNI_LOAD4 \
+    "movdqu (%[in]), %%xmm0\n\t" \
+    "movdqu 16(%[in]), %%xmm1\n\t" \
+    "movdqu 32(%[in]), %%xmm2\n\t" \
+    "movdqu 48(%[in]), %%xmm3\n\t"
+
+#define AESNI_STORE4 \
+    "movdqu %%xmm0, (%[out])\n\t" \
+    "movdqu %%xmm1, 16(%[out])\n\t" \
+    "movdqu %%xmm2, 32(%[out])\n\t" \
+    "movdqu %%xmm3, 48(%[out])\n\t"
+
+static void aesni_ecb(const unsigned char *rk, int Nr, const unsigned char *in,
+                      unsigned char *out, unsigned long blocks, int enc)
+{
+    const unsigned char *end = rk + 16 * Nr, *k;
+
+    /* independent blocks, so keep four of them in flight */
+    for (; blocks >= 4; blocks -= 4, in += 64, out += 64) {
+        k = rk;
+        if (enc)
+            __asm__ __volatile__(AESNI_LOAD4 AESNI_ROUNDS4("aesenc") AESNI_STORE4
+                                 : [k] "+r" (k)
+                                 : [in] "r" (in), [out] "r" (out), [end] "m" (end)
+                                 : "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "memory", "cc");
+        else
+            __asm__ __volatile__(AESNI_LOAD4 AESNI_ROUNDS4("aesdec") AESNI_STORE4
+                                 : [k] "+r" (k)
+                                 : [in] "r" (in), [out] "r" (out), [end] "m" (end)
+                                 : "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "memory", "cc");
+    }
+    for (; blocks; blocks--, in += 16, out += 16) {
+        k = rk;
+        if (enc)
+            __asm__ __volatile__("movdqu (%[in]), %%xmm0\n\t"
+                                 AESNI_ROUNDS1("aesenc")
+                                 "movdqu %%xmm0, (%[out])"
+                                 : [k] "+r" (k)
+                                 : [in] "r" (in), [out] "r" (out), [end] "m" (end)
+                                 : "xmm0", "xmm4", "memory", "cc");
+        else
+            __asm__ __volatile__("movdqu (%[in]), %%xmm0\n\t"
+                                 AESNI_ROUNDS1("aesdec")
+                                 "movdqu %%xmm0, (%[out])"
+                                 : [k] "+r" (k)
+                                 : [in] "r" (in), [out] "r" (out), [end] "m" (end)
+                                 : "xmm0", "xmm4", "memory", "cc");
+    }
+}
+
+static void aesni_cbc_encrypt(const unsigned char *rk, int Nr, const unsigned char *in,
+                              unsigned char *out, unsigned long blocks, unsigned char *iv)
+{
+    const unsigned char *end = rk + 16 * Nr, *k;
+
+    for (; blocks; blocks--, in += 16, out += 16) {
+        k = rk;
+        __asm__ __volatile__("movdqu (%[in]), %%xmm0\n\t"
+                             "movdqu (%[iv]), %%xmm1\n\t"
+                             "pxor %%xmm1, %%xmm0\n\t"
+                             AESNI_ROUNDS1("aesenc")
+                             "movdqu %%xmm0, (%[iv])\n\t"
+                             "movdqu %%xmm0, (%[out])"
+                             : [k] "+r" (k)
+                             : [in] "r" (in), [out] "r" (out), [iv] "r" (iv), [end] "m" (end)
+                             : "xmm0", "xmm1", "xmm4", "memory", "cc");
+    }
+}
+
+static void aesni_cbc_decrypt(const unsigned char *rk, int Nr, const unsigned char *in,
+                              unsigned char *out, unsigned long blocks, unsigned char *iv)
+{
+    const unsigned char *end = rk + 16 * Nr, *k;
+
+    /* all ciphertext is read before any plaintext is stored, so in may be out */
+    for (; blocks >= 4; blocks -= 4, in += 64, out += 64) {
+        k = rk;
+        __asm__ __volatile__(AESNI_LOAD4
+                             AESNI_ROUNDS4("aesdec")
+                             "movdqu (%[iv]), %%xmm4\n\t"
+                             "pxor %%xmm4, %%xmm0\n\t"
+                             "movdqu (%[in]), %%xmm4\n\t"
+                             "pxor %%xmm4, %%xmm1\n\t"
+                             "movdqu 16(%[in]), %%xmm4\n\t"
+                             "pxor %%xmm4, %%xmm2\n\t"
+                             "movdqu 32(%[in]), %%xmm4\n\t"
+                             "pxor %%xmm4, %%xmm3\n\t"
+                             "movdqu 48(%[in]), %%xmm4\n\t"
+                             "movdqu %%xmm4, (%[iv])\n\t"
+                             AESNI_STORE4
+                             : [k] "+r" (k)
+                             : [in] "r" (in), [out] "r" (out), [iv] "r" (iv), [end] "m" (end)
+                             : "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "memory", "cc");
+    }
+    for (; blocks; blocks--, in += 16, out += 16) {
+        k = rk;
+        __asm__ __volatile__("movdqu (%[in]), %%xmm0\n\t"
+                             "movdqa %%xmm0, %%xmm1\n\t"
+                             AESNI_ROUNDS1("aesdec")
+                             "movdqu (%[iv]), %%xmm4\n\t"
+                             "pxor %%xmm4, %%xmm0\n\t"
+                             "movdqu %%xmm1, (%[iv])\n\t"
+                             "movdqu %%xmm0, (%[out])"
+                             : [k] "+r" (k)
+                             : [in] "r" (in), [out] "r" (out), [iv] "r" (iv), [end] "m" (end)
+                             : "xmm0", "xmm1", "xmm4", "memory", "cc");
+    }
+}
+
+#endif /* AESNI_ASM */
+
+/* The functions below process whole blocks; in and out may be the same buffer. */
+
+void aes_ecb_encrypt_blocks(const unsigned char *pt, unsigned char *ct, unsigned long blocks, aes_key *skey)
+{
+#ifdef AESNI_ASM
+    if (aesni_available()) {
+        unsigned char rk[16 * 15];
+
+        aesni_round_keys(skey->eK, skey->Nr, rk);
+        aesni_ecb(rk, skey->Nr, pt, ct, blocks, 1);
+        memset(rk, 0, sizeof(rk));
+        return;
+    }
+#endif
+    for (; blocks; blocks--, pt += 16, ct += 16)
+        aes_ecb_encrypt(pt, ct, skey);
+}
+
+void aes_ecb_decrypt_blocks(const unsigned char *ct, unsigned char *pt, unsigned long blocks, aes_key *skey)
+{
+#ifdef AESNI_ASM
+    if (aesni_available()) {
+        unsigned char rk[16 * 15];
+
+        aesni_round_keys(skey->dK, skey->Nr, rk);
+        aesni_ecb(rk, skey->Nr, ct, pt, blocks, 0);
+        memset(rk, 0, sizeof(rk));
+        return;
+    }
+#endif
+    for (; blocks; blocks--, ct += 16, pt += 16)
+        aes_ecb_decrypt(ct, pt, skey);
+}
+
+void aes_cbc_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks,
+                     unsigned char *iv, aes_key *skey)
+{
+    unsigned char buf[16];
+    int i;
+
+#ifdef AESNI_ASM
+    if (aesni_available()) {
+        unsigned char rk[16 * 15];
+
+        aesni_round_keys(skey->eK, skey->Nr, rk);
+        aesni_cbc_encrypt(rk, skey->Nr, pt, ct, blocks, iv);
+        memset(rk, 0, sizeof(rk));
+        return;
+    }
+#endif
+    for (; blocks; blocks--, pt += 16, ct += 16) {
+        for (i = 0; i < 16; i++) buf[i] = pt[i] ^ iv[i];
+        aes_ecb_encrypt(buf, ct, skey);
+        memcpy(iv, ct, 16);
+    }
+}
+
+void aes_cbc_decrypt(const unsigned char *ct, unsigned char *pt, unsigned long blocks,
+                     unsigned char *iv, aes_key *skey)
+{
+    unsigned char buf[16];
+    int i;
+
+#ifdef AESNI_ASM
+    if (aesni_available()) {
+        unsigned char rk[16 * 15];
+
+        aesni_round_keys(skey->dK, skey->Nr, rk);
+        aesni_cbc_decrypt(rk, skey->Nr, ct, pt, blocks, iv);
+        memset(rk, 0, sizeof(rk));
+        return;
+    }
+#endif
+    for (; blocks; blocks--, ct += 16, pt += 16) {
+        memcpy(buf, ct, 16);
+        aes_ecb_decrypt(ct, pt, skey);
+        for (i = 0; i < 16; i++) pt[i] ^= iv[i];
+        memcpy(iv, buf, 16);
+    }
+}
@@ -375,6 +375,68 @@ BOOL encrypt_block_impl(ALG_ID aiAlgid, DWORD dwKeySpec, KEY_CONTEXT *pKeyContex
     return TRUE;
 }
 
+BOOL encrypt_blocks_impl(ALG_ID aiAlgid, KEY_CONTEXT *pKeyContext, DWORD dwMode, DWORD dwBlockLen,
+                         BYTE *pbChainVector, BYTE *pbInOut, DWORD dwLen, DWORD enc)
+{
+    BYTE out[RSAENH_MAX_BLOCK_SIZE];
+    DWORD i, j;
+
+    switch (aiAlgid) {
+        case CALG_AES:
+        case CALG_AES_128:
+        case CALG_AES_192:
+        case CALG_AES_256:
+            /* the AES code handles whole runs of blocks */
+            if (dwMode == CRYPT_MODE_ECB) {
+                if (enc) {
+                    aes_ecb_encrypt_blocks(pbInOut, pbInOut, dwLen / 16, &pKeyContext->aes);
+                } else {
+                    aes_ecb_decrypt_blocks(pbInOut, pbInOut, dwLen / 16, &pKeyContext->aes);
+                }
+                return TRUE;
+            }
+            if (dwMode == CRYPT_MODE_CBC) {
+                if (enc) {
+                    aes_cbc_encrypt(pbInOut, pbInOut, dwLen / 16, pbChainVector, &pKeyContext->aes);
+                } else {
+                    aes_cbc_decrypt(pbInOut, pbInOut, dwLen / 16, pbChainVector, &pKeyContext->aes);
+                }
+                return TRUE;
+            }
+            break;
+    }
+
+    for (i = 0; i < dwLen; i += dwBlockLen, pbInOut += dwBlockLen) {
+        switch (dwMode) {
+            case CRYPT_MODE_ECB:
+                if (!encrypt_block_impl(aiAlgid, 0, pKeyContext, pbInOut, out, enc))
+                    return FALSE;
+                break;
+
+            case CRYPT_MODE_CBC:
+                if (enc) {
+                    for (j = 0; j < dwBlockLen; j++) pbInOut[j] ^= pbChainVector[j];
+                    if (!encrypt_block_impl(aiAlgid, 0, pKeyContext, pbInOut, out, enc))
+                        return FALSE;
+                    memcpy(pbChainVector, out, dwBlockLen);
+                } else {
+                    if (!encrypt_block_impl(aiAlgid, 0, pKeyContext, pbInOut, out, enc))
+                        return FALSE;
+                    for (j = 0; j < dwBlockLen; j++) out[j] ^= pbChainVector[j];
+                    memcpy(pbChainVector, pbInOut, dwBlockLen);
+                }
+                break;
+
+            default:
+                SetLastError(NTE_BAD_ALGID);
+                return FALSE;
+        }
+        memcpy(pbInOut, out, dwBlockLen);
+    }
+
+    return TRUE;
+}
+
 BOOL encrypt_stream_impl(ALG_ID aiAlgid, KEY_CONTEXT *pKeyContext, BYTE *stream, DWORD dwLen)
 {
     switch (aiAlgid) {
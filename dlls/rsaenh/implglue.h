@@ -27,6 +27,8 @@
 #include "tomcrypt.h"
 #include "sha2.h"
 
+#define RSAENH_MAX_BLOCK_SIZE      24
+
 /* Next typedef copied from dlls/advapi32/crypt_md4.c */
 typedef struct tagMD4_CTX {
     unsigned int buf[4];
@@ -89,6 +91,9 @@ BOOL duplicate_key_impl(ALG_ID aiAlgid, const KEY_CONTEXT *pSrcKeyContext,
 /* dwKeySpec is optional for symmetric key algorithms */
 BOOL encrypt_block_impl(ALG_ID aiAlgid, DWORD dwKeySpec, KEY_CONTEXT *pKeyContext, const BYTE *pbIn,
                         BYTE *pbOut, DWORD enc) DECLSPEC_HIDDEN;
+/* ECB or CBC over whole blocks, in place */
+BOOL encrypt_blocks_impl(ALG_ID aiAlgid, KEY_CONTEXT *pKeyContext, DWORD dwMode, DWORD dwBlockLen,
+                         BYTE *pbChainVector, BYTE *pbInOut, DWORD dwLen, DWORD enc) DECLSPEC_HIDDEN;
 BOOL encrypt_stream_impl(ALG_ID aiAlgid, KEY_CONTEXT *pKeyContext, BYTE *pbInOut, DWORD dwLen) DECLSPEC_HIDDEN;
 
 BOOL export_public_key_impl(BYTE *pbDest, const KEY_CONTEXT *pKeyContext, DWORD dwKeyLen,
@@ -1909,6 +1909,268 @@ static void mp_dr_setup(const mp_int *a, mp_digit *d)
         ((mp_word)a->dp[0]));
 }
 
+#if defined(__SIZEOF_INT128__)
+
+/* Montgomery exponentiation on 64-bit limbs.
+ *
+ * With 28-bit digits a 1024-bit CRT prime of an RSA-2048 key takes 37
+ * digits, packed into 64-bit limbs it takes 16, which cuts the number of
+ * digit products per multiplication by more than five. The exponent is
+ * scanned in fixed size windows and the table is read in full for every
+ * window, so the sequence of operations and memory accesses depends only
+ * on the sizes of the operands and not on the bits of the exponent.
+ */
+#define MP_MONT64
+#define MONT64_MAX_LIMBS 64     /* moduli of up to 4096 bits */
+#define MONT64_WINSIZE   5
+
+typedef unsigned __int128 mont64_word;
+
+/* packs |a| into n 64-bit limbs, a must fit */
+static void mont64_from_mp(const mp_int *a, ulong64 *r, int n)
+{
+  ulong64 d, acc = 0;
+  int     x, bits = 0, limb = 0;
+
+  memset(r, 0, n * sizeof(*r));
+  for (x = 0; x < a->used; x++) {
+    d = a->dp[x];
+    acc |= d << bits;
+    bits += DIGIT_BIT;
+    if (bits >= 64) {
+      r[limb++] = acc;
+      bits -= 64;
+      acc = bits ? d >> (DIGIT_BIT - bits) : 0;
+    }
+  }
+  if (limb < n) {
+    r[limb] = acc;
+  }
+}
+
+/* unpacks n 64-bit limbs into a */
+static int mont64_to_mp(const ulong64 *r, int n, mp_int *a)
+{
+  ulong64 d;
+  int     err, x, bit, limb, shift, digits = (n * 64 + DIGIT_BIT - 1) / DIGIT_BIT;
+
+  if ((err = mp_grow(a, digits)) != MP_OKAY) {
+    return err;
+  }
+  for (x = 0; x < digits; x++) {
+    bit   = x * DIGIT_BIT;
+    limb  = bit / 64;
+    shift = bit % 64;
+    d     = r[limb] >> shift;
+    if (shift > 64 - DIGIT_BIT && limb + 1 < n) {
+      d |= r[limb + 1] << (64 - shift);
+    }
+    a->dp[x] = (mp_digit)(d & MP_MASK);
+  }
+  for (; x < a->used; x++) {
+    a->dp[x] = 0;
+  }
+  a->used = digits;
+  a->sign = MP_ZPOS;
+  mp_clamp(a);
+  return MP_OKAY;
+}
+
+/* r = t / 2**(64*n) mod m for t < m * 2**(64*n), HAC pp.601, Algorithm 14.32.
+ * t holds 2*n limbs and is destroyed.
+ */
+static void mont64_reduce(ulong64 *r, ulong64 *t, const ulong64 *m, int n, ulong64 rho)
+{
+  ulong64     s[MONT64_MAX_LIMBS], c, u, top, borrow, mask;
+  mont64_word w;
+  int         x, y;
+
+  top = 0;
+  for (x = 0; x < n; x++) {
+    /* add u * m * 2**(64*x) with u chosen so that limb x vanishes */
+    u = t[x] * rho;
+    c = 0;
+    for (y = 0; y < n; y++) {
+      w        = (mont64_word)u * m[y] + t[x + y] + c;
+      t[x + y] = (ulong64)w;
+      c        = (ulong64)(w >> 64);
+    }
+    w        = (mont64_word)t[x + n] + c + top;
+    t[x + n] = (ulong64)w;
+    top      = (ulong64)(w >> 64);
+  }
+
+  /* the result is below 2m, subtract m once and keep whichever is in range */
+  t += n;
+  borrow = 0;
+  for (y = 0; y < n; y++) {
+    w      = (mont64_word)t[y] - m[y] - borrow;
+    s[y]   = (ulong64)w;
+    borrow = (ulong64)(w >> 64) & 1;
+  }
+  mask = (ulong64)0 - (ulong64)(top < borrow);
+  for (y = 0; y < n; y++) {
+    r[y] = (t[y] & mask) | (s[y] & ~mask);
+  }
+}
+
+/* r = a * b / 2**(64*n) mod m, a and b must be less than m */
+static void mont64_mul(ulong64 *r, const ulong64 *a, const ulong64 *b, const ulong64 *m, int n, ulong64 rho)
+{
+  ulong64     t[2 * MONT64_MAX_LIMBS], c;
+  mont64_word w;
+  int         x, y;
+
+  memset(t, 0, n * sizeof(*t));
+  for (x = 0; x < n; x++) {
+    c = 0;
+    for (y = 0; y < n; y++) {
+      w        = (mont64_word)a[y] * b[x] + t[x + y] + c;
+      t[x + y] = (ulong64)w;
+      c        = (ulong64)(w >> 64);
+    }
+    t[x + n] = c;
+  }
+  mont64_reduce(r, t, m, n, rho);
+}
+
+/* r = a * a / 2**(64*n) mod m, computing each cross product only once */
+static void mont64_sqr(ulong64 *r, const ulong64 *a, const ulong64 *m, int n, ulong64 rho)
+{
+  ulong64     t[2 * MONT64_MAX_LIMBS], c, hi;
+  mont64_word w;
+  int         x, y;
+
+  memset(t, 0, 2 * n * sizeof(*t));
+  for (x = 0; x < n - 1; x++) {
+    c = 0;
+    for (y = x + 1; y < n; y++) {
+      w        = (mont64_word)a[x] * a[y] + t[x + y] + c;
+      t[x + y] = (ulong64)w;
+      c        = (ulong64)(w >> 64);
+    }
+    t[x + n] = c;
+  }
+
+  /* double the cross products and add the squares */
+  hi = 0;
+  c  = 0;
+  for (x = 0; x < n; x++) {
+    ulong64 lo = t[2 * x], up = t[2 * x + 1];
+    w            = (mont64_word)a[x] * a[x] + (lo << 1 | hi) + c;
+    t[2 * x]     = (ulong64)w;
+    w            = (w >> 64) + (up << 1 | lo >> 63);
+    t[2 * x + 1] = (ulong64)w;
+    c            = (ulong64)(w >> 64);
+    hi           = up >> 63;
+  }
+  mont64_reduce(r, t, m, n, rho);
+}
+
+/* returns bits [bit, bit + MONT64_WINSIZE) of X */
+static int mont64_window(const mp_int *X, int bit)
+{
+  int x, b, digit, win = 0;
+
+  for (x = MONT64_WINSIZE - 1; x >= 0; x--) {
+    b     = bit + x;
+    digit = b / DIGIT_BIT;
+    win <<= 1;
+    if (digit < X->used) {
+      win |= (int)((X->dp[digit] >> (b % DIGIT_BIT)) & 1);
+    }
+  }
+  return win;
+}
+
+/* r = table[idx], touching every entry */
+static void mont64_select(ulong64 *r, ulong64 table[][MONT64_MAX_LIMBS], int n, int idx)
+{
+  ulong64 mask;
+  int     x, y;
+
+  memset(r, 0, n * sizeof(*r));
+  for (x = 0; x < (1 << MONT64_WINSIZE); x++) {
+    mask = (ulong64)0 - (ulong64)(x == idx);
+    for (y = 0; y < n; y++) {
+      r[y] |= table[x][y] & mask;
+    }
+  }
+}
+
+/* Y = G**X mod P for odd P of at most MONT64_MAX_LIMBS limbs and X >= 0 */
+static int mp_exptmod_mont64(const mp_int *G, const mp_int *X, mp_int *P, mp_int *Y)
+{
+  ulong64 table[1 << MONT64_WINSIZE][MONT64_MAX_LIMBS];
+  ulong64 m[MONT64_MAX_LIMBS], acc[MONT64_MAX_LIMBS], tmp[MONT64_MAX_LIMBS], inv, rho;
+  mp_int  t;
+  int     err, n, x, y, windows;
+
+  n = (mp_count_bits(P) + 63) / 64;
+  mont64_from_mp(P, m, n);
+
+  /* rho = -1/m mod 2**64, m*m == 1 mod 8 and each Newton step doubles
+   * the number of correct low bits */
+  inv = m[0];
+  for (x = 0; x < 5; x++) {
+    inv *= 2 - m[0] * inv;
+  }
+  rho = (ulong64)0 - inv;
+
+  if ((err = mp_init(&t)) != MP_OKAY) {
+    return err;
+  }
+
+  /* tmp = R**2 mod P with R = 2**(64*n) */
+  if ((err = mp_2expt(&t, 2 * 64 * n)) != MP_OKAY) {
+    goto LBL_T;
+  }
+  if ((err = mp_mod(&t, P, &t)) != MP_OKAY) {
+    goto LBL_T;
+  }
+  mont64_from_mp(&t, tmp, n);
+
+  /* table[0] = R mod P, table[1] = G*R mod P, table[x] = G**x * R mod P */
+  memset(acc, 0, n * sizeof(*acc));
+  acc[0] = 1;
+  mont64_mul(table[0], acc, tmp, m, n, rho);
+  if ((err = mp_mod(G, P, &t)) != MP_OKAY) {
+    goto LBL_T;
+  }
+  mont64_from_mp(&t, acc, n);
+  mont64_mul(table[1], acc, tmp, m, n, rho);
+  for (x = 2; x < (1 << MONT64_WINSIZE); x++) {
+    mont64_mul(table[x], table[x - 1], table[1], m, n, rho);
+  }
+
+  /* left to right over fixed windows of the exponent */
+  memcpy(acc, table[0], n * sizeof(*acc));
+  windows = (mp_count_bits(X) + MONT64_WINSIZE - 1) / MONT64_WINSIZE;
+  for (x = windows - 1; x >= 0; x--) {
+    if (x != windows - 1) {
+      for (y = 0; y < MONT64_WINSIZE; y++) {
+        mont64_sqr(acc, acc, m, n, rho);
+      }
+    }
+    mont64_select(tmp, table, n, mont64_window(X, x * MONT64_WINSIZE));
+    mont64_mul(acc, acc, tmp, m, n, rho);
+  }
+
+  /* leave the Montgomery domain */
+  memset(tmp, 0, n * sizeof(*tmp));
+  tmp[0] = 1;
+  mont64_mul(acc, acc, tmp, m, n, rho);
+  err = mont64_to_mp(acc, n, Y);
+
+  memset(table, 0, sizeof(table));
+  memset(acc, 0, sizeof(acc));
+LBL_T:
+  mp_clear(&t);
+  return err;
+}
+
+#endif  /* __SIZEOF_INT128__ */
+
 /* this is a shell function that calls either the normal or Montgomery
  * exptmod functions.  Originally the call to the montgomery code was
  * embedded in the normal function but that wasted a lot of stack space
@@ -1955,6 +2217,14 @@ int mp_exptmod (const mp_int * G, const mp_int * X, mp_int * P, mp_int * Y)
 
   dr = 0;
 
+#ifdef MP_MONT64
+  /* odd moduli that fit in 64-bit limbs, which covers RSA moduli and
+   * CRT primes up to 4096 bits, use the word sized Montgomery code */
+  if (mp_isodd (P) == 1 && mp_count_bits (P) <= MONT64_MAX_LIMBS * 64) {
+    return mp_exptmod_mont64 (G, X, P, Y);
+  }
+#endif
+
   /* if the modulus is odd or dr != 0 use the fast method */
   if (mp_isodd (P) == 1 || dr !=  0) {
     return mp_exptmod_fast (G, X, P, Y, dr);
@@ -76,7 +76,6 @@ typedef struct tagCRYPTHASH
  */
 #define RSAENH_MAGIC_KEY           0x73620457u
 #define RSAENH_MAX_KEY_SIZE        64
-#define RSAENH_MAX_BLOCK_SIZE      24
 #define RSAENH_KEYSTATE_IDLE       0
 #define RSAENH_KEYSTATE_ENCRYPTING 1
 #define RSAENH_KEYSTATE_MASTERKEY  2
@@ -2239,20 +2238,13 @@ BOOL WINAPI RSAENH_CPEncrypt(HCRYPTPROV hProv, HCRYPTKEY hKey, HCRYPTHASH hHash,
         for (i=*pdwDataLen; i<dwEncryptedLen; i++) pbData[i] = dwEncryptedLen - *pdwDataLen;
         *pdwDataLen = dwEncryptedLen;
 
-        for (i=0, in=pbData; i<*pdwDataLen; i+=pCryptKey->dwBlockLen, in+=pCryptKey->dwBlockLen) {
+        if (pCryptKey->dwMode == CRYPT_MODE_ECB || pCryptKey->dwMode == CRYPT_MODE_CBC) {
+            if (!encrypt_blocks_impl(pCryptKey->aiAlgid, &pCryptKey->context, pCryptKey->dwMode,
+                                     pCryptKey->dwBlockLen, pCryptKey->abChainVector, pbData,
+                                     *pdwDataLen, RSAENH_ENCRYPT))
+                return FALSE;
+        } else for (i=0, in=pbData; i<*pdwDataLen; i+=pCryptKey->dwBlockLen, in+=pCryptKey->dwBlockLen) {
             switch (pCryptKey->dwMode) {
-                case CRYPT_MODE_ECB:
-                    encrypt_block_impl(pCryptKey->aiAlgid, 0, &pCryptKey->context, in, out, 
-                                       RSAENH_ENCRYPT);
-                    break;
-                
-                case CRYPT_MODE_CBC:
-                    for (j=0; j<pCryptKey->dwBlockLen; j++) in[j] ^= pCryptKey->abChainVector[j];
-                    encrypt_block_impl(pCryptKey->aiAlgid, 0, &pCryptKey->context, in, out, 
-                                       RSAENH_ENCRYPT);
-                    memcpy(pCryptKey->abChainVector, out, pCryptKey->dwBlockLen);
-                    break;
-
                 case CRYPT_MODE_CFB:
                     for (j=0; j<pCryptKey->dwBlockLen; j++) {
                         encrypt_block_impl(pCryptKey->aiAlgid, 0, &pCryptKey->context, 
@@ -2368,20 +2360,13 @@ BOOL WINAPI RSAENH_CPDecrypt(HCRYPTPROV hProv, HCRYPTKEY hKey, HCRYPTHASH hHash,
     dwMax=*pdwDataLen;
 
     if (GET_ALG_TYPE(pCryptKey->aiAlgid) == ALG_TYPE_BLOCK) {
-        for (i=0, in=pbData; i<*pdwDataLen; i+=pCryptKey->dwBlockLen, in+=pCryptKey->dwBlockLen) {
+        if (pCryptKey->dwMode == CRYPT_MODE_ECB || pCryptKey->dwMode == CRYPT_MODE_CBC) {
+            if (!encrypt_blocks_impl(pCryptKey->aiAlgid, &pCryptKey->context, pCryptKey->dwMode,
+                                     pCryptKey->dwBlockLen, pCryptKey->abChainVector, pbData,
+                                     *pdwDataLen, RSAENH_DECRYPT))
+                return FALSE;
+        } else for (i=0, in=pbData; i<*pdwDataLen; i+=pCryptKey->dwBlockLen, in+=pCryptKey->dwBlockLen) {
             switch (pCryptKey->dwMode) {
-                case CRYPT_MODE_ECB:
-                    encrypt_block_impl(pCryptKey->aiAlgid, 0, &pCryptKey->context, in, out, 
-                                       RSAENH_DECRYPT);
-                    break;
-                
-                case CRYPT_MODE_CBC:
-                    encrypt_block_impl(pCryptKey->aiAlgid, 0, &pCryptKey->context, in, out, 
-                                       RSAENH_DECRYPT);
-                    for (j=0; j<pCryptKey->dwBlockLen; j++) out[j] ^= pCryptKey->abChainVector[j];
-                    memcpy(pCryptKey->abChainVector, in, pCryptKey->dwBlockLen);
-                    break;
-
                 case CRYPT_MODE_CFB:
                     for (j=0; j<pCryptKey->dwBlockLen; j++) {
                         encrypt_block_impl(pCryptKey->aiAlgid, 0, &pCryptKey->context, 
@@ -456,6 +456,128 @@ void SHA256_Transform(SHA256_CTX* context, const sha2_word32* data) {
 
 #endif /* SHA2_UNROLL_TRANSFORM */
 
+#if defined(__GNUC__) && defined(__x86_64__)
+
+/*** SHA-256 using the SHA extensions (x86_64 only) *******************/
+static void sha2_cpuid(unsigned int ax, unsigned int cx, unsigned int *p) {
+	__asm__("cpuid"
+		: "=a" (p[0]), "=b" (p[1]), "=c" (p[2]), "=d" (p[3])
+		: "0" (ax), "2" (cx));
+}
+
+/* -1 until the CPU has been checked */
+static int sha_ni_present = -1;
+
+static int sha_ni_available(void) {
+	unsigned int	regs[4];
+
+	if (sha_ni_present < 0) {
+		sha_ni_present = 0;
+		sha2_cpuid(0, 0, regs);
+		if (regs[0] >= 7) {
+			sha2_cpuid(1, 0, regs);
+			/* SSSE3 and SSE4.1 are used too */
+			if ((regs[2] & (1 << 9)) && (regs[2] & (1 << 19))) {
+				sha2_cpuid(7, 0, regs);
+				sha_ni_present = (regs[1] >> 29) & 1;
+			}
+		}
+	}
+	return sha_ni_present;
+}
+
+/* pshufb mask turning the big endian message words around */
+static const sha2_byte sha256_ni_shuffle[16] = {
+	3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12
+};
+
+/*
+ * Register use: xmm0 message (implicit operand of sha256rnds2),
+ * xmm1 ABEF, xmm2 CDGH, xmm3-xmm6 message schedule, xmm7 temporary,
+ * xmm8 byte shuffle mask, xmm9/xmm10 state at the start of the block.
+ */
+#define SHA256NI_LOAD(i, m) \
+	"movdqu " #i "*16(%[data]), %%xmm0\n\t" \
+	"pshufb %%xmm8, %%xmm0\n\t" \
+	"movdqa %%xmm0, %%xmm" #m "\n\t"
+#define SHA256NI_FROM(m) \
+	"movdqa %%xmm" #m ", %%xmm0\n\t"
+#define SHA256NI_RNDS(i) \
+	"movdqu " #i "*16(%[k]), %%xmm7\n\t" \
+	"paddd %%xmm7, %%xmm0\n\t" \
+	"sha256rnds2 %%xmm1, %%xmm2\n\t" \
+	"pshufd $0x0e, %%xmm0, %%xmm0\n\t" \
+	"sha256rnds2 %%xmm2, %%xmm1\n\t"
+#define SHA256NI_MSG1(cur, prev) \
+	"sha256msg1 %%xmm" #cur ", %%xmm" #prev "\n\t"
+#define SHA256NI_MSG2(cur, prev, next) \
+	"movdqa %%xmm" #cur ", %%xmm7\n\t" \
+	"palignr $4, %%xmm" #prev ", %%xmm7\n\t" \
+	"paddd %%xmm7, %%xmm" #next "\n\t" \
+	"sha256msg2 %%xmm" #cur ", %%xmm" #next "\n\t"
+
+static void SHA256_Transform_ni(sha2_word32 *state, const sha2_byte *data, size_t blocks) {
+	__asm__ __volatile__(
+		"movdqu (%[state]), %%xmm7\n\t"
+		"movdqu 16(%[state]), %%xmm2\n\t"
+		"pshufd $0xb1, %%xmm7, %%xmm7\n\t"
+		"pshufd $0x1b, %%xmm2, %%xmm2\n\t"
+		"movdqa %%xmm7, %%xmm1\n\t"
+		"palignr $8, %%xmm2, %%xmm1\n\t"
+		"pblendw $0xf0, %%xmm7, %%xmm2\n\t"
+		"movdqu (%[shuf]), %%xmm8\n"
+		"1:\tmovdqa %%xmm1, %%xmm9\n\t"
+		"movdqa %%xmm2, %%xmm10\n\t"
+		SHA256NI_LOAD(0, 3) SHA256NI_RNDS(0)
+		SHA256NI_LOAD(1, 4) SHA256NI_RNDS(1) SHA256NI_MSG1(4, 3)
+		SHA256NI_LOAD(2, 5) SHA256NI_RNDS(2) SHA256NI_MSG1(5, 4)
+		SHA256NI_LOAD(3, 6) SHA256NI_RNDS(3) SHA256NI_MSG2(6, 5, 3) SHA256NI_MSG1(6, 5)
+		SHA256NI_FROM(3) SHA256NI_RNDS(4) SHA256NI_MSG2(3, 6, 4) SHA256NI_MSG1(3, 6)
+		SHA256NI_FROM(4) SHA256NI_RNDS(5) SHA256NI_MSG2(4, 3, 5) SHA256NI_MSG1(4, 3)
+		SHA256NI_FROM(5) SHA256NI_RNDS(6) SHA256NI_MSG2(5, 4, 6) SHA256NI_MSG1(5, 4)
+		SHA256NI_FROM(6) SHA256NI_RNDS(7) SHA256NI_MSG2(6, 5, 3) SHA256NI_MSG1(6, 5)
+		SHA256NI_FROM(3) SHA256NI_RNDS(8) SHA256NI_MSG2(3, 6, 4) SHA256NI_MSG1(3, 6)
+		SHA256NI_FROM(4) SHA256NI_RNDS(9) SHA256NI_MSG2(4, 3, 5) SHA256NI_MSG1(4, 3)
+		SHA256NI_FROM(5) SHA256NI_RNDS(10) SHA256NI_MSG2(5, 4, 6) SHA256NI_MSG1(5, 4)
+		SHA256NI_FROM(6) SHA256NI_RNDS(11) SHA256NI_MSG2(6, 5, 3) SHA256NI_MSG1(6, 5)
+		SHA256NI_FROM(3) SHA256NI_RNDS(12) SHA256NI_MSG2(3, 6, 4) SHA256NI_MSG1(3, 6)
+		SHA256NI_FROM(4) SHA256NI_RNDS(13) SHA256NI_MSG2(4, 3, 5)
+		SHA256NI_FROM(5) SHA256NI_RNDS(14) SHA256NI_MSG2(5, 4, 6)
+		SHA256NI_FROM(6) SHA256NI_RNDS(15)
+		"paddd %%xmm9, %%xmm1\n\t"
+		"paddd %%xmm10, %%xmm2\n\t"
+		"add $64, %[data]\n\t"
+		"dec %[blocks]\n\t"
+		"jnz 1b\n\t"
+		"pshufd $0x1b, %%xmm1, %%xmm1\n\t"
+		"pshufd $0xb1, %%xmm2, %%xmm2\n\t"
+		"movdqa %%xmm1, %%xmm7\n\t"
+		"pblendw $0xf0, %%xmm2, %%xmm1\n\t"
+		"palignr $8, %%xmm7, %%xmm2\n\t"
+		"movdqu %%xmm1, (%[state])\n\t"
+		"movdqu %%xmm2, 16(%[state])"
+		: [data] "+r" (data), [blocks] "+r" (blocks)
+		: [state] "r" (state), [k] "r" (K256), [shuf] "r" (sha256_ni_shuffle)
+		: "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6", "xmm7",
+		  "xmm8", "xmm9", "xmm10", "memory", "cc");
+}
+
+#endif
+
+/* Process a run of complete blocks */
+static void SHA256_Transform_blocks(SHA256_CTX* context, const sha2_byte *data, size_t blocks) {
+#if defined(__GNUC__) && defined(__x86_64__)
+	if (sha_ni_available()) {
+		SHA256_Transform_ni(context->state, data, blocks);
+		return;
+	}
+#endif
+	while (blocks--) {
+		SHA256_Transform(context, (const sha2_word32*)data);
+		data += SHA256_BLOCK_LENGTH;
+	}
+}
+
 void SHA256_Update(SHA256_CTX* context, const sha2_byte *data, size_t len) {
 	unsigned int	freespace, usedspace;
 
@@ -478,7 +600,7 @@ void SHA256_Update(SHA256_CTX* context, const sha2_byte *data, size_t len) {
 			context->bitcount += freespace << 3;
 			len -= freespace;
 			data += freespace;
-			SHA256_Transform(context, (sha2_word32*)context->buffer);
+			SHA256_Transform_blocks(context, context->buffer, 1);
 		} else {
 			/* The buffer is not yet full */
 			MEMCPY_BCOPY(&context->buffer[usedspace], data, len);
@@ -488,12 +610,14 @@ void SHA256_Update(SHA256_CTX* context, const sha2_byte *data, size_t len) {
 			return;
 		}
 	}
-	while (len >= SHA256_BLOCK_LENGTH) {
+	if (len >= SHA256_BLOCK_LENGTH) {
 		/* Process as many complete blocks as we can */
-		SHA256_Transform(context, (const sha2_word32*)data);
-		context->bitcount += SHA256_BLOCK_LENGTH << 3;
-		len -= SHA256_BLOCK_LENGTH;
-		data += SHA256_BLOCK_LENGTH;
+		size_t blocks = len / SHA256_BLOCK_LENGTH;
+
+		SHA256_Transform_blocks(context, data, blocks);
+		context->bitcount += (sha2_word64)blocks * SHA256_BLOCK_LENGTH << 3;
+		len -= blocks * SHA256_BLOCK_LENGTH;
+		data += blocks * SHA256_BLOCK_LENGTH;
 	}
 	if (len > 0) {
 		/* There's left-overs, so save 'em */
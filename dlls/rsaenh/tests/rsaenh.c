@@ -1116,7 +1116,8 @@ static void test_aes(int keylen)
     BOOL result;
     DWORD dwLen, dwMode;
     unsigned char pbData[48], enc_data[16], bad_data[16];
-    int i;
+    unsigned char plain[160], bulk[176], single[176];
+    int i, mode;
     static const BYTE aes_plain[32] = {
         "AES Test With 2 Blocks Of Data." };
     static const BYTE aes_cbc_enc[3][48] = {
@@ -1241,6 +1242,40 @@ static void test_aes(int keylen)
           printBytes("got",pbData,dwLen);
       }
     }
+
+    /* encrypting many blocks at once gives the same as one block at a time */
+    for (i=0; i<sizeof(plain); i++) plain[i] = (unsigned char)(i * 7);
+    for (mode=0; mode<2; mode++)
+    {
+      dwMode = mode ? CRYPT_MODE_ECB : CRYPT_MODE_CBC;
+      result = CryptSetKeyParam(hKey, KP_MODE, (BYTE*)&dwMode, 0);
+      ok(result, "%08x\n", GetLastError());
+
+      memcpy(bulk, plain, sizeof(plain));
+      dwLen = sizeof(plain);
+      result = CryptEncrypt(hKey, 0, TRUE, 0, bulk, &dwLen, sizeof(bulk));
+      ok(result, "%08x\n", GetLastError());
+      ok(dwLen == sizeof(bulk), "length incorrect, got %d\n", dwLen);
+
+      memcpy(single, plain, sizeof(plain));
+      for (i=0; i<sizeof(plain); i+=16)
+      {
+        dwLen = 16;
+        result = CryptEncrypt(hKey, 0, FALSE, 0, single + i, &dwLen, 16);
+        ok(result, "%08x\n", GetLastError());
+      }
+      dwLen = 0;
+      result = CryptEncrypt(hKey, 0, TRUE, 0, single + sizeof(plain), &dwLen, 16);
+      ok(result, "%08x\n", GetLastError());
+      ok(!memcmp(bulk, single, sizeof(bulk)), "mode %u: encrypted data differs\n", dwMode);
+
+      dwLen = sizeof(bulk);
+      result = CryptDecrypt(hKey, 0, TRUE, 0, bulk, &dwLen);
+      ok(result, "%08x\n", GetLastError());
+      ok(dwLen == sizeof(plain) && !memcmp(bulk, plain, sizeof(plain)),
+         "mode %u: decryption incorrect\n", dwMode);
+    }
+
     result = CryptDestroyKey(hKey);
     ok(result, "%08x\n", GetLastError());
 }
@@ -149,6 +149,10 @@ void des3_ecb_decrypt(const unsigned char *ct, unsigned char *pt, const des3_key
 int aes_setup(const unsigned char *key, int keylen, int rounds, aes_key *skey);
 void aes_ecb_encrypt(const unsigned char *pt, unsigned char *ct, aes_key *skey);
 void aes_ecb_decrypt(const unsigned char *ct, unsigned char *pt, aes_key *skey);
+void aes_ecb_encrypt_blocks(const unsigned char *pt, unsigned char *ct, unsigned long blocks, aes_key *skey);
+void aes_ecb_decrypt_blocks(const unsigned char *ct, unsigned char *pt, unsigned long blocks, aes_key *skey);
+void aes_cbc_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks, unsigned char *iv, aes_key *skey);
+void aes_cbc_decrypt(const unsigned char *ct, unsigned char *pt, unsigned long blocks, unsigned char *iv, aes_key *skey);
 
 typedef struct tag_md2_state {
     unsigned char chksum[16], X[48], buf[16];
@@ -1324,6 +1324,71 @@ static HRESULT fill_array_desc(compile_ctx_t *ctx, dim_decl_t *dim_decl, array_d
     return S_OK;
 }
 
+static int lookup_local_slot(function_t *func, const WCHAR *name)
+{
+    unsigned i;
+
+    for(i=0; i < func->var_cnt; i++) {
+        if(!strcmpiW(func->vars[i].name, name))
+            return i;
+    }
+
+    for(i=0; i < func->arg_cnt; i++) {
+        if(!strcmpiW(func->args[i].name, name))
+            return func->var_cnt+i;
+    }
+
+    return -1;
+}
+
+/*
+ * Variables and arguments of a procedure are looked up before any other name, so identifier
+ * instructions referring to them may be bound to their slots while generating bytecode.
+ */
+static void resolve_locals(compile_ctx_t *ctx, function_t *func)
+{
+    BOOL has_ret_val;
+    instr_t *instr;
+    int slot;
+
+    has_ret_val = func->type == FUNC_FUNCTION || func->type == FUNC_PROPGET || func->type == FUNC_DEFGET;
+
+    for(instr = ctx->code->instrs+func->code_off; instr < ctx->code->instrs+ctx->instr_cnt; instr++) {
+        switch(instr->op) {
+        case OP_icall:
+        case OP_icallv:
+            slot = lookup_local_slot(func, instr->arg1.bstr);
+            if(slot != -1) {
+                instr->op = instr->op == OP_icall ? OP_icall_local : OP_icallv_local;
+                instr->arg1.uint = slot;
+            }
+            break;
+        case OP_assign_ident:
+        case OP_set_ident:
+        case OP_incc:
+            /* Assignment to the function name sets its return value. */
+            if(has_ret_val && !strcmpiW(instr->arg1.bstr, func->name))
+                break;
+            slot = lookup_local_slot(func, instr->arg1.bstr);
+            if(slot != -1) {
+                instr->op = instr->op == OP_assign_ident ? OP_assign_local
+                    : instr->op == OP_set_ident ? OP_set_local : OP_incc_local;
+                instr->arg1.uint = slot;
+            }
+            break;
+        case OP_step:
+            slot = lookup_local_slot(func, instr->arg2.bstr);
+            if(slot != -1) {
+                instr->op = OP_step_local;
+                instr->arg2.uint = slot;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+}
+
 static HRESULT compile_func(compile_ctx_t *ctx, statement_t *stat, function_t *func)
 {
     HRESULT hres;
@@ -1417,6 +1482,9 @@ static HRESULT compile_func(compile_ctx_t *ctx, statement_t *stat, function_t *f
         }
     }
 
+    if(func->type != FUNC_GLOBAL)
+        resolve_locals(ctx, func);
+
     if(func->array_cnt) {
         unsigned array_id = 0;
         dim_decl_t *dim_decl;
@@ -1750,11 +1818,21 @@ void release_vbscode(vbscode_t *code)
 
     heap_free(code->bstr_pool);
     heap_free(code->source);
+    heap_free(code->delimiter);
     heap_free(code->instrs);
     heap_free(code);
 }
 
-static vbscode_t *alloc_vbscode(compile_ctx_t *ctx, const WCHAR *source)
+static unsigned hash_source(const WCHAR *source)
+{
+    unsigned h = 0;
+
+    for(; *source; source++)
+        h = (h>>(sizeof(unsigned)*8-4)) ^ (h<<4) ^ *source;
+    return h;
+}
+
+static vbscode_t *alloc_vbscode(compile_ctx_t *ctx, const WCHAR *source, const WCHAR *delimiter, unsigned source_hash)
 {
     vbscode_t *ret;
 
@@ -1768,6 +1846,20 @@ static vbscode_t *alloc_vbscode(compile_ctx_t *ctx, const WCHAR *source)
         return NULL;
     }
 
+    if(delimiter) {
+        ret->delimiter = heap_strdupW(delimiter);
+        if(!ret->delimiter) {
+            heap_free(ret->source);
+            heap_free(ret);
+            return NULL;
+        }
+    }else {
+        ret->delimiter = NULL;
+    }
+
+    ret->source_hash = source_hash;
+    ret->is_reusable = FALSE;
+
     ret->instrs = heap_alloc(32*sizeof(instr_t));
     if(!ret->instrs) {
         release_vbscode(ret);
@@ -1806,20 +1898,49 @@ static void release_compiler(compile_ctx_t *ctx)
         release_vbscode(ctx->code);
 }
 
+/*
+ * Code that declares no global variables, functions or classes doesn't change the script
+ * state when it's compiled, so the same source may be executed again from existing bytecode.
+ * Code that is still waiting for the script to be started is not shared, so that every
+ * submitted copy is executed.
+ */
+static vbscode_t *lookup_compiled_script(script_ctx_t *script, const WCHAR *src, const WCHAR *delimiter, unsigned source_hash)
+{
+    vbscode_t *iter;
+
+    LIST_FOR_EACH_ENTRY(iter, &script->code_list, vbscode_t, entry) {
+        if(iter->is_reusable && !iter->pending_exec && iter->source_hash == source_hash
+           && !strcmpW(iter->source, src)
+           && (delimiter ? iter->delimiter && !strcmpW(iter->delimiter, delimiter) : !iter->delimiter))
+            return iter;
+    }
+
+    return NULL;
+}
+
 HRESULT compile_script(script_ctx_t *script, const WCHAR *src, const WCHAR *delimiter, vbscode_t **ret)
 {
     function_t *new_func;
     function_decl_t *func_decl;
     class_decl_t *class_decl;
     compile_ctx_t ctx;
+    unsigned source_hash;
     vbscode_t *code;
     HRESULT hres;
 
+    source_hash = hash_source(src);
+    code = lookup_compiled_script(script, src, delimiter, source_hash);
+    if(code) {
+        TRACE("reusing compiled code %p\n", code);
+        *ret = code;
+        return S_OK;
+    }
+
     hres = parse_script(&ctx.parser, src, delimiter);
     if(FAILED(hres))
         return hres;
 
-    code = ctx.code = alloc_vbscode(&ctx, src);
+    code = ctx.code = alloc_vbscode(&ctx, src, delimiter, source_hash);
     if(!ctx.code)
         return E_OUTOFMEMORY;
 
@@ -1872,6 +1993,7 @@ HRESULT compile_script(script_ctx_t *script, const WCHAR *src, const WCHAR *deli
 
         var->next = script->global_vars;
         script->global_vars = ctx.global_vars;
+        clear_global_refs(script);
     }
 
     if(ctx.funcs) {
@@ -1879,6 +2001,7 @@ HRESULT compile_script(script_ctx_t *script, const WCHAR *src, const WCHAR *deli
 
         new_func->next = script->global_funcs;
         script->global_funcs = ctx.funcs;
+        clear_global_refs(script);
     }
 
     if(ctx.classes) {
@@ -1898,6 +2021,8 @@ HRESULT compile_script(script_ctx_t *script, const WCHAR *src, const WCHAR *deli
     if(TRACE_ON(vbscript_disas))
         dump_code(&ctx);
 
+    code->is_reusable = !ctx.global_vars && !ctx.funcs && !ctx.classes;
+
     ctx.code = NULL;
     release_compiler(&ctx);
 
@@ -80,6 +80,37 @@ typedef struct {
     BOOL owned;
 } variant_val_t;
 
+struct _global_ref_t {
+    global_ref_t *next;
+    unsigned hash;
+    vbdisp_invoke_type_t invoke_type;
+    ref_t ref;
+    WCHAR name[1];
+};
+
+static unsigned global_ref_hash(const WCHAR *name)
+{
+    unsigned h = 0;
+
+    for(; *name; name++)
+        h = (h>>(sizeof(unsigned)*8-4)) ^ (h<<4) ^ tolowerW(*name);
+    return h;
+}
+
+void clear_global_refs(script_ctx_t *ctx)
+{
+    global_ref_t *iter, *next;
+    unsigned i;
+
+    for(i=0; i < GLOBAL_REF_CACHE_SIZE; i++) {
+        for(iter = ctx->global_refs[i]; iter; iter = next) {
+            next = iter->next;
+            heap_free(iter);
+        }
+        ctx->global_refs[i] = NULL;
+    }
+}
+
 static BOOL lookup_dynamic_vars(dynamic_var_t *var, const WCHAR *name, ref_t *ref)
 {
     while(var) {
@@ -95,65 +126,16 @@ static BOOL lookup_dynamic_vars(dynamic_var_t *var, const WCHAR *name, ref_t *re
     return FALSE;
 }
 
-static HRESULT lookup_identifier(exec_ctx_t *ctx, BSTR name, vbdisp_invoke_type_t invoke_type, ref_t *ref)
+static HRESULT lookup_global_identifier(exec_ctx_t *ctx, BSTR name, vbdisp_invoke_type_t invoke_type, ref_t *ref)
 {
     named_item_t *item;
     function_t *func;
-    unsigned i;
     DISPID id;
     HRESULT hres;
 
     static const WCHAR errW[] = {'e','r','r',0};
 
-    if(invoke_type == VBDISP_LET
-            && (ctx->func->type == FUNC_FUNCTION || ctx->func->type == FUNC_PROPGET || ctx->func->type == FUNC_DEFGET)
-            && !strcmpiW(name, ctx->func->name)) {
-        ref->type = REF_VAR;
-        ref->u.v = &ctx->ret_val;
-        return S_OK;
-    }
-
-    for(i=0; i < ctx->func->var_cnt; i++) {
-        if(!strcmpiW(ctx->func->vars[i].name, name)) {
-            ref->type = REF_VAR;
-            ref->u.v = ctx->vars+i;
-            return TRUE;
-        }
-    }
-
-    for(i=0; i < ctx->func->arg_cnt; i++) {
-        if(!strcmpiW(ctx->func->args[i].name, name)) {
-            ref->type = REF_VAR;
-            ref->u.v = ctx->args+i;
-            return S_OK;
-        }
-    }
-
-    if(lookup_dynamic_vars(ctx->func->type == FUNC_GLOBAL ? ctx->script->global_vars : ctx->dynamic_vars, name, ref))
-        return S_OK;
-
-    if(ctx->func->type != FUNC_GLOBAL) {
-        if(ctx->vbthis) {
-            /* FIXME: Bind such identifier while generating bytecode. */
-            for(i=0; i < ctx->vbthis->desc->prop_cnt; i++) {
-                if(!strcmpiW(ctx->vbthis->desc->props[i].name, name)) {
-                    ref->type = REF_VAR;
-                    ref->u.v = ctx->vbthis->props+i;
-                    return S_OK;
-                }
-            }
-        }
-
-        hres = disp_get_id(ctx->this_obj, name, invoke_type, TRUE, &id);
-        if(SUCCEEDED(hres)) {
-            ref->type = REF_DISP;
-            ref->u.d.disp = ctx->this_obj;
-            ref->u.d.id = id;
-            return S_OK;
-        }
-    }
-
-    if(ctx->func->type != FUNC_GLOBAL && lookup_dynamic_vars(ctx->script->global_vars, name, ref))
+    if(lookup_dynamic_vars(ctx->script->global_vars, name, ref))
         return S_OK;
 
     for(func = ctx->script->global_funcs; func; func = func->next) {
@@ -219,6 +201,107 @@ static HRESULT lookup_identifier(exec_ctx_t *ctx, BSTR name, vbdisp_invoke_type_
     return S_OK;
 }
 
+/*
+ * Global identifiers are resolved through a per-script cache. The cache is cleared
+ * whenever a global variable, function or named item is added, so a cached reference
+ * is always the one that a full lookup would find.
+ */
+static HRESULT lookup_global_ref(exec_ctx_t *ctx, BSTR name, vbdisp_invoke_type_t invoke_type, ref_t *ref)
+{
+    unsigned hash = global_ref_hash(name);
+    global_ref_t *iter, **bucket;
+    size_t size;
+    HRESULT hres;
+
+    bucket = ctx->script->global_refs + hash % GLOBAL_REF_CACHE_SIZE;
+    for(iter = *bucket; iter; iter = iter->next) {
+        if(iter->hash == hash && iter->invoke_type == invoke_type && !strcmpiW(iter->name, name)) {
+            *ref = iter->ref;
+            return S_OK;
+        }
+    }
+
+    hres = lookup_global_identifier(ctx, name, invoke_type, ref);
+    if(FAILED(hres) || ref->type == REF_NONE)
+        return hres;
+
+    size = (strlenW(name)+1)*sizeof(WCHAR);
+    iter = heap_alloc(FIELD_OFFSET(global_ref_t, name) + size);
+    if(iter) {
+        iter->hash = hash;
+        iter->invoke_type = invoke_type;
+        iter->ref = *ref;
+        memcpy(iter->name, name, size);
+        iter->next = *bucket;
+        *bucket = iter;
+    }
+
+    return S_OK;
+}
+
+static HRESULT lookup_identifier(exec_ctx_t *ctx, BSTR name, vbdisp_invoke_type_t invoke_type, ref_t *ref)
+{
+    unsigned i;
+    DISPID id;
+    HRESULT hres;
+
+    if(invoke_type == VBDISP_LET
+            && (ctx->func->type == FUNC_FUNCTION || ctx->func->type == FUNC_PROPGET || ctx->func->type == FUNC_DEFGET)
+            && !strcmpiW(name, ctx->func->name)) {
+        ref->type = REF_VAR;
+        ref->u.v = &ctx->ret_val;
+        return S_OK;
+    }
+
+    for(i=0; i < ctx->func->var_cnt; i++) {
+        if(!strcmpiW(ctx->func->vars[i].name, name)) {
+            ref->type = REF_VAR;
+            ref->u.v = ctx->vars+i;
+            return TRUE;
+        }
+    }
+
+    for(i=0; i < ctx->func->arg_cnt; i++) {
+        if(!strcmpiW(ctx->func->args[i].name, name)) {
+            ref->type = REF_VAR;
+            ref->u.v = ctx->args+i;
+            return S_OK;
+        }
+    }
+
+    if(ctx->func->type != FUNC_GLOBAL) {
+        if(lookup_dynamic_vars(ctx->dynamic_vars, name, ref))
+            return S_OK;
+
+        if(ctx->vbthis) {
+            /* FIXME: Bind such identifier while generating bytecode. */
+            for(i=0; i < ctx->vbthis->desc->prop_cnt; i++) {
+                if(!strcmpiW(ctx->vbthis->desc->props[i].name, name)) {
+                    ref->type = REF_VAR;
+                    ref->u.v = ctx->vbthis->props+i;
+                    return S_OK;
+                }
+            }
+        }
+
+        hres = disp_get_id(ctx->this_obj, name, invoke_type, TRUE, &id);
+        if(SUCCEEDED(hres)) {
+            ref->type = REF_DISP;
+            ref->u.d.disp = ctx->this_obj;
+            ref->u.d.id = id;
+            return S_OK;
+        }
+    }
+
+    return lookup_global_ref(ctx, name, invoke_type, ref);
+}
+
+static void lookup_local(exec_ctx_t *ctx, unsigned slot, ref_t *ref)
+{
+    ref->type = REF_VAR;
+    ref->u.v = slot < ctx->func->var_cnt ? ctx->vars+slot : ctx->args+slot-ctx->func->var_cnt;
+}
+
 static HRESULT add_dynamic_var(exec_ctx_t *ctx, const WCHAR *name,
         BOOL is_const, VARIANT *val, BOOL own_val, VARIANT **out_var)
 {
@@ -254,6 +337,7 @@ static HRESULT add_dynamic_var(exec_ctx_t *ctx, const WCHAR *name,
     if(ctx->func->type == FUNC_GLOBAL) {
         new_var->next = ctx->script->global_vars;
         ctx->script->global_vars = new_var;
+        clear_global_refs(ctx->script);
     }else {
         new_var->next = ctx->dynamic_vars;
         ctx->dynamic_vars = new_var;
@@ -536,17 +620,21 @@ static HRESULT array_access(exec_ctx_t *ctx, SAFEARRAY *array, DISPPARAMS *dp, V
     return S_OK;
 }
 
-static HRESULT do_icall(exec_ctx_t *ctx, VARIANT *res)
+static HRESULT do_icall(exec_ctx_t *ctx, BOOL is_local, VARIANT *res)
 {
-    BSTR identifier = ctx->instr->arg1.bstr;
+    BSTR identifier = is_local ? NULL : ctx->instr->arg1.bstr;
     const unsigned arg_cnt = ctx->instr->arg2.uint;
     DISPPARAMS dp;
     ref_t ref;
     HRESULT hres;
 
-    hres = lookup_identifier(ctx, identifier, VBDISP_CALLGET, &ref);
-    if(FAILED(hres))
-        return hres;
+    if(is_local) {
+        lookup_local(ctx, ctx->instr->arg1.uint, &ref);
+    }else {
+        hres = lookup_identifier(ctx, identifier, VBDISP_CALLGET, &ref);
+        if(FAILED(hres))
+            return hres;
+    }
 
     switch(ref.type) {
     case REF_VAR:
@@ -644,7 +732,21 @@ static HRESULT interp_icall(exec_ctx_t *ctx)
 
     TRACE("\n");
 
-    hres = do_icall(ctx, &v);
+    hres = do_icall(ctx, FALSE, &v);
+    if(FAILED(hres))
+        return hres;
+
+    return stack_push(ctx, &v);
+}
+
+static HRESULT interp_icall_local(exec_ctx_t *ctx)
+{
+    VARIANT v;
+    HRESULT hres;
+
+    TRACE("%u\n", ctx->instr->arg1.uint);
+
+    hres = do_icall(ctx, TRUE, &v);
     if(FAILED(hres))
         return hres;
 
@@ -654,7 +756,13 @@ static HRESULT interp_icall(exec_ctx_t *ctx)
 static HRESULT interp_icallv(exec_ctx_t *ctx)
 {
     TRACE("\n");
-    return do_icall(ctx, NULL);
+    return do_icall(ctx, FALSE, NULL);
+}
+
+static HRESULT interp_icallv_local(exec_ctx_t *ctx)
+{
+    TRACE("%u\n", ctx->instr->arg1.uint);
+    return do_icall(ctx, TRUE, NULL);
 }
 
 static HRESULT do_mcall(exec_ctx_t *ctx, VARIANT *res)
@@ -709,18 +817,13 @@ static HRESULT interp_mcallv(exec_ctx_t *ctx)
     return do_mcall(ctx, NULL);
 }
 
-static HRESULT assign_ident(exec_ctx_t *ctx, BSTR name, DISPPARAMS *dp)
+static HRESULT assign_ref(exec_ctx_t *ctx, ref_t *ref, BSTR name, DISPPARAMS *dp)
 {
-    ref_t ref;
     HRESULT hres;
 
-    hres = lookup_identifier(ctx, name, VBDISP_LET, &ref);
-    if(FAILED(hres))
-        return hres;
-
-    switch(ref.type) {
+    switch(ref->type) {
     case REF_VAR: {
-        VARIANT *v = ref.u.v;
+        VARIANT *v = ref->u.v;
 
         if(V_VT(v) == (VT_VARIANT|VT_BYREF))
             v = V_VARIANTREF(v);
@@ -762,7 +865,7 @@ static HRESULT assign_ident(exec_ctx_t *ctx, BSTR name, DISPPARAMS *dp)
         break;
     }
     case REF_DISP:
-        hres = disp_propput(ctx->script, ref.u.d.disp, ref.u.d.id, dp);
+        hres = disp_propput(ctx->script, ref->u.d.disp, ref->u.d.id, dp);
         break;
     case REF_FUNC:
         FIXME("functions not implemented\n");
@@ -786,11 +889,25 @@ static HRESULT assign_ident(exec_ctx_t *ctx, BSTR name, DISPPARAMS *dp)
             TRACE("creating variable %s\n", debugstr_w(name));
             hres = add_dynamic_var(ctx, name, FALSE, dp->rgvarg, FALSE, NULL);
         }
+        break;
+    DEFAULT_UNREACHABLE;
     }
 
     return hres;
 }
 
+static HRESULT assign_ident(exec_ctx_t *ctx, BSTR name, DISPPARAMS *dp)
+{
+    ref_t ref;
+    HRESULT hres;
+
+    hres = lookup_identifier(ctx, name, VBDISP_LET, &ref);
+    if(FAILED(hres))
+        return hres;
+
+    return assign_ref(ctx, &ref, name, dp);
+}
+
 static HRESULT interp_assign_ident(exec_ctx_t *ctx)
 {
     const BSTR arg = ctx->instr->arg1.bstr;
@@ -813,6 +930,30 @@ static HRESULT interp_assign_ident(exec_ctx_t *ctx)
     return S_OK;
 }
 
+static HRESULT interp_assign_local(exec_ctx_t *ctx)
+{
+    const unsigned slot = ctx->instr->arg1.uint;
+    const unsigned arg_cnt = ctx->instr->arg2.uint;
+    DISPPARAMS dp;
+    ref_t ref;
+    HRESULT hres;
+
+    TRACE("%u\n", slot);
+
+    hres = stack_assume_val(ctx, arg_cnt);
+    if(FAILED(hres))
+        return hres;
+
+    lookup_local(ctx, slot, &ref);
+    vbstack_to_dp(ctx, arg_cnt, TRUE, &dp);
+    hres = assign_ref(ctx, &ref, NULL, &dp);
+    if(FAILED(hres))
+        return hres;
+
+    stack_popn(ctx, arg_cnt+1);
+    return S_OK;
+}
+
 static HRESULT interp_set_ident(exec_ctx_t *ctx)
 {
     const BSTR arg = ctx->instr->arg1.bstr;
@@ -840,6 +981,35 @@ static HRESULT interp_set_ident(exec_ctx_t *ctx)
     return S_OK;
 }
 
+static HRESULT interp_set_local(exec_ctx_t *ctx)
+{
+    const unsigned slot = ctx->instr->arg1.uint;
+    const unsigned arg_cnt = ctx->instr->arg2.uint;
+    DISPPARAMS dp;
+    ref_t ref;
+    HRESULT hres;
+
+    TRACE("%u\n", slot);
+
+    if(arg_cnt) {
+        FIXME("arguments not supported\n");
+        return E_NOTIMPL;
+    }
+
+    hres = stack_assume_disp(ctx, 0, NULL);
+    if(FAILED(hres))
+        return hres;
+
+    lookup_local(ctx, slot, &ref);
+    vbstack_to_dp(ctx, 0, TRUE, &dp);
+    hres = assign_ref(ctx, &ref, NULL, &dp);
+    if(FAILED(hres))
+        return hres;
+
+    stack_popn(ctx, 1);
+    return S_OK;
+}
+
 static HRESULT interp_assign_member(exec_ctx_t *ctx)
 {
     BSTR identifier = ctx->instr->arg1.bstr;
@@ -1060,16 +1230,12 @@ static HRESULT interp_dim(exec_ctx_t *ctx)
     return S_OK;
 }
 
-static HRESULT interp_step(exec_ctx_t *ctx)
+static HRESULT do_step(exec_ctx_t *ctx, ref_t *ref)
 {
-    const BSTR ident = ctx->instr->arg2.bstr;
     BOOL gteq_zero;
     VARIANT zero;
-    ref_t ref;
     HRESULT hres;
 
-    TRACE("%s\n", debugstr_w(ident));
-
     V_VT(&zero) = VT_I2;
     V_I2(&zero) = 0;
     hres = VarCmp(stack_top(ctx, 0), &zero, ctx->script->lcid, 0);
@@ -1078,16 +1244,7 @@ static HRESULT interp_step(exec_ctx_t *ctx)
 
     gteq_zero = hres == VARCMP_GT || hres == VARCMP_EQ;
 
-    hres = lookup_identifier(ctx, ident, VBDISP_ANY, &ref);
-    if(FAILED(hres))
-        return hres;
-
-    if(ref.type != REF_VAR) {
-        FIXME("%s is not REF_VAR\n", debugstr_w(ident));
-        return E_FAIL;
-    }
-
-    hres = VarCmp(ref.u.v, stack_top(ctx, 1), ctx->script->lcid, 0);
+    hres = VarCmp(ref->u.v, stack_top(ctx, 1), ctx->script->lcid, 0);
     if(FAILED(hres))
         return hres;
 
@@ -1100,6 +1257,36 @@ static HRESULT interp_step(exec_ctx_t *ctx)
     return S_OK;
 }
 
+static HRESULT interp_step(exec_ctx_t *ctx)
+{
+    const BSTR ident = ctx->instr->arg2.bstr;
+    ref_t ref;
+    HRESULT hres;
+
+    TRACE("%s\n", debugstr_w(ident));
+
+    hres = lookup_identifier(ctx, ident, VBDISP_ANY, &ref);
+    if(FAILED(hres))
+        return hres;
+
+    if(ref.type != REF_VAR) {
+        FIXME("%s is not REF_VAR\n", debugstr_w(ident));
+        return E_FAIL;
+    }
+
+    return do_step(ctx, &ref);
+}
+
+static HRESULT interp_step_local(exec_ctx_t *ctx)
+{
+    ref_t ref;
+
+    TRACE("%u\n", ctx->instr->arg2.uint);
+
+    lookup_local(ctx, ctx->instr->arg2.uint, &ref);
+    return do_step(ctx, &ref);
+}
+
 static HRESULT interp_newenum(exec_ctx_t *ctx)
 {
     variant_val_t v;
@@ -1962,10 +2149,23 @@ static HRESULT interp_neg(exec_ctx_t *ctx)
     return stack_push(ctx, &v);
 }
 
+static HRESULT do_incc(exec_ctx_t *ctx, ref_t *ref)
+{
+    VARIANT v;
+    HRESULT hres;
+
+    hres = VarAdd(stack_top(ctx, 0), ref->u.v, &v);
+    if(FAILED(hres))
+        return hres;
+
+    VariantClear(ref->u.v);
+    *ref->u.v = v;
+    return S_OK;
+}
+
 static HRESULT interp_incc(exec_ctx_t *ctx)
 {
     const BSTR ident = ctx->instr->arg1.bstr;
-    VARIANT v;
     ref_t ref;
     HRESULT hres;
 
@@ -1980,13 +2180,17 @@ static HRESULT interp_incc(exec_ctx_t *ctx)
         return E_FAIL;
     }
 
-    hres = VarAdd(stack_top(ctx, 0), ref.u.v, &v);
-    if(FAILED(hres))
-        return hres;
+    return do_incc(ctx, &ref);
+}
 
-    VariantClear(ref.u.v);
-    *ref.u.v = v;
-    return S_OK;
+static HRESULT interp_incc_local(exec_ctx_t *ctx)
+{
+    ref_t ref;
+
+    TRACE("%u\n", ctx->instr->arg1.uint);
+
+    lookup_local(ctx, ctx->instr->arg1.uint, &ref);
+    return do_incc(ctx, &ref);
 }
 
 static HRESULT interp_catch(exec_ctx_t *ctx)
@@ -1841,6 +1841,64 @@ static void test_msgbox(void)
     CHECK_CALLED(GetUIBehavior);
 }
 
+static void parse_engine_script(IActiveScriptParse *parser, const char *src)
+{
+    BSTR script_str;
+    HRESULT hres;
+
+    script_str = a2bstr(src);
+    hres = IActiveScriptParse_ParseScriptText(parser, script_str, NULL, NULL, NULL, 0, 0, 0, NULL, NULL);
+    SysFreeString(script_str);
+    ok(hres == S_OK, "ParseScriptText failed: %08x\n", hres);
+}
+
+static void test_parse_same_script(void)
+{
+    IActiveScriptParse *parser;
+    IActiveScript *engine;
+    unsigned i;
+    HRESULT hres;
+
+    engine = create_script();
+    if(!engine)
+        return;
+
+    hres = IActiveScript_QueryInterface(engine, &IID_IActiveScriptParse, (void**)&parser);
+    ok(hres == S_OK, "Could not get IActiveScriptParse: %08x\n", hres);
+
+    hres = IActiveScriptParse_InitNew(parser);
+    ok(hres == S_OK, "InitNew failed: %08x\n", hres);
+
+    hres = IActiveScript_SetScriptSite(engine, &ActiveScriptSite);
+    ok(hres == S_OK, "SetScriptSite failed: %08x\n", hres);
+
+    hres = IActiveScript_AddNamedItem(engine, testW, SCRIPTITEM_ISVISIBLE|SCRIPTITEM_ISSOURCE|SCRIPTITEM_GLOBALMEMBERS);
+    ok(hres == S_OK, "AddNamedItem failed: %08x\n", hres);
+
+    /* Both copies are executed once the script is started. */
+    parse_engine_script(parser, "y = y + 1");
+    parse_engine_script(parser, "y = y + 1");
+
+    hres = IActiveScript_SetScriptState(engine, SCRIPTSTATE_STARTED);
+    ok(hres == S_OK, "SetScriptState(SCRIPTSTATE_STARTED) failed: %08x\n", hres);
+
+    parse_engine_script(parser, "Call ok(y = 2, \"y = \" & y)");
+
+    parse_engine_script(parser, "Dim x\nx = 0");
+    for(i = 0; i < 3; i++)
+        parse_engine_script(parser, "x = x + 1");
+    parse_engine_script(parser, "Call ok(x = 3, \"x = \" & x)");
+
+    parse_engine_script(parser, "Function add(a)\nadd = a + 1\nEnd Function");
+    parse_engine_script(parser, "x = add(x)\nCall ok(x = 4, \"x = \" & x)");
+    parse_engine_script(parser, "y = add(y)\nCall ok(y = 3, \"y = \" & y)");
+    parse_engine_script(parser, "x = add(x)\nCall ok(x = 5, \"x = \" & x)");
+
+    IActiveScript_Close(engine);
+    IActiveScript_Release(engine);
+    IActiveScriptParse_Release(parser);
+}
+
 static HRESULT test_global_vars_ref(BOOL use_close)
 {
     IActiveScriptParse *parser;
@@ -2092,6 +2150,8 @@ static void run_tests(void)
     test_global_vars_ref(TRUE);
     test_global_vars_ref(FALSE);
 
+    test_parse_same_script();
+
     hres = parse_script_ar("throwInt(&h80080008&)");
     ok(hres == 0x80080008, "hres = %08x\n", hres);
 
@@ -118,6 +118,7 @@ static void release_script(script_ctx_t *ctx)
     class_desc_t *class_desc;
 
     collect_objects(ctx);
+    clear_global_refs(ctx);
 
     release_dynamic_vars(ctx->global_vars);
     ctx->global_vars = NULL;
@@ -441,6 +442,7 @@ static HRESULT WINAPI VBScript_AddNamedItem(IActiveScript *iface, LPCOLESTR pstr
     }
 
     list_add_tail(&This->ctx->named_items, &item->entry);
+    clear_global_refs(This->ctx);
     return S_OK;
 }
 
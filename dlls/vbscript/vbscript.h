@@ -172,6 +172,10 @@ typedef struct _dynamic_var_t {
     BOOL is_const;
 } dynamic_var_t;
 
+typedef struct _global_ref_t global_ref_t;
+
+#define GLOBAL_REF_CACHE_SIZE 128
+
 struct _script_ctx_t {
     IActiveScriptSite *site;
     LCID lcid;
@@ -196,6 +200,8 @@ struct _script_ctx_t {
     class_desc_t *classes;
     class_desc_t *procs;
 
+    global_ref_t *global_refs[GLOBAL_REF_CACHE_SIZE];
+
     heap_pool_t heap;
 
     struct list objects;
@@ -222,6 +228,7 @@ typedef enum {
     X(add,            1, 0,           0)          \
     X(and,            1, 0,           0)          \
     X(assign_ident,   1, ARG_BSTR,    ARG_UINT)   \
+    X(assign_local,   1, ARG_UINT,    ARG_UINT)   \
     X(assign_member,  1, ARG_BSTR,    ARG_UINT)   \
     X(bool,           1, ARG_INT,     0)          \
     X(catch,          1, ARG_ADDR,    ARG_UINT)    \
@@ -241,10 +248,13 @@ typedef enum {
     X(gt,             1, 0,           0)          \
     X(gteq,           1, 0,           0)          \
     X(icall,          1, ARG_BSTR,    ARG_UINT)   \
+    X(icall_local,    1, ARG_UINT,    ARG_UINT)   \
     X(icallv,         1, ARG_BSTR,    ARG_UINT)   \
+    X(icallv_local,   1, ARG_UINT,    ARG_UINT)   \
     X(idiv,           1, 0,           0)          \
     X(imp,            1, 0,           0)          \
     X(incc,           1, ARG_BSTR,    0)          \
+    X(incc_local,     1, ARG_UINT,    0)          \
     X(is,             1, 0,           0)          \
     X(jmp,            0, ARG_ADDR,    0)          \
     X(jmp_false,      0, ARG_ADDR,    0)          \
@@ -268,9 +278,11 @@ typedef enum {
     X(pop,            1, ARG_UINT,    0)          \
     X(ret,            0, 0,           0)          \
     X(set_ident,      1, ARG_BSTR,    ARG_UINT)   \
+    X(set_local,      1, ARG_UINT,    ARG_UINT)   \
     X(set_member,     1, ARG_BSTR,    ARG_UINT)   \
     X(short,          1, ARG_INT,     0)          \
     X(step,           0, ARG_ADDR,    ARG_BSTR)   \
+    X(step_local,     0, ARG_ADDR,    ARG_UINT)   \
     X(stop,           1, 0,           0)          \
     X(string,         1, ARG_STR,     0)          \
     X(sub,            1, 0,           0)          \
@@ -335,6 +347,9 @@ struct _function_t {
 struct _vbscode_t {
     instr_t *instrs;
     WCHAR *source;
+    WCHAR *delimiter;
+    unsigned source_hash;
+    BOOL is_reusable;
 
     BOOL option_explicit;
 
@@ -353,6 +368,7 @@ void release_vbscode(vbscode_t*) DECLSPEC_HIDDEN;
 HRESULT compile_script(script_ctx_t*,const WCHAR*,const WCHAR*,vbscode_t**) DECLSPEC_HIDDEN;
 HRESULT exec_script(script_ctx_t*,function_t*,vbdisp_t*,DISPPARAMS*,VARIANT*) DECLSPEC_HIDDEN;
 void release_dynamic_vars(dynamic_var_t*) DECLSPEC_HIDDEN;
+void clear_global_refs(script_ctx_t*) DECLSPEC_HIDDEN;
 
 typedef struct {
     UINT16 len;
@@ -83,6 +83,165 @@ static inline FormatConverter *impl_from_IWICFormatConverter(IWICFormatConverter
     return CONTAINING_RECORD(iface, FormatConverter, IWICFormatConverter_iface);
 }
 
+/* Conversions that need the source pixels in a separate buffer fetch them a
+ * strip of rows at a time, so the temporary buffer stays small and hot in
+ * the cache no matter how large the requested rectangle is. */
+#define CONVERT_STRIP_SIZE 0x10000
+
+typedef void (*convert_row_func)(const BYTE *src, BYTE *dst, UINT width);
+
+static HRESULT copypixels_by_strips(struct FormatConverter *This, const WICRect *prc,
+    UINT srcbpp, UINT cbStride, BYTE *pbBuffer, convert_row_func convert_row)
+{
+    HRESULT res;
+    WICRect rc;
+    BYTE *srcdata;
+    UINT srcstride, rows, y, i;
+
+    srcstride = (srcbpp * prc->Width + 7) / 8;
+    rows = srcstride ? CONVERT_STRIP_SIZE / srcstride : prc->Height;
+    if (!rows) rows = 1;
+    if (rows > prc->Height) rows = prc->Height;
+
+    srcdata = HeapAlloc(GetProcessHeap(), 0, srcstride * max(rows, 1));
+    if (!srcdata) return E_OUTOFMEMORY;
+
+    rc.X = prc->X;
+    rc.Width = prc->Width;
+    y = 0;
+    do
+    {
+        rc.Y = prc->Y + y;
+        rc.Height = min(rows, prc->Height - y);
+
+        res = IWICBitmapSource_CopyPixels(This->source, &rc, srcstride, srcstride * rc.Height, srcdata);
+        if (FAILED(res)) break;
+
+        for (i = 0; i < rc.Height; i++)
+            convert_row(srcdata + srcstride * i, pbBuffer + cbStride * (y + i), prc->Width);
+
+        y += rc.Height;
+    } while (y < prc->Height);
+
+    HeapFree(GetProcessHeap(), 0, srcdata);
+
+    return res;
+}
+
+/* 24bpp pixels are smaller than 32bpp ones, so the source can be read straight
+ * into the destination buffer and each row widened in place from the end. */
+static HRESULT copypixels_expand_24bpp(struct FormatConverter *This, const WICRect *prc,
+    UINT cbStride, UINT cbBufferSize, BYTE *pbBuffer, BOOL swap_rb)
+{
+    HRESULT res;
+    INT x, y;
+    const BYTE *srcpixel;
+    BYTE *dstrow, *dstpixel;
+    BYTE red, green, blue;
+
+    res = IWICBitmapSource_CopyPixels(This->source, prc, cbStride, cbBufferSize, pbBuffer);
+    if (FAILED(res)) return res;
+
+    dstrow = pbBuffer;
+    for (y=0; y<prc->Height; y++) {
+        srcpixel=dstrow+3*prc->Width;
+        dstpixel=dstrow+4*prc->Width;
+        for (x=0; x<prc->Width; x++) {
+            srcpixel-=3;
+            dstpixel-=4;
+            if (swap_rb) {
+                red=srcpixel[0]; green=srcpixel[1]; blue=srcpixel[2];
+            } else {
+                blue=srcpixel[0]; green=srcpixel[1]; red=srcpixel[2];
+            }
+            dstpixel[3]=255; /* alpha */
+            dstpixel[2]=red;
+            dstpixel[1]=green;
+            dstpixel[0]=blue;
+        }
+        dstrow += cbStride;
+    }
+
+    return S_OK;
+}
+
+static void convert_row_32bpp_to_24bppBGR(const BYTE *src, BYTE *dst, UINT width)
+{
+    UINT x;
+
+    for (x=0; x<width; x++) {
+        dst[0]=src[0]; /* blue */
+        dst[1]=src[1]; /* green */
+        dst[2]=src[2]; /* red */
+        src+=4;
+        dst+=3;
+    }
+}
+
+static void convert_row_32bpp_to_24bppRGB(const BYTE *src, BYTE *dst, UINT width)
+{
+    UINT x;
+
+    for (x=0; x<width; x++) {
+        dst[0]=src[2]; /* red */
+        dst[1]=src[1]; /* green */
+        dst[2]=src[0]; /* blue */
+        src+=4;
+        dst+=3;
+    }
+}
+
+static void convert_row_48bppRGB_to_32bppBGRA(const BYTE *src, BYTE *dst, UINT width)
+{
+    DWORD *dstpixel = (DWORD *)dst;
+    UINT x;
+
+    for (x=0; x<width; x++) {
+        *dstpixel++=0xff000000|src[0]<<16|src[2]<<8|src[4];
+        src+=6;
+    }
+}
+
+static void convert_row_64bppRGBA_to_32bppBGRA(const BYTE *src, BYTE *dst, UINT width)
+{
+    DWORD *dstpixel = (DWORD *)dst;
+    UINT x;
+
+    for (x=0; x<width; x++) {
+        *dstpixel++=src[6]<<24|src[0]<<16|src[2]<<8|src[4];
+        src+=8;
+    }
+}
+
+/* Exact c * alpha / 255 for 8-bit values, without the division. */
+static inline BYTE premultiply_channel(BYTE c, BYTE alpha)
+{
+    UINT x = c * alpha;
+    return (x + 1 + (x >> 8)) >> 8;
+}
+
+static void premultiply_32bppBGRA(BYTE *buffer, UINT width, UINT height, UINT stride)
+{
+    UINT x, y;
+    BYTE *row, *pixel;
+
+    row = buffer;
+    for (y=0; y<height; y++) {
+        pixel=row;
+        for (x=0; x<width; x++) {
+            BYTE alpha = pixel[3];
+            if (alpha != 255)
+            {
+                pixel[0] = premultiply_channel(pixel[0], alpha);
+                pixel[1] = premultiply_channel(pixel[1], alpha);
+                pixel[2] = premultiply_channel(pixel[2], alpha);
+            }
+            pixel+=4;
+        }
+        row += stride;
+    }
+}
+
 static HRESULT copypixels_to_32bppBGRA(struct FormatConverter *This, const WICRect *prc,
     UINT cbStride, UINT cbBufferSize, BYTE *pbBuffer, enum pixelformat source_format)
 {
@@ -562,108 +721,29 @@ static HRESULT copypixels_to_32bppBGRA(struct FormatConverter *This, const WICRe
         return S_OK;
     case format_24bppBGR:
         if (prc)
-        {
-            HRESULT res;
-            INT x, y;
-            BYTE *srcdata;
-            UINT srcstride, srcdatasize;
-            const BYTE *srcrow;
-            const BYTE *srcpixel;
-            BYTE *dstrow;
-            BYTE *dstpixel;
-
-            srcstride = 3 * prc->Width;
-            srcdatasize = srcstride * prc->Height;
-
-            srcdata = HeapAlloc(GetProcessHeap(), 0, srcdatasize);
-            if (!srcdata) return E_OUTOFMEMORY;
-
-            res = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
-
-            if (SUCCEEDED(res))
-            {
-                srcrow = srcdata;
-                dstrow = pbBuffer;
-                for (y=0; y<prc->Height; y++) {
-                    srcpixel=srcrow;
-                    dstpixel=dstrow;
-                    for (x=0; x<prc->Width; x++) {
-                        *dstpixel++=*srcpixel++; /* blue */
-                        *dstpixel++=*srcpixel++; /* green */
-                        *dstpixel++=*srcpixel++; /* red */
-                        *dstpixel++=255; /* alpha */
-                    }
-                    srcrow += srcstride;
-                    dstrow += cbStride;
-                }
-            }
-
-            HeapFree(GetProcessHeap(), 0, srcdata);
-
-            return res;
-        }
+            return copypixels_expand_24bpp(This, prc, cbStride, cbBufferSize, pbBuffer, FALSE);
         return S_OK;
     case format_24bppRGB:
         if (prc)
-        {
-            HRESULT res;
-            INT x, y;
-            BYTE *srcdata;
-            UINT srcstride, srcdatasize;
-            const BYTE *srcrow;
-            const BYTE *srcpixel;
-            BYTE *dstrow;
-            BYTE *dstpixel;
-            BYTE tmppixel[3];
-
-            srcstride = 3 * prc->Width;
-            srcdatasize = srcstride * prc->Height;
-
-            srcdata = HeapAlloc(GetProcessHeap(), 0, srcdatasize);
-            if (!srcdata) return E_OUTOFMEMORY;
-
-            res = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
-
-            if (SUCCEEDED(res))
-            {
-                srcrow = srcdata;
-                dstrow = pbBuffer;
-                for (y=0; y<prc->Height; y++) {
-                    srcpixel=srcrow;
-                    dstpixel=dstrow;
-                    for (x=0; x<prc->Width; x++) {
-                        tmppixel[0]=*srcpixel++; /* red */
-                        tmppixel[1]=*srcpixel++; /* green */
-                        tmppixel[2]=*srcpixel++; /* blue */
-
-                        *dstpixel++=tmppixel[2]; /* blue */
-                        *dstpixel++=tmppixel[1]; /* green */
-                        *dstpixel++=tmppixel[0]; /* red */
-                        *dstpixel++=255; /* alpha */
-                    }
-                    srcrow += srcstride;
-                    dstrow += cbStride;
-                }
-            }
-
-            HeapFree(GetProcessHeap(), 0, srcdata);
-
-            return res;
-        }
+            return copypixels_expand_24bpp(This, prc, cbStride, cbBufferSize, pbBuffer, TRUE);
         return S_OK;
     case format_32bppBGR:
         if (prc)
         {
             HRESULT res;
             INT x, y;
+            BYTE *row;
 
             res = IWICBitmapSource_CopyPixels(This->source, prc, cbStride, cbBufferSize, pbBuffer);
             if (FAILED(res)) return res;
 
             /* set all alpha values to 255 */
-            for (y=0; y<prc->Height; y++)
+            row = pbBuffer;
+            for (y=0; y<prc->Height; y++) {
                 for (x=0; x<prc->Width; x++)
-                    pbBuffer[cbStride*y+4*x+3] = 0xff;
+                    row[4*x+3] = 0xff;
+                row += cbStride;
+            }
         }
         return S_OK;
     case format_32bppBGRA:
@@ -694,92 +774,11 @@ static HRESULT copypixels_to_32bppBGRA(struct FormatConverter *This, const WICRe
         return S_OK;
     case format_48bppRGB:
         if (prc)
-        {
-            HRESULT res;
-            INT x, y;
-            BYTE *srcdata;
-            UINT srcstride, srcdatasize;
-            const BYTE *srcrow;
-            const BYTE *srcpixel;
-            BYTE *dstrow;
-            DWORD *dstpixel;
-
-            srcstride = 6 * prc->Width;
-            srcdatasize = srcstride * prc->Height;
-
-            srcdata = HeapAlloc(GetProcessHeap(), 0, srcdatasize);
-            if (!srcdata) return E_OUTOFMEMORY;
-
-            res = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
-
-            if (SUCCEEDED(res))
-            {
-                srcrow = srcdata;
-                dstrow = pbBuffer;
-                for (y=0; y<prc->Height; y++) {
-                    srcpixel=srcrow;
-                    dstpixel=(DWORD*)dstrow;
-                    for (x=0; x<prc->Width; x++) {
-                        BYTE red, green, blue;
-                        red = *srcpixel++; srcpixel++;
-                        green = *srcpixel++; srcpixel++;
-                        blue = *srcpixel++; srcpixel++;
-                        *dstpixel++=0xff000000|red<<16|green<<8|blue;
-                    }
-                    srcrow += srcstride;
-                    dstrow += cbStride;
-                }
-            }
-
-            HeapFree(GetProcessHeap(), 0, srcdata);
-
-            return res;
-        }
+            return copypixels_by_strips(This, prc, 48, cbStride, pbBuffer, convert_row_48bppRGB_to_32bppBGRA);
         return S_OK;
     case format_64bppRGBA:
         if (prc)
-        {
-            HRESULT res;
-            INT x, y;
-            BYTE *srcdata;
-            UINT srcstride, srcdatasize;
-            const BYTE *srcrow;
-            const BYTE *srcpixel;
-            BYTE *dstrow;
-            DWORD *dstpixel;
-
-            srcstride = 8 * prc->Width;
-            srcdatasize = srcstride * prc->Height;
-
-            srcdata = HeapAlloc(GetProcessHeap(), 0, srcdatasize);
-            if (!srcdata) return E_OUTOFMEMORY;
-
-            res = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
-
-            if (SUCCEEDED(res))
-            {
-                srcrow = srcdata;
-                dstrow = pbBuffer;
-                for (y=0; y<prc->Height; y++) {
-                    srcpixel=srcrow;
-                    dstpixel=(DWORD*)dstrow;
-                    for (x=0; x<prc->Width; x++) {
-                        BYTE red, green, blue, alpha;
-                        red = *srcpixel++; srcpixel++;
-                        green = *srcpixel++; srcpixel++;
-                        blue = *srcpixel++; srcpixel++;
-                        alpha = *srcpixel++; srcpixel++;
-                        *dstpixel++=alpha<<24|red<<16|green<<8|blue;
-                    }
-                    srcrow += srcstride;
-                    dstrow += cbStride;
-                }
-            }
-
-            HeapFree(GetProcessHeap(), 0, srcdata);
-
-            return res;
-        }
+            return copypixels_by_strips(This, prc, 64, cbStride, pbBuffer, convert_row_64bppRGBA_to_32bppBGRA);
         return S_OK;
     case format_32bppCMYK:
         if (prc)
@@ -834,24 +833,16 @@ static HRESULT copypixels_to_32bppPBGRA(struct FormatConverter *This, const WICR
         if (prc)
             return IWICBitmapSource_CopyPixels(This->source, prc, cbStride, cbBufferSize, pbBuffer);
         return S_OK;
+    case format_24bppBGR:
+    case format_24bppRGB:
+    case format_32bppBGR:
+    case format_48bppRGB:
+        /* opaque, nothing to premultiply */
+        return copypixels_to_32bppBGRA(This, prc, cbStride, cbBufferSize, pbBuffer, source_format);
     default:
         hr = copypixels_to_32bppBGRA(This, prc, cbStride, cbBufferSize, pbBuffer, source_format);
         if (SUCCEEDED(hr) && prc)
-        {
-            INT x, y;
-
-            for (y=0; y<prc->Height; y++)
-                for (x=0; x<prc->Width; x++)
-                {
-                    BYTE alpha = pbBuffer[cbStride*y+4*x+3];
-                    if (alpha != 255)
-                    {
-                        pbBuffer[cbStride*y+4*x] = pbBuffer[cbStride*y+4*x] * alpha / 255;
-                        pbBuffer[cbStride*y+4*x+1] = pbBuffer[cbStride*y+4*x+1] * alpha / 255;
-                        pbBuffer[cbStride*y+4*x+2] = pbBuffer[cbStride*y+4*x+2] * alpha / 255;
-                    }
-                }
-        }
+            premultiply_32bppBGRA(pbBuffer, prc->Width, prc->Height, cbStride);
         return hr;
     }
 }
@@ -877,46 +868,7 @@ static HRESULT copypixels_to_24bppBGR(struct FormatConverter *This, const WICRec
     case format_32bppBGRA:
     case format_32bppPBGRA:
         if (prc)
-        {
-            HRESULT res;
-            INT x, y;
-            BYTE *srcdata;
-            UINT srcstride, srcdatasize;
-            const BYTE *srcrow;
-            const BYTE *srcpixel;
-            BYTE *dstrow;
-            BYTE *dstpixel;
-
-            srcstride = 4 * prc->Width;
-            srcdatasize = srcstride * prc->Height;
-
-            srcdata = HeapAlloc(GetProcessHeap(), 0, srcdatasize);
-            if (!srcdata) return E_OUTOFMEMORY;
-
-            res = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
-
-            if (SUCCEEDED(res))
-            {
-                srcrow = srcdata;
-                dstrow = pbBuffer;
-                for (y=0; y<prc->Height; y++) {
-                    srcpixel=srcrow;
-                    dstpixel=dstrow;
-                    for (x=0; x<prc->Width; x++) {
-                        *dstpixel++=*srcpixel++; /* blue */
-                        *dstpixel++=*srcpixel++; /* green */
-                        *dstpixel++=*srcpixel++; /* red */
-                        srcpixel++; /* alpha */
-                    }
-                    srcrow += srcstride;
-                    dstrow += cbStride;
-                }
-            }
-
-            HeapFree(GetProcessHeap(), 0, srcdata);
-
-            return res;
-        }
+            return copypixels_by_strips(This, prc, 32, cbStride, pbBuffer, convert_row_32bpp_to_24bppBGR);
         return S_OK;
     default:
         FIXME("Unimplemented conversion path!\n");
@@ -945,48 +897,7 @@ static HRESULT copypixels_to_24bppRGB(struct FormatConverter *This, const WICRec
     case format_32bppBGRA:
     case format_32bppPBGRA:
         if (prc)
-        {
-            HRESULT res;
-            INT x, y;
-            BYTE *srcdata;
-            UINT srcstride, srcdatasize;
-            const BYTE *srcrow;
-            const BYTE *srcpixel;
-            BYTE *dstrow;
-            BYTE *dstpixel;
-
-            srcstride = 4 * prc->Width;
-            srcdatasize = srcstride * prc->Height;
-
-            srcdata = HeapAlloc(GetProcessHeap(), 0, srcdatasize);
-            if (!srcdata) return E_OUTOFMEMORY;
-
-            res = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
-
-            if (SUCCEEDED(res))
-            {
-                srcrow = srcdata;
-                dstrow = pbBuffer;
-                for (y=0; y<prc->Height; y++) {
-                    srcpixel=srcrow;
-                    dstpixel=dstrow;
-                    for (x=0; x<prc->Width; x++) {
-                        *dstpixel++=*srcpixel++; /* blue */
-                        *dstpixel++=*srcpixel++; /* green */
-                        *dstpixel++=*srcpixel++; /* red */
-                        srcpixel++; /* alpha */
-                    }
-                    srcrow += srcstride;
-                    dstrow += cbStride;
-                }
-
-                reverse_bgr8(3, pbBuffer, prc->Width, prc->Height, cbStride);
-            }
-
-            HeapFree(GetProcessHeap(), 0, srcdata);
-
-            return res;
-        }
+            return copypixels_by_strips(This, prc, 32, cbStride, pbBuffer, convert_row_32bpp_to_24bppRGB);
         return S_OK;
     default:
         FIXME("Unimplemented conversion path!\n");
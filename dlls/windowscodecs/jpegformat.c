@@ -612,7 +612,7 @@ static HRESULT WINAPI JpegDecoder_Frame_CopyPixels(IWICBitmapFrameDecode *iface,
     else if (This->cinfo.out_color_space == JCS_CMYK) bpp = 32;
     else bpp = 24;
 
-    stride = bpp * This->cinfo.output_width;
+    stride = bpp / 8 * This->cinfo.output_width;
     data_size = stride * This->cinfo.output_height;
 
     max_row_needed = prc->Y + prc->Height;
@@ -668,9 +668,12 @@ static HRESULT WINAPI JpegDecoder_Frame_CopyPixels(IWICBitmapFrameDecode *iface,
         }
 
         if (This->cinfo.out_color_space == JCS_CMYK && This->cinfo.saw_Adobe_marker)
+        {
             /* Adobe JPEG's have inverted CMYK data. */
-            for (i=0; i<data_size; i++)
-                This->image_data[i] ^= 0xff;
+            BYTE *row = This->image_data + stride * first_scanline;
+            for (i=0; i<stride * (This->cinfo.output_scanline - first_scanline); i++)
+                row[i] ^= 0xff;
+        }
     }
 
     LeaveCriticalSection(&This->lock);
@@ -171,6 +171,7 @@ MAKE_FUNCPTR(png_get_error_ptr);
 MAKE_FUNCPTR(png_get_iCCP);
 MAKE_FUNCPTR(png_get_image_height);
 MAKE_FUNCPTR(png_get_image_width);
+MAKE_FUNCPTR(png_get_interlace_type);
 MAKE_FUNCPTR(png_get_io_ptr);
 MAKE_FUNCPTR(png_get_pHYs);
 MAKE_FUNCPTR(png_get_PLTE);
@@ -195,6 +196,7 @@ MAKE_FUNCPTR(png_set_write_fn);
 MAKE_FUNCPTR(png_read_end);
 MAKE_FUNCPTR(png_read_image);
 MAKE_FUNCPTR(png_read_info);
+MAKE_FUNCPTR(png_read_rows);
 MAKE_FUNCPTR(png_write_end);
 MAKE_FUNCPTR(png_write_info);
 MAKE_FUNCPTR(png_write_rows);
@@ -236,6 +238,7 @@ static void *load_libpng(void)
         LOAD_FUNCPTR(png_get_iCCP);
         LOAD_FUNCPTR(png_get_image_height);
         LOAD_FUNCPTR(png_get_image_width);
+        LOAD_FUNCPTR(png_get_interlace_type);
         LOAD_FUNCPTR(png_get_io_ptr);
         LOAD_FUNCPTR(png_get_pHYs);
         LOAD_FUNCPTR(png_get_PLTE);
@@ -260,6 +263,7 @@ static void *load_libpng(void)
         LOAD_FUNCPTR(png_read_end);
         LOAD_FUNCPTR(png_read_image);
         LOAD_FUNCPTR(png_read_info);
+        LOAD_FUNCPTR(png_read_rows);
         LOAD_FUNCPTR(png_write_end);
         LOAD_FUNCPTR(png_write_info);
         LOAD_FUNCPTR(png_write_rows);
@@ -305,6 +309,10 @@ typedef struct {
     UINT stride;
     const WICPixelFormatGUID *format;
     BYTE *image_bits;
+    BOOL interlaced;
+    UINT decoded_rows;
+    IStream *stream; /* held until all rows are decoded */
+    ULARGE_INTEGER stream_pos;
     CRITICAL_SECTION lock; /* must be held when png structures are accessed or initialized is set */
 } PngDecoder;
 
@@ -370,6 +378,8 @@ static ULONG WINAPI PngDecoder_Release(IWICBitmapDecoder *iface)
             ppng_destroy_read_struct(&This->png_ptr, &This->info_ptr, &This->end_info);
         This->lock.DebugInfo->Spare[0] = 0;
         DeleteCriticalSection(&This->lock);
+        if (This->stream)
+            IStream_Release(This->stream);
         HeapFree(GetProcessHeap(), 0, This->image_bits);
         HeapFree(GetProcessHeap(), 0, This);
     }
@@ -414,9 +424,7 @@ static HRESULT WINAPI PngDecoder_Initialize(IWICBitmapDecoder *iface, IStream *p
     PngDecoder *This = impl_from_IWICBitmapDecoder(iface);
     LARGE_INTEGER seek;
     HRESULT hr=S_OK;
-    png_bytep *row_pointers=NULL;
     UINT image_size;
-    UINT i;
     int color_type, bit_depth;
     png_bytep trans;
     int num_trans;
@@ -458,7 +466,6 @@ static HRESULT WINAPI PngDecoder_Initialize(IWICBitmapDecoder *iface, IStream *p
     if (setjmp(jmpbuf))
     {
         ppng_destroy_read_struct(&This->png_ptr, &This->info_ptr, &This->end_info);
-        HeapFree(GetProcessHeap(), 0, row_pointers);
         This->png_ptr = NULL;
         hr = E_FAIL;
         goto end;
@@ -575,10 +582,10 @@ static HRESULT WINAPI PngDecoder_Initialize(IWICBitmapDecoder *iface, IStream *p
         goto end;
     }
 
-    /* read the image data */
     This->width = ppng_get_image_width(This->png_ptr, This->info_ptr);
     This->height = ppng_get_image_height(This->png_ptr, This->info_ptr);
-    This->stride = This->width * This->bpp;
+    This->stride = (This->width * This->bpp + 7) / 8;
+    This->interlaced = ppng_get_interlace_type(This->png_ptr, This->info_ptr) != PNG_INTERLACE_NONE;
     image_size = This->stride * This->height;
 
     This->image_bits = HeapAlloc(GetProcessHeap(), 0, image_size);
@@ -588,22 +595,15 @@ static HRESULT WINAPI PngDecoder_Initialize(IWICBitmapDecoder *iface, IStream *p
         goto end;
     }
 
-    row_pointers = HeapAlloc(GetProcessHeap(), 0, sizeof(png_bytep)*This->height);
-    if (!row_pointers)
-    {
-        hr = E_OUTOFMEMORY;
-        goto end;
-    }
-
-    for (i=0; i<This->height; i++)
-        row_pointers[i] = This->image_bits + i * This->stride;
-
-    ppng_read_image(This->png_ptr, row_pointers);
-
-    HeapFree(GetProcessHeap(), 0, row_pointers);
-    row_pointers = NULL;
+    /* The image data is decoded on demand by CopyPixels, only as far as the
+     * last row requested, so remember where it starts in the stream. */
+    seek.QuadPart = 0;
+    hr = IStream_Seek(pIStream, seek, STREAM_SEEK_CUR, &This->stream_pos);
+    if (FAILED(hr)) goto end;
 
-    ppng_read_end(This->png_ptr, This->end_info);
+    IStream_AddRef(pIStream);
+    This->stream = pIStream;
+    This->decoded_rows = 0;
 
     This->initialized = TRUE;
 
@@ -868,15 +868,103 @@ end:
     return hr;
 }
 
+/* Must be called with the lock held. */
+static HRESULT PngDecoder_DecodeRows(PngDecoder *This, UINT last_row)
+{
+    png_bytep rows[16];
+    png_bytep *row_pointers=NULL;
+    LARGE_INTEGER seek;
+    jmp_buf jmpbuf;
+    UINT i, count;
+    HRESULT hr;
+
+    if (This->decoded_rows >= last_row)
+        return S_OK;
+
+    /* a previous decoding error left libpng in an unusable state */
+    if (!This->stream)
+        return E_FAIL;
+
+    if (setjmp(jmpbuf))
+    {
+        HeapFree(GetProcessHeap(), 0, row_pointers);
+        IStream_Release(This->stream);
+        This->stream = NULL;
+        return E_FAIL;
+    }
+    ppng_set_error_fn(This->png_ptr, jmpbuf, user_error_fn, user_warning_fn);
+
+    seek.QuadPart = This->stream_pos.QuadPart;
+    hr = IStream_Seek(This->stream, seek, STREAM_SEEK_SET, NULL);
+    if (FAILED(hr)) return hr;
+
+    if (This->interlaced)
+    {
+        /* every pass touches every row, so the whole image has to be decoded */
+        row_pointers = HeapAlloc(GetProcessHeap(), 0, sizeof(png_bytep)*This->height);
+        if (!row_pointers)
+            return E_OUTOFMEMORY;
+
+        for (i=0; i<This->height; i++)
+            row_pointers[i] = This->image_bits + i * This->stride;
+
+        ppng_read_image(This->png_ptr, row_pointers);
+
+        HeapFree(GetProcessHeap(), 0, row_pointers);
+        row_pointers = NULL;
+
+        This->decoded_rows = This->height;
+    }
+    else
+    {
+        while (This->decoded_rows < last_row)
+        {
+            count = min(last_row - This->decoded_rows, sizeof(rows)/sizeof(rows[0]));
+            for (i=0; i<count; i++)
+                rows[i] = This->image_bits + (This->decoded_rows + i) * This->stride;
+
+            ppng_read_rows(This->png_ptr, rows, NULL, count);
+
+            This->decoded_rows += count;
+        }
+    }
+
+    if (This->decoded_rows == This->height)
+    {
+        ppng_read_end(This->png_ptr, This->end_info);
+        IStream_Release(This->stream);
+        This->stream = NULL;
+        return S_OK;
+    }
+
+    seek.QuadPart = 0;
+    return IStream_Seek(This->stream, seek, STREAM_SEEK_CUR, &This->stream_pos);
+}
+
 static HRESULT WINAPI PngDecoder_Frame_CopyPixels(IWICBitmapFrameDecode *iface,
     const WICRect *prc, UINT cbStride, UINT cbBufferSize, BYTE *pbBuffer)
 {
     PngDecoder *This = impl_from_IWICBitmapFrameDecode(iface);
+    UINT last_row = This->height;
+    HRESULT hr;
     TRACE("(%p,%p,%u,%u,%p)\n", iface, prc, cbStride, cbBufferSize, pbBuffer);
 
-    return copy_pixels(This->bpp, This->image_bits,
-        This->width, This->height, This->stride,
-        prc, cbStride, cbBufferSize, pbBuffer);
+    /* invalid rectangles are rejected by copy_pixels */
+    if (prc && prc->Y >= 0 && prc->Height >= 0 && prc->Y + prc->Height <= This->height)
+        last_row = prc->Y + prc->Height;
+
+    EnterCriticalSection(&This->lock);
+
+    hr = PngDecoder_DecodeRows(This, last_row);
+
+    if (SUCCEEDED(hr))
+        hr = copy_pixels(This->bpp, This->image_bits,
+            This->width, This->height, This->stride,
+            prc, cbStride, cbBufferSize, pbBuffer);
+
+    LeaveCriticalSection(&This->lock);
+
+    return hr;
 }
 
 static HRESULT WINAPI PngDecoder_Frame_GetMetadataQueryReader(IWICBitmapFrameDecode *iface,
@@ -1035,6 +1123,8 @@ HRESULT PngDecoder_CreateInstance(REFIID iid, void** ppv)
     This->end_info = NULL;
     This->initialized = FALSE;
     This->image_bits = NULL;
+    This->stream = NULL;
+    This->decoded_rows = 0;
     InitializeCriticalSection(&This->lock);
     This->lock.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": PngDecoder.lock");
 
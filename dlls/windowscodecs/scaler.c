@@ -33,6 +33,21 @@
 
 WINE_DEFAULT_DEBUG_CHANNEL(wincodecs);
 
+/* Precomputed resampling filter for one axis. Destination pixel i is made of
+ * count[i] source pixels starting at first[i], weighted by the max_taps
+ * entries at weights[i*max_taps], in 2.14 fixed point. */
+struct filter_table {
+    UINT max_taps;
+    INT *first;
+    UINT *count;
+    INT *weights;
+};
+
+#define FILTER_SHIFT 14
+#define FILTER_ONE (1 << FILTER_SHIFT)
+/* extra precision kept between the vertical and horizontal passes */
+#define FILTER_ROW_SHIFT 8
+
 typedef struct BitmapScaler {
     IWICBitmapScaler IWICBitmapScaler_iface;
     LONG ref;
@@ -43,6 +58,9 @@ typedef struct BitmapScaler {
     UINT bpp;
     void (*fn_get_required_source_rect)(struct BitmapScaler*,UINT,UINT,WICRect*);
     void (*fn_copy_scanline)(struct BitmapScaler*,UINT,UINT,UINT,BYTE**,UINT,UINT,BYTE*);
+    struct filter_table filter_x, filter_y;
+    INT *row_buffer;
+    UINT row_buffer_size;
     CRITICAL_SECTION lock; /* must be held when initialized */
 } BitmapScaler;
 
@@ -51,6 +69,131 @@ static inline BitmapScaler *impl_from_IWICBitmapScaler(IWICBitmapScaler *iface)
     return CONTAINING_RECORD(iface, BitmapScaler, IWICBitmapScaler_iface);
 }
 
+static void free_filter_table(struct filter_table *table)
+{
+    HeapFree(GetProcessHeap(), 0, table->first);
+    HeapFree(GetProcessHeap(), 0, table->count);
+    HeapFree(GetProcessHeap(), 0, table->weights);
+    memset(table, 0, sizeof(*table));
+}
+
+static inline INT floor_int(double x)
+{
+    INT i = (INT)x;
+    return i - (x < i);
+}
+
+static double filter_weight(WICBitmapInterpolationMode mode, double x)
+{
+    if (x < 0.0) x = -x;
+
+    if (mode == WICBitmapInterpolationModeLinear)
+        return x < 1.0 ? 1.0 - x : 0.0;
+
+    /* Catmull-Rom cubic */
+    if (x < 1.0)
+        return (1.5 * x - 2.5) * x * x + 1.0;
+    if (x < 2.0)
+        return ((-0.5 * x + 2.5) * x - 4.0) * x + 2.0;
+    return 0.0;
+}
+
+static HRESULT init_filter_table(struct filter_table *table, UINT src_size, UINT dst_size,
+    WICBitmapInterpolationMode mode)
+{
+    double scale, *tmp;
+    UINT i;
+
+    if (!src_size || !dst_size)
+        return E_INVALIDARG;
+
+    scale = (double)src_size / dst_size;
+
+    switch (mode)
+    {
+    case WICBitmapInterpolationModeLinear:
+        table->max_taps = 2;
+        break;
+    case WICBitmapInterpolationModeCubic:
+        table->max_taps = 4;
+        break;
+    default:
+        /* Fant: a box covering the destination pixel's footprint */
+        table->max_taps = (src_size + dst_size - 1) / dst_size + 1;
+        break;
+    }
+
+    table->first = HeapAlloc(GetProcessHeap(), 0, dst_size * sizeof(INT));
+    table->count = HeapAlloc(GetProcessHeap(), 0, dst_size * sizeof(UINT));
+    table->weights = HeapAlloc(GetProcessHeap(), 0, dst_size * table->max_taps * sizeof(INT));
+    tmp = HeapAlloc(GetProcessHeap(), 0, table->max_taps * sizeof(double));
+
+    if (!table->first || !table->count || !table->weights || !tmp)
+    {
+        HeapFree(GetProcessHeap(), 0, tmp);
+        free_filter_table(table);
+        return E_OUTOFMEMORY;
+    }
+
+    for (i = 0; i < dst_size; i++)
+    {
+        INT *weights = table->weights + i * table->max_taps;
+        INT lo, hi, first, last, k, remaining;
+        double sum = 0.0;
+        UINT largest = 0;
+
+        if (mode == WICBitmapInterpolationModeLinear || mode == WICBitmapInterpolationModeCubic)
+        {
+            double center = (i + 0.5) * scale - 0.5;
+            INT support = table->max_taps / 2;
+
+            lo = floor_int(center) - support + 1;
+            hi = floor_int(center) + support;
+            first = max(lo, 0);
+            last = min(hi, (INT)src_size - 1);
+
+            for (k = 0; k <= last - first; k++) tmp[k] = 0.0;
+
+            /* taps outside the source are folded onto the edge pixels */
+            for (k = lo; k <= hi; k++)
+                tmp[min(max(k, first), last) - first] += filter_weight(mode, k - center);
+        }
+        else
+        {
+            double start = i * scale, end = (i + 1) * scale;
+
+            first = floor_int(start);
+            last = floor_int(end);
+            if (last == end) last--;
+            last = min(last, (INT)src_size - 1);
+
+            for (k = first; k <= last; k++)
+                tmp[k - first] = min(end, k + 1.0) - max(start, (double)k);
+        }
+
+        for (k = 0; k <= last - first; k++) sum += tmp[k];
+
+        /* convert to fixed point, giving the rounding error to the largest tap */
+        remaining = FILTER_ONE;
+        for (k = 0; k <= last - first; k++)
+        {
+            weights[k] = floor_int(tmp[k] / sum * FILTER_ONE + 0.5);
+            remaining -= weights[k];
+            if (weights[k] > weights[largest]) largest = k;
+        }
+        weights[largest] += remaining;
+
+        /* zero-weight taps are kept, so first[] and first+count stay
+         * nondecreasing in i */
+        table->first[i] = first;
+        table->count[i] = last - first + 1;
+    }
+
+    HeapFree(GetProcessHeap(), 0, tmp);
+
+    return S_OK;
+}
+
 static HRESULT WINAPI BitmapScaler_QueryInterface(IWICBitmapScaler *iface, REFIID iid,
     void **ppv)
 {
@@ -97,6 +240,9 @@ static ULONG WINAPI BitmapScaler_Release(IWICBitmapScaler *iface)
         This->lock.DebugInfo->Spare[0] = 0;
         DeleteCriticalSection(&This->lock);
         if (This->source) IWICBitmapSource_Release(This->source);
+        free_filter_table(&This->filter_x);
+        free_filter_table(&This->filter_y);
+        HeapFree(GetProcessHeap(), 0, This->row_buffer);
         HeapFree(GetProcessHeap(), 0, This);
     }
 
@@ -191,19 +337,92 @@ static void NearestNeighbor_CopyScanline(BitmapScaler *This,
     }
 }
 
+/* Source pixels [*first,*end) needed by destination pixels [start,start+count). */
+static void filter_table_span(const struct filter_table *table, UINT start, UINT count,
+    UINT *first, UINT *end)
+{
+    UINT i;
+
+    *first = table->first[start];
+    *end = table->first[start] + table->count[start];
+    for (i = start + 1; i < start + count; i++)
+    {
+        *first = min(*first, (UINT)table->first[i]);
+        *end = max(*end, table->first[i] + table->count[i]);
+    }
+}
+
+static void Filter_GetRequiredSourceRect(BitmapScaler *This,
+    UINT x, UINT y, WICRect *src_rect)
+{
+    src_rect->X = This->filter_x.first[x];
+    src_rect->Y = This->filter_y.first[y];
+    src_rect->Width = This->filter_x.count[x];
+    src_rect->Height = This->filter_y.count[y];
+}
+
+static void Filter_CopyScanline(BitmapScaler *This,
+    UINT dst_x, UINT dst_y, UINT dst_width,
+    BYTE **src_data, UINT src_data_x, UINT src_data_y, BYTE *pbBuffer)
+{
+    const struct filter_table *fx = &This->filter_x, *fy = &This->filter_y;
+    UINT channels = This->bpp/8;
+    UINT first_col, end_col, row_size, i, j, c, k;
+    const INT *weights;
+    INT *row = This->row_buffer;
+
+    /* vertical pass over the source columns this scanline needs */
+    filter_table_span(fx, dst_x, dst_width, &first_col, &end_col);
+    row_size = (end_col - first_col) * channels;
+
+    memset(row, 0, row_size * sizeof(INT));
+    weights = fy->weights + dst_y * fy->max_taps;
+    for (k = 0; k < fy->count[dst_y]; k++)
+    {
+        const BYTE *src = src_data[fy->first[dst_y] + k - src_data_y] + (first_col - src_data_x) * channels;
+        INT w = weights[k];
+
+        for (c = 0; c < row_size; c++)
+            row[c] += w * src[c];
+    }
+
+    for (c = 0; c < row_size; c++)
+        row[c] = (row[c] + (1 << (FILTER_SHIFT - FILTER_ROW_SHIFT - 1))) >> (FILTER_SHIFT - FILTER_ROW_SHIFT);
+
+    /* horizontal pass */
+    for (i = 0; i < dst_width; i++)
+    {
+        UINT x = dst_x + i;
+        const INT *src = row + (fx->first[x] - first_col) * channels;
+
+        weights = fx->weights + x * fx->max_taps;
+        for (c = 0; c < channels; c++)
+        {
+            INT sum = 0;
+
+            for (j = 0; j < fx->count[x]; j++)
+                sum += weights[j] * src[j * channels + c];
+
+            sum = (sum + (1 << (FILTER_SHIFT + FILTER_ROW_SHIFT - 1))) >> (FILTER_SHIFT + FILTER_ROW_SHIFT);
+            *pbBuffer++ = sum < 0 ? 0 : (sum > 255 ? 255 : sum);
+        }
+    }
+}
+
 static HRESULT WINAPI BitmapScaler_CopyPixels(IWICBitmapScaler *iface,
     const WICRect *prc, UINT cbStride, UINT cbBufferSize, BYTE *pbBuffer)
 {
     BitmapScaler *This = impl_from_IWICBitmapScaler(iface);
     HRESULT hr;
     WICRect dest_rect;
-    WICRect src_rect_ul, src_rect_br, src_rect;
+    WICRect pixel_rect, src_rect;
+    INT src_right, src_bottom;
     BYTE **src_rows;
     BYTE *src_bits;
     ULONG bytesperrow;
     ULONG src_bytesperrow;
     ULONG buffer_size;
-    UINT y;
+    UINT x, y;
 
     TRACE("(%p,%p,%u,%u,%p)\n", iface, prc, cbStride, cbBufferSize, pbBuffer);
 
@@ -253,14 +472,34 @@ static HRESULT WINAPI BitmapScaler_CopyPixels(IWICBitmapScaler *iface,
      * designed to make it possible to do this in a generic way, but for now we
      * just grab all the data we need in each call. */
 
-    This->fn_get_required_source_rect(This, dest_rect.X, dest_rect.Y, &src_rect_ul);
-    This->fn_get_required_source_rect(This, dest_rect.X+dest_rect.Width-1,
-        dest_rect.Y+dest_rect.Height-1, &src_rect_br);
+    if (!dest_rect.Width || !dest_rect.Height)
+    {
+        hr = S_OK;
+        goto end;
+    }
+
+    /* the source rectangle is the union of what every destination column and
+     * row needs; don't assume the outermost pixels need the outermost source */
+    This->fn_get_required_source_rect(This, dest_rect.X, dest_rect.Y, &src_rect);
+    src_right = src_rect.X + src_rect.Width;
+    src_bottom = src_rect.Y + src_rect.Height;
+
+    for (x=1; x<dest_rect.Width; x++)
+    {
+        This->fn_get_required_source_rect(This, dest_rect.X+x, dest_rect.Y, &pixel_rect);
+        src_rect.X = min(src_rect.X, pixel_rect.X);
+        src_right = max(src_right, pixel_rect.X + pixel_rect.Width);
+    }
+
+    for (y=1; y<dest_rect.Height; y++)
+    {
+        This->fn_get_required_source_rect(This, dest_rect.X, dest_rect.Y+y, &pixel_rect);
+        src_rect.Y = min(src_rect.Y, pixel_rect.Y);
+        src_bottom = max(src_bottom, pixel_rect.Y + pixel_rect.Height);
+    }
 
-    src_rect.X = src_rect_ul.X;
-    src_rect.Y = src_rect_ul.Y;
-    src_rect.Width = src_rect_br.Width + src_rect_br.X - src_rect_ul.X;
-    src_rect.Height = src_rect_br.Height + src_rect_br.Y - src_rect_ul.Y;
+    src_rect.Width = src_right - src_rect.X;
+    src_rect.Height = src_bottom - src_rect.Y;
 
     src_bytesperrow = (src_rect.Width * This->bpp + 7)/8;
     buffer_size = src_bytesperrow * src_rect.Height;
@@ -279,6 +518,23 @@ static HRESULT WINAPI BitmapScaler_CopyPixels(IWICBitmapScaler *iface,
     for (y=0; y<src_rect.Height; y++)
         src_rows[y] = src_bits + y * src_bytesperrow;
 
+    if (This->filter_x.weights && This->row_buffer_size < src_bytesperrow)
+    {
+        INT *row_buffer = HeapAlloc(GetProcessHeap(), 0, src_bytesperrow * sizeof(INT));
+
+        if (!row_buffer)
+        {
+            HeapFree(GetProcessHeap(), 0, src_rows);
+            HeapFree(GetProcessHeap(), 0, src_bits);
+            hr = E_OUTOFMEMORY;
+            goto end;
+        }
+
+        HeapFree(GetProcessHeap(), 0, This->row_buffer);
+        This->row_buffer = row_buffer;
+        This->row_buffer_size = src_bytesperrow;
+    }
+
     hr = IWICBitmapSource_CopyPixels(This->source, &src_rect, src_bytesperrow,
         buffer_size, src_bits);
 
@@ -300,6 +556,16 @@ end:
     return hr;
 }
 
+static BOOL is_byte_channel_format(const WICPixelFormatGUID *format)
+{
+    return IsEqualGUID(format, &GUID_WICPixelFormat8bppGray) ||
+           IsEqualGUID(format, &GUID_WICPixelFormat24bppBGR) ||
+           IsEqualGUID(format, &GUID_WICPixelFormat24bppRGB) ||
+           IsEqualGUID(format, &GUID_WICPixelFormat32bppBGR) ||
+           IsEqualGUID(format, &GUID_WICPixelFormat32bppBGRA) ||
+           IsEqualGUID(format, &GUID_WICPixelFormat32bppPBGRA);
+}
+
 static HRESULT WINAPI BitmapScaler_Initialize(IWICBitmapScaler *iface,
     IWICBitmapSource *pISource, UINT uiWidth, UINT uiHeight,
     WICBitmapInterpolationMode mode)
@@ -307,6 +573,7 @@ static HRESULT WINAPI BitmapScaler_Initialize(IWICBitmapScaler *iface,
     BitmapScaler *This = impl_from_IWICBitmapScaler(iface);
     HRESULT hr;
     GUID src_pixelformat;
+    BOOL use_filter = FALSE;
 
     TRACE("(%p,%p,%u,%u,%u)\n", iface, pISource, uiWidth, uiHeight, mode);
 
@@ -336,27 +603,58 @@ static HRESULT WINAPI BitmapScaler_Initialize(IWICBitmapScaler *iface,
     {
         switch (mode)
         {
+        case WICBitmapInterpolationModeLinear:
+        case WICBitmapInterpolationModeCubic:
+        case WICBitmapInterpolationModeFant:
+            /* the filters work on 8-bit channels; other formats and empty
+             * images keep using nearest neighbor in the source format */
+            use_filter = is_byte_channel_format(&src_pixelformat) &&
+                This->width && This->height && This->src_width && This->src_height;
+            break;
         default:
             FIXME("unsupported mode %i\n", mode);
             /* fall-through */
         case WICBitmapInterpolationModeNearestNeighbor:
-            if ((This->bpp % 8) == 0)
-            {
-                IWICBitmapSource_AddRef(pISource);
-                This->source = pISource;
-            }
-            else
-            {
-                hr = WICConvertBitmapSource(&GUID_WICPixelFormat32bppBGRA,
-                    pISource, &This->source);
-                This->bpp = 32;
-            }
-            This->fn_get_required_source_rect = NearestNeighbor_GetRequiredSourceRect;
-            This->fn_copy_scanline = NearestNeighbor_CopyScanline;
             break;
         }
     }
 
+    if (SUCCEEDED(hr) && use_filter)
+    {
+        hr = init_filter_table(&This->filter_x, This->src_width, This->width, mode);
+        if (SUCCEEDED(hr))
+            hr = init_filter_table(&This->filter_y, This->src_height, This->height, mode);
+
+        if (SUCCEEDED(hr))
+        {
+            IWICBitmapSource_AddRef(pISource);
+            This->source = pISource;
+            This->fn_get_required_source_rect = Filter_GetRequiredSourceRect;
+            This->fn_copy_scanline = Filter_CopyScanline;
+        }
+        else
+        {
+            free_filter_table(&This->filter_x);
+            free_filter_table(&This->filter_y);
+        }
+    }
+    else if (SUCCEEDED(hr))
+    {
+        if ((This->bpp % 8) == 0)
+        {
+            IWICBitmapSource_AddRef(pISource);
+            This->source = pISource;
+        }
+        else
+        {
+            hr = WICConvertBitmapSource(&GUID_WICPixelFormat32bppBGRA,
+                pISource, &This->source);
+            This->bpp = 32;
+        }
+        This->fn_get_required_source_rect = NearestNeighbor_GetRequiredSourceRect;
+        This->fn_copy_scanline = NearestNeighbor_CopyScanline;
+    }
+
 end:
     LeaveCriticalSection(&This->lock);
 
@@ -391,6 +689,10 @@ HRESULT BitmapScaler_Create(IWICBitmapScaler **scaler)
     This->src_height = 0;
     This->mode = 0;
     This->bpp = 0;
+    memset(&This->filter_x, 0, sizeof(This->filter_x));
+    memset(&This->filter_y, 0, sizeof(This->filter_y));
+    This->row_buffer = NULL;
+    This->row_buffer_size = 0;
     InitializeCriticalSection(&This->lock);
     This->lock.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": BitmapScaler.lock");
 
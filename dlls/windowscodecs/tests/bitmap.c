@@ -977,6 +977,107 @@ static void test_clipper(void)
     IWICBitmapClipper_Release(clipper);
 }
 
+static void test_bitmap_scaler(void)
+{
+    static const WICBitmapInterpolationMode modes[] =
+    {
+        WICBitmapInterpolationModeNearestNeighbor,
+        WICBitmapInterpolationModeLinear,
+        WICBitmapInterpolationModeCubic,
+        WICBitmapInterpolationModeFant
+    };
+    BYTE src[4 * 4 * 3], full[12 * 12 * 3], part[12 * 12 * 3];
+    BYTE indexed[4 * 4];
+    IWICBitmapScaler *scaler;
+    IWICBitmap *bitmap;
+    WICPixelFormatGUID format;
+    WICRect rect;
+    UINT width, height, i, x, y;
+    HRESULT hr;
+
+    for (i = 0; i < sizeof(src); i++)
+        src[i] = (i * 97 + (i % 7) * 31) & 0xff;
+
+    hr = IWICImagingFactory_CreateBitmapFromMemory(factory, 4, 4, &GUID_WICPixelFormat24bppBGR,
+                                                   12, sizeof(src), src, &bitmap);
+    ok(hr == S_OK, "IWICImagingFactory_CreateBitmapFromMemory error %#x\n", hr);
+
+    for (i = 0; i < sizeof(modes)/sizeof(modes[0]); i++)
+    {
+        hr = IWICImagingFactory_CreateBitmapScaler(factory, &scaler);
+        ok(hr == S_OK, "CreateBitmapScaler error %#x\n", hr);
+
+        hr = IWICBitmapScaler_Initialize(scaler, (IWICBitmapSource*)bitmap, 12, 12, modes[i]);
+        ok(hr == S_OK, "%u: Initialize error %#x\n", modes[i], hr);
+
+        hr = IWICBitmapScaler_GetSize(scaler, &width, &height);
+        ok(hr == S_OK, "%u: GetSize error %#x\n", modes[i], hr);
+        ok(width == 12 && height == 12, "%u: got %ux%u\n", modes[i], width, height);
+
+        hr = IWICBitmapScaler_GetPixelFormat(scaler, &format);
+        ok(hr == S_OK, "%u: GetPixelFormat error %#x\n", modes[i], hr);
+        ok(IsEqualGUID(&format, &GUID_WICPixelFormat24bppBGR), "%u: got format %s\n",
+           modes[i], wine_dbgstr_guid(&format));
+
+        hr = IWICBitmapScaler_CopyPixels(scaler, NULL, 36, sizeof(full), full);
+        ok(hr == S_OK, "%u: CopyPixels error %#x\n", modes[i], hr);
+
+        /* any part of the image must match the same part of a full copy */
+        for (x = 0; x < 12; x++)
+        {
+            rect.X = x;
+            rect.Y = 0;
+            rect.Width = 1;
+            rect.Height = 12;
+            hr = IWICBitmapScaler_CopyPixels(scaler, &rect, 3, sizeof(part), part);
+            ok(hr == S_OK, "%u: CopyPixels error %#x\n", modes[i], hr);
+            for (y = 0; y < 12; y++)
+                ok(!memcmp(part + y * 3, full + y * 36 + x * 3, 3),
+                   "%u: column %u, row %u differs\n", modes[i], x, y);
+        }
+
+        rect.X = 1;
+        rect.Y = 2;
+        rect.Width = 7;
+        rect.Height = 5;
+        hr = IWICBitmapScaler_CopyPixels(scaler, &rect, 21, sizeof(part), part);
+        ok(hr == S_OK, "%u: CopyPixels error %#x\n", modes[i], hr);
+        for (y = 0; y < 5; y++)
+            ok(!memcmp(part + y * 21, full + (y + 2) * 36 + 3, 21),
+               "%u: row %u differs\n", modes[i], y);
+
+        IWICBitmapScaler_Release(scaler);
+    }
+
+    IWICBitmap_Release(bitmap);
+
+    /* indexed formats are not converted */
+    for (i = 0; i < sizeof(indexed); i++)
+        indexed[i] = i;
+
+    hr = IWICImagingFactory_CreateBitmapFromMemory(factory, 4, 4, &GUID_WICPixelFormat8bppIndexed,
+                                                   4, sizeof(indexed), indexed, &bitmap);
+    ok(hr == S_OK, "IWICImagingFactory_CreateBitmapFromMemory error %#x\n", hr);
+
+    hr = IWICImagingFactory_CreateBitmapScaler(factory, &scaler);
+    ok(hr == S_OK, "CreateBitmapScaler error %#x\n", hr);
+
+    hr = IWICBitmapScaler_Initialize(scaler, (IWICBitmapSource*)bitmap, 8, 8,
+                                     WICBitmapInterpolationModeCubic);
+    ok(hr == S_OK, "Initialize error %#x\n", hr);
+
+    hr = IWICBitmapScaler_GetPixelFormat(scaler, &format);
+    ok(hr == S_OK, "GetPixelFormat error %#x\n", hr);
+    ok(IsEqualGUID(&format, &GUID_WICPixelFormat8bppIndexed), "got format %s\n",
+       wine_dbgstr_guid(&format));
+
+    hr = IWICBitmapScaler_CopyPixels(scaler, NULL, 8, 64, part);
+    ok(hr == S_OK, "CopyPixels error %#x\n", hr);
+
+    IWICBitmapScaler_Release(scaler);
+    IWICBitmap_Release(bitmap);
+}
+
 START_TEST(bitmap)
 {
     HRESULT hr;
@@ -993,6 +1094,7 @@ START_TEST(bitmap)
     test_CreateBitmapFromHICON();
     test_CreateBitmapFromHBITMAP();
     test_clipper();
+    test_bitmap_scaler();
 
     IWICImagingFactory_Release(factory);
 
@@ -295,6 +295,23 @@ static const BYTE bits_32bppBGRA[] = {
 static const struct bitmap_data testdata_32bppBGRA = {
     &GUID_WICPixelFormat32bppBGRA, 32, bits_32bppBGRA, 4, 2, 96.0, 96.0};
 
+static const struct bitmap_data testdata_32bppPBGRA = {
+    &GUID_WICPixelFormat32bppPBGRA, 32, bits_32bppBGRA, 4, 2, 96.0, 96.0};
+
+/* alpha 0, 255, 128, 1, 254 and 77, with values that premultiply to whole numbers
+ * or well away from the middle, so rounding and truncating give the same result */
+static const BYTE bits_32bppBGRA_alpha[] = {
+    255,128,1,0, 10,20,30,255, 255,255,0,128, 100,50,127,1,
+    255,0,128,254, 0,0,0,0, 255,255,255,255, 10,51,255,77};
+static const struct bitmap_data testdata_32bppBGRA_alpha = {
+    &GUID_WICPixelFormat32bppBGRA, 32, bits_32bppBGRA_alpha, 4, 2, 96.0, 96.0};
+
+static const BYTE bits_32bppPBGRA_alpha[] = {
+    0,0,0,0, 10,20,30,255, 128,128,0,128, 0,0,0,1,
+    254,0,127,254, 0,0,0,0, 255,255,255,255, 3,15,77,77};
+static const struct bitmap_data testdata_32bppPBGRA_alpha = {
+    &GUID_WICPixelFormat32bppPBGRA, 32, bits_32bppPBGRA_alpha, 4, 2, 96.0, 96.0};
+
 static void test_conversion(const struct bitmap_data *src, const struct bitmap_data *dst, const char *name, BOOL todo)
 {
     BitmapTestSrc *src_obj;
@@ -319,6 +336,47 @@ static void test_conversion(const struct bitmap_data *src, const struct bitmap_d
     DeleteTestBitmap(src_obj);
 }
 
+/* convert only part of the bitmap, starting and ending inside its rows */
+static void test_conversion_rect(const struct bitmap_data *src, const struct bitmap_data *dst,
+    INT x, INT y, INT width, INT height, const char *name)
+{
+    BitmapTestSrc *src_obj;
+    IWICBitmapSource *dst_bitmap;
+    BYTE converted_bits[64];
+    UINT stride, dst_stride;
+    WICRect rc;
+    HRESULT hr;
+    INT i;
+
+    CreateTestBitmap(src, &src_obj);
+
+    hr = WICConvertBitmapSource(dst->format, &src_obj->IWICBitmapSource_iface, &dst_bitmap);
+    ok(SUCCEEDED(hr), "WICConvertBitmapSource(%s) failed, hr=%x\n", name, hr);
+
+    if (SUCCEEDED(hr))
+    {
+        rc.X = x;
+        rc.Y = y;
+        rc.Width = width;
+        rc.Height = height;
+        stride = (dst->bpp * width + 7) / 8;
+        dst_stride = (dst->bpp * dst->width + 7) / 8;
+
+        memset(converted_bits, 0xcc, sizeof(converted_bits));
+        hr = IWICBitmapSource_CopyPixels(dst_bitmap, &rc, stride, stride * height, converted_bits);
+        ok(SUCCEEDED(hr), "CopyPixels(%s) failed, hr=%x\n", name, hr);
+
+        for (i = 0; i < height; i++)
+            ok(!memcmp(converted_bits + stride * i, dst->bits + dst_stride * (y + i) + dst->bpp / 8 * x, stride),
+               "unexpected pixel data in row %d (%s)\n", y + i, name);
+        ok(converted_bits[stride * height] == 0xcc, "wrote past the end of the rectangle (%s)\n", name);
+
+        IWICBitmapSource_Release(dst_bitmap);
+    }
+
+    DeleteTestBitmap(src_obj);
+}
+
 static void test_invalid_conversion(void)
 {
     BitmapTestSrc *src_obj;
@@ -736,6 +794,19 @@ START_TEST(converter)
     test_conversion(&testdata_32bppBGR, &testdata_24bppRGB, "32bppBGR -> 24bppRGB", FALSE);
     test_conversion(&testdata_24bppRGB, &testdata_32bppBGR, "24bppRGB -> 32bppBGR", FALSE);
 
+    test_conversion(&testdata_24bppBGR, &testdata_32bppBGRA, "24bppBGR -> 32bppBGRA", FALSE);
+    test_conversion(&testdata_24bppRGB, &testdata_32bppBGRA, "24bppRGB -> 32bppBGRA", FALSE);
+    test_conversion(&testdata_24bppRGB, &testdata_32bppPBGRA, "24bppRGB -> 32bppPBGRA", FALSE);
+    test_conversion(&testdata_32bppBGRA, &testdata_24bppBGR, "32bppBGRA -> 24bppBGR", FALSE);
+    test_conversion(&testdata_32bppBGRA, &testdata_32bppPBGRA, "opaque 32bppBGRA -> 32bppPBGRA", FALSE);
+    test_conversion(&testdata_32bppBGRA_alpha, &testdata_32bppPBGRA_alpha, "32bppBGRA -> 32bppPBGRA", FALSE);
+
+    test_conversion_rect(&testdata_32bppBGRA_alpha, &testdata_32bppPBGRA_alpha, 1, 0, 2, 2, "32bppBGRA -> 32bppPBGRA 2x2");
+    test_conversion_rect(&testdata_32bppBGRA_alpha, &testdata_32bppPBGRA_alpha, 3, 1, 1, 1, "32bppBGRA -> 32bppPBGRA 1x1");
+    test_conversion_rect(&testdata_24bppBGR, &testdata_32bppBGRA, 1, 1, 3, 1, "24bppBGR -> 32bppBGRA 3x1");
+    test_conversion_rect(&testdata_24bppRGB, &testdata_32bppPBGRA, 2, 0, 1, 2, "24bppRGB -> 32bppPBGRA 1x2");
+    test_conversion_rect(&testdata_32bppBGRA, &testdata_24bppRGB, 2, 0, 2, 2, "32bppBGRA -> 24bppRGB 2x2");
+
     test_invalid_conversion();
     test_default_converter();
 
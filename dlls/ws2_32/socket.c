@@ -141,6 +141,7 @@
 #include "winuser.h"
 #include "winerror.h"
 #include "winnls.h"
+#include "winreg.h"
 #include "winsock2.h"
 #include "mswsock.h"
 #include "ws2tcpip.h"
@@ -155,6 +156,7 @@
 #include "wine/server.h"
 #include "wine/debug.h"
 #include "wine/exception.h"
+#include "wine/list.h"
 #include "wine/unicode.h"
 
 #ifdef HAS_IPX
@@ -346,6 +348,7 @@ typedef struct ws2_async
     DWORD                               flags;
     DWORD                              *lpFlags;
     WSABUF                             *control;
+    BOOL                                from_batch;  /* served from the datagram batch queue */
     unsigned int                        n_iovecs;
     unsigned int                        first_iovec;
     struct iovec                        iovec[1];
@@ -1893,6 +1896,384 @@ static void WINAPI ws2_async_apc( void *arg, IO_STATUS_BLOCK *iosb, ULONG reserv
     HeapFree( GetProcessHeap(), 0, wsa );
 }
 
+#ifdef HAVE_RECVMMSG
+
+/***********************************************************************
+ * Datagram receive batching
+ *
+ * When enabled through the UdpReceiveBatch setting, a receive on a
+ * datagram socket fetches all the datagrams the kernel has queued (up to
+ * the batch size) with a single recvmmsg() call. The first one is received
+ * straight into the caller's buffers; the others are kept here and handed
+ * out by the next receives without any system call.
+ *
+ * The server doesn't know about queued datagrams, so batching is only done
+ * while the socket isn't in WSAAsyncSelect/WSAEventSelect mode, and select(),
+ * FIONREAD and WSAEnumNetworkEvents take the queue into account.
+ */
+
+#define UDP_BATCH_MAX          256
+#define UDP_BATCH_SLOT_SIZE    65536  /* large enough for any datagram */
+#define UDP_BATCH_CONTROL_SIZE 512
+
+struct udp_batch
+{
+    CRITICAL_SECTION             cs;
+    int                          fd;        /* unix fd of the socket, -1 until the first receive */
+    BOOL                         disabled;  /* the application needs more than plain receives */
+    LONG                         select_mask;
+    unsigned int                 count;     /* number of datagrams received by the last recvmmsg */
+    unsigned int                 next;      /* index of the next queued datagram */
+    struct mmsghdr              *msgs;
+    union generic_unix_sockaddr *addrs;
+    struct iovec                *iov;
+    char                        *data;
+    char                        *control;
+};
+
+/* the queues are attached to the socket handles through a table indexed like
+ * the ntdll fd cache; only datagram sockets created by WSASocket have one */
+#define UDP_BATCH_BLOCK_SIZE  (65536 / sizeof(struct udp_batch *))
+#define UDP_BATCH_ENTRIES     128
+
+static struct udp_batch **udp_batch_table[UDP_BATCH_ENTRIES];
+static SRWLOCK udp_batch_lock = SRWLOCK_INIT;  /* protects the table, not the queues */
+static int udp_batch_size = -1;  /* -1 until the configuration has been read */
+
+static inline DWORD get_config_key( HKEY defkey, HKEY appkey, const char *name,
+                                    char *buffer, DWORD size )
+{
+    if (appkey && !RegQueryValueExA( appkey, name, 0, NULL, (LPBYTE)buffer, &size )) return 0;
+    if (defkey && !RegQueryValueExA( defkey, name, 0, NULL, (LPBYTE)buffer, &size )) return 0;
+    return ERROR_FILE_NOT_FOUND;
+}
+
+/* read the batch size from HKCU\Software\Wine\WinSock or its AppDefaults equivalent */
+static void udp_batch_read_config(void)
+{
+    char buffer[MAX_PATH + 16], *p, *appname;
+    HKEY hkey, tmpkey, appkey = 0;
+    DWORD len;
+
+    udp_batch_size = 0;
+
+    if (RegOpenKeyA( HKEY_CURRENT_USER, "Software\\Wine\\WinSock", &hkey )) hkey = 0;
+
+    len = GetModuleFileNameA( 0, buffer, MAX_PATH );
+    if (len && len < MAX_PATH)
+    {
+        if (!RegOpenKeyA( HKEY_CURRENT_USER, "Software\\Wine\\AppDefaults", &tmpkey ))
+        {
+            if ((p = strrchr( buffer, '/' ))) appname = p + 1;
+            else appname = buffer;
+            if ((p = strrchr( appname, '\\' ))) appname = p + 1;
+            strcat( appname, "\\WinSock" );
+            if (RegOpenKeyA( tmpkey, appname, &appkey )) appkey = 0;
+            RegCloseKey( tmpkey );
+        }
+    }
+
+    if (!get_config_key( hkey, appkey, "UdpReceiveBatch", buffer, sizeof(buffer) ))
+    {
+        udp_batch_size = atoi( buffer );
+        if (udp_batch_size < 2) udp_batch_size = 0;
+        if (udp_batch_size > UDP_BATCH_MAX) udp_batch_size = UDP_BATCH_MAX;
+        TRACE( "receiving up to %d datagrams at once\n", udp_batch_size );
+    }
+
+    if (appkey) RegCloseKey( appkey );
+    if (hkey) RegCloseKey( hkey );
+}
+
+static void udp_batch_free( struct udp_batch *batch )
+{
+    batch->cs.DebugInfo->Spare[0] = 0;
+    DeleteCriticalSection( &batch->cs );
+    HeapFree( GetProcessHeap(), 0, batch->data );
+    HeapFree( GetProcessHeap(), 0, batch->msgs );
+    HeapFree( GetProcessHeap(), 0, batch );
+}
+
+static inline struct udp_batch **udp_batch_slot( SOCKET s, BOOL alloc )
+{
+    unsigned int idx = (s >> 2) - 1, entry = idx / UDP_BATCH_BLOCK_SIZE;
+
+    if (entry >= UDP_BATCH_ENTRIES) return NULL;
+    if (!udp_batch_table[entry])
+    {
+        if (!alloc) return NULL;
+        udp_batch_table[entry] = HeapAlloc( GetProcessHeap(), HEAP_ZERO_MEMORY,
+                                            UDP_BATCH_BLOCK_SIZE * sizeof(struct udp_batch *) );
+        if (!udp_batch_table[entry]) return NULL;
+    }
+    return &udp_batch_table[entry][idx % UDP_BATCH_BLOCK_SIZE];
+}
+
+/* find the queue of a socket and lock it; returns NULL if the socket doesn't batch */
+static struct udp_batch *udp_batch_lock_queue( SOCKET s )
+{
+    struct udp_batch **slot, *batch = NULL;
+
+    if (udp_batch_size <= 0) return NULL;
+
+    AcquireSRWLockShared( &udp_batch_lock );
+    if ((slot = udp_batch_slot( s, FALSE )) && (batch = *slot))
+        EnterCriticalSection( &batch->cs );
+    ReleaseSRWLockShared( &udp_batch_lock );
+    return batch;
+}
+
+static void udp_batch_discard( SOCKET s )
+{
+    struct udp_batch **slot, *batch = NULL;
+
+    if (udp_batch_size <= 0) return;
+
+    AcquireSRWLockExclusive( &udp_batch_lock );
+    if ((slot = udp_batch_slot( s, FALSE )))
+    {
+        batch = *slot;
+        *slot = NULL;
+    }
+    ReleaseSRWLockExclusive( &udp_batch_lock );
+
+    if (!batch) return;
+    /* wait for a receive that found the queue before it was removed */
+    EnterCriticalSection( &batch->cs );
+    LeaveCriticalSection( &batch->cs );
+    udp_batch_free( batch );
+}
+
+/* attach a queue to a newly created socket if it is a datagram socket */
+static void udp_batch_init( SOCKET s, int type )
+{
+    struct udp_batch **slot, *batch;
+
+    udp_batch_discard( s );
+    if (type != SOCK_DGRAM || !udp_batch_size) return;
+
+    AcquireSRWLockExclusive( &udp_batch_lock );
+    if (udp_batch_size == -1) udp_batch_read_config();
+    if (udp_batch_size > 0 && (slot = udp_batch_slot( s, TRUE )) &&
+        (batch = HeapAlloc( GetProcessHeap(), HEAP_ZERO_MEMORY, sizeof(*batch) )))
+    {
+        InitializeCriticalSection( &batch->cs );
+        batch->cs.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": udp_batch.cs");
+        batch->fd = -1;
+        *slot = batch;
+    }
+    ReleaseSRWLockExclusive( &udp_batch_lock );
+}
+
+/* allocate the queue storage on the first receive */
+static BOOL udp_batch_alloc( struct udp_batch *batch )
+{
+    unsigned int i;
+
+    if (batch->msgs) return TRUE;
+
+    batch->msgs = HeapAlloc( GetProcessHeap(), HEAP_ZERO_MEMORY,
+                             udp_batch_size * (sizeof(*batch->msgs) + sizeof(*batch->addrs) +
+                                               sizeof(*batch->iov)) );
+    batch->data = HeapAlloc( GetProcessHeap(), 0, (udp_batch_size - 1) *
+                             (UDP_BATCH_SLOT_SIZE + UDP_BATCH_CONTROL_SIZE) );
+    if (!batch->msgs || !batch->data)
+    {
+        HeapFree( GetProcessHeap(), 0, batch->msgs );
+        HeapFree( GetProcessHeap(), 0, batch->data );
+        batch->msgs = NULL;
+        batch->data = NULL;
+        return FALSE;
+    }
+    batch->addrs   = (union generic_unix_sockaddr *)(batch->msgs + udp_batch_size);
+    batch->iov     = (struct iovec *)(batch->addrs + udp_batch_size);
+    batch->control = batch->data + (udp_batch_size - 1) * UDP_BATCH_SLOT_SIZE;
+
+    /* slot 0 is the caller's buffer, the others point to the queue storage */
+    for (i = 1; i < udp_batch_size; i++)
+    {
+        batch->iov[i].iov_base = batch->data + (i - 1) * UDP_BATCH_SLOT_SIZE;
+        batch->iov[i].iov_len  = UDP_BATCH_SLOT_SIZE;
+        batch->msgs[i].msg_hdr.msg_iov    = &batch->iov[i];
+        batch->msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+    return TRUE;
+}
+
+/* hand out the next queued datagram; must be called with the queue locked */
+static int udp_batch_dequeue( struct udp_batch *batch, struct ws2_async *wsa )
+{
+    struct msghdr *hdr = &batch->msgs[batch->next].msg_hdr;
+    const char *data = batch->iov[batch->next].iov_base;
+    unsigned int i, len, size = batch->msgs[batch->next].msg_len;
+    int n = 0;
+
+    for (i = wsa->first_iovec; i < wsa->n_iovecs && n < size; i++)
+    {
+        len = min( wsa->iovec[i].iov_len, size - n );
+        memcpy( wsa->iovec[i].iov_base, data + n, len );
+        n += len;
+    }
+    if (!(wsa->flags & WS_MSG_PEEK)) batch->next++;
+    wsa->from_batch = TRUE;
+
+#ifdef HAVE_STRUCT_MSGHDR_MSG_ACCRIGHTS
+    if (wsa->control) wsa->control->len = 0;
+#else
+    if (wsa->control && !convert_control_headers( hdr, wsa->control ))
+    {
+        WARN("Application passed insufficient room for control headers.\n");
+        *wsa->lpFlags |= WS_MSG_CTRUNC;
+        errno = EMSGSIZE;
+        return -1;
+    }
+#endif
+    if (wsa->addr && hdr->msg_namelen)
+        ws_sockaddr_u2ws( hdr->msg_name, wsa->addr, wsa->addrlen.ptr );
+    return n;
+}
+
+/***********************************************************************
+ *              udp_batch_recv          (INTERNAL)
+ *
+ * Receive a datagram through the batch queue of the socket.
+ * Returns FALSE if the request can't be batched and must go through recvmsg().
+ */
+static BOOL udp_batch_recv( int fd, struct ws2_async *wsa, int *ret )
+{
+    struct udp_batch *batch;
+    struct msghdr *hdr;
+    unsigned int i;
+    int n;
+
+    /* out of band data never goes through the queue */
+    if (wsa->flags & WS_MSG_OOB) return FALSE;
+    if (!(batch = udp_batch_lock_queue( HANDLE2SOCKET(wsa->hSocket) ))) return FALSE;
+
+    if (batch->fd != fd)
+    {
+        /* first receive, or the queue belongs to a socket that was closed with CloseHandle */
+        if (batch->fd != -1) batch->disabled = TRUE;
+        batch->fd = fd;
+    }
+
+    /* flags and control data are only supported for the datagrams already
+     * queued; after that, the socket goes back to plain recvmsg() */
+    if (wsa->flags || wsa->control) batch->disabled = TRUE;
+
+    if (batch->next < batch->count)
+    {
+        *ret = udp_batch_dequeue( batch, wsa );
+        LeaveCriticalSection( &batch->cs );
+        return TRUE;
+    }
+
+    if (batch->disabled || batch->select_mask || !udp_batch_alloc( batch ))
+    {
+        LeaveCriticalSection( &batch->cs );
+        return FALSE;
+    }
+
+    hdr = &batch->msgs[0].msg_hdr;
+    hdr->msg_iov     = wsa->iovec + wsa->first_iovec;
+    hdr->msg_iovlen  = wsa->n_iovecs - wsa->first_iovec;
+#ifndef HAVE_STRUCT_MSGHDR_MSG_ACCRIGHTS
+    hdr->msg_control = NULL;
+    hdr->msg_controllen = 0;
+#endif
+    for (i = 0; i < udp_batch_size; i++)
+    {
+        /* always fetch the source addresses, a later recvfrom() may need them */
+        batch->msgs[i].msg_hdr.msg_name    = &batch->addrs[i];
+        batch->msgs[i].msg_hdr.msg_namelen = sizeof(batch->addrs[i]);
+#ifndef HAVE_STRUCT_MSGHDR_MSG_ACCRIGHTS
+        if (!i) continue;
+        /* and the control data, in case a later WSARecvMsg asks for it */
+        batch->msgs[i].msg_hdr.msg_control    = batch->control + (i - 1) * UDP_BATCH_CONTROL_SIZE;
+        batch->msgs[i].msg_hdr.msg_controllen = UDP_BATCH_CONTROL_SIZE;
+#endif
+    }
+
+    while ((n = recvmmsg( fd, batch->msgs, udp_batch_size, MSG_DONTWAIT, NULL )) == -1)
+    {
+        if (errno != EINTR) break;
+    }
+
+    if (n == -1 && errno == ENOSYS)
+    {
+        WARN( "recvmmsg not supported, disabling datagram batching\n" );
+        batch->disabled = TRUE;
+        LeaveCriticalSection( &batch->cs );
+        return FALSE;
+    }
+
+    if (n > 0)
+    {
+        batch->count = n;
+        batch->next  = 1;
+        if (wsa->addr && hdr->msg_namelen)
+            ws_sockaddr_u2ws( hdr->msg_name, wsa->addr, wsa->addrlen.ptr );
+        n = batch->msgs[0].msg_len;
+    }
+    LeaveCriticalSection( &batch->cs );
+    *ret = n;
+    return TRUE;
+}
+
+/* returns the size of the next queued datagram, or -1 if there isn't any */
+static int udp_batch_pending( SOCKET s )
+{
+    struct udp_batch *batch;
+    int ret = -1;
+
+    if (!(batch = udp_batch_lock_queue( s ))) return -1;
+    if (batch->next < batch->count) ret = batch->msgs[batch->next].msg_len;
+    LeaveCriticalSection( &batch->cs );
+    return ret;
+}
+
+/* flag the sockets of the read set that have queued datagrams as readable */
+static int udp_batch_poll_results( const WS_fd_set *readfds, struct pollfd *fds )
+{
+    unsigned int i;
+    int count = 0;
+
+    if (!readfds || udp_batch_size <= 0) return 0;
+
+    for (i = 0; i < readfds->fd_count; i++)
+    {
+        if (udp_batch_pending( readfds->fd_array[i] ) == -1) continue;
+        fds[i].revents |= POLLIN;
+        count++;
+    }
+    return count;
+}
+
+/* stop batching once the socket is in asynchronous select mode;
+ * returns TRUE if there are queued datagrams that the application has to be told about */
+static BOOL udp_batch_set_select( SOCKET s, LONG mask )
+{
+    struct udp_batch *batch;
+    BOOL ret;
+
+    if (!(batch = udp_batch_lock_queue( s ))) return FALSE;
+    batch->select_mask = mask;
+    ret = (mask & FD_READ) && batch->next < batch->count;
+    LeaveCriticalSection( &batch->cs );
+    return ret;
+}
+
+#else  /* HAVE_RECVMMSG */
+
+static inline BOOL udp_batch_recv( int fd, struct ws2_async *wsa, int *ret ) { return FALSE; }
+static inline int udp_batch_pending( SOCKET s ) { return -1; }
+static inline int udp_batch_poll_results( const WS_fd_set *readfds, struct pollfd *fds ) { return 0; }
+static inline BOOL udp_batch_set_select( SOCKET s, LONG mask ) { return FALSE; }
+static inline void udp_batch_discard( SOCKET s ) { }
+static inline void udp_batch_init( SOCKET s, int type ) { }
+
+#endif  /* HAVE_RECVMMSG */
+
 /***********************************************************************
  *              WS2_recv                (INTERNAL)
  *
@@ -1907,6 +2288,9 @@ static int WS2_recv( int fd, struct ws2_async *wsa )
     union generic_unix_sockaddr unix_sockaddr;
     int n;
 
+    wsa->from_batch = FALSE;
+    if (udp_batch_recv( fd, wsa, &n )) return n;
+
     hdr.msg_name = NULL;
 
     if (wsa->addr)
@@ -1987,7 +2371,7 @@ static NTSTATUS WS2_async_recv( void* user, IO_STATUS_BLOCK* iosb, NTSTATUS stat
         if (result >= 0)
         {
             status = STATUS_SUCCESS;
-            _enable_event( wsa->hSocket, FD_READ, 0, 0 );
+            if (!wsa->from_batch) _enable_event( wsa->hSocket, FD_READ, 0, 0 );
         }
         else
         {
@@ -2353,6 +2737,7 @@ SOCKET WINAPI WS_accept(SOCKET s, struct WS_sockaddr *addr, int *addrlen32)
         SERVER_END_REQ;
         if (!status)
         {
+            udp_batch_discard( as );
             if (addr && WS_getpeername(as, addr, addrlen32))
             {
                 WS_closesocket(as);
@@ -2730,6 +3115,7 @@ int WINAPI WS_bind(SOCKET s, const struct WS_sockaddr* name, int namelen)
 int WINAPI WS_closesocket(SOCKET s)
 {
     TRACE("socket %04lx\n", s);
+    udp_batch_discard( s );
     if (CloseHandle(SOCKET2HANDLE(s))) return 0;
     return SOCKET_ERROR;
 }
@@ -3846,13 +4232,17 @@ INT WINAPI WSAIoctl(SOCKET s, DWORD code, LPVOID in_buff, DWORD in_size, LPVOID
 
     case WS_FIONREAD:
     {
+        int pending;
+
         if (out_size != sizeof(WS_u_long) || IS_INTRESOURCE(out_buff))
         {
             SetLastError(WSAEFAULT);
             return SOCKET_ERROR;
         }
         if ((fd = get_sock_fd( s, 0, NULL )) == -1) return SOCKET_ERROR;
-        if (ioctl(fd, FIONREAD, out_buff ) == -1)
+        if ((pending = udp_batch_pending( s )) != -1)
+            *(WS_u_long *)out_buff = pending;
+        else if (ioctl(fd, FIONREAD, out_buff ) == -1)
             status = (errno == EBADF) ? WSAENOTSOCK : wsaErrno();
         release_sock_fd( s, fd );
         break;
@@ -4525,6 +4915,9 @@ int WINAPI WS_select(int nfds, WS_fd_set *ws_readfds,
         gettimeofday( &tv1, 0 );
     }
 
+    /* sockets with queued datagrams are already readable, don't wait */
+    if (udp_batch_poll_results( ws_readfds, pollfds )) timeout = 0;
+
     while ((ret = poll( pollfds, count, timeout )) < 0)
     {
         if (errno == EINTR)
@@ -4547,7 +4940,11 @@ int WINAPI WS_select(int nfds, WS_fd_set *ws_readfds,
     release_poll_fds( ws_readfds, ws_writefds, ws_exceptfds, pollfds );
 
     if (ret == -1) SetLastError(wsaErrno());
-    else ret = get_poll_results( ws_readfds, ws_writefds, ws_exceptfds, pollfds );
+    else
+    {
+        udp_batch_poll_results( ws_readfds, pollfds );
+        ret = get_poll_results( ws_readfds, ws_writefds, ws_exceptfds, pollfds );
+    }
     HeapFree( GetProcessHeap(), 0, pollfds );
     return ret;
 }
@@ -6031,6 +6428,8 @@ int WINAPI WSAEnumNetworkEvents(SOCKET s, WSAEVENT hEvent, LPWSANETWORKEVENTS lp
         req->c_event = wine_server_obj_handle( hEvent );
         wine_server_set_reply( req, errors, sizeof(errors) );
         if (!(ret = wine_server_call(req))) lpEvent->lNetworkEvents = reply->pmask & reply->mask;
+        if (!ret && (reply->mask & FD_READ) && udp_batch_pending( s ) != -1)
+            lpEvent->lNetworkEvents |= FD_READ;
     }
     SERVER_END_REQ;
     if (!ret)
@@ -6062,7 +6461,11 @@ int WINAPI WSAEventSelect(SOCKET s, WSAEVENT hEvent, LONG lEvent)
         ret = wine_server_call( req );
     }
     SERVER_END_REQ;
-    if (!ret) return 0;
+    if (!ret)
+    {
+        if (udp_batch_set_select( s, lEvent )) SetEvent( hEvent );
+        return 0;
+    }
     SetLastError(WSAEINVAL);
     return SOCKET_ERROR;
 }
@@ -6131,7 +6534,12 @@ INT WINAPI WSAAsyncSelect(SOCKET s, HWND hWnd, UINT uMsg, LONG lEvent)
         ret = wine_server_call( req );
     }
     SERVER_END_REQ;
-    if (!ret) return 0;
+    if (!ret)
+    {
+        if (udp_batch_set_select( s, lEvent ))
+            PostMessageW( hWnd, uMsg, s, WSAMAKESELECTREPLY( FD_READ, 0 ) );
+        return 0;
+    }
     SetLastError(WSAEINVAL);
     return SOCKET_ERROR;
 }
@@ -6316,6 +6724,7 @@ SOCKET WINAPI WSASocketW(int af, int type, int protocol,
     if (ret)
     {
         TRACE("\tcreated %04lx\n", ret );
+        udp_batch_init( ret, unixtype );
         if (ipxptype > 0)
             set_ipx_packettype(ret, ipxptype);
        return ret;
@@ -6635,7 +7044,7 @@ static int WS2_recv_base( SOCKET s, LPWSABUF lpBuffers, DWORD dwBufferCount,
     unsigned int i, options;
     int n, fd, err, overlapped;
     struct ws2_async *wsa, localwsa;
-    BOOL is_blocking;
+    BOOL is_blocking, from_batch = FALSE;
     DWORD timeout_start = GetTickCount();
     ULONG_PTR cvalue = (lpOverlapped && ((ULONG_PTR)lpOverlapped->hEvent & 1) == 0) ? (ULONG_PTR)lpOverlapped : 0;
 
@@ -6696,6 +7105,7 @@ static int WS2_recv_base( SOCKET s, LPWSABUF lpBuffers, DWORD dwBufferCount,
             }
         }
         else if (lpNumberOfBytesRecvd) *lpNumberOfBytesRecvd = n;
+        from_batch = wsa->from_batch;
 
         if (overlapped)
         {
@@ -6738,7 +7148,7 @@ static int WS2_recv_base( SOCKET s, LPWSABUF lpBuffers, DWORD dwBufferCount,
             }
             else NtQueueApcThread( GetCurrentThread(), (PNTAPCFUNC)ws2_async_apc,
                                    (ULONG_PTR)wsa, (ULONG_PTR)iosb, 0 );
-            _enable_event(SOCKET2HANDLE(s), FD_READ, 0, 0);
+            if (!from_batch) _enable_event(SOCKET2HANDLE(s), FD_READ, 0, 0);
             return 0;
         }
 
@@ -6783,7 +7193,7 @@ static int WS2_recv_base( SOCKET s, LPWSABUF lpBuffers, DWORD dwBufferCount,
     TRACE(" -> %i bytes\n", n);
     if (wsa != &localwsa) HeapFree( GetProcessHeap(), 0, wsa );
     release_sock_fd( s, fd );
-    _enable_event(SOCKET2HANDLE(s), FD_READ, 0, 0);
+    if (!from_batch) _enable_event(SOCKET2HANDLE(s), FD_READ, 0, 0);
     SetLastError(ERROR_SUCCESS);
 
     return 0;
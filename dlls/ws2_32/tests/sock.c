@@ -2019,6 +2019,133 @@ static void test_UDP(void)
     }
 }
 
+static void test_UDP_burst_recv(void)
+{
+    /* several datagrams queued at once must still be received one at a time, in
+     * order, with their own size and source address */
+    struct sockaddr_in addr, from;
+    SOCKET src[2], dst;
+    char buf[256], data[256];
+    struct timeval timeout;
+    fd_set readfds;
+    u_long bytes;
+    int i, ret, len;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = inet_addr(SERVERIP);
+    addr.sin_port = 0;
+
+    dst = socket(AF_INET, SOCK_DGRAM, 0);
+    ok(dst != INVALID_SOCKET, "socket failed: %d\n", WSAGetLastError());
+    ret = bind(dst, (struct sockaddr *)&addr, sizeof(addr));
+    ok(!ret, "bind failed: %d\n", WSAGetLastError());
+    len = sizeof(addr);
+    ret = getsockname(dst, (struct sockaddr *)&addr, &len);
+    ok(!ret, "getsockname failed: %d\n", WSAGetLastError());
+
+    for (i = 0; i < 2; i++)
+    {
+        src[i] = socket(AF_INET, SOCK_DGRAM, 0);
+        ok(src[i] != INVALID_SOCKET, "socket failed: %d\n", WSAGetLastError());
+    }
+
+    for (i = 0; i < sizeof(data); i++) data[i] = i;
+    for (i = 0; i < 16; i++)
+    {
+        ret = sendto(src[i % 2], data, i + 1, 0, (struct sockaddr *)&addr, sizeof(addr));
+        ok(ret == i + 1, "sendto returned %d: %d\n", ret, WSAGetLastError());
+    }
+
+    /* receive the first datagram, the others stay pending */
+    len = sizeof(from);
+    ret = recvfrom(dst, buf, sizeof(buf), 0, (struct sockaddr *)&from, &len);
+    ok(ret == 1, "recvfrom returned %d: %d\n", ret, WSAGetLastError());
+
+    FD_ZERO(&readfds);
+    FD_SET(dst, &readfds);
+    timeout.tv_sec = 0;
+    timeout.tv_usec = 0;
+    ret = select(0, &readfds, NULL, NULL, &timeout);
+    ok(ret == 1, "select returned %d\n", ret);
+    ok(FD_ISSET(dst, &readfds), "socket should be readable\n");
+
+    bytes = 0;
+    ret = ioctlsocket(dst, FIONREAD, &bytes);
+    ok(!ret, "ioctlsocket failed: %d\n", WSAGetLastError());
+    ok(bytes >= 2, "got %u bytes pending\n", bytes);
+
+    /* peeking must not skip or consume the pending datagrams */
+    memset(buf, 0xcc, sizeof(buf));
+    ret = recv(dst, buf, sizeof(buf), MSG_PEEK);
+    ok(ret == 2, "recv returned %d: %d\n", ret, WSAGetLastError());
+    ok(!memcmp(buf, data, 2), "wrong data\n");
+
+    for (i = 1; i < 16; i++)
+    {
+        struct sockaddr_in peer;
+
+        len = sizeof(peer);
+        ret = getsockname(src[i % 2], (struct sockaddr *)&peer, &len);
+        ok(!ret, "getsockname failed: %d\n", WSAGetLastError());
+
+        memset(buf, 0xcc, sizeof(buf));
+        len = sizeof(from);
+        ret = recvfrom(dst, buf, sizeof(buf), 0, (struct sockaddr *)&from, &len);
+        ok(ret == i + 1, "%d: recvfrom returned %d: %d\n", i, ret, WSAGetLastError());
+        ok(!memcmp(buf, data, i + 1), "%d: wrong data\n", i);
+        ok(from.sin_port == peer.sin_port, "%d: got port %u, expected %u\n",
+           i, ntohs(from.sin_port), ntohs(peer.sin_port));
+    }
+
+    FD_ZERO(&readfds);
+    FD_SET(dst, &readfds);
+    ret = select(0, &readfds, NULL, NULL, &timeout);
+    ok(ret == 0, "select returned %d\n", ret);
+
+    closesocket(src[0]);
+    closesocket(src[1]);
+    closesocket(dst);
+}
+
+static void test_UDP_burst(const char *argv0)
+{
+    char cmd[MAX_PATH + 32];
+    PROCESS_INFORMATION info;
+    STARTUPINFOA startup;
+    DWORD disposition;
+    HKEY hkey;
+    LONG err;
+    BOOL ret;
+
+    test_UDP_burst_recv();
+
+    /* the batch size is read when the first datagram socket is created, so
+     * run the test again in a new process with Wine's receive batching on */
+    err = RegCreateKeyExA(HKEY_CURRENT_USER, "Software\\Wine\\WinSock", 0, NULL, 0, KEY_ALL_ACCESS,
+                          NULL, &hkey, &disposition);
+    ok(!err, "RegCreateKeyEx failed with %d\n", err);
+    if (err) return;
+    RegSetValueExA(hkey, "UdpReceiveBatch", 0, REG_SZ, (const BYTE *)"8", 2);
+
+    memset(&startup, 0, sizeof(startup));
+    startup.cb = sizeof(startup);
+    sprintf(cmd, "\"%s\" sock udp_burst", argv0);
+    ret = CreateProcessA(NULL, cmd, NULL, NULL, FALSE, 0, NULL, NULL, &startup, &info);
+    ok(ret, "CreateProcess failed with %u\n", GetLastError());
+    if (ret)
+    {
+        winetest_wait_child_process(info.hProcess);
+        CloseHandle(info.hThread);
+        CloseHandle(info.hProcess);
+    }
+
+    RegDeleteValueA(hkey, "UdpReceiveBatch");
+    RegCloseKey(hkey);
+    if (disposition == REG_CREATED_NEW_KEY)
+        RegDeleteKeyA(HKEY_CURRENT_USER, "Software\\Wine\\WinSock");
+}
+
 static DWORD WINAPI do_getservbyname( void *param )
 {
     struct {
@@ -8210,7 +8337,17 @@ todo_wine
 
 START_TEST( sock )
 {
-    int i;
+    int i, argc;
+    char **argv;
+
+    argc = winetest_get_mainargs(&argv);
+    if (argc >= 3 && !strcmp(argv[2], "udp_burst"))
+    {
+        Init();
+        test_UDP_burst_recv();
+        Exit();
+        return;
+    }
 
 /* Leave these tests at the beginning. They depend on WSAStartup not having been
  * called, which is done by Init() below. */
@@ -8234,6 +8371,7 @@ START_TEST( sock )
     }
 
     test_UDP();
+    test_UDP_burst(argv[0]);
 
     test_getservbyname();
     test_WSASocket();
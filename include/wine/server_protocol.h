@@ -1382,6 +1382,8 @@ struct get_handle_fd_reply
     int          cacheable;
     unsigned int access;
     unsigned int options;
+    int          pipe_ring;
+    char __pad_28[4];
 };
 enum server_fd_type
 {
@@ -3167,6 +3169,7 @@ struct create_named_pipe_reply
 #define NAMED_PIPE_MESSAGE_STREAM_WRITE 0x0001
 #define NAMED_PIPE_MESSAGE_STREAM_READ  0x0002
 #define NAMED_PIPE_NONBLOCKING_MODE     0x0004
+#define NAMED_PIPE_SHARED_MEMORY        0x0008
 #define NAMED_PIPE_SERVER_END           0x8000
 
 
@@ -3200,6 +3203,41 @@ struct set_named_pipe_info_reply
 };
 
 
+struct get_named_pipe_ring_request
+{
+    struct request_header __header;
+    obj_handle_t   handle;
+};
+struct get_named_pipe_ring_reply
+{
+    struct reply_header __header;
+    data_size_t    size;
+    int            end;
+};
+
+
+struct pipe_ring
+{
+    int            read_lock;
+    int            write_lock;
+    int            seq;
+    int            waiters;
+    unsigned int   head;
+    unsigned int   tail;
+    unsigned int   avail;
+    unsigned int   messages;
+    unsigned int   partial;
+    unsigned int   flags;
+    unsigned int   closed;
+    unsigned int   size;
+    unsigned int   offset;
+    unsigned int   __pad[3];
+};
+
+#define PIPE_RING_CLOSED     1
+#define PIPE_RING_DISCARDED  2
+
+
 struct create_window_request
 {
     struct request_header __header;
@@ -5214,6 +5252,7 @@ enum request
     REQ_create_named_pipe,
     REQ_get_named_pipe_info,
     REQ_set_named_pipe_info,
+    REQ_get_named_pipe_ring,
     REQ_create_window,
     REQ_destroy_window,
     REQ_get_desktop_window,
@@ -5476,6 +5515,7 @@ union generic_request
     struct create_named_pipe_request create_named_pipe_request;
     struct get_named_pipe_info_request get_named_pipe_info_request;
     struct set_named_pipe_info_request set_named_pipe_info_request;
+    struct get_named_pipe_ring_request get_named_pipe_ring_request;
     struct create_window_request create_window_request;
     struct destroy_window_request destroy_window_request;
     struct get_desktop_window_request get_desktop_window_request;
@@ -5736,6 +5776,7 @@ union generic_reply
     struct create_named_pipe_reply create_named_pipe_reply;
     struct get_named_pipe_info_reply get_named_pipe_info_reply;
     struct set_named_pipe_info_reply set_named_pipe_info_reply;
+    struct get_named_pipe_ring_reply get_named_pipe_ring_reply;
     struct create_window_reply create_window_reply;
     struct destroy_window_reply destroy_window_reply;
     struct get_desktop_window_reply get_desktop_window_reply;
@@ -5847,6 +5888,6 @@ union generic_reply
     struct set_suspend_context_reply set_suspend_context_reply;
 };
 
-#define SERVER_PROTOCOL_VERSION 458
+#define SERVER_PROTOCOL_VERSION 460
 
 #endif /* __WINE_WINE_SERVER_PROTOCOL_H */
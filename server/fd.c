@@ -185,6 +185,7 @@ struct fd
     unsigned int         cacheable :1;/* can the fd be cached on the client side? */
     unsigned int         signaled :1; /* is the fd signaled? */
     unsigned int         fs_locks :1; /* can we use filesystem locks for this fd? */
+    unsigned int         pipe_ring :1;/* does the fd have a shared memory pipe transport? */
     int                  poll_index;  /* index of fd in poll array */
     struct async_queue  *read_q;      /* async readers of this fd */
     struct async_queue  *write_q;     /* async writers of this fd */
@@ -1588,6 +1589,7 @@ static struct fd *alloc_fd_object(void)
     fd->cacheable  = 0;
     fd->signaled   = 1;
     fd->fs_locks   = 1;
+    fd->pipe_ring  = 0;
     fd->poll_index = -1;
     fd->read_q     = NULL;
     fd->write_q    = NULL;
@@ -1623,6 +1625,7 @@ struct fd *alloc_pseudo_fd( const struct fd_ops *fd_user_ops, struct object *use
     fd->cacheable  = 0;
     fd->signaled   = 0;
     fd->fs_locks   = 0;
+    fd->pipe_ring  = 0;
     fd->poll_index = -1;
     fd->read_q     = NULL;
     fd->write_q    = NULL;
@@ -1644,6 +1647,7 @@ struct fd *dup_fd_object( struct fd *orig, unsigned int access, unsigned int sha
 
     fd->options    = options;
     fd->cacheable  = orig->cacheable;
+    fd->pipe_ring  = orig->pipe_ring;
 
     if (orig->unix_name)
     {
@@ -1936,6 +1940,12 @@ void allow_fd_caching( struct fd *fd )
     fd->cacheable = 1;
 }
 
+/* mark the fd as having a shared memory pipe transport */
+void set_fd_pipe_ring( struct fd *fd )
+{
+    fd->pipe_ring = 1;
+}
+
 /* check if fd is on a removable device */
 int is_fd_removable( struct fd *fd )
 {
@@ -2285,6 +2295,7 @@ DECL_HANDLER(get_handle_fd)
         {
             reply->type = fd->fd_ops->get_fd_type( fd );
             reply->cacheable = fd->cacheable;
+            reply->pipe_ring = fd->pipe_ring;
             reply->options = fd->options;
             reply->access = get_handle_access( current->process, req->handle );
             send_client_fd( current->process, unix_fd, req->handle );
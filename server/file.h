@@ -76,6 +76,7 @@ extern void set_fd_events( struct fd *fd, int events );
 extern obj_handle_t lock_fd( struct fd *fd, file_pos_t offset, file_pos_t count, int shared, int wait );
 extern void unlock_fd( struct fd *fd, file_pos_t offset, file_pos_t count );
 extern void allow_fd_caching( struct fd *fd );
+extern void set_fd_pipe_ring( struct fd *fd );
 extern void set_fd_signaled( struct fd *fd, int signaled );
 extern int is_fd_signaled( struct fd *fd );
 
@@ -132,6 +133,7 @@ extern struct mapping *get_mapping_obj( struct process *process, obj_handle_t ha
 extern obj_handle_t open_mapping_file( struct process *process, struct mapping *mapping,
                                        unsigned int access, unsigned int sharing );
 extern struct mapping *grab_mapping_unless_removable( struct mapping *mapping );
+extern int create_temp_file( file_pos_t size );
 extern int get_page_size(void);
 
 /* change notification functions */
@@ -27,6 +27,7 @@
 
 #include <assert.h>
 #include <fcntl.h>
+#include <limits.h>
 #include <string.h>
 #include <stdarg.h>
 #include <stdio.h>
@@ -36,6 +37,12 @@
 #ifdef HAVE_SYS_SOCKET_H
 #include <sys/socket.h>
 #endif
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+#ifdef HAVE_SYS_SYSCALL_H
+#include <sys/syscall.h>
+#endif
 #include <time.h>
 #include <unistd.h>
 #ifdef HAVE_POLL_H
@@ -79,6 +86,9 @@ struct pipe_server
     struct event        *event;
     unsigned int         options;    /* pipe options */
     unsigned int         pipe_flags;
+    int                  ring_fd;    /* fd of the shared memory transport, -1 if not used */
+    struct pipe_ring    *ring;       /* server view of the shared memory transport rings */
+    data_size_t          ring_size;  /* size of the shared memory transport mapping */
 };
 
 struct pipe_client
@@ -99,6 +109,7 @@ struct named_pipe
     unsigned int        outsize;
     unsigned int        insize;
     unsigned int        instances;
+    unsigned int        ring_size;   /* size of the shared memory rings, 0 if not used */
     timeout_t           timeout;
     struct list         servers;     /* list of servers using this pipe */
     struct async_queue *waiters;     /* list of clients waiting to connect */
@@ -363,6 +374,112 @@ static void notify_empty( struct pipe_server *server )
     server->event = NULL;
 }
 
+/* message framing is fixed by the pipe type, the read mode is chosen by the reading end */
+static unsigned int get_pipe_ring_flags( struct named_pipe *pipe, unsigned int pipe_flags )
+{
+    return (pipe->flags & NAMED_PIPE_MESSAGE_STREAM_WRITE) | (pipe_flags & NAMED_PIPE_MESSAGE_STREAM_READ);
+}
+
+#ifdef __linux__
+
+/* limits for the size of each shared memory ring */
+#define PIPE_RING_MIN_SIZE  0x10000
+#define PIPE_RING_MAX_SIZE  0x100000
+
+static unsigned int get_pipe_ring_size( unsigned int insize, unsigned int outsize )
+{
+    unsigned int size = PIPE_RING_MIN_SIZE;
+
+    while ((size < insize || size < outsize) && size < PIPE_RING_MAX_SIZE) size <<= 1;
+    return size;
+}
+
+/* the rings are shared between processes, so we can't use private futexes */
+static void wake_pipe_ring( struct pipe_ring *ring )
+{
+    interlocked_xchg_add( &ring->seq, 1 );
+    syscall( __NR_futex, &ring->seq, 1 /* FUTEX_WAKE */, INT_MAX, NULL, 0, 0 );
+}
+
+/* create the shared memory transport of a newly connected pipe */
+static void create_pipe_rings( struct pipe_server *server, struct pipe_client *client )
+{
+    unsigned int size = server->pipe->ring_size;
+    data_size_t total = 2 * sizeof(struct pipe_ring) + 2 * size;
+    struct pipe_ring *ring;
+    int fd;
+
+    /* the transport is optional, fall back to the socket on failure */
+    if ((fd = create_temp_file( total )) == -1)
+    {
+        clear_error();
+        return;
+    }
+    if ((ring = mmap( NULL, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 )) == MAP_FAILED)
+    {
+        close( fd );
+        return;
+    }
+
+    /* ring 0 carries data from the server to the client, ring 1 the other way round */
+    ring[0].size   = ring[1].size = size;
+    ring[0].offset = 2 * sizeof(struct pipe_ring);
+    ring[1].offset = ring[0].offset + size;
+    ring[0].flags  = get_pipe_ring_flags( server->pipe, client->pipe_flags );
+    ring[1].flags  = get_pipe_ring_flags( server->pipe, server->pipe_flags );
+
+    server->ring_fd   = fd;
+    server->ring      = ring;
+    server->ring_size = total;
+    set_fd_pipe_ring( server->fd );
+    set_fd_pipe_ring( client->fd );
+}
+
+/* flag the shared memory transport as closed and wake up all waiters */
+static void close_pipe_rings( struct pipe_server *server, unsigned int how )
+{
+    int i;
+
+    if (!server->ring) return;
+    for (i = 0; i < 2; i++)
+    {
+        if (server->ring[i].closed < how) server->ring[i].closed = how;
+        wake_pipe_ring( &server->ring[i] );
+    }
+}
+
+static void release_pipe_rings( struct pipe_server *server )
+{
+    if (!server->ring) return;
+    close_pipe_rings( server, PIPE_RING_CLOSED );
+    munmap( server->ring, server->ring_size );
+    close( server->ring_fd );
+    server->ring      = NULL;
+    server->ring_fd   = -1;
+    server->ring_size = 0;
+}
+
+#else  /* __linux__ */
+
+static unsigned int get_pipe_ring_size( unsigned int insize, unsigned int outsize )
+{
+    return 0;
+}
+
+static void create_pipe_rings( struct pipe_server *server, struct pipe_client *client )
+{
+}
+
+static void close_pipe_rings( struct pipe_server *server, unsigned int how )
+{
+}
+
+static void release_pipe_rings( struct pipe_server *server )
+{
+}
+
+#endif  /* __linux__ */
+
 static void do_disconnect( struct pipe_server *server )
 {
     /* we may only have a server fd, if the client disconnected */
@@ -377,6 +494,7 @@ static void do_disconnect( struct pipe_server *server )
     shutdown( get_unix_fd( server->fd ), SHUT_RDWR );
     release_object( server->fd );
     server->fd = NULL;
+    release_pipe_rings( server );
 }
 
 static void pipe_server_destroy( struct object *obj)
@@ -416,6 +534,9 @@ static void pipe_client_destroy( struct object *obj)
     {
         notify_empty( server );
 
+        /* keep the rings around so that the server can read the remaining data */
+        close_pipe_rings( server, PIPE_RING_CLOSED );
+
         switch(server->state)
         {
         case ps_connected_server:
@@ -652,11 +773,13 @@ static obj_handle_t pipe_server_ioctl( struct fd *fd, ioctl_code_t code, const a
 
             /* dump the client and server fds, but keep the pointers
                around - client loses all waiting data */
+            close_pipe_rings( server, PIPE_RING_DISCARDED );
             do_disconnect( server );
             set_server_state( server, ps_disconnected_server );
             break;
         case ps_wait_disconnect:
             assert( !server->client );
+            close_pipe_rings( server, PIPE_RING_DISCARDED );
             do_disconnect( server );
             set_server_state( server, ps_wait_connect );
             break;
@@ -742,6 +865,9 @@ static struct pipe_server *create_pipe_server( struct named_pipe *pipe, unsigned
     server->flush_poll = NULL;
     server->options = options;
     server->pipe_flags = pipe_flags;
+    server->ring_fd = -1;
+    server->ring = NULL;
+    server->ring_size = 0;
 
     list_add_head( &pipe->servers, &server->entry );
     grab_object( pipe );
@@ -850,6 +976,9 @@ static struct object *named_pipe_open_file( struct object *obj, unsigned int acc
                 set_server_state( server, ps_connected_server );
                 server->client = client;
                 client->server = server;
+                /* data can only bypass the socket if nobody needs to poll it */
+                if (pipe->ring_size && !is_overlapped( options ) && !is_overlapped( server->options ))
+                    create_pipe_rings( server, client );
             }
             else
             {
@@ -980,6 +1109,8 @@ DECL_HANDLER(create_named_pipe)
         pipe->timeout = req->timeout;
         pipe->flags = req->flags & NAMED_PIPE_MESSAGE_STREAM_WRITE;
         pipe->sharing = req->sharing;
+        pipe->ring_size = (req->flags & NAMED_PIPE_SHARED_MEMORY) ?
+                          get_pipe_ring_size( req->insize, req->outsize ) : 0;
     }
     else
     {
@@ -998,7 +1129,7 @@ DECL_HANDLER(create_named_pipe)
         clear_error(); /* clear the name collision */
     }
 
-    server = create_pipe_server( pipe, req->options, req->flags );
+    server = create_pipe_server( pipe, req->options, req->flags & ~NAMED_PIPE_SHARED_MEMORY );
     if (server)
     {
         reply->handle = alloc_handle( current->process, server, req->access, req->attributes );
@@ -1073,10 +1204,47 @@ DECL_HANDLER(set_named_pipe_info)
     else if (client)
     {
         client->pipe_flags = server->pipe->flags | req->flags;
+        if (server->ring) server->ring[0].flags = get_pipe_ring_flags( server->pipe, client->pipe_flags );
     }
     else
     {
         server->pipe_flags = server->pipe->flags | req->flags;
+        if (server->ring) server->ring[1].flags = get_pipe_ring_flags( server->pipe, server->pipe_flags );
+    }
+
+    if (client)
+        release_object(client);
+    else
+        release_object(server);
+}
+
+DECL_HANDLER(get_named_pipe_ring)
+{
+    struct pipe_server *server;
+    struct pipe_client *client = NULL;
+
+    server = get_pipe_server_obj( current->process, req->handle, 0 );
+    if (!server)
+    {
+        if (get_error() != STATUS_OBJECT_TYPE_MISMATCH)
+            return;
+
+        clear_error();
+        client = (struct pipe_client *)get_handle_obj( current->process, req->handle,
+                                                       0, &pipe_client_ops );
+        if (!client) return;
+        server = client->fd ? client->server : NULL;
+    }
+
+    if (!server || !server->fd)
+        set_error( STATUS_PIPE_DISCONNECTED );
+    else if (!server->ring)
+        set_error( STATUS_NOT_SUPPORTED );
+    else
+    {
+        reply->size = server->ring_size;
+        reply->end  = client ? 1 : 0;
+        send_client_fd( current->process, server->ring_fd, req->handle );
     }
 
     if (client)
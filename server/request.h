@@ -252,6 +252,7 @@ DECL_HANDLER(get_ioctl_result);
 DECL_HANDLER(create_named_pipe);
 DECL_HANDLER(get_named_pipe_info);
 DECL_HANDLER(set_named_pipe_info);
+DECL_HANDLER(get_named_pipe_ring);
 DECL_HANDLER(create_window);
 DECL_HANDLER(destroy_window);
 DECL_HANDLER(get_desktop_window);
@@ -513,6 +514,7 @@ static const req_handler req_handlers[REQ_NB_REQUESTS] =
     (req_handler)req_create_named_pipe,
     (req_handler)req_get_named_pipe_info,
     (req_handler)req_set_named_pipe_info,
+    (req_handler)req_get_named_pipe_ring,
     (req_handler)req_create_window,
     (req_handler)req_destroy_window,
     (req_handler)req_get_desktop_window,
@@ -934,7 +936,8 @@ C_ASSERT( FIELD_OFFSET(struct get_handle_fd_reply, type) == 8 );
 C_ASSERT( FIELD_OFFSET(struct get_handle_fd_reply, cacheable) == 12 );
 C_ASSERT( FIELD_OFFSET(struct get_handle_fd_reply, access) == 16 );
 C_ASSERT( FIELD_OFFSET(struct get_handle_fd_reply, options) == 20 );
-C_ASSERT( sizeof(struct get_handle_fd_reply) == 24 );
+C_ASSERT( FIELD_OFFSET(struct get_handle_fd_reply, pipe_ring) == 24 );
+C_ASSERT( sizeof(struct get_handle_fd_reply) == 32 );
 C_ASSERT( FIELD_OFFSET(struct flush_file_request, handle) == 12 );
 C_ASSERT( sizeof(struct flush_file_request) == 16 );
 C_ASSERT( FIELD_OFFSET(struct flush_file_reply, event) == 8 );
@@ -1539,6 +1542,11 @@ C_ASSERT( sizeof(struct get_named_pipe_info_reply) == 32 );
 C_ASSERT( FIELD_OFFSET(struct set_named_pipe_info_request, handle) == 12 );
 C_ASSERT( FIELD_OFFSET(struct set_named_pipe_info_request, flags) == 16 );
 C_ASSERT( sizeof(struct set_named_pipe_info_request) == 24 );
+C_ASSERT( FIELD_OFFSET(struct get_named_pipe_ring_request, handle) == 12 );
+C_ASSERT( sizeof(struct get_named_pipe_ring_request) == 16 );
+C_ASSERT( FIELD_OFFSET(struct get_named_pipe_ring_reply, size) == 8 );
+C_ASSERT( FIELD_OFFSET(struct get_named_pipe_ring_reply, end) == 12 );
+C_ASSERT( sizeof(struct get_named_pipe_ring_reply) == 16 );
 C_ASSERT( FIELD_OFFSET(struct create_window_request, parent) == 12 );
 C_ASSERT( FIELD_OFFSET(struct create_window_request, owner) == 16 );
 C_ASSERT( FIELD_OFFSET(struct create_window_request, atom) == 20 );
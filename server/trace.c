@@ -1626,6 +1626,7 @@ static void dump_get_handle_fd_reply( const struct get_handle_fd_reply *req )
     fprintf( stderr, ", cacheable=%d", req->cacheable );
     fprintf( stderr, ", access=%08x", req->access );
     fprintf( stderr, ", options=%08x", req->options );
+    fprintf( stderr, ", pipe_ring=%d", req->pipe_ring );
 }
 
 static void dump_flush_file_request( const struct flush_file_request *req )
@@ -2782,6 +2783,17 @@ static void dump_set_named_pipe_info_request( const struct set_named_pipe_info_r
     fprintf( stderr, ", flags=%08x", req->flags );
 }
 
+static void dump_get_named_pipe_ring_request( const struct get_named_pipe_ring_request *req )
+{
+    fprintf( stderr, " handle=%04x", req->handle );
+}
+
+static void dump_get_named_pipe_ring_reply( const struct get_named_pipe_ring_reply *req )
+{
+    fprintf( stderr, " size=%u", req->size );
+    fprintf( stderr, ", end=%d", req->end );
+}
+
 static void dump_create_window_request( const struct create_window_request *req )
 {
     fprintf( stderr, " parent=%08x", req->parent );
@@ -4233,6 +4245,7 @@ static const dump_func req_dumpers[REQ_NB_REQUESTS] = {
     (dump_func)dump_create_named_pipe_request,
     (dump_func)dump_get_named_pipe_info_request,
     (dump_func)dump_set_named_pipe_info_request,
+    (dump_func)dump_get_named_pipe_ring_request,
     (dump_func)dump_create_window_request,
     (dump_func)dump_destroy_window_request,
     (dump_func)dump_get_desktop_window_request,
@@ -4491,6 +4504,7 @@ static const dump_func reply_dumpers[REQ_NB_REQUESTS] = {
     (dump_func)dump_create_named_pipe_reply,
     (dump_func)dump_get_named_pipe_info_reply,
     NULL,
+    (dump_func)dump_get_named_pipe_ring_reply,
     (dump_func)dump_create_window_reply,
     NULL,
     (dump_func)dump_get_desktop_window_reply,
@@ -4749,6 +4763,7 @@ static const char * const req_names[REQ_NB_REQUESTS] = {
     "create_named_pipe",
     "get_named_pipe_info",
     "set_named_pipe_info",
+    "get_named_pipe_ring",
     "create_window",
     "destroy_window",
     "get_desktop_window",